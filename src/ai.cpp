@@ -7,14 +7,19 @@
 
 #include <iostream>
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <cstring>
 #include <ctime>
 #include <cmath>
+#include <cassert>
 #include "ai.h"
 #include "ansi.h"
 #include "gomoku.hpp"
-#include "util/thread_pool.hpp"
+#include "search_scratch.hpp"
+#include "search_metrics.hpp"
+#include "move_picker.hpp"
+#include "threat_search.hpp"
 
 //===============================================================================
 // AI CONSTANTS AND STRUCTURES
@@ -23,46 +28,54 @@
 #define MAX_RADIUS 2
 #define WIN_SCORE 1000000
 
+// Late move reductions: quiet moves tried after the first few at a node are
+// searched a ply shallower first
+#define LMR_MIN_DEPTH 3
+#define LMR_FULL_DEPTH_MOVES 3
+#define LMR_QUIET_PRIORITY 100
+
 //===============================================================================
 // OPTIMIZED MOVE GENERATION
 //===============================================================================
 
 /**
- * Optimized move generation using cached interesting moves
+ * Optimized move generation using the incrementally maintained candidate set
  */
+template<int Size> requires gomoku::ValidBoardSize<Size>
 int generate_moves_optimized(game_state_t *game, move_t *moves, int current_player) {
     int move_count = 0;
 
-    // Use cached interesting moves
-    for (int i = 0; i < game->interesting_move_count; i++) {
-        if (game->interesting_moves[i].is_active &&
-                game->board[game->interesting_moves[i].x][game->interesting_moves[i].y] == static_cast<int>(gomoku::Player::Empty)) {
-
-            moves[move_count].x = game->interesting_moves[i].x;
-            moves[move_count].y = game->interesting_moves[i].y;
-            moves[move_count].priority = get_move_priority_optimized(game,
-                    game->interesting_moves[i].x, game->interesting_moves[i].y, current_player);
-            move_count++;
-        }
-    }
+    game->candidates.for_each([&](int x, int y) {
+        moves[move_count].x = x;
+        moves[move_count].y = y;
+        moves[move_count].priority = get_move_priority_optimized<Size>(game, x, y, current_player);
+        move_count++;
+    });
 
     return move_count;
 }
 
+int generate_moves_optimized(game_state_t *game, move_t *moves, int current_player) {
+    return gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        return generate_moves_optimized<Size>(game, moves, current_player);
+    });
+}
+
 /**
  * Optimized move prioritization that avoids expensive temporary placements
  */
+template<int Size> requires gomoku::ValidBoardSize<Size>
 int get_move_priority_optimized(game_state_t *game, int x, int y, int player) {
-    int center = game->board_size / 2;
+    constexpr int center = Size / 2;
     int priority = 0;
 
     // Center bias - closer to center is better
     int center_dist = abs(x - center) + abs(y - center);
-    priority += std::max(0, game->board_size - center_dist);
+    priority += std::max(0, Size - center_dist);
 
     // Quick threat evaluation without temporary placement
-    int my_threat = evaluate_threat_fast(game->board, x, y, player, game->board_size);
-    int opp_threat = evaluate_threat_fast(game->board, x, y, other_player(player), game->board_size);
+    int my_threat = evaluate_threat_fast(game->bitboard, x, y, player);
+    int opp_threat = evaluate_threat_fast(game->bitboard, x, y, other_player(player));
 
     // Immediate win detection
     if (my_threat >= 100000) {
@@ -74,11 +87,6 @@ int get_move_priority_optimized(game_state_t *game, int x, int y, int player) {
         return 50000;
     }
 
-    // Killer move bonus
-    if (is_killer_move(game, game->max_depth, x, y)) {
-        priority += 10000;
-    }
-
     // Prioritize offensive and defensive moves
     priority += my_threat / 10;   // Our opportunities
     priority += opp_threat / 5;   // Blocking opponent
@@ -86,6 +94,28 @@ int get_move_priority_optimized(game_state_t *game, int x, int y, int player) {
     return priority;
 }
 
+int get_move_priority_optimized(game_state_t *game, int x, int y, int player) {
+    return gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        return get_move_priority_optimized<Size>(game, x, y, player);
+    });
+}
+
+/**
+ * Maps the length of a run created by a move onto its threat level
+ */
+static int run_threat_score(int count) {
+    if (count >= 5) {
+        return 100000; // Win
+    } else if (count == 4) {
+        return 10000;  // Strong threat
+    } else if (count == 3) {
+        return 1000;   // Medium threat
+    } else if (count == 2) {
+        return 100;    // Weak threat
+    }
+    return 0;
+}
+
 /**
  * Fast threat evaluation without temporary board modifications
  */
@@ -119,19 +149,18 @@ int evaluate_threat_fast(int **board, int x, int y, int player, int board_size)
             ny -= dy;
         }
 
-        // Evaluate threat level
-        int threat = 0;
-        if (count >= 5) {
-            threat = 100000; // Win
-        } else if (count == 4) {
-            threat = 10000;  // Strong threat
-        } else if (count == 3) {
-            threat = 1000;   // Medium threat
-        } else if (count == 2) {
-            threat = 100;    // Weak threat
-        }
+        max_threat = std::max(max_threat, run_threat_score(count));
+    }
+
+    return max_threat;
+}
+
+int evaluate_threat_fast(const gomoku::BitBoard &board, int x, int y, int player) {
+    gomoku::Player stone = static_cast<gomoku::Player>(player);
+    int max_threat = 0;
 
-        max_threat = std::max(max_threat, threat);
+    for (int d = 0; d < gomoku::NUM_DIRECTIONS; d++) {
+        max_threat = std::max(max_threat, run_threat_score(board.run_length(stone, d, x, y)));
     }
 
     return max_threat;
@@ -209,115 +238,199 @@ int compare_moves(const void *a, const void *b) {
 // MINIMAX ALGORITHM
 //===============================================================================
 
+/**
+ * Searches the position after move, the searched-th move tried at a node of
+ * the given depth, and returns its score. Under PVS only the first move gets
+ * the full window: later ones are first shown to be no better than the best
+ * so far with a null window, a ply shallower when they are late and quiet,
+ * and only searched again in full when that fails.
+ */
+template<int Size>
+static int search_move(game_state_t *game, const move_t &move, int searched, int depth,
+        int alpha, int beta, int maximizing_player, int ai_player, int ply) {
+    int child = !maximizing_player;
+    if (!game->use_principal_variation || searched == 0) {
+        return minimax_with_timeout<Size>(game, depth - 1, alpha, beta, child, ai_player, move.x, move.y, ply + 1);
+    }
+
+    // The best so far is alpha for the maximizer and beta for the minimizer
+    int null_alpha = maximizing_player ? alpha : beta - 1;
+    auto improves = [&](int eval) { return maximizing_player ? eval > alpha : eval < beta; };
+
+    int reduction = (depth >= LMR_MIN_DEPTH && searched >= LMR_FULL_DEPTH_MOVES &&
+                     move.priority < LMR_QUIET_PRIORITY) ? 1 : 0;
+    int eval = minimax_with_timeout<Size>(game, depth - 1 - reduction, null_alpha, null_alpha + 1,
+            child, ai_player, move.x, move.y, ply + 1);
+    if (reduction && improves(eval)) {
+        eval = minimax_with_timeout<Size>(game, depth - 1, null_alpha, null_alpha + 1, child, ai_player,
+                move.x, move.y, ply + 1);
+    }
+    if (improves(eval) && eval > alpha && eval < beta) {
+        eval = minimax_with_timeout<Size>(game, depth - 1, alpha, beta, child, ai_player, move.x, move.y, ply + 1);
+    }
+    return eval;
+}
+
+/**
+ * Feeds a cutoff back into move ordering: the move becomes a killer at its
+ * ply, the countermove to the move before it, and earns history credit.
+ */
+static void store_cutoff_move(game_state_t *game, int ply, int depth, int player,
+        int last_x, int last_y, int x, int y) {
+    store_killer_move(game, ply, x, y);
+    store_countermove(game, player, last_x, last_y, x, y);
+    store_history_move(game, player, depth, x, y);
+}
+
+/**
+ * The table scores positions for the side to move, the search for ai_player:
+ * at a minimizing node the side to move is the opponent, so the value and
+ * window change sign on the way in and out, and bounds swap.
+ */
+static void store_search_value(game_state_t *game, uint64_t hash, int value, int depth, int flag,
+        int best_x, int best_y, int maximizing_player) {
+    if (!maximizing_player) {
+        value = -value;
+        flag = flag == TT_LOWER_BOUND ? TT_UPPER_BOUND : flag == TT_UPPER_BOUND ? TT_LOWER_BOUND : flag;
+    }
+    store_transposition(game, hash, value, depth, flag, best_x, best_y);
+}
+
+static int probe_search_value(game_state_t *game, uint64_t hash, int depth, int alpha, int beta,
+        int maximizing_player, int *value) {
+    if (maximizing_player) {
+        return probe_transposition(game, hash, depth, alpha, beta, value);
+    }
+    if (!probe_transposition(game, hash, depth, -beta, -alpha, value)) {
+        return 0;
+    }
+    *value = -*value;
+    return 1;
+}
+
 int minimax(int **board, int depth, int alpha, int beta, int maximizing_player, int ai_player) {
     // Create a temporary game state to use the timeout version
     // This is for backward compatibility only
-    game_state_t temp_game = {
-        .board = board,
-        .board_size = 19, // Default size
-        .move_timeout = 0, // No timeout
-        .search_timed_out = 0
-    };
+    game_state_t temp_game{}; // No timeout, no transposition table attached
+    temp_game.board_size = 19; // Default size
+    temp_game.board.load(board, temp_game.board_size);
+    temp_game.bitboard.load(board, temp_game.board_size);
+    temp_game.threats.load(temp_game.bitboard);
+    temp_game.candidates.load(temp_game.bitboard);
+    gomoku::ScratchLease lease(&temp_game);
 
     // Use center position as default for initial call
     int center = 19 / 2;
-    return minimax_with_timeout(&temp_game, board, depth, alpha, beta, maximizing_player, ai_player, center, center);
+    return minimax_with_timeout(&temp_game, depth, alpha, beta, maximizing_player, ai_player, center, center);
 }
 
-int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha, int beta,
-        int maximizing_player, int ai_player, int last_x, int last_y) {
+int minimax_with_timeout(game_state_t *game, int depth, int alpha, int beta,
+        int maximizing_player, int ai_player, int last_x, int last_y, int ply) {
+    return gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        return minimax_with_timeout<Size>(game, depth, alpha, beta, maximizing_player, ai_player, last_x, last_y, ply);
+    });
+}
+
+template<int Size> requires gomoku::ValidBoardSize<Size>
+int minimax_with_timeout(game_state_t *game, int depth, int alpha, int beta,
+        int maximizing_player, int ai_player, int last_x, int last_y, int ply) {
+    game->search_nodes++;
+
     // Check for timeout first
     if (is_search_timed_out(game)) {
         game->search_timed_out = 1;
-        return evaluate_position_incremental(board, game->board_size, ai_player, last_x, last_y);
+        return game->threats.evaluate(static_cast<gomoku::Player>(ai_player));
     }
 
-    // Compute position hash
-    uint64_t hash = compute_zobrist_hash(game);
+    // Position hash is maintained incrementally by place_stone()/remove_stone()
+    uint64_t hash = game->current_hash;
+#ifdef DEBUG
+    assert(hash == compute_zobrist_hash(game));
+#endif
 
     // Probe transposition table
     int tt_value;
-    if (probe_transposition(game, hash, depth, alpha, beta, &tt_value)) {
+    if (probe_search_value(game, hash, depth, alpha, beta, maximizing_player, &tt_value)) {
         return tt_value;
     }
 
     // Check for immediate wins/losses first (terminal conditions)
     if (get_cached_winner(game, ai_player)) {
         int value = WIN_SCORE + depth; // Prefer faster wins
-        store_transposition(game, hash, value, depth, TT_EXACT, -1, -1);
+        store_search_value(game, hash, value, depth, TT_EXACT, -1, -1, maximizing_player);
         return value;
     }
     if (get_cached_winner(game, other_player(ai_player))) {
         int value = -WIN_SCORE - depth; // Prefer slower losses
-        store_transposition(game, hash, value, depth, TT_EXACT, -1, -1);
+        store_search_value(game, hash, value, depth, TT_EXACT, -1, -1, maximizing_player);
         return value;
     }
 
     // Check search depth limit
     if (depth == 0) {
-        int value = evaluate_position_incremental(board, game->board_size, ai_player, last_x, last_y);
-        store_transposition(game, hash, value, depth, TT_EXACT, -1, -1);
+        gomoku::PhaseTimer eval_timer(gomoku::SearchPhase::Eval);
+
+        // Running sum kept by place_stone()/remove_stone(), no board rescan
+        int value = game->threats.evaluate(static_cast<gomoku::Player>(ai_player));
+#ifdef DEBUG
+        assert(value == gomoku::evaluate_position(game->bitboard, static_cast<gomoku::Player>(ai_player)));
+#endif
+        // Quiescence: a forced win by fours for the side to move outweighs any static score
+        if (game->use_threat_space_search) {
+            auto mover = static_cast<gomoku::Player>(maximizing_player ? ai_player : other_player(ai_player));
+            if (gomoku::ThreatSearch::has_four_move(game->bitboard, mover)) {
+                gomoku::ThreatSearch solver(game->bitboard, mover, gomoku::ThreatSearch::LEAF_VCF);
+                if (solver.solve()) {
+                    value = maximizing_player ? gomoku::FORCED_WIN_SCORE : -gomoku::FORCED_WIN_SCORE;
+                }
+                game->search_nodes += solver.nodes();
+            }
+        }
+        store_search_value(game, hash, value, depth, TT_EXACT, -1, -1, maximizing_player);
         return value;
     }
 
-    // Use cached stone count
-    if (game->stones_on_board == 0) {
+    if (game->bitboard.stone_count() == 0) {
         return 0; // Draw
     }
 
     int current_player_turn = maximizing_player ? ai_player : other_player(ai_player);
 
-    // Generate and sort moves using optimized method
-    move_t moves[361]; // Max for 19x19 board
-    int move_count = generate_moves_optimized(game, moves, current_player_turn);
-
-    if (move_count == 0) {
-        return 0; // No moves available
-    }
-
-    // Sort moves by priority (best first)
-    qsort(moves, move_count, sizeof(move_t), compare_moves);
+    // Moves come out best-first, generated only once the table move is tried
+    int tt_x = -1, tt_y = -1;
+    probe_transposition_move(game, hash, &tt_x, &tt_y);
+    gomoku::MovePicker<Size> picker(game, ply, current_player_turn, tt_x, tt_y, last_x, last_y);
+    move_t move;
 
     int best_x = -1, best_y = -1;
     int original_alpha = alpha;
+    int original_beta = beta;
+    int searched = 0;
 
     if (maximizing_player) {
         int max_eval = -WIN_SCORE - 1;
 
-        for (int m = 0; m < move_count; m++) {
+        while (picker.next(move)) {
             // Check for timeout before evaluating each move
             if (is_search_timed_out(game)) {
                 game->search_timed_out = 1;
                 return max_eval;
             }
 
-            int i = moves[m].x;
-            int j = moves[m].y;
+            int i = move.x;
+            int j = move.y;
 
             // Aggressive pruning: Skip moves with very low priority at deeper levels
-            if (depth > 2 && moves[m].priority < 10) {
+            if (depth > 2 && move.priority < 10) {
                 continue;
             }
 
-            board[i][j] = current_player_turn;
+            place_stone<Size>(game, i, j, current_player_turn);
 
-            // Update hash incrementally
-            int player_index = (current_player_turn == static_cast<int>(gomoku::Player::Cross)) ? 0 : 1;
-            int pos = i * game->board_size + j;
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
+            int eval = search_move<Size>(game, move, searched++, depth, alpha, beta, 1, ai_player, ply);
 
-            // Temporary cache invalidation
-            invalidate_winner_cache(game);
-
-            int eval = minimax_with_timeout(game, board, depth - 1, alpha, beta, 0, ai_player, i, j);
-
-            // Restore hash
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
-
-            // Restore cache
-            invalidate_winner_cache(game);
-
-            board[i][j] = static_cast<int>(gomoku::Player::Empty);
+            remove_stone<Size>(game, i, j);
+            store_butterfly_move(game, current_player_turn, depth, i, j);
 
             if (eval > max_eval) {
                 max_eval = eval;
@@ -332,18 +445,28 @@ int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha,
             }
 
             if (beta <= alpha) {
+                gomoku::record_cutoff(searched - 1);
                 break; // Alpha-beta pruning
             }
         }
 
+        if (picker.picked() == 0) {
+            return 0; // No moves available
+        }
+
+        // An interrupted search is incomplete; keep it out of the shared table
+        if (game->search_timed_out) {
+            return max_eval;
+        }
+
         // Store in transposition table
         int flag = (max_eval <= original_alpha) ? TT_UPPER_BOUND :
             (max_eval >= beta) ? TT_LOWER_BOUND : TT_EXACT;
-        store_transposition(game, hash, max_eval, depth, flag, best_x, best_y);
+        store_search_value(game, hash, max_eval, depth, flag, best_x, best_y, maximizing_player);
 
-        // Store killer move if beta cutoff occurred
+        // Credit the move that caused a beta cutoff
         if (max_eval >= beta && best_x != -1) {
-            store_killer_move(game, depth, best_x, best_y);
+            store_cutoff_move(game, ply, depth, current_player_turn, last_x, last_y, best_x, best_y);
         }
 
         return max_eval;
@@ -351,40 +474,27 @@ int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha,
     } else {
         int min_eval = WIN_SCORE + 1;
 
-        for (int m = 0; m < move_count; m++) {
+        while (picker.next(move)) {
             // Check for timeout before evaluating each move
             if (is_search_timed_out(game)) {
                 game->search_timed_out = 1;
                 return min_eval;
             }
 
-            int i = moves[m].x;
-            int j = moves[m].y;
+            int i = move.x;
+            int j = move.y;
 
             // Aggressive pruning: Skip moves with very low priority at deeper levels
-            if (depth > 2 && moves[m].priority < 10) {
+            if (depth > 2 && move.priority < 10) {
                 continue;
             }
 
-            board[i][j] = current_player_turn;
-
-            // Update hash incrementally
-            int player_index = (current_player_turn == static_cast<int>(gomoku::Player::Cross)) ? 0 : 1;
-            int pos = i * game->board_size + j;
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
-
-            // Temporary cache invalidation
-            invalidate_winner_cache(game);
-
-            int eval = minimax_with_timeout(game, board, depth - 1, alpha, beta, 1, ai_player, i, j);
+            place_stone<Size>(game, i, j, current_player_turn);
 
-            // Restore hash
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
+            int eval = search_move<Size>(game, move, searched++, depth, alpha, beta, 0, ai_player, ply);
 
-            // Restore cache
-            invalidate_winner_cache(game);
-
-            board[i][j] = static_cast<int>(gomoku::Player::Empty);
+            remove_stone<Size>(game, i, j);
+            store_butterfly_move(game, current_player_turn, depth, i, j);
 
             if (eval < min_eval) {
                 min_eval = eval;
@@ -399,18 +509,28 @@ int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha,
             }
 
             if (beta <= alpha) {
+                gomoku::record_cutoff(searched - 1);
                 break; // Alpha-beta pruning
             }
         }
 
+        if (picker.picked() == 0) {
+            return 0; // No moves available
+        }
+
+        // An interrupted search is incomplete; keep it out of the shared table
+        if (game->search_timed_out) {
+            return min_eval;
+        }
+
         // Store in transposition table
         int flag = (min_eval <= original_alpha) ? TT_UPPER_BOUND :
-            (min_eval >= beta) ? TT_LOWER_BOUND : TT_EXACT;
-        store_transposition(game, hash, min_eval, depth, flag, best_x, best_y);
+            (min_eval >= original_beta) ? TT_LOWER_BOUND : TT_EXACT;
+        store_search_value(game, hash, min_eval, depth, flag, best_x, best_y, maximizing_player);
 
-        // Store killer move if alpha cutoff occurred
+        // Credit the move that caused an alpha cutoff
         if (min_eval <= alpha && best_x != -1) {
-            store_killer_move(game, depth, best_x, best_y);
+            store_cutoff_move(game, ply, depth, current_player_turn, last_x, last_y, best_x, best_y);
         }
 
         return min_eval;
@@ -421,12 +541,105 @@ int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha,
 // AI MOVE FINDING FUNCTIONS
 //===============================================================================
 
+int probe_opening_book(game_state_t *game, int *best_x, int *best_y) {
+    if (!game->opening_book) {
+        return 0;
+    }
+
+    auto entry = game->opening_book->probe(game->current_hash, game->board_size);
+    if (!entry || entry->x >= game->board_size || entry->y >= game->board_size) {
+        return 0;
+    }
+
+    // Book moves are stored in the orientation the position is keyed on
+    gomoku::SymmetricCell cell = gomoku::transform_cell(gomoku::inverse_symmetry(game->hash_symmetry),
+                                                        entry->x, entry->y, game->board_size);
+    if (game->board[cell.x][cell.y] != static_cast<int>(gomoku::Player::Empty)) {
+        return 0;
+    }
+
+    *best_x = cell.x;
+    *best_y = cell.y;
+    game->search_depth_reached = entry->depth;
+    snprintf(game->ai_status_message, sizeof(game->ai_status_message),
+            "%s%s%s Book move (depth %d, score %d)",
+            COLOR_BLUE, "O", COLOR_RESET, entry->depth, entry->score);
+    add_ai_history_entry(game, 1); // A single lookup, no positions searched
+    return 1;
+}
+
+int find_forced_win(game_state_t *game, int *best_x, int *best_y) {
+    if (!game->use_threat_space_search) {
+        return 0;
+    }
+
+    // Continuous fours are cheap to refute, so they are tried before threes
+    const gomoku::ThreatSearchLimits stages[] = {gomoku::ThreatSearch::ROOT_VCF, gomoku::ThreatSearch::ROOT_VCT};
+    for (const auto &limits : stages) {
+        gomoku::ThreatSearch solver(game->bitboard, static_cast<gomoku::Player>(game->current_player), limits);
+        auto move = solver.solve();
+        game->search_nodes += solver.nodes();
+        if (move) {
+            *best_x = move->x;
+            *best_y = move->y;
+            game->search_depth_reached = 1;
+            snprintf(game->ai_status_message, sizeof(game->ai_status_message),
+                    "%s%s%s Forced win by %s ;-)",
+                    COLOR_BLUE, "O", COLOR_RESET, limits.allow_threes ? "threes and fours" : "fours");
+            add_ai_history_entry(game, static_cast<int>(solver.nodes()));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int extract_principal_variation(game_state_t *game, int x, int y, int max_length, int pv[][2]) {
+    int length = 0;
+    int player = game->current_player;
+
+    // Follow the table's best moves until it runs out, the line ends in a five, or it repeats
+    while (length < max_length && game->board.is_playable(x, y)) {
+        place_stone(game, x, y, player);
+        pv[length][0] = x;
+        pv[length][1] = y;
+        length++;
+
+        if (game->bitboard.has_five_at(static_cast<gomoku::Player>(player), x, y) ||
+                !probe_transposition_move(game, game->current_hash, &x, &y)) {
+            break;
+        }
+        player = other_player(player);
+    }
+
+    for (int i = length - 1; i >= 0; i--) {
+        remove_stone(game, pv[i][0], pv[i][1]);
+    }
+    return length;
+}
+
+void report_search_depth(const game_state_t *root, game_state_t *position, int depth, int score,
+                         int best_x, int best_y, uint64_t nodes) {
+    if (!root->on_search_depth) {
+        return;
+    }
+
+    search_depth_t report;
+    report.depth = depth;
+    report.score = score;
+    report.best_x = best_x;
+    report.best_y = best_y;
+    report.pv_length = extract_principal_variation(position, best_x, best_y, std::min(depth, MAX_SEARCH_DEPTH), report.pv);
+    report.nodes = nodes;
+    report.elapsed = get_current_time() - root->search_start_time;
+    root->on_search_depth(root->search_depth_context, &report);
+}
+
 void find_first_ai_move(game_state_t *game, int *best_x, int *best_y) {
     // Find the human's first move
     int human_x = -1, human_y = -1;
     for (int i = 0; i < game->board_size && human_x == -1; i++) {
         for (int j = 0; j < game->board_size && human_x == -1; j++) {
-            if (game->board[i][j] == static_cast<int>(gomoku::Player::Cross)) {
+            if (game->board[i][j] == other_player(game->current_player)) {
                 human_x = i;
                 human_y = j;
             }
@@ -452,10 +665,8 @@ void find_first_ai_move(game_state_t *game, int *best_x, int *best_y) {
                 int new_x = human_x + dx;
                 int new_y = human_y + dy;
 
-                // Check bounds and if position is empty
-                if (new_x >= 0 && new_x < game->board_size &&
-                        new_y >= 0 && new_y < game->board_size &&
-                        game->board[new_x][new_y] == static_cast<int>(gomoku::Player::Empty)) {
+                // Off-board cells are wall, never empty
+                if (game->board[new_x][new_y] == static_cast<int>(gomoku::Player::Empty)) {
                     valid_moves[move_count][0] = new_x;
                     valid_moves[move_count][1] = new_y;
                     move_count++;
@@ -480,24 +691,93 @@ void find_first_ai_move(game_state_t *game, int *best_x, int *best_y) {
     }
 }
 
-void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_threads) {
+/**
+ * Searches the root moves to depth and returns the best score, setting
+ * *best_index to its move. Under PVS the window narrows as better moves are
+ * found and the search stops once a move reaches beta; plain alpha-beta
+ * searches every move with the full window it was given.
+ */
+template<int Size>
+static int search_root(game_state_t *game, const move_t *moves, int move_count, int depth,
+        int alpha, int beta, int *best_index, int *moves_considered) {
+    int ai_player = game->current_player;
+    int best_score = -WIN_SCORE - 1;
+
+    for (int m = 0; m < move_count; m++) {
+        // Check for timeout before evaluating each move
+        if (is_search_timed_out(game)) {
+            game->search_timed_out = 1;
+            break;
+        }
+
+        place_stone<Size>(game, moves[m].x, moves[m].y, ai_player);
+        int score = search_move<Size>(game, moves[m], m, depth, alpha, beta, 1, ai_player, 0);
+        remove_stone<Size>(game, moves[m].x, moves[m].y);
+
+        if (score > best_score) {
+            best_score = score;
+            *best_index = m;
+        }
+
+        (*moves_considered)++;
+        if (depth == game->max_depth && !game->quiet_search) {
+            printf("%s•%s", COLOR_BLUE, COLOR_RESET);
+            fflush(stdout);
+        }
+
+        // Break if timeout occurred during minimax search, or on a win or a fail high
+        if (game->search_timed_out || score >= WIN_SCORE - 1000 || score >= beta) {
+            break;
+        }
+        if (game->use_principal_variation) {
+            alpha = std::max(alpha, score);
+        }
+    }
+    return best_score;
+}
+
+template<int Size>
+static void find_best_ai_move(game_state_t *game, int *best_x, int *best_y);
+
+void find_best_ai_move(game_state_t *game, int *best_x, int *best_y) {
+    gomoku::ScratchLease lease(game);
+    gomoku::SearchMetricsScope metrics(game);
+
+    // The rest of the search runs specialized for the board size
+    gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        find_best_ai_move<Size>(game, best_x, best_y);
+    });
+}
+
+template<int Size>
+static void find_best_ai_move(game_state_t *game, int *best_x, int *best_y) {
     // Initialize timeout tracking
     game->search_start_time = get_current_time();
     game->search_timed_out = 0;
+    game->search_depth_reached = 0;
+    game->search_nodes = 0;
+    game->search_tt_probes = 0;
+    game->search_tt_hits = 0;
+    game->search_moves_evaluated = 0;
 
-    // Count stones on board to detect first AI move
-    int stone_count = 0;
-    for (int i = 0; i < game->board_size; i++) {
-        for (int j = 0; j < game->board_size; j++) {
-            if (game->board[i][j] != static_cast<int>(gomoku::Player::Empty)) {
-                stone_count++;
-            }
-        }
+    // Age out entries left by previous moves' searches
+    if (game->transposition_table) {
+        game->transposition_table->new_search();
     }
+    age_history_scores(game);
+
+    // Positions the offline book builder already searched deeply need no search at all
+    if (probe_opening_book(game, best_x, best_y)) {
+        return;
+    }
+
+    // Count stones on board to detect first AI move
+    int stone_count = game->bitboard.stone_count();
 
     // If there's exactly 1 stone (human's first move), use simple random placement
     if (stone_count == 1) {
         find_first_ai_move(game, best_x, best_y);
+        game->search_depth_reached = 1;
         add_ai_history_entry(game, 1); // Random placement, 1 "move" considered
         return;
     }
@@ -508,34 +788,42 @@ void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_thr
 
     // Clear previous AI status message and show thinking message
     strcpy(game->ai_status_message, "");
-    if (game->move_timeout > 0) {
-        printf("%s%s%s It's AI's Turn... Please wait... (timeout: %ds)\n",
-                COLOR_BLUE, "O", COLOR_RESET, game->move_timeout);
-    } else {
-        printf("%s%s%s It's AI's Turn... Please wait...\n",
-                COLOR_BLUE, "O", COLOR_RESET);
+    if (!game->quiet_search) {
+        if (game->move_timeout > 0) {
+            printf("%s%s%s It's AI's Turn... Please wait... (timeout: %ds)\n",
+                    COLOR_BLUE, "O", COLOR_RESET, game->move_timeout);
+        } else {
+            printf("%s%s%s It's AI's Turn... Please wait...\n",
+                    COLOR_BLUE, "O", COLOR_RESET);
+        }
+        fflush(stdout);
     }
-    fflush(stdout);
 
     // Generate and sort moves using optimized method
-    move_t moves[361]; // Max for 19x19 board
-    int move_count = generate_moves_optimized(game, moves, static_cast<int>(gomoku::Player::Naught));
+    std::array<move_t, Size * Size> moves;
+    int move_count = generate_moves_optimized<Size>(game, moves.data(), game->current_player);
 
     // Check for immediate winning moves first
     for (int i = 0; i < move_count; i++) {
-        if (evaluate_threat_fast(game->board, moves[i].x, moves[i].y, static_cast<int>(gomoku::Player::Naught), game->board_size) >= 100000) {
+        if (evaluate_threat_fast(game->bitboard, moves[i].x, moves[i].y, game->current_player) >= 100000) {
             *best_x = moves[i].x;
             *best_y = moves[i].y;
             snprintf(game->ai_status_message, sizeof(game->ai_status_message),
                     "%s%s%s It's a checkmate ;-)",
                     COLOR_BLUE, "O", COLOR_RESET);
+            game->search_depth_reached = 1;
             add_ai_history_entry(game, 1); // Only checked 1 move
             return;
         }
     }
 
+    // A forced win found by threat-space search needs no full-width search
+    if (find_forced_win(game, best_x, best_y)) {
+        return;
+    }
+
     // Sort moves by priority (best first)
-    qsort(moves, move_count, sizeof(move_t), compare_moves);
+    qsort(moves.data(), move_count, sizeof(move_t), compare_moves);
 
     int moves_considered = 0;
 
@@ -545,81 +833,63 @@ void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_thr
         *best_y = moves[0].y;
     }
 
-    // Use parallel search for multiple threads and sufficient moves
-    if (num_threads > 1 && move_count > 1 && stone_count >= 2 && game->move_timeout == 0) {
-        find_best_move_parallel_internal(game, moves, move_count, best_x, best_y, num_threads);
-        return;
-    }
-
     // Iterative deepening search (sequential)
+    init_aspiration_windows(game);
     for (int current_depth = 1; current_depth <= game->max_depth; current_depth++) {
         if (is_search_timed_out(game)) {
             break;
         }
+        uint64_t depth_started = gomoku::search_metrics_now();
 
-        int depth_best_score = -WIN_SCORE - 1;
-        int depth_best_x = *best_x;
-        int depth_best_y = *best_y;
-
-        // Search all moves at current depth
-        for (int m = 0; m < move_count; m++) {
-            // Check for timeout before evaluating each move
-            if (is_search_timed_out(game)) {
-                game->search_timed_out = 1;
-                break;
-            }
-
-            int i = moves[m].x;
-            int j = moves[m].y;
-
-            game->board[i][j] = static_cast<int>(gomoku::Player::Naught);
-
-            // Update hash incrementally
-            int player_index = 1; // static_cast<int>(gomoku::Player::Naught)
-            int pos = i * game->board_size + j;
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
-
-            int score = minimax_with_timeout(game, game->board, current_depth - 1, -WIN_SCORE - 1, WIN_SCORE + 1,
-                    0, static_cast<int>(gomoku::Player::Naught), i, j);
-
-            // Restore hash
-            game->current_hash ^= game->zobrist_keys[player_index][pos];
-
-            game->board[i][j] = static_cast<int>(gomoku::Player::Empty);
-
-            if (score > depth_best_score) {
-                depth_best_score = score;
-                depth_best_x = i;
-                depth_best_y = j;
-
-                // Early termination for very good moves
-                if (score >= WIN_SCORE - 1000) {
-                    snprintf(game->ai_status_message, sizeof(game->ai_status_message),
-                            "%s%s%s Win (depth %d, %d moves).",
-                            COLOR_BLUE, "O", COLOR_RESET, current_depth, moves_considered + 1);
-                    *best_x = depth_best_x;
-                    *best_y = depth_best_y;
-                    add_ai_history_entry(game, moves_considered + 1);
-                    return; // Exit function early
-                }
-            }
+        // Under PVS each iteration starts from a narrow window around the last score
+        int alpha = -WIN_SCORE - 1;
+        int beta = WIN_SCORE + 1;
+        if (game->use_principal_variation) {
+            get_aspiration_window(game, current_depth, &alpha, &beta);
+        }
 
-            moves_considered++;
-            if (current_depth == game->max_depth) {
-                printf("%s•%s", COLOR_BLUE, COLOR_RESET);
-                fflush(stdout);
-            }
+        int depth_best = 0;
+        int attempt_moves = moves_considered;
+        uint64_t attempt_nodes = game->search_nodes;
+        int depth_best_score = search_root<Size>(game, moves.data(), move_count, current_depth, alpha, beta,
+                &depth_best, &moves_considered);
+        if (!game->search_timed_out && depth_best_score < WIN_SCORE - 1000 &&
+                (depth_best_score <= alpha || depth_best_score >= beta)) {
+            // The score fell outside the window, so it is only a bound: search again in full.
+            // Its nodes stay in the totals and are also reported as the re-search share of them
+            gomoku::record_research_nodes(game->search_nodes - attempt_nodes);
+            moves_considered = attempt_moves;
+            depth_best_score = search_root<Size>(game, moves.data(), move_count, current_depth, -WIN_SCORE - 1, WIN_SCORE + 1,
+                    &depth_best, &moves_considered);
+        }
 
-            // Break if timeout occurred during minimax search
-            if (game->search_timed_out) {
-                break;
-            }
+        // Early termination for very good moves
+        if (depth_best_score >= WIN_SCORE - 1000) {
+            snprintf(game->ai_status_message, sizeof(game->ai_status_message),
+                    "%s%s%s Win (depth %d, %d moves).",
+                    COLOR_BLUE, "O", COLOR_RESET, current_depth, moves_considered);
+            *best_x = moves[depth_best].x;
+            *best_y = moves[depth_best].y;
+            game->search_depth_reached = current_depth;
+            gomoku::record_depth(current_depth, depth_started);
+            report_search_depth(game, game, current_depth, depth_best_score, *best_x, *best_y, game->search_nodes);
+            add_ai_history_entry(game, moves_considered);
+            return; // Exit function early
         }
 
         // If we completed this depth without timeout, use the result
         if (!game->search_timed_out) {
-            *best_x = depth_best_x;
-            *best_y = depth_best_y;
+            *best_x = moves[depth_best].x;
+            *best_y = moves[depth_best].y;
+            game->search_depth_reached = current_depth;
+            gomoku::record_depth(current_depth, depth_started);
+            update_aspiration_window(game, current_depth + 1, depth_best_score, -WIN_SCORE - 1, WIN_SCORE + 1);
+            report_search_depth(game, game, current_depth, depth_best_score, *best_x, *best_y, game->search_nodes);
+
+            // The next iteration searches this move first, so PVS proves the rest against it
+            if (game->use_principal_variation) {
+                std::rotate(moves.begin(), moves.begin() + depth_best, moves.begin() + depth_best + 1);
+            }
         }
     }
 
@@ -643,109 +913,43 @@ void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_thr
 
 
 //===============================================================================
-// PARALLEL SEARCH IMPLEMENTATION
+// ROOT MOVE SEARCH
 //===============================================================================
 
-/**
- * Internal parallel search function for root-level parallelization
- */
-void find_best_move_parallel_internal(game_state_t* game, move_t* moves, int move_count, 
-                                    int* best_x, int* best_y, int num_threads) {
-    using namespace gomoku;
-    
-    // Create thread pool
-    gomoku::ThreadPool thread_pool(num_threads == 0 ? 
-        std::max(1u, std::thread::hardware_concurrency() - 1) : num_threads);
-    
-    // Limit moves to evaluate in parallel (top candidates)
-    int parallel_moves = std::min(move_count, num_threads * 2);
-    
-    std::vector<std::future<std::pair<int, int>>> futures;
-    std::vector<int> scores(parallel_moves, -WIN_SCORE - 1);
-    
-    // Evaluate top moves in parallel
-    for (int m = 0; m < parallel_moves; m++) {
-        futures.emplace_back(
-            thread_pool.enqueue([game, moves, m]() -> std::pair<int, int> {
-                // Clone game state for thread safety
-                game_state_t* game_copy = clone_game_state(game);
-                
-                int i = moves[m].x;
-                int j = moves[m].y;
-                
-                // Make move
-                game_copy->board[i][j] = static_cast<int>(gomoku::Player::Naught);
-                
-                // Update hash
-                int player_index = 1; // Naught player
-                int pos = i * game_copy->board_size + j;
-                game_copy->current_hash ^= game_copy->zobrist_keys[player_index][pos];
-                
-                // Search with minimax
-                int score = minimax_with_timeout(game_copy, game_copy->board, 
-                    game_copy->max_depth - 1, -WIN_SCORE - 1, WIN_SCORE + 1,
-                    0, static_cast<int>(gomoku::Player::Naught), i, j);
-                
-                // Cleanup
-                cleanup_game(game_copy);
-                
-                return std::make_pair(score, m);
-            })
-        );
-    }
-    
-    // Collect results
-    int best_score = -WIN_SCORE - 1;
-    int best_move_index = 0;
-    int moves_evaluated = 0;
-    
-    for (size_t i = 0; i < futures.size(); i++) {
-        auto result = futures[i].get();
-        int score = result.first;
-        int move_idx = result.second;
-        
-        if (score > best_score) {
-            best_score = score;
-            best_move_index = move_idx;
-        }
-        moves_evaluated++;
-    }
-    
-    // Set best move
-    *best_x = moves[best_move_index].x;
-    *best_y = moves[best_move_index].y;
-    
-    // Update AI status
-    double elapsed = get_current_time() - game->search_start_time;
-    snprintf(game->ai_status_message, sizeof(game->ai_status_message),
-        "Done in %.0fs (checked %d moves)", elapsed, moves_evaluated);
-    
-    add_ai_history_entry(game, moves_evaluated);
-}
+template<int Size>
+static int search_root_move(game_state_t *game, int x, int y, int depth, int alpha) {
+    int ai_player = game->current_player;
+    int score = alpha;
 
-/**
- * Clone game state for thread-safe parallel evaluation
- */
-game_state_t* clone_game_state(game_state_t* original) {
-    game_state_t* clone = (game_state_t*)malloc(sizeof(game_state_t));
-    if (!clone) return nullptr;
-    
-    // Copy the entire structure
-    memcpy(clone, original, sizeof(game_state_t));
-    
-    // Clone the board
-    clone->board = create_board(original->board_size);
-    if (!clone->board) {
-        free(clone);
-        return nullptr;
-    }
-    
-    // Copy board contents
-    for (int i = 0; i < original->board_size; i++) {
-        for (int j = 0; j < original->board_size; j++) {
-            clone->board[i][j] = original->board[i][j];
+    // Shallow passes fill the table, so each deeper one tries the best replies first
+    place_stone<Size>(game, x, y, ai_player);
+    for (int current_depth = 1; current_depth <= depth; current_depth++) {
+        int result = minimax_with_timeout<Size>(game, current_depth - 1, alpha, WIN_SCORE + 1, 0, ai_player, x, y);
+        if (game->search_timed_out) {
+            break;
+        }
+        score = result;
+        if (std::abs(score) >= WIN_SCORE - 1000) {
+            break;
         }
     }
-    
-    return clone;
+    remove_stone<Size>(game, x, y);
+    return score;
 }
+
+int search_root_move(game_state_t *game, int x, int y, int depth, int alpha) {
+    return gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        return search_root_move<Size>(game, x, y, depth, alpha);
+    });
+}
+
+//===============================================================================
+// EXPLICIT TEMPLATE INSTANTIATIONS
+//===============================================================================
+
+template int generate_moves_optimized<15>(game_state_t *, move_t *, int);
+template int generate_moves_optimized<19>(game_state_t *, move_t *, int);
+template int get_move_priority_optimized<15>(game_state_t *, int, int, int);
+template int get_move_priority_optimized<19>(game_state_t *, int, int, int);
+template int minimax_with_timeout<15>(game_state_t *, int, int, int, int, int, int, int, int);
+template int minimax_with_timeout<19>(game_state_t *, int, int, int, int, int, int, int, int);
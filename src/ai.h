@@ -29,13 +29,13 @@ typedef struct {
 
 /**
  * Finds the best AI move using minimax algorithm with alpha-beta pruning.
+ * The AI plays the side to move, game->current_player.
  * 
  * @param game The game state
  * @param best_x Pointer to store the best x coordinate
  * @param best_y Pointer to store the best y coordinate
- * @param num_threads Number of threads for parallel search (0 = auto, 1 = sequential)
  */
-void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_threads = 1);
+void find_best_ai_move(game_state_t *game, int *best_x, int *best_y);
 
 /**
  * Finds the AI's first move (random placement near human's first move).
@@ -47,46 +47,93 @@ void find_best_ai_move(game_state_t *game, int *best_x, int *best_y, int num_thr
 void find_first_ai_move(game_state_t *game, int *best_x, int *best_y);
 
 /**
- * Internal parallel search function for root-level parallelization
+ * Looks the current position up in the game's opening book.
  * 
- * @param game The game state
- * @param moves Array of moves to evaluate
- * @param move_count Number of moves in the array
- * @param best_x Pointer to store the best x coordinate
- * @param best_y Pointer to store the best y coordinate
- * @param num_threads Number of threads to use
+ * @param game The game state, with the AI to move
+ * @param best_x Pointer to store the book move's x coordinate
+ * @param best_y Pointer to store the book move's y coordinate
+ * @return 1 if the book had a playable move for the position, 0 otherwise
+ */
+int probe_opening_book(game_state_t *game, int *best_x, int *best_y);
+
+/**
+ * Looks for a forced win for the AI with the threat-space solver: first by
+ * continuous fours (VCF), then by fours and open threes (VCT), each within
+ * its own node budget.
+ * 
+ * @param game The game state, with the AI to move
+ * @param best_x Pointer to store the first move's x coordinate
+ * @param best_y Pointer to store the first move's y coordinate
+ * @return 1 if a forced win was found, 0 otherwise
+ */
+int find_forced_win(game_state_t *game, int *best_x, int *best_y);
+
+/**
+ * Reads the line of play the search expects after the AI's move (x, y) out
+ * of the transposition table, leaving the game as it was found.
+ * 
+ * @param game The game state, with the AI to move
+ * @param max_length Most moves to write to pv
+ * @param pv Receives the line, (x, y) first
+ * @return Number of moves written to pv
+ */
+int extract_principal_variation(game_state_t *game, int x, int y, int max_length, int pv[][2]);
+
+/**
+ * Tells root's on_search_depth, if one is set, that an iteration completed.
+ * 
+ * @param root The game the search was started on
+ * @param position The state the iteration searched, back at the root position
+ * @param nodes Positions visited by the whole search so far
  */
-void find_best_move_parallel_internal(game_state_t* game, move_t* moves, int move_count, 
-                                    int* best_x, int* best_y, int num_threads);
+void report_search_depth(const game_state_t *root, game_state_t *position, int depth, int score,
+                         int best_x, int best_y, uint64_t nodes);
 
 /**
- * Clone game state for thread safety
+ * Scores the root move (x, y) for the side to move, game->current_player,
+ * deepening iteratively to depth plies counting the move itself. The window
+ * is (alpha, WIN_SCORE + 1), so a score at or below alpha only bounds the
+ * move from above. For searches that split the root moves between workers;
+ * the caller holds the scratch lease and resets the search counters.
  * 
- * @param game The game state to clone
- * @return Cloned game state
+ * @param game The game state, left as it was found
+ * @param depth Plies to search, at least 1
+ * @param alpha Best score already found for another root move
+ * @return Score from the side to move's point of view; not meaningful if
+ *         game->search_timed_out was set
  */
-game_state_t* clone_game_state(game_state_t* game);
+int search_root_move(game_state_t *game, int x, int y, int depth, int alpha);
 
 //===============================================================================
 // MINIMAX ALGORITHM
 //===============================================================================
 
 /**
- * Minimax algorithm with alpha-beta pruning and timeout support.
+ * Minimax algorithm with alpha-beta pruning and timeout support. Leaves are
+ * scored from game->threats, which covers the whole board in constant time.
  * 
  * @param game The game state
- * @param board The game board
  * @param depth Current search depth
  * @param alpha Alpha value for pruning
  * @param beta Beta value for pruning
  * @param maximizing_player 1 if maximizing, 0 if minimizing
  * @param ai_player The AI player
- * @param last_x X coordinate of last move
- * @param last_y Y coordinate of last move
+ * @param last_x X coordinate of last move (kept for move ordering; unused by the evaluation)
+ * @param last_y Y coordinate of last move (kept for move ordering; unused by the evaluation)
+ * @param ply Plies from the search root, which selects the killer slot; 1 for a reply to a root move
  * @return Best evaluation score
  */
-int minimax_with_timeout(game_state_t *game, int **board, int depth, int alpha, int beta,
-        int maximizing_player, int ai_player, int last_x, int last_y);
+int minimax_with_timeout(game_state_t *game, int depth, int alpha, int beta,
+        int maximizing_player, int ai_player, int last_x, int last_y, int ply = 1);
+
+/**
+ * minimax_with_timeout() specialized for one board size. The runtime-sized
+ * entry points dispatch here once, so the whole recursion below runs with
+ * constant board bounds and exactly sized move arrays.
+ */
+template<int Size> requires gomoku::ValidBoardSize<Size>
+int minimax_with_timeout(game_state_t *game, int depth, int alpha, int beta,
+        int maximizing_player, int ai_player, int last_x, int last_y, int ply = 1);
 
 /**
  * Wrapper for backward compatibility with existing minimax function.
@@ -115,6 +162,10 @@ int minimax(int **board, int depth, int alpha, int beta, int maximizing_player,
  */
 int generate_moves_optimized(game_state_t *game, move_t *moves, int current_player);
 
+// generate_moves_optimized() for a board of Size; moves must hold Size * Size entries
+template<int Size> requires gomoku::ValidBoardSize<Size>
+int generate_moves_optimized(game_state_t *game, move_t *moves, int current_player);
+
 /**
  * Optimized move prioritization that avoids expensive temporary placements.
  * 
@@ -126,6 +177,10 @@ int generate_moves_optimized(game_state_t *game, move_t *moves, int current_play
  */
 int get_move_priority_optimized(game_state_t *game, int x, int y, int player);
 
+// get_move_priority_optimized() for a board of Size
+template<int Size> requires gomoku::ValidBoardSize<Size>
+int get_move_priority_optimized(game_state_t *game, int x, int y, int player);
+
 /**
  * Fast threat evaluation without temporary board modifications.
  * 
@@ -138,6 +193,17 @@ int get_move_priority_optimized(game_state_t *game, int x, int y, int player);
  */
 int evaluate_threat_fast(int **board, int x, int y, int player, int board_size);
 
+/**
+ * Bitboard version of evaluate_threat_fast() used by the search.
+ *
+ * @param board The packed position
+ * @param x Row coordinate
+ * @param y Column coordinate
+ * @param player The player making the move
+ * @return Threat score for the move
+ */
+int evaluate_threat_fast(const gomoku::BitBoard &board, int x, int y, int player);
+
 /**
  * Checks if a move position is "interesting" (within range of existing stones).
  * 
@@ -8,14 +8,31 @@
 #pragma once
 
 #include "ai.h"
+#include "mcts.hpp"
+#include "search_position.hpp"
 #include "util/thread_pool.hpp"
 #include <atomic>
 #include <mutex>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <string_view>
 
 namespace gomoku {
 
+/**
+ * How ParallelAI spreads a search over its threads
+ */
+enum class SearchMode {
+    LazySmp,    // Every thread deepens the whole root over the shared transposition table
+    RootSplit   // Root moves are divided between threads, one search per move
+};
+
+/**
+ * Parses "lazy" or "root"; anything else yields std::nullopt.
+ */
+std::optional<SearchMode> parse_search_mode(std::string_view name);
+
 /**
  * Parallel AI search engine using thread pool for root-level parallelization
  */
@@ -24,8 +41,9 @@ public:
     /**
      * Constructor - initializes thread pool
      * @param num_threads Number of threads to use (0 = auto-detect)
+     * @param mode Parallel search strategy
      */
-    explicit ParallelAI(size_t num_threads = 0);
+    explicit ParallelAI(size_t num_threads = 0, SearchMode mode = SearchMode::LazySmp);
     
     /**
      * Find best move using parallel search at root level
@@ -40,6 +58,16 @@ public:
      */
     size_t get_thread_count() const { return thread_pool_.size(); }
     
+    /**
+     * Get the parallel search strategy
+     */
+    SearchMode get_search_mode() const { return mode_; }
+    
+    /**
+     * Monte Carlo tree search spread over the same threads
+     */
+    MctsEngine& mcts() { return mcts_; }
+    
 private:
     /**
      * Structure to hold move evaluation results
@@ -56,14 +84,19 @@ private:
     };
     
     /**
-     * Parallel root search state
+     * State of one depth of a root split search
      */
     struct ParallelSearchState {
+        int depth = 1;                  // Plies searched below the root, counting the root move
         std::atomic<int> global_alpha{-WIN_SCORE-1};
         std::atomic<int> global_beta{WIN_SCORE+1};
         std::atomic<bool> timeout_occurred{false};
         std::atomic<int> best_score{-WIN_SCORE-1};
         std::atomic<int> moves_evaluated{0};
+        std::atomic<size_t> next_move{0};   // Index of the next root move a thread takes
+        std::atomic<uint64_t> nodes{0};
+        std::atomic<uint64_t> tt_probes{0};
+        std::atomic<uint64_t> tt_hits{0};
         
         std::mutex best_move_mutex;
         int best_x{-1};
@@ -71,97 +104,55 @@ private:
     };
     
     /**
-     * Evaluate a single move in parallel
-     */
-    void evaluate_move_parallel(game_state_t* game, MoveEvaluation* move_eval, 
-                               ParallelSearchState* search_state);
-    
-    /**
-     * Create a deep copy of game state for thread safety
+     * Root split: at each depth of iterative deepening the pool threads take
+     * root moves in turn until none are left, searching each against the
+     * best score found so far. A deadline or a stop keeps the best move of
+     * the last depth that every move finished
      */
-    game_state_t* clone_game_state(game_state_t* original);
+    void find_best_move_root_split(game_state_t* game, move_t* moves, int move_count,
+                                   int* best_x, int* best_y);
     
     /**
-     * Free cloned game state
+     * Shared state of one Lazy SMP search
      */
-    void free_game_state_clone(game_state_t* clone);
-    
-    /**
-     * Thread-safe move evaluation using sequential minimax
-     */
-    int evaluate_move_sequential(game_state_t* game, int x, int y, int depth, 
-                                int alpha, int beta, int ai_player);
-    
-    /**
-     * Enhanced parallel minimax with branch-level parallelization
-     * @param game Game state (will be cloned for thread safety)
-     * @param depth Current search depth
-     * @param alpha Alpha value for pruning
-     * @param beta Beta value for pruning
-     * @param maximizing_player Whether maximizing or minimizing
-     * @param ai_player The AI player value
-     * @param last_x X coordinate of last move
-     * @param last_y Y coordinate of last move
-     * @param min_parallel_depth Minimum depth to use parallelization
-     * @return Best score found
-     */
-    int parallel_minimax(game_state_t* game, int depth, int alpha, int beta,
-                        bool maximizing_player, int ai_player, int last_x, int last_y,
-                        int min_parallel_depth = 3);
-    
-    /**
-     * Structure for parallel minimax task
-     */
-    struct ParallelMinimaxTask {
-        game_state_t* game_clone;
-        move_t move;
-        int depth;
-        int alpha;
-        int beta;
-        bool maximizing_player;
-        int ai_player;
-        int min_parallel_depth;
-        
-        // Result - use pointers to make struct movable
-        std::unique_ptr<std::atomic<int>> score;
-        std::unique_ptr<std::atomic<bool>> completed;
-        
-        // Default constructor
-        ParallelMinimaxTask() 
-            : game_clone(nullptr), move{}, depth(0), alpha(0), beta(0), 
-              maximizing_player(false), ai_player(0), min_parallel_depth(0),
-              score(std::make_unique<std::atomic<int>>(-WIN_SCORE - 1)),
-              completed(std::make_unique<std::atomic<bool>>(false)) {}
-        
-        // Move constructor and assignment
-        ParallelMinimaxTask(ParallelMinimaxTask&&) = default;
-        ParallelMinimaxTask& operator=(ParallelMinimaxTask&&) = default;
+    struct LazySmpState {
+        std::atomic<bool> stop{false};
+        std::atomic<int> completed_depth{0};
+        std::atomic<int> moves_evaluated{0};
+        std::atomic<uint64_t> nodes{0};
+        std::atomic<uint64_t> tt_probes{0};
+        std::atomic<uint64_t> tt_hits{0};
         
-        // Delete copy constructor and assignment
-        ParallelMinimaxTask(const ParallelMinimaxTask&) = delete;
-        ParallelMinimaxTask& operator=(const ParallelMinimaxTask&) = delete;
+        std::mutex best_move_mutex;
+        int best_x{-1};
+        int best_y{-1};
+        int best_score{-WIN_SCORE-1};
     };
     
     /**
-     * Parallel maximizing node evaluation
+     * Lazy SMP: every pool thread runs iterative deepening over all root
+     * moves, sharing results only through the transposition table
      */
-    int parallel_max_node(game_state_t* game, move_t* moves, int move_count, 
-                         int depth, int alpha, int beta, int ai_player, int min_parallel_depth);
+    void find_best_move_lazy_smp(game_state_t* game, move_t* moves, int move_count,
+                                 int* best_x, int* best_y);
     
     /**
-     * Parallel minimizing node evaluation
+     * One Lazy SMP thread. Odd helpers start one ply deeper and helpers
+     * rotate the leading root moves, so threads fill the table with different
+     * subtrees instead of repeating each other's work.
      */
-    int parallel_min_node(game_state_t* game, move_t* moves, int move_count, 
-                         int depth, int alpha, int beta, int ai_player, int min_parallel_depth);
+    void lazy_smp_worker(const game_state_t* game, const SearchPosition* root_position,
+                         std::vector<move_t> moves, size_t thread_index, LazySmpState* state);
     
     /**
-     * Sequential node evaluation fallback
+     * Evaluate a single move in parallel
      */
-    int sequential_minimax_node(game_state_t* game, move_t* moves, int move_count, 
-                               int depth, int alpha, int beta, bool maximizing_player, 
-                               int ai_player, int min_parallel_depth);
+    void evaluate_move_parallel(const game_state_t* game, const SearchPosition* root_position,
+                               MoveEvaluation* move_eval, ParallelSearchState* search_state);
     
     ThreadPool thread_pool_;
+    SearchMode mode_;
+    MctsEngine mcts_;
 };
 
 /**
@@ -172,8 +163,9 @@ extern std::unique_ptr<ParallelAI> g_parallel_ai;
 /**
  * Initialize global parallel AI
  * @param num_threads Number of threads (0 = auto-detect)
+ * @param mode Parallel search strategy
  */
-void init_parallel_ai(size_t num_threads = 0);
+void init_parallel_ai(size_t num_threads = 0, SearchMode mode = SearchMode::LazySmp);
 
 /**
  * Cleanup global parallel AI
@@ -0,0 +1,464 @@
+//
+//  bench_main.cpp
+//  gomoku-bench - Search benchmark over a fixed position suite
+//
+//  Runs the AI on every position of a corpus at fixed depths and thread counts and reports JSON lines
+//
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+#include "json.hpp"
+#include "gomoku.hpp"
+#include "game.h"
+#include "ai.h"
+#include "ai_parallel.hpp"
+
+namespace {
+
+using json = nlohmann::ordered_json;
+using GamePtr = std::unique_ptr<game_state_t, void(*)(game_state_t*)>;
+
+struct BenchOptions {
+    std::string positions = "tests/fixtures/bench-positions.json";
+    std::string reference;     // Earlier output to check move agreement against
+    int max_depth = 4;         // Every depth from 1 up to this one is searched
+    std::vector<int> threads = {1};
+    int tt_size_mb = 32;
+    bool plain_search = false;
+};
+
+struct Position {
+    std::string id;
+    int board_size;
+    std::vector<move_history_t> moves;
+};
+
+// One search result; the key of a reference run is (position, depth, threads)
+using ResultKey = std::tuple<std::string, int, int>;
+
+struct Move {
+    int x;
+    int y;
+
+    bool operator==(const Move&) const = default;
+};
+
+//===============================================================================
+// COMMAND LINE
+//===============================================================================
+
+void print_usage(std::string_view program_name) {
+    std::cout << std::format(R"(
+gomoku-bench - Search benchmark over a fixed position suite
+
+USAGE:
+    {} [OPTIONS]
+
+OPTIONS:
+    -p, --positions <PATH>   Position corpus (default: tests/fixtures/bench-positions.json)
+    -d, --depth <DEPTH>      Search every depth from 1 to DEPTH (default: 4, range: 1-10)
+    -j, --threads <LIST>     Comma-separated thread counts (default: 1)
+    -m, --tt-size <MB>       Transposition table size in megabytes (default: 32)
+    -r, --reference <PATH>   Earlier output to check move agreement against
+    -P, --no-pvs             Plain alpha-beta instead of PVS
+    -h, --help               Show this help message
+
+Every search starts from an empty transposition table. One JSON object is
+written per line: a "search" record for every position, depth and thread
+count, then a "summary" record for every depth and thread count. Without
+--reference, moves are compared with those of the first thread count.
+)", program_name);
+}
+
+std::optional<int> parse_int(std::string_view text, int min, int max) {
+    int value{};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<std::vector<int>> parse_int_list(std::string_view text, int min, int max) {
+    std::vector<int> values;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        auto value = parse_int(text.substr(0, comma), min, max);
+        if (!value) {
+            return std::nullopt;
+        }
+        values.push_back(*value);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    if (values.empty()) {
+        return std::nullopt;
+    }
+    return values;
+}
+
+std::expected<BenchOptions, std::string> parse_options(int argc, char* argv[]) {
+    BenchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            std::exit(0);
+        }
+        if (arg == "-P" || arg == "--no-pvs") {
+            options.plain_search = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return std::unexpected(std::format("Missing value for '{}'", arg));
+        }
+        std::string_view value = argv[++i];
+
+        if (arg == "-p" || arg == "--positions") {
+            options.positions = value;
+        } else if (arg == "-r" || arg == "--reference") {
+            options.reference = value;
+        } else if (arg == "-d" || arg == "--depth") {
+            auto depth = parse_int(value, 1, 10);
+            if (!depth) {
+                return std::unexpected("Depth must be between 1 and 10");
+            }
+            options.max_depth = *depth;
+        } else if (arg == "-j" || arg == "--threads") {
+            auto threads = parse_int_list(value, 1, 256);
+            if (!threads) {
+                return std::unexpected("Threads must be a comma-separated list of counts between 1 and 256");
+            }
+            options.threads = *threads;
+        } else if (arg == "-m" || arg == "--tt-size") {
+            auto size = parse_int(value, 1, 4096);
+            if (!size) {
+                return std::unexpected("Table size must be between 1 and 4096 MB");
+            }
+            options.tt_size_mb = *size;
+        } else {
+            return std::unexpected(std::format("Unknown argument '{}'", arg));
+        }
+    }
+    return options;
+}
+
+//===============================================================================
+// CORPUS
+//===============================================================================
+
+std::expected<json, std::string> read_json(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(std::format("Cannot open '{}'", path));
+    }
+    json document = json::parse(file, nullptr, false);
+    if (document.is_discarded()) {
+        return std::unexpected(std::format("'{}' is not valid JSON", path));
+    }
+    return document;
+}
+
+/**
+ * Reads the corpus: a "positions" array whose entries carry an id, a board
+ * size and a "moves" array in the game JSON format, so the moves of a saved
+ * game can be pasted in as they are. A full game document with its size
+ * under "game" is accepted too.
+ */
+std::expected<std::vector<Position>, std::string> load_positions(const std::string& path) {
+    auto document = read_json(path);
+    if (!document) {
+        return std::unexpected(document.error());
+    }
+
+    const json& entries = document->contains("positions") ? (*document)["positions"] : *document;
+    if (!entries.is_array()) {
+        return std::unexpected(std::format("'{}' has no positions array", path));
+    }
+
+    std::vector<Position> positions;
+    for (const auto& entry : entries) {
+        Position position;
+        position.id = entry.value("id", std::format("position-{}", positions.size() + 1));
+        position.board_size = entry.contains("game") ? entry["game"].value("board_size", 0)
+                                                     : entry.value("board_size", 0);
+        if (position.board_size != 15 && position.board_size != 19) {
+            return std::unexpected(std::format("{}: board size must be 15 or 19", position.id));
+        }
+
+        for (const auto& move : entry.value("moves", json::array())) {
+            if (!move.contains("position")) {
+                return std::unexpected(std::format("{}: every move needs a position", position.id));
+            }
+            move_history_t record{};
+            record.player = move.value("player", "x") == "o" ? static_cast<int>(gomoku::Player::Naught)
+                                                               : static_cast<int>(gomoku::Player::Cross);
+            record.x = move["position"].value("x", -1);
+            record.y = move["position"].value("y", -1);
+            position.moves.push_back(record);
+        }
+
+        // The AI always plays o; a lone stone would be answered at random
+        if (position.moves.size() < 3 || position.moves.size() % 2 == 0) {
+            return std::unexpected(std::format("{}: needs an odd number of at least 3 moves, o to move",
+                                               position.id));
+        }
+        positions.push_back(std::move(position));
+    }
+    return positions;
+}
+
+std::expected<GamePtr, std::string> setup_game(const Position& position, const BenchOptions& options, int depth) {
+    cli_config_t config{};
+    config.board_size = position.board_size;
+    config.max_depth = depth;
+    config.plain_search = options.plain_search ? 1 : 0;
+
+    GamePtr game(init_game(config), cleanup_game);
+    if (!game) {
+        return std::unexpected("Failed to initialize game state");
+    }
+    for (const auto& move : position.moves) {
+        if (!make_move(game.get(), move.x, move.y, move.player, 0.0, 0.0) ||
+                game->game_state != static_cast<int>(gomoku::GameState::Running)) {
+            return std::unexpected(std::format("{}: move ({}, {}) is illegal or ends the game",
+                                               position.id, move.x, move.y));
+        }
+    }
+    return game;
+}
+
+std::map<ResultKey, Move> load_reference(const std::string& path) {
+    std::map<ResultKey, Move> moves;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        json record = json::parse(line, nullptr, false);
+        if (record.is_discarded() || record.value("type", "") != "search") {
+            continue;
+        }
+        ResultKey key{record.value("position", ""), record.value("depth", 0), record.value("threads", 0)};
+        moves[key] = Move{record["move"][0].get<int>(), record["move"][1].get<int>()};
+    }
+    return moves;
+}
+
+//===============================================================================
+// BENCHMARK
+//===============================================================================
+
+/**
+ * Totals of one depth and thread count over the whole corpus
+ */
+struct Summary {
+    int positions = 0;
+    uint64_t nodes = 0;
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    double seconds = 0.0;
+    double log_branching = 0.0;     // Summed to give the geometric mean
+    int branching_samples = 0;
+    int compared = 0;
+    int agreed = 0;
+};
+
+double rate(uint64_t part, uint64_t whole) {
+    return whole ? static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+class Benchmark {
+public:
+    Benchmark(const BenchOptions& options, std::FILE* out) : options_(options), out_(out) {
+        if (!options_.reference.empty()) {
+            reference_ = load_reference(options_.reference);
+        }
+    }
+
+    std::expected<void, std::string> run(const std::vector<Position>& positions) {
+        gomoku::shared_transposition_table().resize(options_.tt_size_mb);
+
+        for (int threads : options_.threads) {
+            std::unique_ptr<gomoku::ParallelAI> parallel;
+            if (threads > 1) {
+                parallel = std::make_unique<gomoku::ParallelAI>(threads);
+            }
+
+            for (const auto& position : positions) {
+                uint64_t previous_nodes = 0;
+                for (int depth = 1; depth <= options_.max_depth; depth++) {
+                    auto searched = search(position, depth, threads, parallel.get(), previous_nodes);
+                    if (!searched) {
+                        return std::unexpected(searched.error());
+                    }
+                    previous_nodes = *searched;
+                }
+            }
+        }
+
+        for (const auto& [key, summary] : summaries_) {
+            write_summary(key.first, key.second, summary);
+        }
+        return {};
+    }
+
+private:
+    /**
+     * Searches position to depth from an empty table, writes its record and
+     * returns the nodes it took, against which the next depth's branching
+     * factor is measured.
+     */
+    std::expected<uint64_t, std::string> search(const Position& position, int depth, int threads,
+                                                gomoku::ParallelAI* parallel, uint64_t previous_nodes) {
+        auto game = setup_game(position, options_, depth);
+        if (!game) {
+            return std::unexpected(game.error());
+        }
+        (*game)->transposition_table->clear();
+
+        Move move{-1, -1};
+        double start = get_current_time();
+        if (parallel) {
+            parallel->find_best_move_parallel(game->get(), &move.x, &move.y);
+        } else {
+            find_best_ai_move(game->get(), &move.x, &move.y);
+        }
+        double seconds = get_current_time() - start;
+
+        const game_state_t& searched = **game;
+        Summary& summary = summaries_[{depth, threads}];
+        summary.positions++;
+        summary.nodes += searched.search_nodes;
+        summary.tt_probes += searched.search_tt_probes;
+        summary.tt_hits += searched.search_tt_hits;
+        summary.seconds += seconds;
+
+        json record = {
+            {"type", "search"},
+            {"position", position.id},
+            {"depth", depth},
+            {"threads", threads},
+            {"move", {move.x, move.y}},
+            {"depth_reached", searched.search_depth_reached},
+            {"nodes", searched.search_nodes},
+            {"time_ms", seconds * 1000.0},
+            {"nps", seconds > 0.0 ? static_cast<double>(searched.search_nodes) / seconds : 0.0},
+            {"tt_hit_rate", rate(searched.search_tt_hits, searched.search_tt_probes)},
+            {"branching_factor", nullptr},
+            {"agrees", nullptr},
+        };
+
+        // Effective branching factor: how many times the work grew for one more ply
+        if (previous_nodes > 0 && searched.search_nodes > 0) {
+            double branching = static_cast<double>(searched.search_nodes) / static_cast<double>(previous_nodes);
+            record["branching_factor"] = branching;
+            summary.log_branching += std::log(branching);
+            summary.branching_samples++;
+        }
+
+        if (auto expected = expected_move(position.id, depth, threads)) {
+            bool agrees = *expected == move;
+            record["agrees"] = agrees;
+            summary.compared++;
+            summary.agreed += agrees ? 1 : 0;
+        }
+        if (threads == options_.threads.front()) {
+            first_moves_[{position.id, depth, threads}] = move;
+        }
+
+        write(record);
+        return searched.search_nodes;
+    }
+
+    std::optional<Move> expected_move(const std::string& id, int depth, int threads) const {
+        if (!options_.reference.empty()) {
+            auto it = reference_.find({id, depth, threads});
+            return it != reference_.end() ? std::optional(it->second) : std::nullopt;
+        }
+        if (threads == options_.threads.front()) {
+            return std::nullopt;
+        }
+        auto it = first_moves_.find({id, depth, options_.threads.front()});
+        return it != first_moves_.end() ? std::optional(it->second) : std::nullopt;
+    }
+
+    void write_summary(int depth, int threads, const Summary& summary) {
+        json record = {
+            {"type", "summary"},
+            {"depth", depth},
+            {"threads", threads},
+            {"positions", summary.positions},
+            {"nodes", summary.nodes},
+            {"time_to_depth_ms", summary.seconds * 1000.0 / summary.positions},
+            {"nps", summary.seconds > 0.0 ? static_cast<double>(summary.nodes) / summary.seconds : 0.0},
+            {"tt_hit_rate", rate(summary.tt_hits, summary.tt_probes)},
+            {"branching_factor", nullptr},
+            {"move_agreement", nullptr},
+        };
+        if (summary.branching_samples > 0) {
+            record["branching_factor"] = std::exp(summary.log_branching / summary.branching_samples);
+        }
+        if (summary.compared > 0) {
+            record["move_agreement"] = rate(summary.agreed, summary.compared);
+        }
+        write(record);
+    }
+
+    void write(const json& record) {
+        std::fprintf(out_, "%s\n", record.dump().c_str());
+        std::fflush(out_);
+    }
+
+    const BenchOptions& options_;
+    std::FILE* out_;
+    std::map<ResultKey, Move> reference_;
+    std::map<ResultKey, Move> first_moves_;
+    std::map<std::pair<int, int>, Summary> summaries_;   // By (depth, threads)
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        std::cerr << std::format("Error: {}\n", options.error());
+        return 1;
+    }
+
+    auto positions = load_positions(options->positions);
+    if (!positions) {
+        std::cerr << std::format("Error: {}\n", positions.error());
+        return 1;
+    }
+    gomoku::populate_threat_matrix();
+
+    // The search prints progress meant for the terminal game; keep it out of the records
+    std::FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!out || !std::freopen("/dev/null", "w", stdout)) {
+        std::cerr << "Error: Failed to redirect search output\n";
+        return 1;
+    }
+
+    auto result = Benchmark(*options, out).run(*positions);
+    std::fclose(out);
+    if (!result) {
+        std::cerr << std::format("Error: {}\n", result.error());
+        return 1;
+    }
+    return 0;
+}
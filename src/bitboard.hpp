@@ -0,0 +1,287 @@
+//
+//  bitboard.hpp
+//  gomoku - Packed bitboard position used by the search and the evaluator
+//
+//  One bitset per player for each line direction, mutated in place on make/unmake
+//
+
+#pragma once
+
+#include "gomoku.hpp"
+#include "simd_kernels.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace gomoku {
+
+inline constexpr int MAX_BOARD_SIZE = 19;
+
+//===============================================================================
+// BITBOARD CLASS
+//===============================================================================
+
+/**
+ * Packed position with one line bitset per player for each of the four
+ * DIRECTIONS. Every cell appears exactly once in each direction view, so the
+ * line through any cell is a single 32-bit word, and stepping along
+ * DIRECTIONS[d] moves one bit up in that word. Cells beyond the board edge are
+ * never set, which matches Board::get_line() treating them as empty.
+ */
+class BitBoard {
+public:
+    using LineMask = uint32_t;
+
+    static constexpr int MAX_LINES = MAX_BOARD_SIZE * 2 - 1;
+    static constexpr int WINDOW_SIZE = NEED_TO_WIN * 2 - 1;
+    static constexpr int WINDOW_CENTER = NEED_TO_WIN - 1;
+    static constexpr uint32_t WINDOW_MASK = (1u << WINDOW_SIZE) - 1;
+    static constexpr uint32_t WINDOW_CENTER_BIT = 1u << WINDOW_CENTER;
+
+    constexpr BitBoard() noexcept = default;
+    constexpr explicit BitBoard(int board_size) noexcept : size_(board_size) {}
+
+    //===============================================================================
+    // BOARD STATE
+    //===============================================================================
+
+    constexpr void reset(int board_size) noexcept {
+        size_ = board_size;
+        stones_ = 0;
+        lines_ = {};
+    }
+
+    [[nodiscard]] constexpr int size() const noexcept { return size_; }
+    [[nodiscard]] constexpr int stone_count() const noexcept { return stones_; }
+
+    /**
+     * Loads a board indexable as board[x][y] holding Player values, either a
+     * FlatBoard or a legacy int** board (AI_CELL_* values).
+     */
+    template<typename Rows>
+    constexpr void load(const Rows& board, int board_size) noexcept {
+        reset(board_size);
+        for (int x = 0; x < board_size; ++x) {
+            for (int y = 0; y < board_size; ++y) {
+                if (board[x][y] != static_cast<int>(Player::Empty)) {
+                    place(x, y, static_cast<Player>(board[x][y]));
+                }
+            }
+        }
+    }
+
+    //===============================================================================
+    // MAKE / UNMAKE
+    //===============================================================================
+
+    constexpr void place(int x, int y, Player player) noexcept { place(x, y, player, size_); }
+    constexpr void remove(int x, int y, Player player) noexcept { remove(x, y, player, size_); }
+
+    /**
+     * place() and remove() for a board whose size is known at compile time,
+     * which folds the diagonal line offsets into constants. Size must be size().
+     */
+    template<int Size> requires ValidBoardSize<Size>
+    constexpr void place(int x, int y, Player player) noexcept { place(x, y, player, Size); }
+
+    template<int Size> requires ValidBoardSize<Size>
+    constexpr void remove(int x, int y, Player player) noexcept { remove(x, y, player, Size); }
+
+    //===============================================================================
+    // CELL ACCESS
+    //===============================================================================
+
+    [[nodiscard]] constexpr bool has_stone(int x, int y, Player player) const noexcept {
+        return (line(player, 1, x) >> y) & 1u;
+    }
+
+    [[nodiscard]] constexpr bool is_empty(int x, int y) const noexcept {
+        return !(((line(Player::Cross, 1, x) | line(Player::Naught, 1, x)) >> y) & 1u);
+    }
+
+    [[nodiscard]] constexpr Player at(int x, int y) const noexcept {
+        if (has_stone(x, y, Player::Cross)) return Player::Cross;
+        if (has_stone(x, y, Player::Naught)) return Player::Naught;
+        return Player::Empty;
+    }
+
+    /**
+     * Stones of player on row x, one bit per column y.
+     */
+    [[nodiscard]] constexpr LineMask row(Player player, int x) const noexcept {
+        return line(player, 1, x);
+    }
+
+    //===============================================================================
+    // LINE KERNELS
+    //===============================================================================
+
+    /**
+     * Returns the 9-cell window of player's stones along DIRECTIONS[dir],
+     * centered on (x, y): bit i holds the cell at offset i - WINDOW_CENTER.
+     */
+    [[nodiscard]] constexpr uint32_t window(Player player, int dir, int x, int y) const noexcept {
+        LineMask bits = line(player, dir, line_index(dir, x, y));
+        return ((bits << WINDOW_CENTER) >> line_bit(dir, x, y)) & WINDOW_MASK;
+    }
+
+    /**
+     * Length of the unbroken run of player's stones through (x, y) along
+     * DIRECTIONS[dir], counting (x, y) itself as occupied by player.
+     */
+    [[nodiscard]] constexpr int run_length(Player player, int dir, int x, int y) const noexcept {
+        int bit = line_bit(dir, x, y);
+        LineMask bits = line(player, dir, line_index(dir, x, y));
+        int forward = std::countr_one(bits >> (bit + 1));
+        int backward = bit == 0 ? 0 : std::countl_one(static_cast<LineMask>(bits << (32 - bit)));
+        return 1 + forward + backward;
+    }
+
+    /**
+     * Whether player has five (or more) in a row anywhere on the board.
+     * Lines past line_count() are always empty, so all of a player's line
+     * words are scanned as one array by the vectorized kernel.
+     */
+    [[nodiscard]] constexpr bool has_five(Player player) const noexcept {
+        const auto& lines = lines_[player_index(player)];
+        if consteval {
+            return simd::any_five_scalar(lines);
+        } else {
+            return simd::any_five(lines);
+        }
+    }
+
+    /**
+     * Whether one of the four lines through (x, y) holds five of player's stones.
+     */
+    [[nodiscard]] constexpr bool has_five_at(Player player, int x, int y) const noexcept {
+        for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+            if (contains_five(line(player, dir, line_index(dir, x, y)))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] static constexpr bool contains_five(LineMask m) noexcept {
+        return (m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4)) != 0;
+    }
+
+    //===============================================================================
+    // ITERATION SUPPORT
+    //===============================================================================
+
+    /**
+     * Calls fn(x, y) for every stone of player inside the inclusive rectangle.
+     */
+    template<typename Fn>
+    constexpr void for_each_stone(Player player, int min_x, int max_x, int min_y, int max_y,
+                                  Fn&& fn) const {
+        LineMask column_mask = ((LineMask{1} << (max_y - min_y + 1)) - 1) << min_y;
+        for (int x = min_x; x <= max_x; ++x) {
+            LineMask bits = row(player, x) & column_mask;
+            while (bits) {
+                fn(x, std::countr_zero(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    template<typename Fn>
+    constexpr void for_each_stone(Player player, Fn&& fn) const {
+        for_each_stone(player, 0, size_ - 1, 0, size_ - 1, std::forward<Fn>(fn));
+    }
+
+    //===============================================================================
+    // LINE GEOMETRY
+    //===============================================================================
+
+    [[nodiscard]] static constexpr int player_index(Player player) noexcept {
+        return player == Player::Cross ? 0 : 1;
+    }
+
+    [[nodiscard]] constexpr int line_index(int dir, int x, int y) const noexcept {
+        return line_index(dir, x, y, size_);
+    }
+
+    // DIRECTIONS order: {1,0}, {0,1}, {1,1}, {1,-1}
+    [[nodiscard]] static constexpr int line_index(int dir, int x, int y, int board_size) noexcept {
+        switch (dir) {
+            case 0: return y;
+            case 1: return x;
+            case 2: return x - y + board_size - 1;
+            default: return x + y;
+        }
+    }
+
+    [[nodiscard]] static constexpr int line_bit(int dir, int x, int y) noexcept {
+        return dir == 1 ? y : x;
+    }
+
+    [[nodiscard]] constexpr int line_count(int dir) const noexcept {
+        return dir < 2 ? size_ : size_ * 2 - 1;
+    }
+
+    /**
+     * Stones of player on line index of DIRECTIONS[dir], one bit per step along it.
+     */
+    [[nodiscard]] constexpr LineMask line_stones(Player player, int dir, int index) const noexcept {
+        return line(player, dir, index);
+    }
+
+    /**
+     * Bits of line index of DIRECTIONS[dir] that fall on the board.
+     */
+    [[nodiscard]] constexpr LineMask line_cells(int dir, int index) const noexcept {
+        if (dir < 2) {
+            return (LineMask{1} << size_) - 1;
+        }
+        int low = index - size_ + 1 > 0 ? index - size_ + 1 : 0;
+        int high = index < size_ - 1 ? index : size_ - 1;
+        return ((LineMask{1} << (high - low + 1)) - 1) << low;
+    }
+
+    /**
+     * The cell at bit of line index of DIRECTIONS[dir]; inverse of line_index() and line_bit().
+     */
+    [[nodiscard]] constexpr Position line_cell(int dir, int index, int bit) const noexcept {
+        switch (dir) {
+            case 0: return Position{bit, index};
+            case 1: return Position{index, bit};
+            case 2: return Position{bit, bit - index + size_ - 1};
+            default: return Position{bit, index - bit};
+        }
+    }
+
+    constexpr bool operator==(const BitBoard& other) const noexcept = default;
+
+private:
+    constexpr void place(int x, int y, Player player, int board_size) noexcept {
+        for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+            line(player, dir, line_index(dir, x, y, board_size)) |= LineMask{1} << line_bit(dir, x, y);
+        }
+        ++stones_;
+    }
+
+    constexpr void remove(int x, int y, Player player, int board_size) noexcept {
+        for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+            line(player, dir, line_index(dir, x, y, board_size)) &= ~(LineMask{1} << line_bit(dir, x, y));
+        }
+        --stones_;
+    }
+
+    [[nodiscard]] constexpr LineMask& line(Player player, int dir, int index) noexcept {
+        return lines_[player_index(player)][dir * MAX_LINES + index];
+    }
+
+    [[nodiscard]] constexpr LineMask line(Player player, int dir, int index) const noexcept {
+        return lines_[player_index(player)][dir * MAX_LINES + index];
+    }
+
+    int size_ = DEFAULT_BOARD_SIZE;
+    int stones_ = 0;
+    // Per player, the MAX_LINES words of each direction back to back
+    std::array<std::array<LineMask, NUM_DIRECTIONS * MAX_LINES>, 2> lines_{};
+};
+
+} // namespace gomoku
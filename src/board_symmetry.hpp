@@ -0,0 +1,62 @@
+//
+//  board_symmetry.hpp
+//  gomoku - The eight symmetries of the square board
+//
+//  Maps cells through rotations and reflections, used to key mirrored positions alike
+//
+
+#pragma once
+
+namespace gomoku {
+
+//===============================================================================
+// BOARD SYMMETRY
+//===============================================================================
+
+/**
+ * Number of orientations of a square board: four rotations, each optionally
+ * mirrored. Symmetry 0 is the identity.
+ */
+inline constexpr int SYMMETRY_COUNT = 8;
+
+struct SymmetricCell {
+    int x;
+    int y;
+};
+
+/**
+ * Where cell (x, y) of a board_size board lands under symmetry.
+ */
+[[nodiscard]] constexpr SymmetricCell transform_cell(int symmetry, int x, int y, int board_size) noexcept {
+    int last = board_size - 1;
+    switch (symmetry) {
+        case 1: return {y, last - x};          // Rotate 90 degrees
+        case 2: return {last - x, last - y};   // Rotate 180 degrees
+        case 3: return {last - y, x};          // Rotate 270 degrees
+        case 4: return {x, last - y};          // Mirror columns
+        case 5: return {last - x, y};          // Mirror rows
+        case 6: return {y, x};                 // Transpose
+        case 7: return {last - y, last - x};   // Anti-transpose
+        default: return {x, y};
+    }
+}
+
+/**
+ * The symmetry that undoes symmetry. Only the quarter turns are not their own inverse.
+ */
+[[nodiscard]] constexpr int inverse_symmetry(int symmetry) noexcept {
+    return symmetry == 1 ? 3 : symmetry == 3 ? 1 : symmetry;
+}
+
+static_assert([] {
+    for (int s = 0; s < SYMMETRY_COUNT; s++) {
+        SymmetricCell there = transform_cell(s, 2, 5, 15);
+        SymmetricCell back = transform_cell(inverse_symmetry(s), there.x, there.y, 15);
+        if (back.x != 2 || back.y != 5) {
+            return false;
+        }
+    }
+    return true;
+}(), "inverse_symmetry() must undo transform_cell()");
+
+} // namespace gomoku
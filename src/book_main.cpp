@@ -0,0 +1,278 @@
+//
+//  book_main.cpp
+//  gomoku-book - Opening book generator
+//
+//  Searches the common opening positions deeply offline and writes the replies as a book file
+//
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <expected>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "gomoku.hpp"
+#include "game.h"
+#include "ai.h"
+#include "opening_book.hpp"
+#include "search_scratch.hpp"
+
+namespace {
+
+using gomoku::BookEntry;
+using gomoku::OpeningBook;
+using gomoku::WIN_SCORE;
+
+using GamePtr = std::unique_ptr<game_state_t, void(*)(game_state_t*)>;
+
+struct BookOptions {
+    int board_size = 15;
+    int depth = 6;         // Search depth of every book move
+    int plies = 3;         // Replies the book covers per game, counted in AI moves
+    int width = 4;         // Opponent moves expanded at every ply
+    std::string output;
+};
+
+//===============================================================================
+// COMMAND LINE
+//===============================================================================
+
+void print_usage(std::string_view program_name) {
+    std::cout << std::format(R"(
+gomoku-book - Opening book generator
+
+USAGE:
+    {} [OPTIONS]
+
+OPTIONS:
+    -b, --board <SIZE>       Board size, 15 or 19 (default: 15)
+    -d, --depth <DEPTH>      Search depth of every book move (default: 6, range: 1-10)
+    -p, --plies <COUNT>      AI replies covered per game (default: 3, range: 1-6)
+    -w, --width <COUNT>      Opponent moves expanded at every ply (default: 4, range: 1-16)
+    -o, --output <PATH>      Book file to write (default: opening-<SIZE>.book)
+    -h, --help               Show this help message
+
+The book holds the AI's reply to the opponent's `width` most promising moves
+at each of the first `plies` turns; a book of width W and P plies needs
+W + W^2 + ... + W^P searches.
+)", program_name);
+}
+
+std::optional<int> parse_int(std::string_view text, int min, int max) {
+    int value{};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::expected<BookOptions, std::string> parse_options(int argc, char* argv[]) {
+    BookOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            return std::unexpected(std::format("Missing value for '{}'", arg));
+        }
+        std::string_view value = argv[++i];
+
+        std::optional<int> number;
+        if (arg == "-b" || arg == "--board") {
+            number = parse_int(value, 15, 19);
+            if (!number || (*number != 15 && *number != 19)) {
+                return std::unexpected("Board size must be 15 or 19");
+            }
+            options.board_size = *number;
+        } else if (arg == "-d" || arg == "--depth") {
+            if (!(number = parse_int(value, 1, 10))) {
+                return std::unexpected("Depth must be between 1 and 10");
+            }
+            options.depth = *number;
+        } else if (arg == "-p" || arg == "--plies") {
+            if (!(number = parse_int(value, 1, 6))) {
+                return std::unexpected("Plies must be between 1 and 6");
+            }
+            options.plies = *number;
+        } else if (arg == "-w" || arg == "--width") {
+            if (!(number = parse_int(value, 1, 16))) {
+                return std::unexpected("Width must be between 1 and 16");
+            }
+            options.width = *number;
+        } else if (arg == "-o" || arg == "--output") {
+            options.output = value;
+        } else {
+            return std::unexpected(std::format("Unknown argument '{}'", arg));
+        }
+    }
+
+    if (options.output.empty()) {
+        options.output = std::format("opening-{}.book", options.board_size);
+    }
+    return options;
+}
+
+//===============================================================================
+// BOOK BUILDER
+//===============================================================================
+
+GamePtr clone_game(const game_state_t& game) {
+    // The clone shares the original's search_id, so it searches with the heuristics the original learned
+    auto* copy = new game_state_t(game);
+    copy->scratch = nullptr;
+    return GamePtr(copy, cleanup_game);
+}
+
+class BookBuilder {
+public:
+    explicit BookBuilder(const BookOptions& options) : options_(options) {}
+
+    std::vector<BookEntry> build(game_state_t* root) {
+        expand(*root, options_.plies);
+        return std::move(entries_);
+    }
+
+private:
+    /**
+     * Plays each of the opponent's most promising moves in position, stores
+     * the AI's searched reply to it and, while plies remain, continues from
+     * the reply.
+     */
+    void expand(const game_state_t& position, int plies_left) {
+        move_t moves[361];
+        auto* scratch = const_cast<game_state_t*>(&position);
+        int move_count = generate_moves_optimized(scratch, moves, static_cast<int>(gomoku::Player::Cross));
+        qsort(moves, move_count, sizeof(move_t), compare_moves);
+
+        for (int m = 0; m < std::min(move_count, options_.width); m++) {
+            GamePtr child = clone_game(position);
+            make_move(child.get(), moves[m].x, moves[m].y, static_cast<int>(gomoku::Player::Cross), 0, 0);
+            if (child->game_state != static_cast<int>(gomoku::GameState::Running) ||
+                !seen_.insert(child->current_hash).second) {
+                continue;
+            }
+
+            auto entry = search(child.get());
+            if (!entry) {
+                continue;
+            }
+            entries_.push_back(*entry);
+            std::cout << std::format("\r{} positions searched", entries_.size()) << std::flush;
+
+            if (plies_left > 1) {
+                make_move(child.get(), entry->x, entry->y, static_cast<int>(gomoku::Player::Naught), 0, 0);
+                if (child->game_state == static_cast<int>(gomoku::GameState::Running)) {
+                    expand(*child, plies_left - 1);
+                }
+            }
+        }
+    }
+
+    /**
+     * Iteratively deepened root search for the AI's reply. Unlike
+     * find_best_ai_move() it never shortcuts the first reply with a random
+     * placement, and it returns the score the book records.
+     */
+    std::optional<BookEntry> search(game_state_t* game) {
+        gomoku::ScratchLease lease(game);
+        move_t moves[361];
+        int move_count = generate_moves_optimized(game, moves, static_cast<int>(gomoku::Player::Naught));
+        if (move_count == 0) {
+            return std::nullopt;
+        }
+        qsort(moves, move_count, sizeof(move_t), compare_moves);
+
+        game->move_timeout = 0;
+        game->search_timeout_ms = 0;
+        game->search_start_time = get_current_time();
+        game->transposition_table->new_search();
+
+        int best_score = -WIN_SCORE - 1;
+        for (int depth = 1; depth <= options_.depth; depth++) {
+            int alpha = -WIN_SCORE - 1;
+            int depth_best = 0;
+            for (int m = 0; m < move_count; m++) {
+                place_stone(game, moves[m].x, moves[m].y, static_cast<int>(gomoku::Player::Naught));
+                int score = minimax_with_timeout(game, depth - 1, alpha, WIN_SCORE + 1,
+                        0, static_cast<int>(gomoku::Player::Naught), moves[m].x, moves[m].y);
+                remove_stone(game, moves[m].x, moves[m].y);
+
+                if (score > alpha) {
+                    alpha = score;
+                    depth_best = m;
+                }
+            }
+
+            // Search the previous iteration's best move first
+            std::swap(moves[0], moves[depth_best]);
+            best_score = alpha;
+            if (best_score >= WIN_SCORE - 1000) {
+                break;
+            }
+        }
+
+        // Mirrored positions share a key, so the move is stored in the key's orientation
+        gomoku::SymmetricCell cell = gomoku::transform_cell(game->hash_symmetry, moves[0].x, moves[0].y,
+                                                            game->board_size);
+        return BookEntry{
+            .hash = game->current_hash,
+            .score = best_score,
+            .x = static_cast<uint8_t>(cell.x),
+            .y = static_cast<uint8_t>(cell.y),
+            .depth = static_cast<uint8_t>(options_.depth),
+            .board_size = static_cast<uint8_t>(game->board_size),
+        };
+    }
+
+    const BookOptions& options_;
+    std::vector<BookEntry> entries_;
+    std::unordered_set<uint64_t> seen_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        std::cerr << std::format("Error: {}\n", options.error());
+        return 1;
+    }
+
+    cli_config_t config{};
+    config.board_size = options->board_size;
+    config.max_depth = options->depth;
+    GamePtr root(init_game(config), cleanup_game);
+    if (!root) {
+        std::cerr << "Error: Failed to initialize game state\n";
+        return 1;
+    }
+    gomoku::populate_threat_matrix();
+
+    std::cout << std::format("Building a {}x{} book: depth {}, {} plies, width {}\n",
+                             options->board_size, options->board_size,
+                             options->depth, options->plies, options->width);
+
+    auto entries = BookBuilder(*options).build(root.get());
+    std::cout << '\n';
+
+    auto written = OpeningBook::write(options->output, entries);
+    if (!written) {
+        std::cerr << std::format("Error: {}\n", written.error());
+        return 1;
+    }
+
+    std::cout << std::format("Wrote {} positions to {}\n", entries.size(), options->output);
+    return 0;
+}
@@ -0,0 +1,190 @@
+//
+//  candidate_set.hpp
+//  gomoku - Candidate moves maintained on make/unmake
+//
+//  Reference-counted set of the empty cells near a stone, updated in constant time per neighbour
+//
+
+#pragma once
+
+#include "bitboard.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+
+namespace gomoku {
+
+//===============================================================================
+// CANDIDATE SET CLASS
+//===============================================================================
+
+/**
+ * The moves worth searching: every empty cell within RADIUS of a stone, in
+ * either direction on both axes. Each cell counts the stones around it, and a
+ * bitmask holds the empty cells whose count is above zero, so placing or
+ * removing a stone touches its (2 * RADIUS + 1)^2 neighbourhood once and
+ * never scans the set. That keeps it cheap enough for place_stone() and
+ * remove_stone() to maintain at every node of the search.
+ *
+ * An empty board has the cells within RADIUS of the centre as candidates.
+ */
+class CandidateSet {
+public:
+    static constexpr int RADIUS = 2;
+
+    /**
+     * Empties the set for a board of board_size.
+     */
+    void reset(int board_size) noexcept {
+        size_ = board_size;
+        stones_ = 0;
+        neighbours_.fill(0);
+        candidates_.fill(0);
+        occupied_.fill(0);
+    }
+
+    /**
+     * Rebuilds the set from the stones of board.
+     */
+    void load(const BitBoard& board) noexcept {
+        reset(board.size());
+        for (int x = 0; x < size_; ++x) {
+            for (int y = 0; y < size_; ++y) {
+                if (!board.is_empty(x, y)) {
+                    place(x, y);
+                }
+            }
+        }
+    }
+
+    /**
+     * Records a stone placed on (x, y).
+     */
+    void place(int x, int y) noexcept { place(x, y, size_); }
+
+    /**
+     * Records the stone on (x, y) being taken back.
+     */
+    void remove(int x, int y) noexcept { remove(x, y, size_); }
+
+    /**
+     * place() and remove() with the neighbourhood clipped against a board
+     * size known at compile time. Size must be the size the set was reset for.
+     */
+    template<int Size> requires ValidBoardSize<Size>
+    void place(int x, int y) noexcept { place(x, y, Size); }
+
+    template<int Size> requires ValidBoardSize<Size>
+    void remove(int x, int y) noexcept { remove(x, y, Size); }
+
+    [[nodiscard]] bool contains(int x, int y) const noexcept {
+        if (stones_ == 0) {
+            return near_centre(x, y);
+        }
+        return test(candidates_, index(x, y));
+    }
+
+    /**
+     * Calls fn(x, y) for every candidate, in row order.
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const noexcept {
+        if (stones_ == 0) {
+            int centre = size_ / 2;
+            for (int x = centre - RADIUS; x <= centre + RADIUS; ++x) {
+                for (int y = centre - RADIUS; y <= centre + RADIUS; ++y) {
+                    fn(x, y);
+                }
+            }
+            return;
+        }
+
+        for (int w = 0; w < WORDS; ++w) {
+            for (uint64_t bits = candidates_[w]; bits; bits &= bits - 1) {
+                int cell = w * 64 + std::countr_zero(bits);
+                fn(cell / MAX_BOARD_SIZE, cell % MAX_BOARD_SIZE);
+            }
+        }
+    }
+
+    [[nodiscard]] int count() const noexcept {
+        if (stones_ == 0) {
+            return (2 * RADIUS + 1) * (2 * RADIUS + 1);
+        }
+        int total = 0;
+        for (uint64_t word : candidates_) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+private:
+    static constexpr int CELLS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+
+    using Mask = std::array<uint64_t, WORDS>;
+
+    // A fixed stride keeps cell indices valid for any board size
+    [[nodiscard]] static constexpr int index(int x, int y) noexcept { return x * MAX_BOARD_SIZE + y; }
+
+    static void set(Mask& mask, int cell) noexcept { mask[cell >> 6] |= uint64_t{1} << (cell & 63); }
+    static void clear(Mask& mask, int cell) noexcept { mask[cell >> 6] &= ~(uint64_t{1} << (cell & 63)); }
+    [[nodiscard]] static bool test(const Mask& mask, int cell) noexcept {
+        return (mask[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    [[nodiscard]] bool near_centre(int x, int y) const noexcept {
+        int centre = size_ / 2;
+        return std::abs(x - centre) <= RADIUS && std::abs(y - centre) <= RADIUS;
+    }
+
+    void place(int x, int y, int board_size) noexcept {
+        int cell = index(x, y);
+        set(occupied_, cell);
+        clear(candidates_, cell);
+        ++stones_;
+
+        for_each_neighbour(x, y, board_size, [this](int neighbour) {
+            ++neighbours_[neighbour];
+            if (!test(occupied_, neighbour)) {
+                set(candidates_, neighbour);
+            }
+        });
+    }
+
+    void remove(int x, int y, int board_size) noexcept {
+        int cell = index(x, y);
+        clear(occupied_, cell);
+        if (neighbours_[cell] > 0) {
+            set(candidates_, cell);
+        }
+        --stones_;
+
+        for_each_neighbour(x, y, board_size, [this](int neighbour) {
+            if (--neighbours_[neighbour] == 0) {
+                clear(candidates_, neighbour);
+            }
+        });
+    }
+
+    template<typename Fn>
+    static void for_each_neighbour(int x, int y, int board_size, Fn&& fn) noexcept {
+        for (int i = std::max(0, x - RADIUS); i <= std::min(board_size - 1, x + RADIUS); ++i) {
+            for (int j = std::max(0, y - RADIUS); j <= std::min(board_size - 1, y + RADIUS); ++j) {
+                if (i != x || j != y) {
+                    fn(index(i, j));
+                }
+            }
+        }
+    }
+
+    int size_ = DEFAULT_BOARD_SIZE;
+    int stones_ = 0;
+    std::array<uint8_t, CELLS> neighbours_{};   // Stones within RADIUS of each cell
+    Mask candidates_{};                          // Empty cells with a stone within RADIUS
+    Mask occupied_{};
+};
+
+} // namespace gomoku
@@ -40,6 +40,14 @@ std::expected<void, std::string> Config::validate() const {
         return std::unexpected("Timeout must be a positive number");
     }
     
+    if (tt_size_mb < 1 || tt_size_mb > 4096) {
+        return std::unexpected("Transposition table size must be between 1 and 4096 MB");
+    }
+    
+    if (search_mode != "lazy" && search_mode != "root") {
+        return std::unexpected("Search mode must be 'lazy' or 'root'");
+    }
+    
     // Validate thread count
     if (thread_count < 0) {
         return std::unexpected("Thread count must be a positive number");
@@ -60,14 +68,16 @@ std::expected<void, std::string> Config::validate() const {
     
     // Validate computer difficulty levels
     if (player1.type == "computer" && !player1.difficulty.empty()) {
-        if (player1.difficulty != "easy" && player1.difficulty != "medium" && player1.difficulty != "hard") {
-            return std::unexpected("Player 1 difficulty must be 'easy', 'medium', or 'hard'");
+        if (player1.difficulty != "easy" && player1.difficulty != "medium" && player1.difficulty != "hard" &&
+                player1.difficulty != "mcts") {
+            return std::unexpected("Player 1 difficulty must be 'easy', 'medium', 'hard' or 'mcts'");
         }
     }
     
     if (player2.type == "computer" && !player2.difficulty.empty()) {
-        if (player2.difficulty != "easy" && player2.difficulty != "medium" && player2.difficulty != "hard") {
-            return std::unexpected("Player 2 difficulty must be 'easy', 'medium', or 'hard'");
+        if (player2.difficulty != "easy" && player2.difficulty != "medium" && player2.difficulty != "hard" &&
+                player2.difficulty != "mcts") {
+            return std::unexpected("Player 2 difficulty must be 'easy', 'medium', 'hard' or 'mcts'");
         }
     }
     
@@ -81,10 +91,16 @@ auto Config::to_c_struct() const {
     c_config.max_depth = max_depth;
     c_config.move_timeout = move_timeout;
     c_config.thread_count = thread_count;
+    c_config.tt_size_mb = tt_size_mb;
     c_config.show_help = show_help ? 1 : 0;
     c_config.invalid_args = 0;
     c_config.enable_undo = enable_undo ? 1 : 0;
     c_config.skip_welcome = skip_welcome ? 1 : 0;
+    c_config.plain_search = plain_search ? 1 : 0;
+    c_config.ponder = ponder ? 1 : 0;
+    strncpy(c_config.search_mode, search_mode.c_str(), sizeof(c_config.search_mode) - 1);
+    strncpy(c_config.book_path, book_path.c_str(), sizeof(c_config.book_path) - 1);
+    strncpy(c_config.analyze_path, analyze_path.c_str(), sizeof(c_config.analyze_path) - 1);
     
     // Copy player configurations
     strncpy(c_config.player1_type, player1.type.c_str(), sizeof(c_config.player1_type) - 1);
@@ -140,8 +156,8 @@ std::expected<std::pair<PlayerConfig, PlayerConfig>, ParseError> parse_players_s
             config.type = type;
             
             if (type == "computer") {
-                // Parameter is difficulty
-                if (param != "easy" && param != "medium" && param != "hard") {
+                // Parameter is difficulty, or "mcts" for the tree search at medium depth
+                if (param != "easy" && param != "medium" && param != "hard" && param != "mcts") {
                     return std::unexpected(ParseError::InvalidArgument);
                 }
                 config.difficulty = param;
@@ -188,8 +204,14 @@ std::expected<Config, ParseError> parse_arguments_modern(std::span<const char*>
         option{"board", required_argument, nullptr, 'b'},
         option{"players", required_argument, nullptr, 'p'},
         option{"threads", required_argument, nullptr, 'j'},
+        option{"tt-size", required_argument, nullptr, 'm'},
+        option{"search-mode", required_argument, nullptr, 'S'},
+        option{"book", required_argument, nullptr, 'B'},
+        option{"analyze", required_argument, nullptr, 'A'},
         option{"help", no_argument, nullptr, 'h'},
         option{"undo", no_argument, nullptr, 'u'},
+        option{"no-pvs", no_argument, nullptr, 'P'},
+        option{"ponder", no_argument, nullptr, 'O'},
         option{"skip-welcome", no_argument, nullptr, 's'},
         option{nullptr, 0, nullptr, 0}
     };
@@ -197,7 +219,7 @@ std::expected<Config, ParseError> parse_arguments_modern(std::span<const char*>
     int option_index = 0;
     int c;
     
-    while ((c = getopt_long(argc, argv, "d:l:t:b:p:j:hus", 
+    while ((c = getopt_long(argc, argv, "d:l:t:b:p:j:m:S:B:A:husPO", 
                            const_cast<option*>(long_options.data()), &option_index)) != -1) {
         switch (c) {
             case 'd': {
@@ -270,6 +292,44 @@ std::expected<Config, ParseError> parse_arguments_modern(std::span<const char*>
                 break;
             }
             
+            case 'm': {
+                config.tt_size_mb = std::atoi(optarg);
+                if (config.tt_size_mb < 1 || config.tt_size_mb > 4096) {
+                    return std::unexpected(ParseError::InvalidTableSize);
+                }
+                break;
+            }
+            
+            case 'S': {
+                config.search_mode = optarg;
+                if (config.search_mode != "lazy" && config.search_mode != "root") {
+                    std::cout << std::format("{}{}ERROR: Search mode must be 'lazy' or 'root'{}\n",
+                                           COLOR_BRIGHT_RED, ESCAPE_CODE_BOLD, COLOR_RESET);
+                    return std::unexpected(ParseError::InvalidArgument);
+                }
+                break;
+            }
+            
+            case 'B': {
+                config.book_path = optarg;
+                if (config.book_path.empty() || config.book_path.size() >= 256) {
+                    std::cout << std::format("{}{}ERROR: Opening book path must be 1 to 255 characters{}\n",
+                                           COLOR_BRIGHT_RED, ESCAPE_CODE_BOLD, COLOR_RESET);
+                    return std::unexpected(ParseError::InvalidArgument);
+                }
+                break;
+            }
+            
+            case 'A': {
+                config.analyze_path = optarg;
+                if (config.analyze_path.empty() || config.analyze_path.size() >= 256) {
+                    std::cout << std::format("{}{}ERROR: Game log path must be 1 to 255 characters{}\n",
+                                           COLOR_BRIGHT_RED, ESCAPE_CODE_BOLD, COLOR_RESET);
+                    return std::unexpected(ParseError::InvalidArgument);
+                }
+                break;
+            }
+            
             case 'u':
                 config.enable_undo = true;
                 break;
@@ -278,6 +338,14 @@ std::expected<Config, ParseError> parse_arguments_modern(std::span<const char*>
                 config.skip_welcome = true;
                 break;
                 
+            case 'P':
+                config.plain_search = true;
+                break;
+                
+            case 'O':
+                config.ponder = true;
+                break;
+                
             case 'h':
                 config.show_help = true;
                 break;
@@ -321,10 +389,22 @@ void print_help_modern(std::string_view program_name) {
                             COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("  {}-j, --threads N{}       Number of threads for parallel AI (1 to cores-1)\n", 
                             COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-m, --tt-size MB{}      Transposition table size in megabytes (default: 32)\n", 
+                            COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-S, --search-mode M{}   Parallel search: \"lazy\" (Lazy SMP, default) or \"root\"\n", 
+                            COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-B, --book PATH{}       Opening book built by gomoku-book\n", 
+                            COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-A, --analyze LOGS{}    Annotate game logs (a directory or glob) as JSON lines\n", 
+                            COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("  {}-u, --undo{}            Enable the Undo feature\n", 
                             COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("  {}-s, --skip-welcome{}    Skip the welcome screen\n", 
                             COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-P, --no-pvs{}          Plain alpha-beta instead of PVS, for comparison\n", 
+                            COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("  {}-O, --ponder{}          Think on the human's time about the expected reply\n", 
+                            COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("  {}-h, --help{}            Show this help message\n", 
                             COLOR_YELLOW, COLOR_RESET);
 
@@ -332,8 +412,9 @@ void print_help_modern(std::string_view program_name) {
     std::cout << std::format("  Format: --players PLAYER1,PLAYER2\n");
     std::cout << std::format("  Player types: {}human{} or {}computer{}\n", 
                             COLOR_GREEN, COLOR_RESET, COLOR_GREEN, COLOR_RESET);
-    std::cout << std::format("  Computer difficulties: {}easy{}, {}medium{}, {}hard{}\n",
-                            COLOR_GREEN, COLOR_RESET, COLOR_GREEN, COLOR_RESET, COLOR_GREEN, COLOR_RESET);
+    std::cout << std::format("  Computer difficulties: {}easy{}, {}medium{}, {}hard{}, or {}mcts{} for Monte Carlo tree search\n",
+                            COLOR_GREEN, COLOR_RESET, COLOR_GREEN, COLOR_RESET, COLOR_GREEN, COLOR_RESET,
+                            COLOR_GREEN, COLOR_RESET);
     std::cout << std::format("  Examples:\n");
     std::cout << std::format("    {}--players human,computer{}        (default: human vs computer)\n",
                             COLOR_YELLOW, COLOR_RESET);
@@ -345,6 +426,8 @@ void print_help_modern(std::string_view program_name) {
                             COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("    {}--players computer:hard,human{}   (hard computer vs human)\n",
                             COLOR_YELLOW, COLOR_RESET);
+    std::cout << std::format("    {}--players computer:mcts,human{}   (tree search vs human)\n",
+                            COLOR_YELLOW, COLOR_RESET);
     std::cout << std::format("    {}--players human:Alice,human:Bob{} (named human players)\n",
                             COLOR_YELLOW, COLOR_RESET);
 
@@ -359,6 +442,8 @@ void print_help_modern(std::string_view program_name) {
                             COLOR_YELLOW, program_name, COLOR_RESET);
     std::cout << std::format("  {}{} --players human:Alice,human:Bob --undo{}\n", 
                             COLOR_YELLOW, program_name, COLOR_RESET);
+    std::cout << std::format("  {}{} --analyze 'game_histories/*.json' -d 6 > analysis.jsonl{}\n", 
+                            COLOR_YELLOW, program_name, COLOR_RESET);
 
     std::cout << std::format("\n{}DIFFICULTY LEVELS:{}\n", COLOR_BRIGHT_MAGENTA, COLOR_RESET);
     std::cout << std::format("  {}easy{}         - Search depth 2 (quick moves, good for beginners)\n", 
@@ -388,6 +473,8 @@ std::string_view error_to_string(ParseError error) {
             return "Search depth must be between 1 and 10"sv;
         case ParseError::InvalidTimeout:
             return "Timeout must be a positive number"sv;
+        case ParseError::InvalidTableSize:
+            return "Transposition table size must be between 1 and 4096 MB"sv;
         case ParseError::UnknownOption:
             return "Unknown option or missing argument"sv;
         case ParseError::MissingValue:
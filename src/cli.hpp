@@ -28,7 +28,7 @@ namespace gomoku::cli {
 struct PlayerConfig {
     std::string type;      // "human" or "computer"
     std::string name;      // Optional name for the player
-    std::string difficulty; // For computer players: "easy", "medium", "hard"
+    std::string difficulty; // For computer players: "easy", "medium", "hard" or "mcts"
     
     PlayerConfig() = default;
     PlayerConfig(std::string_view t) : type(t) {}
@@ -45,8 +45,14 @@ struct Config {
     int max_depth = 4;           // AI search depth (default intermediate)
     int move_timeout = 0;        // Move timeout in seconds (0 = no timeout)
     int thread_count = std::max(1u, std::thread::hardware_concurrency() - 1);  // Number of threads for parallel AI
+    int tt_size_mb = 32;         // Shared transposition table size in megabytes
+    std::string search_mode = "lazy"; // Parallel search: "lazy" (Lazy SMP) or "root" (root split)
+    std::string book_path;       // Opening book built by gomoku-book (empty = none)
+    std::string analyze_path;    // Game logs to analyze instead of playing, a directory or glob (empty = play)
     bool show_help = false;      // Whether to show help and exit
     bool enable_undo = false;    // Whether to enable undo feature
+    bool plain_search = false;   // Plain alpha-beta instead of PVS, to compare the two
+    bool ponder = false;         // Search the predicted reply while the human thinks
     bool skip_welcome = false;   // Whether to skip the welcome screen
     
     // New player configuration
@@ -69,6 +75,7 @@ enum class ParseError {
     InvalidBoardSize,
     InvalidDepth,
     InvalidTimeout,
+    InvalidTableSize,
     UnknownOption,
     MissingValue
 };
@@ -113,19 +120,25 @@ typedef struct {
     int max_depth;
     int move_timeout;
     int thread_count;             // Number of threads for parallel AI (0 = auto)
+    int tt_size_mb;               // Transposition table size in MB (0 = keep current)
+    char search_mode[16];         // "lazy" or "root" (empty = lazy)
+    char book_path[256];          // Opening book file (empty = none)
+    char analyze_path[256];       // Game logs to analyze, a directory or glob (empty = play)
     int show_help;
     int invalid_args;
     int enable_undo;
     int skip_welcome;
+    int plain_search;             // Plain alpha-beta instead of PVS (0 = PVS)
+    int ponder;                   // Search on the human's time (0 = off)
     
     // Player configurations (extended for new functionality)
     char player1_type[16];        // "human" or "computer"
     char player1_name[64];        // Player 1 name
-    char player1_difficulty[16];  // For computer: "easy", "medium", "hard"
+    char player1_difficulty[16];  // For computer: "easy", "medium", "hard" or "mcts"
     
     char player2_type[16];        // "human" or "computer" 
     char player2_name[64];        // Player 2 name
-    char player2_difficulty[16];  // For computer: "easy", "medium", "hard"
+    char player2_difficulty[16];  // For computer: "easy", "medium", "hard" or "mcts"
 } cli_config_t;
 
 extern "C" {
@@ -0,0 +1,117 @@
+//
+//  flat_board.hpp
+//  gomoku - Contiguous byte board with a sentinel border
+//
+//  One 529-byte array replaces the row-per-malloc int** board of the game state
+//
+
+#pragma once
+
+#include "bitboard.hpp"
+#include <array>
+#include <cstdint>
+
+namespace gomoku {
+
+//===============================================================================
+// FLAT BOARD CLASS
+//===============================================================================
+
+/**
+ * Game board stored as one contiguous array of signed bytes holding Player
+ * values, framed by a WALL border as wide as the candidate radius. A walk
+ * along any direction stops at the wall because it never equals a player,
+ * and a scan of the 5x5 neighbourhood of any cell stays inside the array, so
+ * neither needs bounds checks.
+ *
+ * The stride is fixed for the largest board; smaller boards simply place
+ * their wall closer. board[x] returns a pointer to the first playable cell
+ * of row x, so board[x][y] reads like the old int** board, and indices in
+ * [-PADDING, size + PADDING) on either axis are valid.
+ */
+class FlatBoard {
+public:
+    using Cell = int8_t;
+
+    static constexpr int PADDING = 2;
+    static constexpr int STRIDE = MAX_BOARD_SIZE + 2 * PADDING;
+    static constexpr Cell WALL = 2;
+
+    constexpr FlatBoard() noexcept = default;
+    constexpr explicit FlatBoard(int board_size) noexcept { reset(board_size); }
+
+    /**
+     * Empties the playable area and rebuilds the wall for board_size.
+     */
+    constexpr void reset(int board_size) noexcept {
+        size_ = board_size;
+        cells_.fill(WALL);
+        for (int x = 0; x < board_size; ++x) {
+            for (int y = 0; y < board_size; ++y) {
+                (*this)[x][y] = static_cast<Cell>(Player::Empty);
+            }
+        }
+    }
+
+    /**
+     * Loads a legacy int** board (AI_CELL_* values).
+     */
+    void load(int** board, int board_size) noexcept {
+        reset(board_size);
+        for (int x = 0; x < board_size; ++x) {
+            for (int y = 0; y < board_size; ++y) {
+                (*this)[x][y] = static_cast<Cell>(board[x][y]);
+            }
+        }
+    }
+
+    /**
+     * Rebuilds the board from the stones of a bitboard.
+     */
+    constexpr void load(const BitBoard& bitboard) noexcept {
+        reset(bitboard.size());
+        for (Player player : {Player::Cross, Player::Naught}) {
+            bitboard.for_each_stone(player, [&](int x, int y) {
+                (*this)[x][y] = static_cast<Cell>(player);
+            });
+        }
+    }
+
+    [[nodiscard]] constexpr int size() const noexcept { return size_; }
+
+    [[nodiscard]] constexpr Cell* operator[](int x) noexcept {
+        return cells_.data() + (x + PADDING) * STRIDE + PADDING;
+    }
+
+    [[nodiscard]] constexpr const Cell* operator[](int x) const noexcept {
+        return cells_.data() + (x + PADDING) * STRIDE + PADDING;
+    }
+
+    [[nodiscard]] constexpr bool in_bounds(int x, int y) const noexcept {
+        return x >= 0 && x < size_ && y >= 0 && y < size_;
+    }
+
+    /**
+     * Whether (x, y) is on the board and empty.
+     */
+    [[nodiscard]] constexpr bool is_playable(int x, int y) const noexcept {
+        return in_bounds(x, y) && (*this)[x][y] == static_cast<Cell>(Player::Empty);
+    }
+
+    /**
+     * Offset between neighbouring cells along DIRECTIONS-style (dx, dy).
+     */
+    [[nodiscard]] static constexpr int step(int dx, int dy) noexcept {
+        return dx * STRIDE + dy;
+    }
+
+    constexpr bool operator==(const FlatBoard& other) const noexcept = default;
+
+private:
+    int size_ = DEFAULT_BOARD_SIZE;
+    std::array<Cell, STRIDE * STRIDE> cells_{};
+};
+
+static_assert(sizeof(FlatBoard) <= 9 * 64, "a flat board should stay within nine cache lines");
+
+} // namespace gomoku
@@ -9,29 +9,36 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <cassert>
+#include <algorithm>
 #include "game.h"
 #include "ai.h"
 #include "gomoku.hpp"
+#include "zobrist.hpp"
 
 //===============================================================================
 // GAME INITIALIZATION AND CLEANUP
 //===============================================================================
 
 game_state_t *init_game(cli_config_t config) {
-    game_state_t *game = static_cast<game_state_t*>(std::malloc(sizeof(game_state_t)));
+    game_state_t *game = new (std::nothrow) game_state_t();
     if (!game) {
         return NULL;
     }
 
-    // Initialize board
-    game->board = create_board(config.board_size);
-    if (!game->board) {
-        free(game);
-        return NULL;
-    }
+    reset_game(game, config);
+    return game;
+}
+
+// Search ids start at 1, so no game owns a scratch with owner 0
+static std::atomic<uint64_t> next_search_id{1};
 
+void reset_game(game_state_t *game, cli_config_t config) {
     // Initialize game parameters
+    game->board.reset(config.board_size);
     game->board_size = config.board_size;
+    game->bitboard.reset(config.board_size);
+    game->threats.reset(config.board_size);
     game->cursor_x = config.board_size / 2;
     game->cursor_y = config.board_size / 2;
     game->current_player = static_cast<int>(gomoku::Player::Cross); // Human plays first
@@ -41,6 +48,7 @@ game_state_t *init_game(cli_config_t config) {
     game->config = config;
 
     // Initialize history
+    game->move_history.clear();
     game->move_history_count = 0;
     game->ai_history_count = 0;
     memset(game->ai_status_message, 0, sizeof(game->ai_status_message));
@@ -55,26 +63,38 @@ game_state_t *init_game(cli_config_t config) {
     game->move_start_time = 0.0;
     game->search_start_time = 0.0;
     game->search_timed_out = 0;
+    game->search_timeout_ms = 0;
+    game->abort_search = NULL;
+    game->quiet_search = 0;
+    game->on_search_depth = NULL;
+    game->search_depth_context = NULL;
+    game->search_depth_reached = 0;
+    game->search_nodes = 0;
+    game->search_tt_probes = 0;
+    game->search_tt_hits = 0;
+    game->search_moves_evaluated = 0;
+    game->null_move_count = 0;
 
     // Initialize optimization caches
     init_optimization_caches(game);
+    game->use_principal_variation = !config.plain_search;
+    game->search_algorithm = gomoku::SearchAlgorithm::AlphaBeta;
 
     // Initialize transposition table
     init_transposition_table(game);
+    game->opening_book = &gomoku::shared_opening_book();
 
-    // Initialize killer moves
-    init_killer_moves(game);
-
-    return game;
+    // Heuristics learned in an earlier game are not carried into this one
+    game->scratch = NULL;
+    game->search_id = next_search_id.fetch_add(1, std::memory_order_relaxed);
 }
 
 void cleanup_game(game_state_t *game) {
-    if (game) {
-        if (game->board) {
-            free_board(game->board, game->board_size);
-        }
-        free(game);
-    }
+    delete game;
+}
+
+size_t game_state_bytes(const game_state_t *game) {
+    return sizeof(game_state_t) + game->move_history.capacity() * sizeof(move_history_t);
 }
 
 //===============================================================================
@@ -82,28 +102,20 @@ void cleanup_game(game_state_t *game) {
 //===============================================================================
 
 void check_game_state(game_state_t *game) {
-    if (has_winner(game->board, game->board_size, static_cast<int>(gomoku::Player::Cross))) {
+    if (game->bitboard.has_five(gomoku::Player::Cross)) {
         game->game_state = static_cast<int>(gomoku::GameState::HumanWin);
-    } else if (has_winner(game->board, game->board_size, static_cast<int>(gomoku::Player::Naught))) {
+    } else if (game->bitboard.has_five(gomoku::Player::Naught)) {
         game->game_state = static_cast<int>(gomoku::GameState::AIWin);
     } else {
         // Check for draw (board full)
-        int empty_cells = 0;
-        for (int i = 0; i < game->board_size; i++) {
-            for (int j = 0; j < game->board_size; j++) {
-                if (game->board[i][j] == static_cast<int>(gomoku::Player::Empty)) {
-                    empty_cells++;
-                }
-            }
-        }
-        if (empty_cells == 0) {
+        if (game->bitboard.stone_count() == game->board_size * game->board_size) {
             game->game_state = static_cast<int>(gomoku::GameState::Draw);
         }
     }
 }
 
 int make_move(game_state_t *game, int x, int y, int player, double time_taken, int positions_evaluated) {
-    if (!is_valid_move(game->board, x, y, game->board_size)) {
+    if (!game->board.is_playable(x, y)) {
         return 0;
     }
 
@@ -111,10 +123,7 @@ int make_move(game_state_t *game, int x, int y, int player, double time_taken, i
     add_move_to_history(game, x, y, player, time_taken, positions_evaluated);
 
     // Make the move
-    game->board[x][y] = player;
-
-    // Update optimization caches
-    update_interesting_moves(game, x, y);
+    place_stone(game, x, y, player);
 
     // Check for game end conditions
     check_game_state(game);
@@ -127,6 +136,78 @@ int make_move(game_state_t *game, int x, int y, int player, double time_taken, i
     return 1;
 }
 
+static inline int zobrist_player(int player) {
+    return (player == static_cast<int>(gomoku::Player::Cross)) ? 0 : 1;
+}
+
+static uint64_t zobrist_side_key(const game_state_t *game) {
+    return gomoku::dispatch_board_size(game->board_size, []<int Size>(std::integral_constant<int, Size>) {
+        return gomoku::ZOBRIST_KEYS<Size>.side;
+    });
+}
+
+// Toggles the stone at (x, y) in every orientation's hash and re-keys the
+// position on the smallest one. The side to move is orientation-independent,
+// so it is carried over from the old key and flipped once.
+template<int Size>
+static inline void toggle_stone_hash(game_state_t *game, int x, int y, int player) {
+    constexpr const gomoku::ZobristKeys<Size> &keys = gomoku::ZOBRIST_KEYS<Size>;
+    uint64_t side = game->current_hash ^ game->symmetry_hashes[game->hash_symmetry];
+
+    int canonical = 0;
+    for (int s = 0; s < gomoku::SYMMETRY_COUNT; s++) {
+        game->symmetry_hashes[s] ^= keys.stones[s][zobrist_player(player)][x * Size + y];
+        if (game->symmetry_hashes[s] < game->symmetry_hashes[canonical]) {
+            canonical = s;
+        }
+    }
+
+    game->hash_symmetry = canonical;
+    game->current_hash = game->symmetry_hashes[canonical] ^ side ^ keys.side;
+}
+
+void place_stone(game_state_t *game, int x, int y, int player) {
+    gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        place_stone<Size>(game, x, y, player);
+    });
+}
+
+void remove_stone(game_state_t *game, int x, int y) {
+    gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        remove_stone<Size>(game, x, y);
+    });
+}
+
+template<int Size> requires gomoku::ValidBoardSize<Size>
+void place_stone(game_state_t *game, int x, int y, int player) {
+    game->board[x][y] = player;
+    game->bitboard.place<Size>(x, y, static_cast<gomoku::Player>(player));
+    game->threats.update<Size>(game->bitboard, x, y);
+    game->candidates.place<Size>(x, y);
+    toggle_stone_hash<Size>(game, x, y, player);
+    invalidate_winner_cache(game);
+}
+
+template<int Size> requires gomoku::ValidBoardSize<Size>
+void remove_stone(game_state_t *game, int x, int y) {
+    int player = game->board[x][y];
+    if (player == static_cast<int>(gomoku::Player::Empty)) {
+        return;
+    }
+
+    game->board[x][y] = static_cast<int>(gomoku::Player::Empty);
+    game->bitboard.remove<Size>(x, y, static_cast<gomoku::Player>(player));
+    game->threats.update<Size>(game->bitboard, x, y);
+    game->candidates.remove<Size>(x, y);
+    toggle_stone_hash<Size>(game, x, y, player);
+    invalidate_winner_cache(game);
+}
+
+template void place_stone<15>(game_state_t *, int, int, int);
+template void place_stone<19>(game_state_t *, int, int, int);
+template void remove_stone<15>(game_state_t *, int, int);
+template void remove_stone<19>(game_state_t *, int, int);
+
 int can_undo(game_state_t *game) {
     // Need at least 2 moves to undo (human + AI)
     return game->config.enable_undo && game->move_history_count >= 2;
@@ -142,7 +223,7 @@ void undo_last_moves(game_state_t *game) {
         if (game->move_history_count > 0) {
             game->move_history_count--;
             move_history_t last_move = game->move_history[game->move_history_count];
-            game->board[last_move.x][last_move.y] = static_cast<int>(gomoku::Player::Empty);
+            remove_stone(game, last_move.x, last_move.y);
 
             // Subtract time from totals
             if (last_move.player == static_cast<int>(gomoku::Player::Cross)) {
@@ -192,6 +273,15 @@ double end_move_timer(game_state_t *game) {
 }
 
 int is_search_timed_out(game_state_t *game) {
+    if (game->abort_search && game->abort_search->load(std::memory_order_relaxed)) {
+        return 1; // Another search thread already finished this move
+    }
+
+    if (game->search_timeout_ms > 0) {
+        double elapsed_ms = (get_current_time() - game->search_start_time) * 1000.0;
+        return elapsed_ms >= game->search_timeout_ms;
+    }
+
     if (game->move_timeout <= 0) {
         return 0; // No timeout set
     }
@@ -206,6 +296,9 @@ int is_search_timed_out(game_state_t *game) {
 
 void add_move_to_history(game_state_t *game, int x, int y, int player, double time_taken, int positions_evaluated) {
     if (game->move_history_count < MAX_MOVE_HISTORY) {
+        if (static_cast<int>(game->move_history.size()) <= game->move_history_count) {
+            game->move_history.resize(game->move_history_count + 1);
+        }
         move_history_t *move = &game->move_history[game->move_history_count];
         move->x = x;
         move->y = y;
@@ -235,6 +328,7 @@ void add_ai_history_entry(game_state_t *game, int moves_evaluated) {
     snprintf(game->ai_history[game->ai_history_count], sizeof(game->ai_history[game->ai_history_count]),
             "%2d | %3d positions evaluated", game->ai_history_count + 1, moves_evaluated);
     game->ai_history_count++;
+    game->search_moves_evaluated = moves_evaluated;
 } 
 
 //===============================================================================
@@ -242,81 +336,17 @@ void add_ai_history_entry(game_state_t *game, int moves_evaluated) {
 //===============================================================================
 
 void init_optimization_caches(game_state_t *game) {
-    // Initialize interesting moves cache
-    game->interesting_move_count = 0;
-    game->stones_on_board = 0;
+    // Candidate moves follow every stone placed or removed from here on
+    game->candidates.reset(game->board_size);
     game->winner_cache_valid = 0;
     game->has_winner_cache[0] = 0;
     game->has_winner_cache[1] = 0;
 
-    // If board is empty, only center area is interesting
-    if (game->stones_on_board == 0) {
-        int center = game->board_size / 2;
-        int count = 0;
-        for (int i = center - 2; i <= center + 2; i++) {
-            for (int j = center - 2; j <= center + 2; j++) {
-                if (i >= 0 && i < game->board_size && j >= 0 && j < game->board_size) {
-                    game->interesting_moves[count].x = i;
-                    game->interesting_moves[count].y = j;
-                    game->interesting_moves[count].is_active = 1;
-                    count++;
-                }
-            }
-        }
-        game->interesting_move_count = count;
-    }
-
     // Initialize transposition table
     init_transposition_table(game);
 
-    // Initialize killer moves
-    init_killer_moves(game);
-
     // Initialize advanced optimizations from research papers
     init_threat_space_search(game);
-    init_aspiration_windows(game);
-}
-
-void update_interesting_moves(game_state_t *game, int x, int y) {
-    // Update stone count
-    game->stones_on_board++;
-
-    // Invalidate winner cache
-    invalidate_winner_cache(game);
-
-    // Add new interesting moves around the placed stone
-    const int radius = 2; // MAX_RADIUS
-
-    for (int i = std::max(0, x - radius); i <= std::min(game->board_size - 1, x + radius); i++) {
-        for (int j = std::max(0, y - radius); j <= std::min(game->board_size - 1, y + radius); j++) {
-            if (game->board[i][j] == static_cast<int>(gomoku::Player::Empty)) {
-                // Check if this position is already in the interesting moves
-                int found = 0;
-                for (int k = 0; k < game->interesting_move_count; k++) {
-                    if (game->interesting_moves[k].x == i && game->interesting_moves[k].y == j && 
-                            game->interesting_moves[k].is_active) {
-                        found = 1;
-                        break;
-                    }
-                }
-
-                if (!found && game->interesting_move_count < 361) {
-                    game->interesting_moves[game->interesting_move_count].x = i;
-                    game->interesting_moves[game->interesting_move_count].y = j;
-                    game->interesting_moves[game->interesting_move_count].is_active = 1;
-                    game->interesting_move_count++;
-                }
-            }
-        }
-    }
-
-    // Remove the move that was just played from interesting moves
-    for (int k = 0; k < game->interesting_move_count; k++) {
-        if (game->interesting_moves[k].x == x && game->interesting_moves[k].y == y) {
-            game->interesting_moves[k].is_active = 0;
-            break;
-        }
-    }
 }
 
 void invalidate_winner_cache(game_state_t *game) {
@@ -326,8 +356,8 @@ void invalidate_winner_cache(game_state_t *game) {
 int get_cached_winner(game_state_t *game, int player) {
     if (!game->winner_cache_valid) {
         // Compute winner status for both players
-        game->has_winner_cache[0] = has_winner(game->board, game->board_size, static_cast<int>(gomoku::Player::Cross));
-        game->has_winner_cache[1] = has_winner(game->board, game->board_size, static_cast<int>(gomoku::Player::Naught));
+        game->has_winner_cache[0] = game->bitboard.has_five(gomoku::Player::Cross);
+        game->has_winner_cache[1] = game->bitboard.has_five(gomoku::Player::Naught);
         game->winner_cache_valid = 1;
     }
 
@@ -343,65 +373,93 @@ int get_cached_winner(game_state_t *game, int player) {
 //===============================================================================
 
 void init_transposition_table(game_state_t *game) {
-    // Initialize transposition table
-    memset(game->transposition_table, 0, sizeof(game->transposition_table));
-
-    // Initialize Zobrist keys with random values
-    srand(12345); // Use fixed seed for reproducible results
-    for (int player = 0; player < 2; player++) {
-        for (int pos = 0; pos < 361; pos++) {
-            game->zobrist_keys[player][pos] = 
-                ((uint64_t)rand() << 32) | rand();
-        }
-    }
+    // Attach the shared table; entries are validated by key, so no clearing is needed
+    game->transposition_table = &gomoku::shared_transposition_table();
 
     // Compute initial hash
-    game->current_hash = compute_zobrist_hash(game);
+    refresh_zobrist_hash(game);
 }
 
-uint64_t compute_zobrist_hash(game_state_t *game) {
-    uint64_t hash = 0;
+// Hashes the stones in every orientation; returns the orientation with the smallest hash
+template<int Size>
+static int compute_symmetry_hashes(const game_state_t *game, uint64_t *hashes) {
+    constexpr const gomoku::ZobristKeys<Size> &keys = gomoku::ZOBRIST_KEYS<Size>;
+    for (int s = 0; s < gomoku::SYMMETRY_COUNT; s++) {
+        hashes[s] = 0;
+    }
 
-    for (int i = 0; i < game->board_size; i++) {
-        for (int j = 0; j < game->board_size; j++) {
+    for (int i = 0; i < Size; i++) {
+        for (int j = 0; j < Size; j++) {
             if (game->board[i][j] != static_cast<int>(gomoku::Player::Empty)) {
-                int player_index = (game->board[i][j] == static_cast<int>(gomoku::Player::Cross)) ? 0 : 1;
-                int pos = i * game->board_size + j;
-                hash ^= game->zobrist_keys[player_index][pos];
+                for (int s = 0; s < gomoku::SYMMETRY_COUNT; s++) {
+                    hashes[s] ^= keys.stones[s][zobrist_player(game->board[i][j])][i * Size + j];
+                }
             }
         }
     }
 
-    return hash;
+    int canonical = 0;
+    for (int s = 1; s < gomoku::SYMMETRY_COUNT; s++) {
+        if (hashes[s] < hashes[canonical]) {
+            canonical = s;
+        }
+    }
+    return canonical;
+}
+
+// Every stone and every pending null move hands the turn over once
+static uint64_t side_to_move_key(const game_state_t *game) {
+    return ((game->bitboard.stone_count() + game->null_move_count) & 1) ? zobrist_side_key(game) : 0;
 }
 
-void store_transposition(game_state_t *game, uint64_t hash, int value, int depth, int flag, int best_x, int best_y) {
-    int index = hash % TRANSPOSITION_TABLE_SIZE;
-    transposition_entry_t *entry = &game->transposition_table[index];
+static int compute_symmetry_hashes(const game_state_t *game, uint64_t *hashes) {
+    return gomoku::dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        return compute_symmetry_hashes<Size>(game, hashes);
+    });
+}
+
+uint64_t compute_zobrist_hash(game_state_t *game) {
+    uint64_t hashes[gomoku::SYMMETRY_COUNT];
+    int canonical = compute_symmetry_hashes(game, hashes);
+    return hashes[canonical] ^ side_to_move_key(game);
+}
+
+void refresh_zobrist_hash(game_state_t *game) {
+    game->hash_symmetry = compute_symmetry_hashes(game, game->symmetry_hashes);
+    game->current_hash = game->symmetry_hashes[game->hash_symmetry] ^ side_to_move_key(game);
+}
 
-    // Replace if this entry is deeper or empty
-    if (entry->hash == 0 || entry->depth <= depth) {
-        entry->hash = hash;
-        entry->value = value;
-        entry->depth = depth;
-        entry->flag = flag;
-        entry->best_move_x = best_x;
-        entry->best_move_y = best_y;
+void store_transposition(game_state_t *game, uint64_t hash, int value, int depth, int flag, int best_x, int best_y) {
+    if (game->transposition_table) {
+        if (best_x >= 0) {
+            gomoku::SymmetricCell cell = gomoku::transform_cell(game->hash_symmetry, best_x, best_y, game->board_size);
+            best_x = cell.x;
+            best_y = cell.y;
+        }
+        game->transposition_table->store(hash, value, depth, flag, best_x, best_y);
     }
 }
 
 int probe_transposition(game_state_t *game, uint64_t hash, int depth, int alpha, int beta, int *value) {
-    int index = hash % TRANSPOSITION_TABLE_SIZE;
-    transposition_entry_t *entry = &game->transposition_table[index];
+    gomoku::TranspositionTable::Entry entry;
+    if (!game->transposition_table) {
+        return 0;
+    }
 
-    if (entry->hash == hash && entry->depth >= depth) {
-        *value = entry->value;
+    game->search_tt_probes++;
+    if (!game->transposition_table->probe(hash, entry)) {
+        return 0;
+    }
+    game->search_tt_hits++;
+
+    if (entry.depth >= depth) {
+        *value = entry.value;
 
-        if (entry->flag == TT_EXACT) {
+        if (entry.flag == TT_EXACT) {
             return 1; // Exact value
-        } else if (entry->flag == TT_LOWER_BOUND && entry->value >= beta) {
+        } else if (entry.flag == TT_LOWER_BOUND && entry.value >= beta) {
             return 1; // Beta cutoff
-        } else if (entry->flag == TT_UPPER_BOUND && entry->value <= alpha) {
+        } else if (entry.flag == TT_UPPER_BOUND && entry.value <= alpha) {
             return 1; // Alpha cutoff
         }
     }
@@ -409,68 +467,167 @@ int probe_transposition(game_state_t *game, uint64_t hash, int depth, int alpha,
     return 0; // Not found or not usable
 }
 
+int probe_transposition_move(game_state_t *game, uint64_t hash, int *best_x, int *best_y) {
+    gomoku::TranspositionTable::Entry entry;
+
+    if (game->transposition_table && game->transposition_table->probe(hash, entry) && entry.best_x >= 0) {
+        gomoku::SymmetricCell cell = gomoku::transform_cell(gomoku::inverse_symmetry(game->hash_symmetry),
+                                                            entry.best_x, entry.best_y, game->board_size);
+        *best_x = cell.x;
+        *best_y = cell.y;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void reset_countermoves(search_scratch_t *scratch) {
+    for (auto &replies : scratch->countermoves) {
+        std::ranges::fill(replies, static_cast<int16_t>(-1));
+    }
+}
+
+void init_search_scratch(search_scratch_t *scratch) {
+    scratch->owner = 0;
+    for (int depth = 0; depth < MAX_SEARCH_DEPTH; depth++) {
+        for (int move_num = 0; move_num < MAX_KILLER_MOVES; move_num++) {
+            scratch->killer_moves[depth][move_num][0] = -1;
+            scratch->killer_moves[depth][move_num][1] = -1;
+        }
+        scratch->aspiration_windows[depth].alpha = -gomoku::WIN_SCORE - 1;
+        scratch->aspiration_windows[depth].beta = gomoku::WIN_SCORE + 1;
+        scratch->aspiration_windows[depth].depth = depth;
+    }
+    memset(scratch->history_scores, 0, sizeof(scratch->history_scores));
+    memset(scratch->butterfly_scores, 0, sizeof(scratch->butterfly_scores));
+    reset_countermoves(scratch);
+    scratch->threat_count = 0;
+}
+
 void init_killer_moves(game_state_t *game) {
     // Initialize killer moves table
     for (int depth = 0; depth < MAX_SEARCH_DEPTH; depth++) {
         for (int move_num = 0; move_num < MAX_KILLER_MOVES; move_num++) {
-            game->killer_moves[depth][move_num][0] = -1;
-            game->killer_moves[depth][move_num][1] = -1;
+            game->scratch->killer_moves[depth][move_num][0] = -1;
+            game->scratch->killer_moves[depth][move_num][1] = -1;
         }
     }
 }
 
-void store_killer_move(game_state_t *game, int depth, int x, int y) {
-    if (depth >= MAX_SEARCH_DEPTH) return;
+void store_killer_move(game_state_t *game, int ply, int x, int y) {
+    if (ply < 0 || ply >= MAX_SEARCH_DEPTH) return;
 
     // Don't store if already a killer move
-    if (is_killer_move(game, depth, x, y)) return;
+    if (is_killer_move(game, ply, x, y)) return;
 
     // Shift killer moves and insert new one at the front
     for (int i = MAX_KILLER_MOVES - 1; i > 0; i--) {
-        game->killer_moves[depth][i][0] = game->killer_moves[depth][i-1][0];
-        game->killer_moves[depth][i][1] = game->killer_moves[depth][i-1][1];
+        game->scratch->killer_moves[ply][i][0] = game->scratch->killer_moves[ply][i-1][0];
+        game->scratch->killer_moves[ply][i][1] = game->scratch->killer_moves[ply][i-1][1];
     }
 
-    game->killer_moves[depth][0][0] = x;
-    game->killer_moves[depth][0][1] = y;
+    game->scratch->killer_moves[ply][0][0] = x;
+    game->scratch->killer_moves[ply][0][1] = y;
 }
 
-int is_killer_move(game_state_t *game, int depth, int x, int y) {
-    if (depth >= MAX_SEARCH_DEPTH) return 0;
+int is_killer_move(game_state_t *game, int ply, int x, int y) {
+    if (ply < 0 || ply >= MAX_SEARCH_DEPTH) return 0;
 
     for (int i = 0; i < MAX_KILLER_MOVES; i++) {
-        if (game->killer_moves[depth][i][0] == x && 
-                game->killer_moves[depth][i][1] == y) {
+        if (game->scratch->killer_moves[ply][i][0] == x && 
+                game->scratch->killer_moves[ply][i][1] == y) {
             return 1;
         }
     }
     return 0;
 } 
 
+// Butterfly counts past this are halved together with the history count, keeping their ratio
+static constexpr int MAX_BUTTERFLY_SCORE = 1 << 24;
+
+// Added to the butterfly count when scoring, so a move searched once or twice
+// does not rank like one that has cut off reliably
+static constexpr int HISTORY_PRIOR = 64;
+
+static int player_index(int player) {
+    return (player == static_cast<int>(gomoku::Player::Cross)) ? 0 : 1;
+}
+
+void init_history_scores(game_state_t *game) {
+    memset(game->scratch->history_scores, 0, sizeof(game->scratch->history_scores));
+    memset(game->scratch->butterfly_scores, 0, sizeof(game->scratch->butterfly_scores));
+    reset_countermoves(game->scratch);
+}
+
+void store_history_move(game_state_t *game, int player, int depth, int x, int y) {
+    game->scratch->history_scores[player_index(player)][x * game->board_size + y] += depth * depth;
+}
+
+void store_butterfly_move(game_state_t *game, int player, int depth, int x, int y) {
+    int cell = x * game->board_size + y;
+    int &butterfly = game->scratch->butterfly_scores[player_index(player)][cell];
+    butterfly += depth * depth;
+    if (butterfly > MAX_BUTTERFLY_SCORE) {
+        butterfly /= 2;
+        game->scratch->history_scores[player_index(player)][cell] /= 2;
+    }
+}
+
+void age_history_scores(game_state_t *game) {
+    for (auto *table : {&game->scratch->history_scores, &game->scratch->butterfly_scores}) {
+        for (auto &scores : *table) {
+            for (int &score : scores) {
+                score /= 2;
+            }
+        }
+    }
+}
+
+void store_countermove(game_state_t *game, int player, int last_x, int last_y, int x, int y) {
+    if (last_x < 0) return;
+    game->scratch->countermoves[player_index(player)][last_x * game->board_size + last_y] =
+        static_cast<int16_t>(x * game->board_size + y);
+}
+
+int get_countermove(const game_state_t *game, int player, int last_x, int last_y, int *x, int *y) {
+    if (last_x < 0) return 0;
+
+    int cell = game->scratch->countermoves[player_index(player)][last_x * game->board_size + last_y];
+    if (cell < 0) return 0;
+
+    *x = cell / game->board_size;
+    *y = cell % game->board_size;
+    return 1;
+}
+
+int get_history_score(const game_state_t *game, int player, int x, int y) {
+    int cell = x * game->board_size + y;
+    int history = game->scratch->history_scores[player_index(player)][cell];
+    int butterfly = game->scratch->butterfly_scores[player_index(player)][cell];
+    return static_cast<int>(static_cast<int64_t>(history) * MAX_HISTORY_SCORE / (butterfly + HISTORY_PRIOR));
+}
+
 //===============================================================================
 // ADVANCED OPTIMIZATION FUNCTIONS (FROM RESEARCH PAPERS)
 //===============================================================================
 
 void init_threat_space_search(game_state_t *game) {
-    game->threat_count = 0;
+    game->use_threat_space_search = 1;
     game->use_aspiration_windows = 1;
     game->null_move_allowed = 1;
     game->null_move_count = 0;
-
-    // Initialize threat array
-    for (int i = 0; i < MAX_THREATS; i++) {
-        game->active_threats[i].is_active = 0;
-    }
 }
 
 void update_threat_analysis(game_state_t *game, int x, int y, int player) {
+    search_scratch_t *scratch = game->scratch;
+
     // Invalidate nearby threats
-    for (int i = 0; i < game->threat_count; i++) {
-        if (game->active_threats[i].is_active) {
-            int dx = abs(game->active_threats[i].x - x);
-            int dy = abs(game->active_threats[i].y - y);
+    for (int i = 0; i < scratch->threat_count; i++) {
+        if (scratch->active_threats[i].is_active) {
+            int dx = abs(scratch->active_threats[i].x - x);
+            int dy = abs(scratch->active_threats[i].y - y);
             if (dx <= 2 && dy <= 2) {
-                game->active_threats[i].is_active = 0;
+                scratch->active_threats[i].is_active = 0;
             }
         }
     }
@@ -481,15 +638,16 @@ void update_threat_analysis(game_state_t *game, int x, int y, int player) {
         for (int j = std::max(0, y - radius); j <= std::min(game->board_size - 1, y + radius); j++) {
             if (game->board[i][j] == static_cast<int>(gomoku::Player::Empty)) {
                 // Check if this position creates a threat
-                int threat_level = evaluate_threat_fast(game->board, i, j, player, game->board_size);
-                if (threat_level > 100 && game->threat_count < MAX_THREATS) {
-                    game->active_threats[game->threat_count].x = i;
-                    game->active_threats[game->threat_count].y = j;
-                    game->active_threats[game->threat_count].threat_type = threat_level;
-                    game->active_threats[game->threat_count].player = player;
-                    game->active_threats[game->threat_count].priority = threat_level;
-                    game->active_threats[game->threat_count].is_active = 1;
-                    game->threat_count++;
+                int threat_level = evaluate_threat_fast(game->bitboard, i, j, player);
+                if (threat_level > 100 && scratch->threat_count < MAX_THREATS) {
+                    threat_t *threat = &scratch->active_threats[scratch->threat_count];
+                    threat->x = i;
+                    threat->y = j;
+                    threat->threat_type = threat_level;
+                    threat->player = player;
+                    threat->priority = threat_level;
+                    threat->is_active = 1;
+                    scratch->threat_count++;
                 }
             }
         }
@@ -500,21 +658,21 @@ void update_threat_analysis(game_state_t *game, int x, int y, int player) {
 
 void init_aspiration_windows(game_state_t *game) {
     for (int depth = 0; depth < MAX_SEARCH_DEPTH; depth++) {
-        game->aspiration_windows[depth].alpha = -gomoku::WIN_SCORE;
-        game->aspiration_windows[depth].beta = gomoku::WIN_SCORE;
-        game->aspiration_windows[depth].depth = depth;
+        game->scratch->aspiration_windows[depth].alpha = -gomoku::WIN_SCORE - 1;
+        game->scratch->aspiration_windows[depth].beta = gomoku::WIN_SCORE + 1;
+        game->scratch->aspiration_windows[depth].depth = depth;
     }
 }
 
 int get_aspiration_window(game_state_t *game, int depth, int *alpha, int *beta) {
     if (!game->use_aspiration_windows || depth >= MAX_SEARCH_DEPTH) {
-        *alpha = -gomoku::WIN_SCORE;
-        *beta = gomoku::WIN_SCORE;
+        *alpha = -gomoku::WIN_SCORE - 1;
+        *beta = gomoku::WIN_SCORE + 1;
         return 0;
     }
 
-    *alpha = game->aspiration_windows[depth].alpha;
-    *beta = game->aspiration_windows[depth].beta;
+    *alpha = game->scratch->aspiration_windows[depth].alpha;
+    *beta = game->scratch->aspiration_windows[depth].beta;
     return 1;
 }
 
@@ -522,8 +680,8 @@ void update_aspiration_window(game_state_t *game, int depth, int value, int alph
     if (depth >= MAX_SEARCH_DEPTH) return;
 
     // Update the window for future searches at this depth
-    game->aspiration_windows[depth].alpha = std::max(alpha, value - ASPIRATION_WINDOW);
-    game->aspiration_windows[depth].beta = std::min(beta, value + ASPIRATION_WINDOW);
+    game->scratch->aspiration_windows[depth].alpha = std::max(alpha, value - ASPIRATION_WINDOW);
+    game->scratch->aspiration_windows[depth].beta = std::min(beta, value + ASPIRATION_WINDOW);
 }
 
 int should_try_null_move(game_state_t *game, int depth) {
@@ -535,7 +693,7 @@ int should_try_null_move(game_state_t *game, int depth) {
     return game->null_move_allowed && 
         game->null_move_count < 2 && 
         depth >= 3 && 
-        game->stones_on_board < (game->board_size * game->board_size) / 2;
+        game->bitboard.stone_count() < (game->board_size * game->board_size) / 2;
 }
 
 int try_null_move_pruning(game_state_t *game, int depth, int beta, int ai_player) {
@@ -546,12 +704,14 @@ int try_null_move_pruning(game_state_t *game, int depth, int beta, int ai_player
     // Temporarily disable null moves to avoid infinite recursion
     game->null_move_allowed = 0;
     game->null_move_count++;
+    game->current_hash ^= zobrist_side_key(game); // Pass the turn
 
     // Search with reduced depth
-    int null_score = -minimax_with_timeout(game, game->board, depth - NULL_MOVE_REDUCTION - 1, 
+    int null_score = -minimax_with_timeout(game, depth - NULL_MOVE_REDUCTION - 1, 
             -(beta + 1), -beta, 0, ai_player, -1, -1);
 
     // Restore null move settings
+    game->current_hash ^= zobrist_side_key(game);
     game->null_move_allowed = 1;
     game->null_move_count--;
 
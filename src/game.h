@@ -9,7 +9,16 @@
 #define GAME_H
 
 #include <stdint.h>
+#include <atomic>
+#include <vector>
 #include "gomoku.hpp"
+#include "bitboard.hpp"
+#include "flat_board.hpp"
+#include "threat_cache.hpp"
+#include "candidate_set.hpp"
+#include "transposition_table.hpp"
+#include "opening_book.hpp"
+#include "board_symmetry.hpp"
 #include "cli.hpp"
 
 // move_t is defined in ai.h
@@ -21,6 +30,9 @@
 #define MAX_MOVE_HISTORY 400
 #define MAX_AI_HISTORY 20
 
+// Cells of the largest board, the size of the per-cell heuristic tables
+inline constexpr int MAX_CELLS = gomoku::MAX_BOARD_SIZE * gomoku::MAX_BOARD_SIZE;
+
 //===============================================================================
 // GAME STATE STRUCTURES
 //===============================================================================
@@ -35,31 +47,11 @@ typedef struct {
     int positions_evaluated; // For AI moves, number of positions evaluated
 } move_history_t;
 
-/**
- * Structure to represent interesting moves for AI search optimization
- */
-typedef struct {
-    int x, y;
-    int is_active;         // Whether this move is still interesting
-} interesting_move_t;
-
-/**
- * Transposition table entry for caching evaluated positions
- */
-typedef struct {
-    uint64_t hash;         // Position hash
-    int value;             // Evaluated value
-    int depth;             // Search depth
-    int flag;              // Exact, lower bound, or upper bound
-    int best_move_x;       // Best move coordinates
-    int best_move_y;
-} transposition_entry_t;
-
-#define TRANSPOSITION_TABLE_SIZE 100000
 #define TT_EXACT 0
 #define TT_LOWER_BOUND 1
 #define TT_UPPER_BOUND 2
 #define MAX_KILLER_MOVES 2
+#define MAX_HISTORY_SCORE 4096
 #define MAX_SEARCH_DEPTH 10
 #define MAX_THREATS 100
 #define ASPIRATION_WINDOW 50
@@ -85,23 +77,67 @@ typedef struct {
     int depth;             // Depth at which window was set
 } aspiration_window_t;
 
+/**
+ * One completed iteration of iterative deepening, as passed to on_search_depth
+ */
+typedef struct {
+    int depth;                              // Depth just completed
+    int score;                              // Score of the best move, from the AI's side
+    int best_x, best_y;                     // Best move at this depth
+    int pv_length;                          // Moves in pv, best_x/best_y first
+    int pv[MAX_SEARCH_DEPTH][2];            // Expected line of play, as far as the table holds it
+    uint64_t nodes;                         // Positions visited so far
+    double elapsed;                         // Seconds since the search started
+} search_depth_t;
+
+/**
+ * Search heuristics and working lists, needed only while a search runs. A
+ * game borrows one from the process-wide gomoku::SearchScratchPool for the
+ * duration of a search instead of carrying its own, and usually gets the
+ * one it used last back, so the heuristics still carry over between moves.
+ */
+typedef struct {
+    uint64_t owner;                           // search_id of the game the heuristics were learned in, 0 for none
+
+    // Killer moves heuristic, kept per ply from the search root
+    int killer_moves[MAX_SEARCH_DEPTH][MAX_KILLER_MOVES][2]; // [ply][move_num][x,y]
+
+    // History heuristic: how often each move caused a cutoff, weighted by depth
+    int history_scores[2][MAX_CELLS];         // [player][x * board_size + y]
+    // Butterfly board: how often each move was searched at all, weighted the same way
+    int butterfly_scores[2][MAX_CELLS];       // [player][x * board_size + y]
+    // Countermove heuristic: the reply that last refuted each move
+    int16_t countermoves[2][MAX_CELLS];       // [player][previous move cell] = reply cell, or -1
+
+    // Threat-space search (from research papers)
+    threat_t active_threats[MAX_THREATS];     // Currently active threats
+    int threat_count;                         // Number of active threats
+
+    // Aspiration windows for enhanced pruning
+    aspiration_window_t aspiration_windows[MAX_SEARCH_DEPTH];
+} search_scratch_t;
+
 // move_t is defined in ai.h
 
 /**
- * Structure to represent the current game state
+ * Structure to represent the current game state. It holds what a game needs
+ * between moves; the transposition table and Zobrist keys are shared, and
+ * search heuristics live in a search_scratch_t attached only while searching.
  */
 typedef struct {
     cli_config_t config;   // Configuration
-    int **board;           // The game board
+    gomoku::FlatBoard board; // The game board, framed by a sentinel wall
     int board_size;        // Size of the board
+    gomoku::BitBoard bitboard; // Packed mirror of board, mutated in place by the search
+    gomoku::ThreatCache threats; // Per-stone threats of bitboard, kept current by place_stone()/remove_stone()
     int cursor_x, cursor_y; // Current cursor position
     int current_player;    // Current player (AI_CELL_CROSSES or AI_CELL_NAUGHTS)
     int game_state;        // Current game state (GAME_RUNNING, etc.)
     int max_depth;         // AI search depth
     int move_timeout;      // Move timeout in seconds (0 = no timeout)
 
-    // Move history
-    move_history_t move_history[MAX_MOVE_HISTORY];
+    // Move history, grown as moves are made (at most MAX_MOVE_HISTORY)
+    std::vector<move_history_t> move_history;
     int move_history_count;
 
     // AI history
@@ -120,29 +156,39 @@ typedef struct {
     // Timeout tracking
     double search_start_time;
     int search_timed_out;
+    int search_timeout_ms;                     // Millisecond budget of one search, used instead of move_timeout when > 0
+    std::atomic<bool> *abort_search;           // Raised by another thread to stop this search early
+    int quiet_search;                          // Print no progress, as when pondering on the opponent's time
+    int search_depth_reached;                  // Deepest iteration the last search completed
+    uint64_t search_nodes;                     // Positions the last search visited
+    uint64_t search_tt_probes;                 // Transposition table lookups of the last search
+    uint64_t search_tt_hits;                   // Lookups that found an entry for their position
+    int search_moves_evaluated;                // Root moves the last search reported in its history entry
+    void (*on_search_depth)(void *context, const search_depth_t *report); // Called, if set, as each depth completes
+    void *search_depth_context;                // Passed back to on_search_depth
 
     // Optimization caches
-    interesting_move_t interesting_moves[361]; // Max for 19x19 board
-    int interesting_move_count;
-    int stones_on_board;                       // Cached stone count
+    gomoku::CandidateSet candidates;           // Empty cells near a stone, kept current by place_stone()/remove_stone()
     int has_winner_cache[2];                   // Cache for winner detection [player1, player2]
     int winner_cache_valid;                    // Whether winner cache is valid
 
-    // Transposition table
-    transposition_entry_t transposition_table[TRANSPOSITION_TABLE_SIZE];
-    uint64_t zobrist_keys[2][361];            // Zobrist keys for hashing
-    uint64_t current_hash;                     // Current position hash
+    // Transposition table (shared between games and search threads, not owned)
+    gomoku::TranspositionTable *transposition_table;
+    uint64_t current_hash;                     // Canonical position key, maintained incrementally
+    uint64_t symmetry_hashes[gomoku::SYMMETRY_COUNT]; // Stone hash of the board in each of its orientations
+    int hash_symmetry;                         // Orientation with the smallest stone hash, which current_hash is keyed on
 
-    // Killer moves heuristic
-    int killer_moves[MAX_SEARCH_DEPTH][MAX_KILLER_MOVES][2]; // [depth][move_num][x,y]
+    // Opening book probed before searching (shared, not owned)
+    const gomoku::OpeningBook *opening_book;
 
-    // Threat-space search (from research papers)
-    threat_t active_threats[MAX_THREATS];     // Currently active threats
-    int threat_count;                         // Number of active threats
+    // Search heuristics, attached by gomoku::ScratchLease while searching (not owned)
+    search_scratch_t *scratch;
+    uint64_t search_id;                       // Identifies this game's heuristics in the scratch pool; new on every reset
 
-    // Aspiration windows for enhanced pruning
-    aspiration_window_t aspiration_windows[MAX_SEARCH_DEPTH];
+    int use_threat_space_search;              // Whether to look for forced VCF/VCT wins before and below the search
     int use_aspiration_windows;               // Whether to use aspiration windows
+    int use_principal_variation;              // PVS with aspiration windows and late move reductions, else plain alpha-beta
+    gomoku::SearchAlgorithm search_algorithm; // Alpha-beta or Monte Carlo tree search, as run_search() dispatches
 
     // Null-move pruning
     int null_move_allowed;                    // Whether null moves are allowed
@@ -163,6 +209,15 @@ typedef struct {
  */
 game_state_t* init_game(cli_config_t config);
 
+/**
+ * Reinitializes an allocated game state for a new game, as init_game()
+ * would, so callers evaluating many positions can reuse one allocation.
+ *
+ * @param game The game state to reset
+ * @param config Configuration of the new game
+ */
+void reset_game(game_state_t *game, cli_config_t config);
+
 /**
  * Cleans up and frees game state resources.
  * 
@@ -170,6 +225,15 @@ game_state_t* init_game(cli_config_t config);
  */
 void cleanup_game(game_state_t *game);
 
+/**
+ * Returns the memory a game state holds: the struct itself plus its move
+ * history. Shared tables and search scratch are not counted.
+ *
+ * @param game The game state
+ * @return Size in bytes
+ */
+size_t game_state_bytes(const game_state_t *game);
+
 //===============================================================================
 // GAME LOGIC FUNCTIONS
 //===============================================================================
@@ -194,6 +258,39 @@ void check_game_state(game_state_t *game);
  */
 int make_move(game_state_t *game, int x, int y, int player, double time_taken, int positions_evaluated);
 
+/**
+ * Places a stone on the board and its bitboard mirror without touching history,
+ * and updates the incremental hash (stone key and side-to-move key) and the
+ * threat cache along the four lines through the stone.
+ * Used by make_move() and by the search for make/unmake.
+ *
+ * @param game The game state
+ * @param x Row coordinate
+ * @param y Column coordinate
+ * @param player The player owning the stone
+ */
+void place_stone(game_state_t *game, int x, int y, int player);
+
+/**
+ * Removes a stone from the board and its bitboard mirror, reversing the hash
+ * and threat cache updates done by place_stone().
+ *
+ * @param game The game state
+ * @param x Row coordinate
+ * @param y Column coordinate
+ */
+void remove_stone(game_state_t *game, int x, int y);
+
+/**
+ * place_stone() and remove_stone() for a board size known at compile time,
+ * used by the search once it has dispatched on game->board_size.
+ */
+template<int Size> requires gomoku::ValidBoardSize<Size>
+void place_stone(game_state_t *game, int x, int y, int player);
+
+template<int Size> requires gomoku::ValidBoardSize<Size>
+void remove_stone(game_state_t *game, int x, int y);
+
 /**
  * Checks if undo is possible (need at least 2 moves).
  * 
@@ -220,15 +317,6 @@ void undo_last_moves(game_state_t *game);
  */
 void init_optimization_caches(game_state_t *game);
 
-/**
- * Updates the interesting moves cache after a move is made.
- * 
- * @param game The game state
- * @param x X coordinate of the move
- * @param y Y coordinate of the move
- */
-void update_interesting_moves(game_state_t *game, int x, int y);
-
 /**
  * Invalidates the winner cache when a move is made.
  * 
@@ -246,26 +334,48 @@ void invalidate_winner_cache(game_state_t *game);
 int get_cached_winner(game_state_t *game, int player);
 
 /**
- * Initializes the transposition table and Zobrist keys.
+ * Attaches the game to the process-wide transposition table and hashes
+ * the position with the compile-time keys of zobrist.hpp. The table itself
+ * is not cleared, so results carry over between games and concurrent
+ * searches.
  * 
  * @param game The game state
  */
 void init_transposition_table(game_state_t *game);
 
 /**
- * Computes the Zobrist hash for the current position.
+ * Computes the Zobrist hash for the current position from scratch.
+ * The search relies on current_hash instead; this full rescan is the
+ * reference used to verify it in debug builds.
+ *
+ * The hash is canonical: the board is hashed in all eight orientations and
+ * the smallest stone hash, combined with the side to move, is the key. A
+ * position and its rotations and reflections therefore share one key.
  * 
  * @param game The game state
  * @return The hash value
  */
 uint64_t compute_zobrist_hash(game_state_t *game);
 
+/**
+ * Recomputes current_hash, symmetry_hashes and hash_symmetry from the board,
+ * for states whose stones were set without place_stone().
+ * 
+ * @param game The game state
+ */
+void refresh_zobrist_hash(game_state_t *game);
+
 /**
  * Stores a position evaluation in the transposition table.
+ * Does nothing when the game has no table attached. The best move is
+ * stored in the canonical orientation, so hash must be the key of the
+ * game's current position. The key does not say which side the search
+ * plays, so value and flag are from the side to move's point of view;
+ * every game and every colour can then share one table.
  * 
  * @param game The game state
  * @param hash Position hash
- * @param value Evaluated value
+ * @param value Evaluated value, for the side to move
  * @param depth Search depth
  * @param flag Type of bound (exact, lower, upper)
  * @param best_x Best move x coordinate
@@ -274,7 +384,8 @@ uint64_t compute_zobrist_hash(game_state_t *game);
 void store_transposition(game_state_t *game, uint64_t hash, int value, int depth, int flag, int best_x, int best_y);
 
 /**
- * Probes the transposition table for a cached evaluation.
+ * Probes the transposition table for a cached evaluation. The window and
+ * the value are from the side to move's point of view, as they are stored.
  * 
  * @param game The game state
  * @param hash Position hash
@@ -287,35 +398,133 @@ void store_transposition(game_state_t *game, uint64_t hash, int value, int depth
 int probe_transposition(game_state_t *game, uint64_t hash, int depth, int alpha, int beta, int *value);
 
 /**
- * Initializes the killer moves table.
+ * Looks up the best move stored for a position, whatever its depth or bound,
+ * mapped back from the canonical orientation to the game's board. hash must
+ * be the key of the game's current position.
+ * 
+ * @param game The game state
+ * @param hash Position hash
+ * @param best_x Pointer to store the move x coordinate
+ * @param best_y Pointer to store the move y coordinate
+ * @return 1 if the table has a move for the position, 0 otherwise
+ */
+int probe_transposition_move(game_state_t *game, uint64_t hash, int *best_x, int *best_y);
+
+/**
+ * Clears every heuristic in a scratch and marks it as owned by nobody.
+ *
+ * @param scratch The scratch to clear
+ */
+void init_search_scratch(search_scratch_t *scratch);
+
+/**
+ * Initializes the killer moves table. This and the other killer, history,
+ * countermove, threat and aspiration functions below work on the scratch
+ * attached to the game, so they may only be called while one is.
  * 
  * @param game The game state
  */
 void init_killer_moves(game_state_t *game);
 
 /**
- * Stores a killer move at the given depth.
+ * Stores a killer move at the given ply.
  * 
  * @param game The game state
- * @param depth Search depth
+ * @param ply Plies from the search root; plies past MAX_SEARCH_DEPTH keep no killers
  * @param x Move x coordinate
  * @param y Move y coordinate
  */
-void store_killer_move(game_state_t *game, int depth, int x, int y);
+void store_killer_move(game_state_t *game, int ply, int x, int y);
 
 /**
- * Checks if a move is a killer move at the given depth.
+ * Checks if a move is a killer move at the given ply.
  * 
  * @param game The game state
- * @param depth Search depth
+ * @param ply Plies from the search root
  * @param x Move x coordinate
  * @param y Move y coordinate
  * @return 1 if killer move, 0 otherwise
  */
-int is_killer_move(game_state_t *game, int depth, int x, int y);
+int is_killer_move(game_state_t *game, int ply, int x, int y);
+
+/**
+ * Clears the history, butterfly and countermove tables.
+ * 
+ * @param game The game state
+ */
+void init_history_scores(game_state_t *game);
+
+/**
+ * Credits a move that caused a cutoff with depth * depth.
+ * 
+ * @param game The game state
+ * @param player The player who made the move
+ * @param depth Remaining search depth at the cutoff
+ * @param x Move x coordinate
+ * @param y Move y coordinate
+ */
+void store_history_move(game_state_t *game, int player, int depth, int x, int y);
+
+/**
+ * Counts a searched move on the butterfly board with depth * depth, whether
+ * or not it caused a cutoff.
+ * 
+ * @param game The game state
+ * @param player The player who made the move
+ * @param depth Remaining search depth of the node
+ * @param x Move x coordinate
+ * @param y Move y coordinate
+ */
+void store_butterfly_move(game_state_t *game, int player, int depth, int x, int y);
+
+/**
+ * Halves every history and butterfly score, so that a new search favours
+ * what it learns itself over what earlier searches found.
+ * 
+ * @param game The game state
+ */
+void age_history_scores(game_state_t *game);
+
+/**
+ * Remembers x, y as the reply that refuted the move at last_x, last_y.
+ * 
+ * @param game The game state
+ * @param player The player who made the reply
+ * @param last_x Previous move x coordinate, or -1 for none
+ * @param last_y Previous move y coordinate
+ * @param x Reply x coordinate
+ * @param y Reply y coordinate
+ */
+void store_countermove(game_state_t *game, int player, int last_x, int last_y, int x, int y);
+
+/**
+ * Gets the reply that last refuted the move at last_x, last_y.
+ * 
+ * @param game The game state
+ * @param player The player to reply
+ * @param last_x Previous move x coordinate, or -1 for none
+ * @param last_y Previous move y coordinate
+ * @param x Pointer to store the reply x coordinate
+ * @param y Pointer to store the reply y coordinate
+ * @return 1 if a countermove is known, 0 otherwise
+ */
+int get_countermove(const game_state_t *game, int player, int last_x, int last_y, int *x, int *y);
+
+/**
+ * Gets the history score of a move: the depth-weighted share of its searches
+ * that caused a cutoff, scaled to 0 .. MAX_HISTORY_SCORE.
+ * 
+ * @param game The game state
+ * @param player The player making the move
+ * @param x Move x coordinate
+ * @param y Move y coordinate
+ * @return Relative history score
+ */
+int get_history_score(const game_state_t *game, int player, int x, int y);
 
 /**
- * Initializes the threat-space search system.
+ * Enables threat-space search, aspiration windows and null moves on the
+ * game. Unlike the functions around it, it needs no scratch.
  * 
  * @param game The game state
  */
@@ -409,7 +618,8 @@ void start_move_timer(game_state_t *game);
 double end_move_timer(game_state_t *game);
 
 /**
- * Checks if the search has timed out.
+ * Checks if the search has timed out: another thread raised abort_search,
+ * or the elapsed time exceeds search_timeout_ms, or move_timeout without one.
  * 
  * @param game The game state
  * @return 1 if timed out, 0 otherwise
@@ -0,0 +1,302 @@
+//
+//  game_analysis.cpp
+//  gomoku - Bulk analysis of archived game logs
+//
+//  Replays each log on a reused game state and scores the best and the played move of every position
+//
+
+#include "game_analysis.hpp"
+#include "ai.h"
+#include "ai_parallel.hpp"
+#include "search_handle.hpp"
+#include "search_scratch.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <thread>
+#include <glob.h>
+
+namespace gomoku {
+
+namespace {
+
+using json = nlohmann::json;
+using ordered_json = nlohmann::ordered_json;
+using GamePtr = std::unique_ptr<game_state_t, void(*)(game_state_t*)>;
+
+// Scores at least this far from zero are forced wins or losses
+constexpr int DECIDED_SCORE = WIN_SCORE - 1000;
+
+} // namespace
+
+//===============================================================================
+// GAME LOGS
+//===============================================================================
+
+std::expected<GameLog, std::string> load_game_log(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected("Cannot open the file");
+    }
+    json document = json::parse(file, nullptr, false);
+    if (document.is_discarded()) {
+        return std::unexpected("Not a valid JSON document");
+    }
+
+    try {
+        GameLog log;
+        log.path = path;
+        const json& game = document.at("game");
+        log.id = game.value("id", "");
+        log.board_size = game.at("board_size").get<int>();
+        if (log.board_size != 15 && log.board_size != 19) {
+            return std::unexpected(std::format("Unsupported board size {}", log.board_size));
+        }
+
+        for (const json& entry : document.at("moves")) {
+            move_history_t move{};
+            std::string player = entry.at("player").get<std::string>();
+            move.player = static_cast<int>(player == "x" ? Player::Cross : Player::Naught);
+            move.x = entry.at("position").at("x").get<int>();
+            move.y = entry.at("position").at("y").get<int>();
+
+            int expected = static_cast<int>(log.moves.size() % 2 == 0 ? Player::Cross : Player::Naught);
+            if ((player != "x" && player != "o") || move.player != expected) {
+                return std::unexpected(std::format("Move {} is played out of turn", log.moves.size() + 1));
+            }
+            if (!Position(move.x, move.y).is_valid(log.board_size)) {
+                return std::unexpected(std::format("Move {} is off the board", log.moves.size() + 1));
+            }
+            log.moves.push_back(move);
+        }
+        return log;
+    } catch (const json::exception& e) {
+        return std::unexpected(std::format("Not a game log: {}", e.what()));
+    }
+}
+
+std::expected<std::vector<std::string>, std::string> find_game_logs(const std::string& pattern) {
+    std::vector<std::string> paths;
+    std::error_code error;
+
+    if (std::filesystem::is_directory(pattern, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(pattern, error)) {
+            if (entry.is_regular_file(error) && entry.path().extension() == ".json") {
+                paths.push_back(entry.path().string());
+            }
+        }
+    } else {
+        glob_t matches{};
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; i++) {
+                if (std::filesystem::is_regular_file(matches.gl_pathv[i], error)) {
+                    paths.emplace_back(matches.gl_pathv[i]);
+                }
+            }
+        }
+        globfree(&matches);
+    }
+
+    if (paths.empty()) {
+        return std::unexpected(std::format("No game logs found at '{}'", pattern));
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+//===============================================================================
+// GAME ANALYZER
+//===============================================================================
+
+GameAnalyzer::GameAnalyzer(AnalysisOptions options, std::FILE* out)
+    : options_(options), out_(out), table_(static_cast<size_t>(options.tt_size_mb)) {}
+
+int GameAnalyzer::run(const std::vector<std::string>& paths) {
+    double started_at = get_current_time();
+
+    // One worker per game while there are enough games, Lazy SMP inside each when not
+    int workers = std::clamp(static_cast<int>(paths.size()), 1, std::max(1, options_.threads));
+    int search_threads = std::max(1, options_.threads / workers);
+    {
+        std::vector<std::jthread> threads;
+        for (int w = 0; w < workers; w++) {
+            threads.emplace_back([this, &paths, search_threads] { worker(paths, search_threads); });
+        }
+    }
+
+    double seconds = get_current_time() - started_at;
+    std::lock_guard lock(mutex_);
+    ordered_json summary = {
+        {"type", "summary"},
+        {"games", totals_.games},
+        {"errors", totals_.errors},
+        {"positions", totals_.positions},
+        {"blunders", totals_.blunders},
+        {"depth", options_.depth},
+        {"time_ms", seconds * 1000.0},
+        {"positions_per_second", seconds > 0.0 ? totals_.positions / seconds : 0.0},
+    };
+    std::fprintf(out_, "%s\n", summary.dump().c_str());
+    std::fflush(out_);
+    return totals_.errors;
+}
+
+void GameAnalyzer::worker(const std::vector<std::string>& paths, int search_threads) {
+    cli_config_t config{};
+    config.board_size = 15;
+    config.max_depth = options_.depth;
+    GamePtr game(init_game(config), cleanup_game);
+    if (!game) {
+        throw std::bad_alloc();
+    }
+
+    std::unique_ptr<ParallelAI> engine;
+    if (search_threads > 1) {
+        engine = std::make_unique<ParallelAI>(search_threads, SearchMode::LazySmp);
+    }
+
+    for (size_t index = next_path_.fetch_add(1, std::memory_order_relaxed); index < paths.size();
+         index = next_path_.fetch_add(1, std::memory_order_relaxed)) {
+        auto log = load_game_log(paths[index]);
+        std::expected<std::vector<ordered_json>, std::string> records = std::unexpected(std::string{});
+        if (log) {
+            records = analyze(*log, game.get(), engine.get());
+        } else {
+            records = std::unexpected(log.error());
+        }
+        if (!records) {
+            std::lock_guard lock(mutex_);
+            totals_.errors++;
+            ordered_json error = {{"type", "error"}, {"file", paths[index]}, {"error", records.error()}};
+            std::fprintf(out_, "%s\n", error.dump().c_str());
+            std::fflush(out_);
+            continue;
+        }
+        write(*records);
+    }
+}
+
+std::expected<std::vector<ordered_json>, std::string>
+GameAnalyzer::analyze(const GameLog& log, game_state_t* game, ParallelAI* engine) {
+    double started_at = get_current_time();
+
+    cli_config_t config{};
+    config.board_size = log.board_size;
+    config.max_depth = options_.depth;
+    reset_game(game, config);
+    game->quiet_search = 1;
+    game->transposition_table = &table_;
+
+    std::vector<ordered_json> records;
+    int blunders = 0;
+    int missed_wins = 0;
+
+    for (size_t ply = 0; ply < log.moves.size(); ply++) {
+        const move_history_t& played = log.moves[ply];
+        if (game->game_state != static_cast<int>(GameState::Running)) {
+            return std::unexpected(std::format("Move {} comes after the game ended", ply + 1));
+        }
+        if (!game->board.is_playable(played.x, played.y)) {
+            return std::unexpected(std::format("Move {} is on an occupied cell", ply + 1));
+        }
+
+        SearchResult best = run_search(*game, engine);
+
+        // Both root moves are rescored with the full window, mostly from the
+        // entries the search just stored; book and solver moves report no score
+        int best_score = 0;
+        int played_score = 0;
+        uint64_t nodes = best.nodes;
+        {
+            ScratchLease lease(game);
+            game->search_start_time = get_current_time();
+            game->search_timed_out = 0;
+            game->search_nodes = 0;
+            best_score = search_root_move(game, best.move.x, best.move.y, options_.depth, -WIN_SCORE - 1);
+            played_score = Position(played.x, played.y) == best.move
+                ? best_score
+                : search_root_move(game, played.x, played.y, options_.depth, -WIN_SCORE - 1);
+            nodes += game->search_nodes;
+        }
+
+        // A search that settles on a worse move than the one played gives it no loss
+        int loss = std::max(0, best_score - played_score);
+        ordered_json flags = ordered_json::array();
+        if (loss >= options_.blunder_loss) {
+            flags.push_back("blunder");
+            blunders++;
+        }
+        if (best_score >= DECIDED_SCORE && played_score < DECIDED_SCORE) {
+            flags.push_back("missed_win");
+            missed_wins++;
+        }
+
+        records.push_back({
+            {"type", "move"},
+            {"file", log.path},
+            {"game", log.id},
+            {"ply", ply + 1},
+            {"player", played.player == static_cast<int>(Player::Cross) ? "x" : "o"},
+            {"move", {played.x, played.y}},
+            {"best", {best.move.x, best.move.y}},
+            {"score", best_score},
+            {"played_score", played_score},
+            {"loss", loss},
+            {"flags", std::move(flags)},
+            {"depth", options_.depth},
+            {"nodes", nodes},
+        });
+
+        make_move(game, played.x, played.y, played.player, 0.0, 0);
+    }
+
+    records.push_back({
+        {"type", "game"},
+        {"file", log.path},
+        {"game", log.id},
+        {"moves", log.moves.size()},
+        {"blunders", blunders},
+        {"missed_wins", missed_wins},
+        {"time_ms", (get_current_time() - started_at) * 1000.0},
+    });
+    return records;
+}
+
+void GameAnalyzer::write(const std::vector<ordered_json>& records) {
+    std::lock_guard lock(mutex_);
+    totals_.games++;
+    for (const auto& record : records) {
+        if (record["type"] == "game") {
+            totals_.positions += record["moves"].get<int>();
+            totals_.blunders += record["blunders"].get<int>();
+        }
+        std::fprintf(out_, "%s\n", record.dump().c_str());
+    }
+    std::fflush(out_);
+}
+
+//===============================================================================
+// COMMAND
+//===============================================================================
+
+int run_analysis_command(const cli_config_t& config, std::FILE* out) {
+    auto paths = find_game_logs(config.analyze_path);
+    if (!paths) {
+        std::cerr << std::format("Error: {}\n", paths.error());
+        return 1;
+    }
+
+    populate_threat_matrix();
+
+    AnalysisOptions options;
+    options.depth = config.max_depth;
+    options.threads = std::max(1, config.thread_count);
+    options.tt_size_mb = std::max(1, config.tt_size_mb);
+    return GameAnalyzer(options, out).run(*paths) == 0 ? 0 : 1;
+}
+
+} // namespace gomoku
@@ -0,0 +1,114 @@
+//
+//  game_analysis.hpp
+//  gomoku - Bulk analysis of archived game logs
+//
+//  Replays game history logs move by move and annotates every move with the engine's verdict
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <expected>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+#include "game.h"
+#include "gomoku.hpp"
+#include "transposition_table.hpp"
+
+namespace gomoku {
+
+class ParallelAI;
+
+/**
+ * A game log in the game history JSON schema, as GameHistory writes it.
+ */
+struct GameLog {
+    std::string path;
+    std::string id;
+    int board_size = 0;
+    std::vector<move_history_t> moves;     // Only player, x and y are read
+};
+
+/**
+ * Reads the game log at path: game.board_size and the moves array are
+ * required, and the moves must alternate starting with crosses.
+ */
+std::expected<GameLog, std::string> load_game_log(const std::string& path);
+
+/**
+ * Expands what `gomoku --analyze` was given: a directory stands for the
+ * .json files in it, anything else for the files the glob pattern matches.
+ * The paths come back sorted.
+ */
+std::expected<std::vector<std::string>, std::string> find_game_logs(const std::string& pattern);
+
+//===============================================================================
+// GAME ANALYZER
+//===============================================================================
+
+struct AnalysisOptions {
+    int depth = 4;
+    int threads = 1;                        // Search threads in all, shared out between the games
+    int tt_size_mb = 32;                    // Size of the transposition table
+    int blunder_loss = 10000;               // Score a move may give up before it is a blunder
+};
+
+/**
+ * Annotates every move of a set of game logs with the best move at
+ * options.depth, its score, the score of the move played and flags for
+ * blunders and missed wins, written as JSON lines to out.
+ *
+ * Games are analyzed concurrently, each by one worker that replays it with
+ * make_move() on a game state kept for all of its games, so no position is
+ * rebuilt from scratch. When there are fewer games than threads, each
+ * worker searches with Lazy SMP on its share of them.
+ *
+ * Every worker searches with one transposition table, so a position's
+ * search finds much of its subtree already scored by the searches of the
+ * positions before it.
+ *
+ * A game's lines are written together once it is analyzed: one "move" line
+ * per position, then a "game" line, or an "error" line for a log that
+ * cannot be read or replayed. A "summary" line comes last.
+ */
+class GameAnalyzer {
+public:
+    GameAnalyzer(AnalysisOptions options, std::FILE* out);
+
+    /**
+     * Analyzes the logs at paths; returns the number that failed.
+     */
+    int run(const std::vector<std::string>& paths);
+
+private:
+    struct Totals {
+        int games = 0;
+        int errors = 0;
+        int positions = 0;
+        int blunders = 0;
+    };
+
+    void worker(const std::vector<std::string>& paths, int search_threads);
+    std::expected<std::vector<nlohmann::ordered_json>, std::string>
+    analyze(const GameLog& log, game_state_t* game, ParallelAI* engine);
+    void write(const std::vector<nlohmann::ordered_json>& records);
+
+    AnalysisOptions options_;
+    std::FILE* out_;
+    std::atomic<size_t> next_path_{0};
+    TranspositionTable table_;
+    std::mutex mutex_;                      // Guards totals_ and out_
+    Totals totals_;
+};
+
+/**
+ * Entry point of `gomoku --analyze`, with the depth, threads and table size
+ * of config. Returns the process exit status.
+ */
+int run_analysis_command(const cli_config_t& config, std::FILE* out);
+
+} // namespace gomoku
@@ -38,7 +38,21 @@ GameCoordinator::GameCoordinator(const cli_config_t& config)
     // Initialize parallel AI with specified thread count
     size_t thread_count = config.thread_count > 0 ? 
         static_cast<size_t>(config.thread_count) : 0;
-    init_parallel_ai(thread_count);
+    SearchMode mode = parse_search_mode(config.search_mode).value_or(SearchMode::LazySmp);
+    init_parallel_ai(thread_count, mode);
+    
+    // Size the transposition table shared by every search thread
+    if (config.tt_size_mb > 0) {
+        shared_transposition_table().resize(static_cast<size_t>(config.tt_size_mb));
+    }
+    
+    // Map the opening book every AI move probes before searching
+    if (config.book_path[0] != '\0') {
+        auto opened = shared_opening_book().open(config.book_path);
+        if (!opened) {
+            throw std::runtime_error(opened.error());
+        }
+    }
     
     // Initialize players from configuration
     initialize_players(config);
@@ -151,6 +165,7 @@ int GameCoordinator::run_game() {
             if (!status_result) {
                 // GameHistory will handle the fatal error
             }
+            game_history_->finalize();
         }
         
         PlayerImpl* current_player = get_current_player();
@@ -175,15 +190,29 @@ void GameCoordinator::initialize_players(const cli_config_t& config) {
     auto spec1 = config_to_spec(config.player1_type);
     std::string name1 = config.player1_name[0] ? config.player1_name : "";
     auto difficulty1 = string_to_difficulty(config.player1_difficulty);
+    auto algorithm1 = string_to_algorithm(config.player1_difficulty);
     
-    player1_ = PlayerFactory::create_player(spec1, name1, difficulty1);
+    player1_ = PlayerFactory::create_player(spec1, name1, difficulty1, algorithm1);
     
     // Create player 2 (moves second)  
     auto spec2 = config_to_spec(config.player2_type);
     std::string name2 = config.player2_name[0] ? config.player2_name : "";
     auto difficulty2 = string_to_difficulty(config.player2_difficulty);
+    auto algorithm2 = string_to_algorithm(config.player2_difficulty);
     
-    player2_ = PlayerFactory::create_player(spec2, name2, difficulty2);
+    player2_ = PlayerFactory::create_player(spec2, name2, difficulty2, algorithm2);
+    
+    // Ponder only against a human: two engines share the search threads, so
+    // one pondering would just slow the other down
+    if (config.ponder) {
+        auto enable_pondering = [](PlayerImpl* player, PlayerImpl* opponent) {
+            if (player->get_type() == PlayerType::Computer && opponent->get_type() == PlayerType::Human) {
+                static_cast<ComputerPlayer*>(player)->set_pondering(true);
+            }
+        };
+        enable_pondering(player1_.get(), player2_.get());
+        enable_pondering(player2_.get(), player1_.get());
+    }
     
     // Set initial player (player1 always goes first with crosses)
     current_player_index_ = 0;
@@ -238,6 +267,7 @@ bool GameCoordinator::make_player_move() {
             if (opponent) {
                 opponent->on_opponent_move(&bridge, result.x, result.y);
             }
+            current_player->on_move_played(&bridge, result.x, result.y);
             
             return true;
         }
@@ -312,6 +342,10 @@ ComputerPlayer::Difficulty GameCoordinator::string_to_difficulty(const std::stri
     return ComputerPlayer::Difficulty::Medium;
 }
 
+SearchAlgorithm GameCoordinator::string_to_algorithm(const std::string& diff) const {
+    return diff == "mcts" ? SearchAlgorithm::MonteCarlo : SearchAlgorithm::AlphaBeta;
+}
+
 void GameCoordinator::increase_computer_difficulty() {
     // Find computer players and increase their difficulty
     bool changed = false;
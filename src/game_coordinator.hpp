@@ -121,6 +121,11 @@ private:
      * Convert difficulty string to enum
      */
     ComputerPlayer::Difficulty string_to_difficulty(const std::string& diff) const;
+    
+    /**
+     * Search algorithm named by a difficulty string: "mcts" picks the tree search
+     */
+    SearchAlgorithm string_to_algorithm(const std::string& diff) const;
 };
 
 } // namespace gomoku
\ No newline at end of file
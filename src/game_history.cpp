@@ -6,6 +6,7 @@
 //
 
 #include "game_history.hpp"
+#include "history_writer.hpp"
 #include "gomoku.hpp"
 #include "ansi.h"
 #include <iostream>
@@ -21,7 +22,7 @@ namespace gomoku {
 const char* game_history_error_to_string(GameHistoryError error) {
     switch (error) {
         case GameHistoryError::DirectoryCreationFailed:
-            return "Failed to create game_histories directory";
+            return "Failed to create log directory";
         case GameHistoryError::FileWriteFailed:
             return "Failed to write JSON file";
         case GameHistoryError::JsonSerializationFailed:
@@ -33,8 +34,9 @@ const char* game_history_error_to_string(GameHistoryError error) {
     }
 }
 
-GameHistory::GameHistory(const cli_config_t& config) 
-    : config_(config), move_count_(0) {
+GameHistory::GameHistory(const cli_config_t& config, std::string directory, std::string file_name)
+    : config_(config), directory_(std::move(directory)), file_name_(std::move(file_name)),
+      writer_(shared_history_writer()), move_count_(0), finalized_(false) {
     
     game_start_time_ = std::chrono::system_clock::now();
     
@@ -54,6 +56,10 @@ GameHistory::GameHistory(const cli_config_t& config)
     game_id_ = ss.str();
 }
 
+GameHistory::~GameHistory() {
+    finalize();
+}
+
 std::string GameHistory::generate_filename() {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -69,11 +75,11 @@ std::string GameHistory::generate_filename() {
 }
 
 std::expected<void, GameHistoryError> GameHistory::ensure_directory_exists() {
-    std::filesystem::path dir_path = "game_histories";
+    std::filesystem::path dir_path = directory_;
     
     try {
         if (!std::filesystem::exists(dir_path)) {
-            if (!std::filesystem::create_directory(dir_path)) {
+            if (!std::filesystem::create_directories(dir_path)) {
                 return std::unexpected(GameHistoryError::DirectoryCreationFailed);
             }
         }
@@ -87,26 +93,28 @@ std::expected<void, GameHistoryError> GameHistory::initialize() {
     // Ensure directory exists
     auto dir_result = ensure_directory_exists();
     if (!dir_result) {
-        fatal_error(std::format("Cannot create game_histories directory: {}", 
+        fatal_error(std::format("Cannot create {} directory: {}", directory_,
                                game_history_error_to_string(dir_result.error())));
         return std::unexpected(dir_result.error());
     }
     
     // Generate filename
-    std::string filename = generate_filename();
-    file_path_ = "game_histories/" + filename;
+    std::string filename = file_name_.empty() ? generate_filename() : file_name_;
+    file_path_ = (std::filesystem::path(directory_) / filename).string();
+    journal_path_ = std::filesystem::path(file_path_).replace_extension(".jsonl").string();
     
-    // Initialize JSON structure
-    game_json_ = json::object();
+    // The journal starts with everything but the moves
+    json game_json = json::object();
+    game_json["type"] = "game";
     
     // Schema version
-    game_json_["version"] = "1.0";
+    game_json["version"] = "1.0";
     
     // Game metadata
     auto now_formatted = std::format("{:%Y-%m-%dT%H:%M:%SZ}", 
                                    std::chrono::floor<std::chrono::seconds>(game_start_time_));
     
-    game_json_["game"] = {
+    game_json["game"] = {
         {"id", game_id_},
         {"status", "in_progress"},
         {"board_size", config_.board_size},
@@ -119,7 +127,7 @@ std::expected<void, GameHistoryError> GameHistory::initialize() {
     
     // AI configuration (if any computer players)
     if (has_ai) {
-        game_json_["game"]["ai_config"] = {
+        game_json["game"]["ai_config"] = {
             {"depth", config_.max_depth},
             {"timeout_ms", config_.move_timeout * 1000},
             {"threads", config_.thread_count > 0 ? config_.thread_count : 1}
@@ -132,15 +140,15 @@ std::expected<void, GameHistoryError> GameHistory::initialize() {
     std::string player2_name = std::strlen(config_.player2_name) > 0 ? 
                               config_.player2_name : "Player 2";
     
-    // Special handling for AI player names
-    if (std::string(config_.player1_type) == "computer") {
+    // Unnamed AI players are logged as the engine
+    if (std::string(config_.player1_type) == "computer" && std::strlen(config_.player1_name) == 0) {
         player1_name = "gomoku-cpp23";
     }
-    if (std::string(config_.player2_type) == "computer") {
+    if (std::string(config_.player2_type) == "computer" && std::strlen(config_.player2_name) == 0) {
         player2_name = "gomoku-cpp23";
     }
     
-    game_json_["players"] = {
+    game_json["players"] = {
         {"x", {
             {"nickname", player1_name}, 
             {"type", std::string(config_.player1_type) == "computer" ? "ai" : "human"}
@@ -151,14 +159,7 @@ std::expected<void, GameHistoryError> GameHistory::initialize() {
         }}
     };
     
-    // Initialize empty move history
-    game_json_["moves"] = json::array();
-    
-    // Current player starts with X
-    game_json_["current_player"] = "x";
-    
-    // Write initial file
-    return write_json_file();
+    return append_record(game_json);
 }
 
 json GameHistory::serialize_move(const move_history_t& move, bool is_winning_move) {
@@ -197,17 +198,8 @@ std::expected<void, GameHistoryError> GameHistory::log_move(
     bool is_winning_move) {
     
     try {
-        // Add move to history
-        json move_json = serialize_move(move, is_winning_move);
-        game_json_["moves"].push_back(move_json);
         move_count_++;
-        
-        // Update current player for next turn
-        std::string current_player = move_json["player"];
-        game_json_["current_player"] = (current_player == "x") ? "o" : "x";
-        
-        // Write updated JSON to file
-        return write_json_file();
+        return append_record({{"type", "move"}, {"move", serialize_move(move, is_winning_move)}});
         
     } catch (const json::exception& e) {
         fatal_error(std::format("JSON serialization failed: {}", e.what()));
@@ -217,36 +209,87 @@ std::expected<void, GameHistoryError> GameHistory::log_move(
 
 std::expected<void, GameHistoryError> GameHistory::update_game_status(const std::string& status) {
     try {
-        game_json_["game"]["status"] = status;
-        return write_json_file();
+        return append_record({{"type", "status"}, {"status", status}});
     } catch (const json::exception& e) {
         fatal_error(std::format("Failed to update game status: {}", e.what()));
         return std::unexpected(GameHistoryError::JsonSerializationFailed);
     }
 }
 
-std::expected<void, GameHistoryError> GameHistory::write_json_file() {
-    try {
-        std::ofstream file(file_path_);
-        if (!file.is_open()) {
-            fatal_error(std::format("Cannot open file for writing: {}", file_path_));
-            return std::unexpected(GameHistoryError::FileWriteFailed);
+std::expected<void, GameHistoryError> GameHistory::append_record(const json& record) {
+    if (journal_path_.empty() || finalized_) {
+        return std::unexpected(GameHistoryError::FileWriteFailed);
+    }
+    writer_.append(journal_path_, record.dump() + '\n');
+    return {};
+}
+
+void GameHistory::finalize() {
+    if (journal_path_.empty() || finalized_) {
+        return;
+    }
+    finalized_ = true;
+    writer_.then([journal = journal_path_, path = file_path_] {
+        if (auto result = finalize_journal(journal, path); !result) {
+            std::cerr << std::format("Warning: cannot finalize game history {}: {}\n",
+                                     path, game_history_error_to_string(result.error()));
         }
-        
-        file << game_json_.dump(2) << std::endl;
-        file.close();
-        
-        if (file.fail()) {
-            fatal_error(std::format("Failed to write to file: {}", file_path_));
+    });
+}
+
+std::expected<void, GameHistoryError> GameHistory::finalize_journal(const std::string& journal_path,
+                                                                    const std::string& json_path) {
+    std::ifstream journal(journal_path);
+    if (!journal.is_open()) {
+        return std::unexpected(GameHistoryError::FileWriteFailed);
+    }
+
+    json game_json;
+    std::string line;
+    while (std::getline(journal, line)) {
+        // Only the last line can be torn; stop at it
+        json record = json::parse(line, nullptr, false);
+        if (record.is_discarded() || journal.eof()) {
+            break;
+        }
+
+        std::string type = record.value("type", "");
+        if (type == "game") {
+            record.erase("type");
+            game_json = std::move(record);
+            game_json["moves"] = json::array();
+            game_json["current_player"] = "x";
+        } else if (game_json.is_null()) {
+            break;
+        } else if (type == "move") {
+            std::string player = record["move"].value("player", "x");
+            game_json["moves"].push_back(std::move(record["move"]));
+            game_json["current_player"] = (player == "x") ? "o" : "x";
+        } else if (type == "status") {
+            game_json["game"]["status"] = record["status"];
+        }
+    }
+    if (game_json.is_null()) {
+        return std::unexpected(GameHistoryError::JsonSerializationFailed);
+    }
+
+    // Written aside and renamed, so the JSON file is never seen half written
+    std::string temp_path = json_path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        file << game_json.dump(2) << std::endl;
+        if (!file) {
             return std::unexpected(GameHistoryError::FileWriteFailed);
         }
-        
-        return {};
-        
-    } catch (const std::exception& e) {
-        fatal_error(std::format("File write error: {}", e.what()));
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, json_path, error);
+    if (error) {
         return std::unexpected(GameHistoryError::FileWriteFailed);
     }
+    std::filesystem::remove(journal_path, error);
+    return {};
 }
 
 void GameHistory::fatal_error(const std::string& message) {
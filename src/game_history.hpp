@@ -2,7 +2,7 @@
 //  game_history.hpp
 //  gomoku - Game history JSON logging functionality
 //
-//  Modern C++23 JSON logging compatible with HTTP daemon schema
+//  Modern C++23 JSON logging compatible with HTTP daemon schema, journaled while the game runs
 //
 
 #pragma once
@@ -28,12 +28,27 @@ enum class GameHistoryError {
     PermissionDenied
 };
 
+class HistoryWriter;
+
+/**
+ * Records a game in the game history JSON schema.
+ *
+ * While the game runs, every call appends one JSON line to a journal
+ * (the JSON path with a .jsonl extension) through the shared
+ * HistoryWriter, so logging a move never waits for the disk. finalize()
+ * turns the journal into the JSON file once the game is over.
+ */
 class GameHistory {
 public:
-    explicit GameHistory(const cli_config_t& config);
-    ~GameHistory() = default;
+    // Logs to directory/file_name; an empty file_name is timestamped
+    explicit GameHistory(const cli_config_t& config,
+                         std::string directory = "game_histories",
+                         std::string file_name = "");
+
+    // Finalizes the log if finalize() was not called
+    ~GameHistory();
 
-    // Initialize the game history (creates directory and initial file)
+    // Initialize the game history (creates directory and starts the journal)
     std::expected<void, GameHistoryError> initialize();
     
     // Log a move to the history file
@@ -44,19 +59,33 @@ public:
     
     // Update game status
     std::expected<void, GameHistoryError> update_game_status(const std::string& status);
+
+    // Queue the journal's conversion to the JSON file; later calls are ignored
+    void finalize();
     
     // Get the current JSON file path
     std::string get_file_path() const { return file_path_; }
+
+    // Get the journal path, which exists until the log is finalized
+    std::string get_journal_path() const { return journal_path_; }
+
+    /**
+     * Writes the JSON file for a journal and removes the journal. A torn
+     * last line, as a crash can leave, is ignored, so this also recovers
+     * the log of a game that never finalized.
+     */
+    static std::expected<void, GameHistoryError> finalize_journal(const std::string& journal_path,
+                                                                  const std::string& json_path);
     
 private:
     // Generate timestamped filename
     std::string generate_filename();
     
-    // Create game_histories directory if it doesn't exist
+    // Create the log directory if it doesn't exist
     std::expected<void, GameHistoryError> ensure_directory_exists();
     
-    // Write JSON to file with error handling
-    std::expected<void, GameHistoryError> write_json_file();
+    // Queue one journal record
+    std::expected<void, GameHistoryError> append_record(const json& record);
     
     // Convert move_history_t to JSON format
     json serialize_move(const move_history_t& move, bool is_winning_move = false);
@@ -65,11 +94,15 @@ private:
     void fatal_error(const std::string& message);
     
     cli_config_t config_;
-    json game_json_;
+    std::string directory_;
+    std::string file_name_;
+    HistoryWriter& writer_;
     std::string file_path_;
+    std::string journal_path_;
     std::string game_id_;
     std::chrono::system_clock::time_point game_start_time_;
     int move_count_;
+    bool finalized_;
 };
 
 const char* game_history_error_to_string(GameHistoryError error);
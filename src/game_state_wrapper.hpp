@@ -22,7 +22,7 @@ struct GameStateWrapper {
     
     // Convenience accessors (if needed by players)
     int get_current_player() const { return legacy_state->current_player; }
-    int** get_board() const { return legacy_state->board; }
+    const FlatBoard& get_board() const { return legacy_state->board; }
     int get_board_size() const { return legacy_state->board_size; }
     int get_cursor_x() const { return legacy_state->cursor_x; }
     int get_cursor_y() const { return legacy_state->cursor_y; }
@@ -7,6 +7,7 @@
 
 #include "gomoku.hpp"
 #include "board.hpp"
+#include "bitboard.hpp"
 #include <array>
 #include <algorithm>
 #include <iostream>
@@ -21,11 +22,6 @@ namespace gomoku {
 //===============================================================================
 
 namespace detail {
-    // Threat scoring matrix - initialized by populate_threat_matrix()
-    std::array<int, 20> threat_cost{};
-    bool threat_initialized = false;
-    std::array<ThreatType, NUM_DIRECTIONS> threats{};
-
     // Constants for legacy C interface
     constexpr int OUT_OF_BOUNDS = 32;
     constexpr int SEARCH_RADIUS = 4;
@@ -53,6 +49,169 @@ namespace detail {
     constexpr int threat_to_int(ThreatType threat) noexcept {
         return static_cast<int>(threat);
     }
+
+    // Maps a run of stones and its two ends onto a threat type
+    constexpr ThreatType classify_run(int count, bool left_blocked, bool right_blocked,
+                                      bool left_open, bool right_open) noexcept {
+        if (count >= NEED_TO_WIN) {
+            return ThreatType::Five;
+        } else if (count == 4) {
+            if (!left_blocked && !right_blocked) {
+                return ThreatType::StraightFour;
+            } else {
+                return ThreatType::Four;
+            }
+        } else if (count == 3) {
+            if (!left_blocked && !right_blocked) {
+                return ThreatType::Three;
+            } else {
+                return ThreatType::ThreeBroken;
+            }
+        } else if (count == 2) {
+            return ThreatType::Two;
+        } else if (count == 1) {
+            // Check if there are friendly stones nearby
+            if (left_open || right_open) {
+                return ThreatType::NearEnemy;
+            }
+        }
+
+        return ThreatType::Nothing;
+    }
+
+    // Reference classification of the run through the center of a line; the
+    // pattern table holds its result for every 9-cell window
+    constexpr ThreatType scan_line(std::span<const Player> line, Player player) noexcept {
+        int center = line.size() / 2;
+        if (line[center] != player) {
+            return ThreatType::Nothing;
+        }
+
+        Player opponent = other_player(player);
+
+        // Count consecutive stones in both directions
+        int count = 1; // Center stone
+
+        // Count left
+        int left_count = 0;
+        for (int i = center - 1; i >= 0 && line[i] == player; --i) {
+            ++left_count;
+            ++count;
+        }
+
+        // Count right
+        int right_count = 0;
+        for (int i = center + 1; i < static_cast<int>(line.size()) && line[i] == player; ++i) {
+            ++right_count;
+            ++count;
+        }
+
+        // Check for blocking by opponents
+        bool left_blocked = (center - left_count - 1 >= 0) && (line[center - left_count - 1] == opponent);
+        bool right_blocked = (center + right_count + 1 < static_cast<int>(line.size())) && (line[center + right_count + 1] == opponent);
+
+        // Check for open spaces
+        bool left_open = (center - left_count - 1 >= 0) && (line[center - left_count - 1] == Player::Empty);
+        bool right_open = (center + right_count + 1 < static_cast<int>(line.size())) && (line[center + right_count + 1] == Player::Empty);
+
+        // Determine threat type based on pattern analysis
+        return classify_run(count, left_blocked, right_blocked, left_open, right_open);
+    }
+
+    // Inverse of patterns::side_cells(): puts the eight side cells back around an empty center
+    constexpr uint32_t window_from_side_cells(uint32_t cells) noexcept {
+        constexpr uint32_t low = (1u << patterns::WINDOW_CENTER) - 1;
+        return (cells & low) | ((cells & ~low) << 1);
+    }
+
+    constexpr std::array<ThreatType, patterns::TABLE_SIZE> build_threat_table() noexcept {
+        std::array<ThreatType, patterns::TABLE_SIZE> table{};
+        constexpr uint32_t side_mask = (1u << patterns::SIDE_CELLS) - 1;
+
+        for (uint32_t key = 0; key < patterns::TABLE_SIZE; ++key) {
+            uint32_t own = window_from_side_cells(key & side_mask) | (1u << patterns::WINDOW_CENTER);
+            uint32_t opponent = window_from_side_cells(key >> patterns::SIDE_CELLS);
+            if (own & opponent) {
+                continue; // A cell cannot hold both players' stones
+            }
+
+            std::array<Player, patterns::WINDOW_SIZE> line{};
+            for (int i = 0; i < patterns::WINDOW_SIZE; ++i) {
+                line[i] = ((own >> i) & 1u) ? Player::Cross
+                        : ((opponent >> i) & 1u) ? Player::Naught : Player::Empty;
+            }
+            table[key] = scan_line(line, Player::Cross);
+        }
+        return table;
+    }
+
+    constexpr std::array<int, patterns::THREAT_TYPES> build_threat_scores() noexcept {
+        std::array<int, patterns::THREAT_TYPES> scores{};
+        scores[threat_to_int(ThreatType::Nothing)] = 0;
+        scores[threat_to_int(ThreatType::Five)] = 1000000;
+        scores[threat_to_int(ThreatType::StraightFour)] = 100000;
+        scores[threat_to_int(ThreatType::Four)] = 10000;
+        scores[threat_to_int(ThreatType::Three)] = 1000;
+        scores[threat_to_int(ThreatType::FourBroken)] = 1000;
+        scores[threat_to_int(ThreatType::ThreeBroken)] = 100;
+        scores[threat_to_int(ThreatType::Two)] = 10;
+        scores[threat_to_int(ThreatType::NearEnemy)] = 1;
+        scores[threat_to_int(ThreatType::ThreeAndFour)] = 200000;
+        scores[threat_to_int(ThreatType::ThreeAndThree)] = 50000;
+        scores[threat_to_int(ThreatType::ThreeAndThreeBroken)] = 10000;
+        return scores;
+    }
+
+    // Bonus for a pair of threats on two lines through the same stone, indexed
+    // [earlier direction][later direction]
+    constexpr std::array<std::array<int, patterns::THREAT_TYPES>, patterns::THREAT_TYPES>
+    build_combination_scores() noexcept {
+        constexpr auto scores = build_threat_scores();
+        std::array<std::array<int, patterns::THREAT_TYPES>, patterns::THREAT_TYPES> combinations{};
+        combinations[threat_to_int(ThreatType::Three)][threat_to_int(ThreatType::Four)] =
+            scores[threat_to_int(ThreatType::ThreeAndFour)];
+        combinations[threat_to_int(ThreatType::Three)][threat_to_int(ThreatType::Three)] =
+            scores[threat_to_int(ThreatType::ThreeAndThree)];
+        return combinations;
+    }
+
+    template<int Size> requires ValidBoardSize<Size>
+    BitBoard to_bitboard(const Board<Size>& board) noexcept {
+        BitBoard bits(Size);
+        for (int i = 0; i < Size; ++i) {
+            for (int j = 0; j < Size; ++j) {
+                Player cell = board.at(i, j);
+                if (cell != Player::Empty) {
+                    bits.place(i, j, cell);
+                }
+            }
+        }
+        return bits;
+    }
+
+    constexpr bool is_supported_size(int size) noexcept {
+        return size == 15 || size == 19;
+    }
+}
+
+//===============================================================================
+// PATTERN TABLES
+//===============================================================================
+
+namespace patterns {
+    constexpr std::array<ThreatType, TABLE_SIZE> THREAT_TABLE = detail::build_threat_table();
+    constexpr std::array<int, THREAT_TYPES> THREAT_SCORE = detail::build_threat_scores();
+    constexpr std::array<std::array<int, THREAT_TYPES>, THREAT_TYPES> COMBINATION_SCORE =
+        detail::build_combination_scores();
+
+    static_assert(THREAT_TABLE[key(0b000011111, 0)] == ThreatType::Five);
+    static_assert(THREAT_TABLE[key(0b000011110, 0)] == ThreatType::StraightFour);
+    static_assert(THREAT_TABLE[key(0b000011110, 0b000100000)] == ThreatType::Four);
+    static_assert(THREAT_TABLE[key(0b000111000, 0)] == ThreatType::Three);
+    static_assert(THREAT_TABLE[key(0b000111000, 0b001000000)] == ThreatType::ThreeBroken);
+    static_assert(THREAT_TABLE[key(0b000110000, 0)] == ThreatType::Two);
+    static_assert(THREAT_TABLE[key(0b000010000, 0)] == ThreatType::NearEnemy);
+    static_assert(THREAT_TABLE[key(0b000010000, 0b000101000)] == ThreatType::Nothing);
 }
 
 //===============================================================================
@@ -60,25 +219,7 @@ namespace detail {
 //===============================================================================
 
 void populate_threat_matrix() {
-    if (detail::threat_initialized) return;
-
-    using namespace detail;
-
-    // Initialize threat costs based on original algorithm
-    threat_cost[threat_to_int(ThreatType::Nothing)] = 0;
-    threat_cost[threat_to_int(ThreatType::Five)] = 1000000;
-    threat_cost[threat_to_int(ThreatType::StraightFour)] = 100000;
-    threat_cost[threat_to_int(ThreatType::Four)] = 10000;
-    threat_cost[threat_to_int(ThreatType::Three)] = 1000;
-    threat_cost[threat_to_int(ThreatType::FourBroken)] = 1000;
-    threat_cost[threat_to_int(ThreatType::ThreeBroken)] = 100;
-    threat_cost[threat_to_int(ThreatType::Two)] = 10;
-    threat_cost[threat_to_int(ThreatType::NearEnemy)] = 1;
-    threat_cost[threat_to_int(ThreatType::ThreeAndFour)] = 200000;
-    threat_cost[threat_to_int(ThreatType::ThreeAndThree)] = 50000;
-    threat_cost[threat_to_int(ThreatType::ThreeAndThreeBroken)] = 10000;
-
-    detail::threat_initialized = true;
+    // The pattern and score tables are compile-time constants
 }
 
 //===============================================================================
@@ -86,191 +227,147 @@ void populate_threat_matrix() {
 //===============================================================================
 
 [[nodiscard]] ThreatType calc_threat_in_one_dimension(std::span<const Player> line, Player player) {
-    if (line.size() < NEED_TO_WIN * 2 - 1) {
+    if (line.size() < patterns::WINDOW_SIZE) {
         return ThreatType::Nothing;
     }
 
-    int center = line.size() / 2;
-    if (line[center] != player) {
+    // A run reaching past the nine cells around the center is a five either
+    // way, so the central window decides the classification
+    int first = static_cast<int>(line.size()) / 2 - patterns::WINDOW_CENTER;
+    if (line[first + patterns::WINDOW_CENTER] != player) {
         return ThreatType::Nothing;
     }
 
     Player opponent = other_player(player);
-
-    // Count consecutive stones in both directions
-    int count = 1; // Center stone
-
-    // Count left
-    int left_count = 0;
-    for (int i = center - 1; i >= 0 && line[i] == player; --i) {
-        ++left_count;
-        ++count;
+    uint32_t own = 0;
+    uint32_t opp = 0;
+    for (int i = 0; i < patterns::WINDOW_SIZE; ++i) {
+        own |= static_cast<uint32_t>(line[first + i] == player) << i;
+        opp |= static_cast<uint32_t>(line[first + i] == opponent) << i;
     }
 
-    // Count right
-    int right_count = 0;
-    for (int i = center + 1; i < static_cast<int>(line.size()) && line[i] == player; ++i) {
-        ++right_count;
-        ++count;
-    }
-
-    // Check for blocking by opponents
-    bool left_blocked = (center - left_count - 1 >= 0) && (line[center - left_count - 1] == opponent);
-    bool right_blocked = (center + right_count + 1 < static_cast<int>(line.size())) && (line[center + right_count + 1] == opponent);
-
-    // Check for open spaces
-    bool left_open = (center - left_count - 1 >= 0) && (line[center - left_count - 1] == Player::Empty);
-    bool right_open = (center + right_count + 1 < static_cast<int>(line.size())) && (line[center + right_count + 1] == Player::Empty);
-
-    // Determine threat type based on pattern analysis
-    if (count >= NEED_TO_WIN) {
-        return ThreatType::Five;
-    } else if (count == 4) {
-        if (!left_blocked && !right_blocked) {
-            return ThreatType::StraightFour;
-        } else {
-            return ThreatType::Four;
-        }
-    } else if (count == 3) {
-        if (!left_blocked && !right_blocked) {
-            return ThreatType::Three;
-        } else {
-            return ThreatType::ThreeBroken;
-        }
-    } else if (count == 2) {
-        return ThreatType::Two;
-    } else if (count == 1) {
-        // Check if there are friendly stones nearby
-        if (left_open || right_open) {
-            return ThreatType::NearEnemy;
-        }
-    }
-
-    return ThreatType::Nothing;
+    return calc_threat_in_window(own, opp);
 }
 
 [[nodiscard]] int calc_combination_threat(ThreatType one, ThreatType two) {
-    using namespace detail;
-
-    populate_threat_matrix();
-
-    // Calculate bonus for threat combinations
-    if (one == ThreatType::Three && two == ThreatType::Four) {
-        return threat_cost[threat_to_int(ThreatType::ThreeAndFour)];
-    } else if (one == ThreatType::Three && two == ThreatType::Three) {
-        return threat_cost[threat_to_int(ThreatType::ThreeAndThree)];
-    }
-
-    return 0;
+    return patterns::COMBINATION_SCORE[detail::threat_to_int(one)][detail::threat_to_int(two)];
 }
 
 //===============================================================================
-// BOARD EVALUATION TEMPLATES
+// BITBOARD EVALUATION KERNELS
 //===============================================================================
 
-template<int Size> requires ValidBoardSize<Size>
-[[nodiscard]] int calc_score_at(const Board<Size>& board, Player player, const Position& pos) {
-    populate_threat_matrix();
-
+[[nodiscard]] int calc_score_at(const BitBoard& board, Player player, const Position& pos) {
     // Don't evaluate if position is out of bounds
-    if (!board.is_valid_position(pos)) {
+    if (player == Player::Empty || !pos.is_valid(board.size())) {
         return 0;
     }
 
-    int total_score = 0;
-    std::array<ThreatType, NUM_DIRECTIONS> threats;
-
     // Analyze all four directions - simulate placing the stone
+    std::array<ThreatType, NUM_DIRECTIONS> threats;
     for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
-        auto line = board.get_line(pos, DIRECTIONS[dir]);
-        std::array<Player, NEED_TO_WIN * 2 - 1> player_line;
-        std::ranges::copy(line, player_line.begin());
-
-        // The center position should be the player we're evaluating for
-        player_line[NEED_TO_WIN - 1] = player;
-
-        ThreatType threat = calc_threat_in_one_dimension(player_line, player);
-        threats[dir] = threat;
-        total_score += detail::threat_cost[detail::threat_to_int(threat)];
+        threats[dir] = calc_threat_at(board, player, dir, pos.x, pos.y);
     }
 
-    // Add combination bonuses
-    for (int i = 0; i < NUM_DIRECTIONS; ++i) {
-        for (int j = i + 1; j < NUM_DIRECTIONS; ++j) {
-            total_score += calc_combination_threat(threats[i], threats[j]);
-        }
-    }
+    return score_threats(threats);
+}
 
-    return total_score;
+[[nodiscard]] ThreatType calc_threat_at(const BitBoard& board, Player player, int dir, int x, int y) noexcept {
+    uint32_t own = board.window(player, dir, x, y) | BitBoard::WINDOW_CENTER_BIT;
+    uint32_t opp = board.window(other_player(player), dir, x, y) & ~BitBoard::WINDOW_CENTER_BIT;
+    return calc_threat_in_window(own, opp);
 }
 
-template<int Size> requires ValidBoardSize<Size>
-[[nodiscard]] int evaluate_position_incremental(const Board<Size>& board, Player player,
-                                               const Position& last_move) {
-    populate_threat_matrix();
+[[nodiscard]] int score_threats(std::span<const ThreatType, NUM_DIRECTIONS> threats) noexcept {
+    using patterns::THREAT_SCORE;
+    using patterns::COMBINATION_SCORE;
+    using detail::threat_to_int;
+
+    int t0 = threat_to_int(threats[0]);
+    int t1 = threat_to_int(threats[1]);
+    int t2 = threat_to_int(threats[2]);
+    int t3 = threat_to_int(threats[3]);
+
+    // Per-direction scores plus the bonus for each ordered pair of directions
+    return THREAT_SCORE[t0] + THREAT_SCORE[t1] + THREAT_SCORE[t2] + THREAT_SCORE[t3]
+         + COMBINATION_SCORE[t0][t1] + COMBINATION_SCORE[t0][t2] + COMBINATION_SCORE[t0][t3]
+         + COMBINATION_SCORE[t1][t2] + COMBINATION_SCORE[t1][t3]
+         + COMBINATION_SCORE[t2][t3];
+}
 
-    int total_score = 0;
+[[nodiscard]] int evaluate_position_incremental(const BitBoard& board, Player player,
+                                               const Position& last_move) {
     Player opponent = other_player(player);
 
     // Check for immediate win/loss first
-    if (board.has_winner(player)) {
+    if (board.has_five(player)) {
         return WIN_SCORE;
     }
-    if (board.has_winner(opponent)) {
+    if (board.has_five(opponent)) {
         return LOSE_SCORE;
     }
 
     // Only evaluate positions within radius of the last move for speed
     constexpr int eval_radius = 3;
     int min_x = std::max(0, last_move.x - eval_radius);
-    int max_x = std::min(Size - 1, last_move.x + eval_radius);
+    int max_x = std::min(board.size() - 1, last_move.x + eval_radius);
     int min_y = std::max(0, last_move.y - eval_radius);
-    int max_y = std::min(Size - 1, last_move.y + eval_radius);
-
-    for (int i = min_x; i <= max_x; ++i) {
-        for (int j = min_y; j <= max_y; ++j) {
-            Position pos{i, j};
-            if (board.at(pos) == player) {
-                total_score += calc_score_at(board, player, pos);
-            } else if (board.at(pos) == opponent) {
-                total_score -= calc_score_at(board, opponent, pos);
-            }
-        }
-    }
+    int max_y = std::min(board.size() - 1, last_move.y + eval_radius);
+
+    int total_score = 0;
+    board.for_each_stone(player, min_x, max_x, min_y, max_y, [&](int x, int y) {
+        total_score += calc_score_at(board, player, Position{x, y});
+    });
+    board.for_each_stone(opponent, min_x, max_x, min_y, max_y, [&](int x, int y) {
+        total_score -= calc_score_at(board, opponent, Position{x, y});
+    });
 
     return total_score;
 }
 
-template<int Size> requires ValidBoardSize<Size>
-[[nodiscard]] int evaluate_position(const Board<Size>& board, Player player) {
-    populate_threat_matrix();
-
-    int total_score = 0;
+[[nodiscard]] int evaluate_position(const BitBoard& board, Player player) {
     Player opponent = other_player(player);
 
     // Check for immediate win/loss first
-    if (board.has_winner(player)) {
+    if (board.has_five(player)) {
         return WIN_SCORE;
     }
-    if (board.has_winner(opponent)) {
+    if (board.has_five(opponent)) {
         return LOSE_SCORE;
     }
 
-    // Evaluate all positions
-    for (int i = 0; i < Size; ++i) {
-        for (int j = 0; j < Size; ++j) {
-            Position pos{i, j};
-            if (board.at(pos) == player) {
-                total_score += calc_score_at(board, player, pos);
-            } else if (board.at(pos) == opponent) {
-                total_score -= calc_score_at(board, opponent, pos);
-            }
-        }
-    }
+    // Evaluate all stones
+    int total_score = 0;
+    board.for_each_stone(player, [&](int x, int y) {
+        total_score += calc_score_at(board, player, Position{x, y});
+    });
+    board.for_each_stone(opponent, [&](int x, int y) {
+        total_score -= calc_score_at(board, opponent, Position{x, y});
+    });
 
     return total_score;
 }
 
+//===============================================================================
+// BOARD EVALUATION TEMPLATES
+//===============================================================================
+
+template<int Size> requires ValidBoardSize<Size>
+[[nodiscard]] int calc_score_at(const Board<Size>& board, Player player, const Position& pos) {
+    return calc_score_at(detail::to_bitboard(board), player, pos);
+}
+
+template<int Size> requires ValidBoardSize<Size>
+[[nodiscard]] int evaluate_position_incremental(const Board<Size>& board, Player player,
+                                               const Position& last_move) {
+    return evaluate_position_incremental(detail::to_bitboard(board), player, last_move);
+}
+
+template<int Size> requires ValidBoardSize<Size>
+[[nodiscard]] int evaluate_position(const Board<Size>& board, Player player) {
+    return evaluate_position(detail::to_bitboard(board), player);
+}
+
 //===============================================================================
 // EXPLICIT TEMPLATE INSTANTIATIONS
 //===============================================================================
@@ -303,102 +400,43 @@ using namespace gomoku;
 using namespace gomoku::detail;
 
 int evaluate_position(int** board, int size, int player) {
-    // Convert to C++ types and delegate
-    Player cpp_player = int_to_player(player);
-
-    if (size == 15) {
-        Board<15> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::evaluate_position(cpp_board, cpp_player);
-    } else if (size == 19) {
-        Board<19> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::evaluate_position(cpp_board, cpp_player);
+    if (!is_supported_size(size)) {
+        return 0;
     }
 
-    return 0;
+    BitBoard bits;
+    bits.load(board, size);
+    return gomoku::evaluate_position(bits, int_to_player(player));
 }
 
 int evaluate_position_incremental(int** board, int size, int player, int last_x, int last_y) {
-    Player cpp_player = int_to_player(player);
-    Position last_move{last_x, last_y};
-
-    if (size == 15) {
-        Board<15> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::evaluate_position_incremental(cpp_board, cpp_player, last_move);
-    } else if (size == 19) {
-        Board<19> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::evaluate_position_incremental(cpp_board, cpp_player, last_move);
+    if (!is_supported_size(size)) {
+        return 0;
     }
 
-    return 0;
+    BitBoard bits;
+    bits.load(board, size);
+    return gomoku::evaluate_position_incremental(bits, int_to_player(player), Position{last_x, last_y});
 }
 
 int has_winner(int** board, int size, int player) {
-    Player cpp_player = int_to_player(player);
-
-    if (size == 15) {
-        Board<15> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return cpp_board.has_winner(cpp_player) ? 1 : 0;
-    } else if (size == 19) {
-        Board<19> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return cpp_board.has_winner(cpp_player) ? 1 : 0;
+    if (!is_supported_size(size)) {
+        return 0; // Unsupported board size
     }
-    
-    return 0; // Unsupported board size
+
+    BitBoard bits;
+    bits.load(board, size);
+    return bits.has_five(int_to_player(player)) ? 1 : 0;
 }
 
 int calc_score_at(int** board, int size, int player, int x, int y) {
-    Player cpp_player = int_to_player(player);
-    Position pos{x, y};
-
-    if (size == 15) {
-        Board<15> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::calc_score_at(cpp_board, cpp_player, pos);
-    } else if (size == 19) {
-        Board<19> cpp_board;
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < size; ++j) {
-                cpp_board.set(i, j, int_to_player(board[i][j]));
-            }
-        }
-        return gomoku::calc_score_at(cpp_board, cpp_player, pos);
+    if (!is_supported_size(size)) {
+        return 0;
     }
 
-    return 0;
+    BitBoard bits;
+    bits.load(board, size);
+    return gomoku::calc_score_at(bits, int_to_player(player), Position{x, y});
 }
 
 int calc_threat_in_one_dimension(int* row, int player) {
@@ -414,6 +452,9 @@ int calc_threat_in_one_dimension(int* row, int player) {
 }
 
 int calc_combination_threat(int one, int two) {
+    if (one < 0 || two < 0 || one >= gomoku::patterns::THREAT_TYPES || two >= gomoku::patterns::THREAT_TYPES) {
+        return 0;
+    }
     return gomoku::calc_combination_threat(int_to_threat(one), int_to_threat(two));
 }
 
@@ -444,39 +485,27 @@ int minimax_example(int** board, int size, int depth, int alpha, int beta,
 
 // Board management functions for C interface
 int** create_board(int size) {
-    int **new_board = (int**)malloc(size * sizeof(int *));
+    // One allocation: the row pointer table followed by the cells, row-major
+    int **new_board = (int**)malloc(size * sizeof(int *) + size * size * sizeof(int));
     if (!new_board) {
         return NULL;
     }
 
+    int *cells = (int*)(new_board + size);
     for (int i = 0; i < size; i++) {
-        new_board[i] = (int*)malloc(size * sizeof(int));
-        if (!new_board[i]) {
-            // Free previously allocated rows on failure
-            for (int j = 0; j < i; j++) {
-                free(new_board[j]);
-            }
-            free(new_board);
-            return NULL;
-        }
+        new_board[i] = cells + i * size;
+    }
 
-        // Initialize cells to empty
-        for (int j = 0; j < size; j++) {
-            new_board[i][j] = detail::AI_CELL_EMPTY;
-        }
+    // Initialize cells to empty
+    for (int i = 0; i < size * size; i++) {
+        cells[i] = detail::AI_CELL_EMPTY;
     }
 
     return new_board;
 }
 
 void free_board(int** board, int size) {
-    if (!board) {
-        return;
-    }
-
-    for (int i = 0; i < size; i++) {
-        free(board[i]);
-    }
+    (void)size; // Rows live in the same block as the pointer table
     free(board);
 }
 
@@ -18,6 +18,8 @@
 #include <algorithm>
 #include <memory>
 #include <span>
+#include <type_traits>
+#include <utility>
 
 namespace gomoku {
 
@@ -92,6 +94,20 @@ enum class PlayerType : uint8_t {
 template<int Size>
 concept ValidBoardSize = (Size == 15 || Size == 19);
 
+/**
+ * Calls fn with board_size as a std::integral_constant, so that code
+ * templated on Size is picked once per call instead of branching on the size
+ * inside its loops. Only 15 and 19 reach here; every other size is refused
+ * where a game is configured.
+ */
+template<typename Fn>
+constexpr decltype(auto) dispatch_board_size(int board_size, Fn&& fn) {
+    if (board_size == 15) {
+        return std::forward<Fn>(fn)(std::integral_constant<int, 15>{});
+    }
+    return std::forward<Fn>(fn)(std::integral_constant<int, 19>{});
+}
+
 // Coordinate concept
 template<typename T>
 concept Coordinate = std::integral<T> && std::signed_integral<T>;
@@ -159,6 +175,12 @@ enum class Difficulty : uint8_t {
     Hard = 6
 };
 
+// Search the AI runs for its moves
+enum class SearchAlgorithm : uint8_t {
+    AlphaBeta,      // Iterative deepening alpha-beta, sequential or Lazy SMP
+    MonteCarlo      // Monte Carlo tree search (see MctsEngine)
+};
+
 //===============================================================================
 // SCORE CONSTANTS
 //===============================================================================
@@ -168,6 +190,10 @@ inline constexpr int LOSE_SCORE = -1'000'000;
 inline constexpr int MAX_DEPTH = 10;
 inline constexpr int DEPTH_WARNING_THRESHOLD = 7;
 
+// Bump whenever evaluate_position() or the search scores change meaning, so
+// that saved transposition table snapshots are discarded rather than trusted
+inline constexpr uint32_t EVALUATION_VERSION = 1;
+
 //===============================================================================
 // UNICODE DISPLAY CONSTANTS
 //===============================================================================
@@ -279,19 +305,93 @@ template<int Size> requires ValidBoardSize<Size>
 template<int Size> requires ValidBoardSize<Size>
 [[nodiscard]] int calc_score_at(const Board<Size>& board, Player player, const Position& pos);
 
+class BitBoard;
+
+/**
+ * Bitboard evaluation kernels used directly by the search.
+ * Same scoring as the Board<Size> templates, without copying the position.
+ */
+[[nodiscard]] int evaluate_position(const BitBoard& board, Player player);
+[[nodiscard]] int evaluate_position_incremental(const BitBoard& board, Player player,
+                                               const Position& last_move);
+[[nodiscard]] int calc_score_at(const BitBoard& board, Player player, const Position& pos);
+
 /**
  * Analyzes a single line/direction for threat patterns.
  */
 [[nodiscard]] ThreatType calc_threat_in_one_dimension(std::span<const Player> line, Player player);
 
+//===============================================================================
+// PATTERN TABLES
+//===============================================================================
+
+namespace patterns {
+    inline constexpr int WINDOW_SIZE = NEED_TO_WIN * 2 - 1;   // Cells in a classified line
+    inline constexpr int WINDOW_CENTER = NEED_TO_WIN - 1;     // Offset of the stone being classified
+    inline constexpr int SIDE_CELLS = WINDOW_SIZE - 1;        // Cells around it
+    inline constexpr size_t TABLE_SIZE = size_t{1} << (2 * SIDE_CELLS);
+    inline constexpr int THREAT_TYPES = static_cast<int>(ThreatType::ThreeAndThreeBroken) + 1;
+
+    /**
+     * Packs the eight cells around the center of a 9-bit window into 8 bits.
+     */
+    constexpr uint32_t side_cells(uint32_t window) noexcept {
+        constexpr uint32_t low = (1u << WINDOW_CENTER) - 1;
+        return (window & low) | ((window >> 1) & ~low & ((1u << SIDE_CELLS) - 1));
+    }
+
+    /**
+     * Index of a window into THREAT_TABLE: own side cells in the low byte,
+     * the opponent's in the high byte.
+     */
+    constexpr uint32_t key(uint32_t own, uint32_t opponent) noexcept {
+        return side_cells(own) | side_cells(opponent) << SIDE_CELLS;
+    }
+
+    /**
+     * ThreatType of every 9-cell window with the center owned, generated at
+     * compile time from the line scan of calc_threat_in_one_dimension().
+     */
+    extern const std::array<ThreatType, TABLE_SIZE> THREAT_TABLE;
+
+    /**
+     * Score of each ThreatType, and the bonus for a pair of threats through
+     * one stone indexed [earlier direction][later direction].
+     */
+    extern const std::array<int, THREAT_TYPES> THREAT_SCORE;
+    extern const std::array<std::array<int, THREAT_TYPES>, THREAT_TYPES> COMBINATION_SCORE;
+}
+
+/**
+ * Table lookup equivalent of calc_threat_in_one_dimension() over a 9-cell
+ * window. Bit i of own/opponent holds the cell at offset i - 4; the center
+ * bit of own must be set.
+ */
+[[nodiscard]] inline ThreatType calc_threat_in_window(uint32_t own, uint32_t opponent) noexcept {
+    return patterns::THREAT_TABLE[patterns::key(own, opponent)];
+}
+
+/**
+ * Threat formed along DIRECTIONS[dir] by a stone of player at (x, y); the
+ * cell itself is treated as player's whether or not it is occupied.
+ */
+[[nodiscard]] ThreatType calc_threat_at(const BitBoard& board, Player player, int dir, int x, int y) noexcept;
+
+/**
+ * Score of a stone from its threats in the four directions, including the
+ * combination bonuses. calc_score_at() is score_threats() over calc_threat_at().
+ */
+[[nodiscard]] int score_threats(std::span<const ThreatType, NUM_DIRECTIONS> threats) noexcept;
+
 /**
  * Calculates additional score for combinations of threats.
  */
 [[nodiscard]] int calc_combination_threat(ThreatType one, ThreatType two);
 
 /**
- * Initializes the threat scoring matrix.
- * Must be called before using evaluation functions.
+ * Formerly initialized the threat scoring matrix. The pattern and score
+ * tables are now compile-time constants, so this does nothing; it is kept
+ * for existing callers.
  */
 void populate_threat_matrix();
 
@@ -0,0 +1,146 @@
+//
+//  history_writer.cpp
+//  gomoku - Background appender for game history journals
+//
+//  Batching, per-file appends and syncs on the writer thread
+//
+
+#include "history_writer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <iostream>
+#include <map>
+#include <unistd.h>
+
+namespace gomoku {
+
+HistoryWriter::HistoryWriter(size_t queue_capacity)
+    : queue_capacity_(queue_capacity > 0 ? queue_capacity : 1), thread_([this] { run(); }) {}
+
+HistoryWriter::~HistoryWriter() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    not_empty_.notify_one();
+    thread_.join();
+}
+
+void HistoryWriter::append(std::string path, std::string data) {
+    push(Op{std::move(path), std::move(data), {}});
+}
+
+void HistoryWriter::then(std::function<void()> task) {
+    push(Op{{}, {}, std::move(task)});
+}
+
+void HistoryWriter::push(Op op) {
+    {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this] { return queue_.size() < queue_capacity_; });
+        queue_.push_back(std::move(op));
+        ++queued_;
+    }
+    not_empty_.notify_one();
+}
+
+void HistoryWriter::flush() {
+    std::unique_lock lock(mutex_);
+    uint64_t target = queued_;
+    drained_.wait(lock, [this, target] { return completed_ >= target; });
+}
+
+uint64_t HistoryWriter::write_errors() const {
+    std::lock_guard lock(mutex_);
+    return write_errors_;
+}
+
+void HistoryWriter::run() {
+    std::deque<Op> batch;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            batch.swap(queue_);
+        }
+        not_full_.notify_all();
+
+        size_t count = batch.size();
+        write_batch(batch);
+        batch.clear();
+
+        {
+            std::lock_guard lock(mutex_);
+            completed_ += count;
+        }
+        drained_.notify_all();
+    }
+}
+
+void HistoryWriter::write_batch(std::deque<Op>& batch) {
+    // Records for the same file are joined into one write; a task is a
+    // barrier, so the files are written out before it runs
+    std::map<std::string, std::string> pending;
+    auto write_pending = [&] {
+        for (const auto& [path, data] : pending) {
+            if (!append_to_file(path, data)) {
+                std::lock_guard lock(mutex_);
+                ++write_errors_;
+            }
+        }
+        pending.clear();
+    };
+
+    for (auto& op : batch) {
+        if (op.task) {
+            write_pending();
+            op.task();
+        } else {
+            pending[op.path] += op.data;
+        }
+    }
+    write_pending();
+}
+
+bool HistoryWriter::append_to_file(const std::string& path, const std::string& data) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    bool ok = fd >= 0;
+    const char* cursor = data.data();
+    size_t remaining = data.size();
+    while (ok && remaining > 0) {
+        ssize_t written = ::write(fd, cursor, remaining);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        ok = written > 0;
+        if (ok) {
+            cursor += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+    if (ok) {
+        ok = ::fsync(fd) == 0;
+    }
+    int error = errno;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    if (!ok && write_errors() == 0) {
+        std::cerr << std::format("Warning: cannot write game history {}: {}\n", path, std::strerror(error));
+    }
+    return ok;
+}
+
+HistoryWriter& shared_history_writer() {
+    static HistoryWriter writer;
+    return writer;
+}
+
+} // namespace gomoku
@@ -0,0 +1,98 @@
+//
+//  history_writer.hpp
+//  gomoku - Background appender for game history journals
+//
+//  Moves game log I/O off the game thread: records are queued and appended in batches
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace gomoku {
+
+/**
+ * Appends records to files on a single background thread.
+ *
+ * Producers queue a record and return at once; they only wait when
+ * queue_capacity records are already pending. The writer takes everything
+ * queued at once as a batch, appends each file's records with one write
+ * on an O_APPEND descriptor and syncs each file once per batch, so a busy
+ * self-play run pays one sync per file per batch rather than per move.
+ *
+ * A record is a whole line, so a crash can at worst leave a torn last
+ * line behind; readers of the journals skip it.
+ */
+class HistoryWriter {
+public:
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096;
+
+    explicit HistoryWriter(size_t queue_capacity = DEFAULT_QUEUE_CAPACITY);
+
+    // Writes out everything still queued before returning
+    ~HistoryWriter();
+
+    HistoryWriter(const HistoryWriter&) = delete;
+    HistoryWriter& operator=(const HistoryWriter&) = delete;
+
+    /**
+     * Queues data to be appended to path, creating the file if needed.
+     */
+    void append(std::string path, std::string data);
+
+    /**
+     * Queues task to run on the writer thread once everything queued before
+     * it has been written and synced. Used to finalize a journal after its
+     * last record; task must not throw.
+     */
+    void then(std::function<void()> task);
+
+    /**
+     * Blocks until everything queued before the call has been written.
+     */
+    void flush();
+
+    // Appends that could not be written; the first failure is also reported on stderr
+    [[nodiscard]] uint64_t write_errors() const;
+
+private:
+    struct Op {
+        std::string path;            // Empty for a task
+        std::string data;
+        std::function<void()> task;
+    };
+
+    void push(Op op);
+    void run();
+    void write_batch(std::deque<Op>& batch);
+    bool append_to_file(const std::string& path, const std::string& data);
+
+    size_t queue_capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable drained_;
+    std::deque<Op> queue_;
+    uint64_t queued_ = 0;       // Ops ever queued
+    uint64_t completed_ = 0;    // Ops ever written or run
+    uint64_t write_errors_ = 0;
+    bool stopping_ = false;
+
+    // Declared last, so the thread starts after the queue exists
+    std::thread thread_;
+};
+
+/**
+ * The writer every game history in the process shares.
+ */
+HistoryWriter& shared_history_writer();
+
+} // namespace gomoku
@@ -7,10 +7,12 @@
 
 #include "httpd_cli.hpp"
 #include "gomoku.hpp"
+#include "httpd_cluster.hpp"
 #include <iostream>
 #include <format>
 #include <charconv>
 #include <algorithm>
+#include <cstdlib>
 
 namespace gomoku::httpd {
 
@@ -26,6 +28,16 @@ const char* cli_error_to_string(CliError error) {
             return "Invalid depth (must be 1-10)";
         case CliError::InvalidThreads:
             return "Invalid thread count (must be 1-64)";
+        case CliError::InvalidTableSize:
+            return "Invalid transposition table size (must be 1-4096 MB)";
+        case CliError::InvalidCacheSize:
+            return "Invalid session cache size (must be 0-100000 games)";
+        case CliError::InvalidQueueSize:
+            return "Invalid search queue size (must be 1-1024 searches)";
+        case CliError::InvalidSnapshotInterval:
+            return "Invalid snapshot interval (must be 0-86400 seconds)";
+        case CliError::InvalidPeers:
+            return "Invalid peer list (must be host:port,...)";
         case CliError::HelpRequested:
             return "Help requested";
         default:
@@ -56,16 +68,36 @@ OPTIONS:
     -v, --version            Show version information
     -p, --port <PORT>        TCP port to bind to (default: 5500)
     -H, --host <HOST>        IP address to bind to (default: 0.0.0.0)
-    -t, --threads <COUNT>    Number of worker threads (default: CPU cores - 1)
+    -t, --threads <COUNT>    Number of concurrent searches (default: CPU cores - 1)
     -d, --depth <DEPTH>      AI search depth (default: 6, range: 1-10)
+    --tt-size <MB>           Shared transposition table size (default: 64, range: 1-4096)
+    --session-cache <COUNT>  Games kept in memory between requests (default: 128, 0 disables)
+    --search-queue <COUNT>   Searches waiting for a worker before 429 (default: 64, range: 1-1024)
+    --search-threads <COUNT> Lazy SMP threads shared by all searches (default: 0 = CPU cores - 1)
+    --book <PATH>            Opening book built by gomoku-book, probed before searching
+    --tt-snapshot <PATH>     Load the transposition table from PATH at startup and save it back
+    --tt-snapshot-interval <SECONDS>
+                             Seconds between snapshots (default: 300, 0 = only on shutdown)
+    --peers <HOST:PORT,...>  Other gomoku-httpd daemons to split deep searches' root moves with
+    --peer-timeout <MS>      Longest a peer may take per move before its moves are searched here
+                             (default: 10000, range: 100-600000)
+    --peer-min-depth <DEPTH> Shallowest search split with peers (default: 8, range: 1-10)
+    --cluster-key <SECRET>   Secret shared by the daemons of a cluster, required with --peers and
+                             for serving peers (default: $GOMOKU_CLUSTER_KEY)
     --daemon                 Run as daemon (detach from TTY)
     --foreground             Run in foreground (for testing, default behavior)
     --verbose                Enable verbose logging
+    --search-metrics         Count nodes, cutoffs and phase times inside searches for /metrics
 
 ENDPOINTS:
     GET  /ai/v1/status       Server health and system metrics
     POST /ai/v1/move         Request AI move for game position
+    POST /ai/v1/moves:batch  AI moves for an array of positions, streamed as NDJSON
     GET  /gomoku.schema.json JSON schema for game state format
+    GET  /metrics            Request, queue and search metrics in Prometheus text format
+    POST /ai/v1/internal/subtree
+                             Root moves scored for a --peers coordinator, streamed as NDJSON;
+                             served only with --cluster-key, to callers presenting the key
 
 EXAMPLES:
     {} --port 8080 --threads 4 --depth 8
@@ -83,6 +115,11 @@ void print_version() {
 std::expected<HttpDaemonConfig, CliError> parse_command_line(int argc, char* argv[]) {
     HttpDaemonConfig config;
     
+    // Read from the environment by default, so the secret stays out of the process list
+    if (const char* key = std::getenv("GOMOKU_CLUSTER_KEY")) {
+        config.cluster_key = key;
+    }
+    
     std::span<char*> args(argv, argc);
     
     for (size_t i = 1; i < args.size(); ++i) {
@@ -113,6 +150,11 @@ std::expected<HttpDaemonConfig, CliError> parse_command_line(int argc, char* arg
             continue;
         }
         
+        if (arg == "--search-metrics") {
+            config.search_metrics = true;
+            continue;
+        }
+        
         // Arguments that require values
         if (i + 1 >= args.size()) {
             std::cerr << std::format("Error: {} requires a value\n", arg);
@@ -161,6 +203,18 @@ std::expected<HttpDaemonConfig, CliError> parse_command_line(int argc, char* arg
             continue;
         }
         
+        if (arg == "--search-threads") {
+            auto threads_result = parse_int(value);
+            if (!threads_result || !is_valid_search_threads(*threads_result)) {
+                std::cerr << std::format("Error: Invalid search thread count '{}' (0-64)\n", value);
+                return std::unexpected(CliError::InvalidThreads);
+            }
+            
+            config.search_threads = *threads_result;
+            ++i;
+            continue;
+        }
+        
         if (arg == "-d" || arg == "--depth") {
             auto depth_result = parse_int(value);
             if (!depth_result) {
@@ -178,10 +232,118 @@ std::expected<HttpDaemonConfig, CliError> parse_command_line(int argc, char* arg
             continue;
         }
         
+        if (arg == "--tt-size") {
+            auto size_result = parse_int(value);
+            if (!size_result || !is_valid_tt_size(*size_result)) {
+                std::cerr << std::format("Error: Invalid transposition table size '{}' (1-4096 MB)\n", value);
+                return std::unexpected(CliError::InvalidTableSize);
+            }
+            
+            config.tt_size_mb = *size_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--session-cache") {
+            auto size_result = parse_int(value);
+            if (!size_result || !is_valid_session_cache_size(*size_result)) {
+                std::cerr << std::format("Error: Invalid session cache size '{}' (0-100000 games)\n", value);
+                return std::unexpected(CliError::InvalidCacheSize);
+            }
+            
+            config.session_cache_size = *size_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--search-queue") {
+            auto size_result = parse_int(value);
+            if (!size_result || !is_valid_search_queue_size(*size_result)) {
+                std::cerr << std::format("Error: Invalid search queue size '{}' (1-1024 searches)\n", value);
+                return std::unexpected(CliError::InvalidQueueSize);
+            }
+            
+            config.search_queue_size = *size_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--book") {
+            config.book_path = value;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--tt-snapshot") {
+            config.tt_snapshot_path = value;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--tt-snapshot-interval") {
+            auto seconds_result = parse_int(value);
+            if (!seconds_result || !is_valid_snapshot_interval(*seconds_result)) {
+                std::cerr << std::format("Error: Invalid snapshot interval '{}' (0-86400 seconds)\n", value);
+                return std::unexpected(CliError::InvalidSnapshotInterval);
+            }
+            
+            config.tt_snapshot_interval = *seconds_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--peers") {
+            auto peers = parse_peer_list(value);
+            if (!peers) {
+                std::cerr << std::format("Error: {}\n", peers.error());
+                return std::unexpected(CliError::InvalidPeers);
+            }
+            
+            config.peers = value;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--peer-timeout") {
+            auto timeout_result = parse_int(value);
+            if (!timeout_result || !is_valid_peer_timeout(*timeout_result)) {
+                std::cerr << std::format("Error: Invalid peer timeout '{}' (100-600000 ms)\n", value);
+                return std::unexpected(CliError::InvalidPeers);
+            }
+            
+            config.peer_timeout_ms = *timeout_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--peer-min-depth") {
+            auto depth_result = parse_int(value);
+            if (!depth_result || !is_valid_depth(*depth_result)) {
+                std::cerr << std::format("Error: Invalid peer minimum depth '{}' (1-10)\n", value);
+                return std::unexpected(CliError::InvalidDepth);
+            }
+            
+            config.peer_min_depth = *depth_result;
+            ++i;
+            continue;
+        }
+        
+        if (arg == "--cluster-key") {
+            config.cluster_key = value;
+            ++i;
+            continue;
+        }
+        
         std::cerr << std::format("Error: Unknown argument '{}'\n", arg);
         return std::unexpected(CliError::InvalidArgument);
     }
     
+    // Peers only serve subtrees to callers that present the cluster's key
+    if (!config.peers.empty() && config.cluster_key.empty()) {
+        std::cerr << "Error: --peers needs a --cluster-key shared with the peers\n";
+        return std::unexpected(CliError::InvalidPeers);
+    }
+    
     return config;
 }
 
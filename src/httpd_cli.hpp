@@ -21,6 +21,11 @@ enum class CliError {
     InvalidPort,
     InvalidDepth,
     InvalidThreads,
+    InvalidTableSize,
+    InvalidCacheSize,
+    InvalidQueueSize,
+    InvalidSnapshotInterval,
+    InvalidPeers,
     HelpRequested
 };
 
@@ -32,9 +37,21 @@ struct HttpDaemonConfig {
         return cores > 1 ? cores - 1 : 1; 
     }();
     int depth = 6;
+    int tt_size_mb = 64;
+    int session_cache_size = 128;
+    int search_queue_size = 64;
+    int search_threads = 0;        // Threads per search; 0 = CPU cores - 1
+    std::string book_path;         // Opening book built by gomoku-book; empty = none
+    std::string tt_snapshot_path;  // Transposition table kept across restarts; empty = none
+    int tt_snapshot_interval = 300; // Seconds between snapshots; 0 = only on shutdown
+    std::string peers;             // host:port,... daemons to split deep searches with; empty = none
+    int peer_timeout_ms = 10000;   // Longest a peer may go without sending a score
+    int peer_min_depth = 8;        // Shallower searches stay local
+    std::string cluster_key;       // Secret peers present to the subtree endpoint; empty = endpoint off
     bool daemon_mode = false;
     bool foreground_mode = false;
     bool verbose = false;
+    bool search_metrics = false;   // Count search internals for /metrics
 };
 
 constexpr bool is_valid_port(int port) noexcept {
@@ -49,6 +66,30 @@ constexpr bool is_valid_threads(int threads) noexcept {
     return threads >= 1 && threads <= 64;
 }
 
+constexpr bool is_valid_search_threads(int threads) noexcept {
+    return threads >= 0 && threads <= 64;
+}
+
+constexpr bool is_valid_tt_size(int megabytes) noexcept {
+    return megabytes >= 1 && megabytes <= 4096;
+}
+
+constexpr bool is_valid_session_cache_size(int games) noexcept {
+    return games >= 0 && games <= 100000;
+}
+
+constexpr bool is_valid_search_queue_size(int searches) noexcept {
+    return searches >= 1 && searches <= 1024;
+}
+
+constexpr bool is_valid_snapshot_interval(int seconds) noexcept {
+    return seconds >= 0 && seconds <= 86400;
+}
+
+constexpr bool is_valid_peer_timeout(int milliseconds) noexcept {
+    return milliseconds >= 100 && milliseconds <= 600000;
+}
+
 std::expected<HttpDaemonConfig, CliError> parse_command_line(int argc, char* argv[]);
 
 void print_help(std::string_view program_name);
@@ -0,0 +1,440 @@
+//
+//  httpd_cluster.cpp
+//  gomoku-httpd - Root-split search across peer daemons
+//
+//  Subtree wire format, peer requests and the merge of their scores with local ones
+//
+
+#include "httpd_cluster.hpp"
+#include "httpd_game_api.hpp"
+#include "httpd_wire.hpp"
+#include "httplib.h"
+#include "ai.h"
+#include "search_metrics.hpp"
+#include "search_scratch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <thread>
+
+namespace gomoku::httpd {
+
+std::expected<std::vector<PeerAddress>, std::string> parse_peer_list(std::string_view list) {
+    std::vector<PeerAddress> peers;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view entry = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+        size_t colon = entry.rfind(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return std::unexpected(std::format("Peer '{}' is not host:port", entry));
+        }
+        int port = 0;
+        std::string_view digits = entry.substr(colon + 1);
+        auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), port);
+        if (error != std::errc{} || end != digits.data() + digits.size() || port < 1 || port > 65535) {
+            return std::unexpected(std::format("Peer '{}' has an invalid port", entry));
+        }
+        peers.push_back(PeerAddress{std::string(entry.substr(0, colon)), port});
+    }
+    if (peers.empty()) {
+        return std::unexpected("The peer list is empty");
+    }
+    return peers;
+}
+
+//===============================================================================
+// SUBTREE PROTOCOL
+//===============================================================================
+
+json SubtreeRequest::to_json() const {
+    json document;
+    document["board_size"] = board_size;
+    document["board_packed"] = json::binary(board_packed);
+    document["to_move"] = to_move == Player::Cross ? "x" : "o";
+    document["depth"] = depth;
+    document["alpha"] = alpha;
+    document["timeout_ms"] = timeout_ms;
+
+    // Flat x, y pairs keep the MessagePack body to a couple of bytes per move
+    json flat = json::array();
+    for (const Position& move : moves) {
+        flat.push_back(move.x);
+        flat.push_back(move.y);
+    }
+    document["moves"] = std::move(flat);
+    return document;
+}
+
+std::expected<SubtreeRequest, std::string> SubtreeRequest::from_json(const json& document) {
+    try {
+        SubtreeRequest request;
+        request.board_size = document.at("board_size").get<int>();
+        if (request.board_size != 15 && request.board_size != 19) {
+            return std::unexpected("board_size must be 15 or 19");
+        }
+
+        // JSON has no binary type, so a JSON body carries the bytes as an array
+        const json& packed = document.at("board_packed");
+        request.board_packed = packed.is_binary() ? std::vector<uint8_t>(packed.get_binary())
+                                                  : packed.get<std::vector<uint8_t>>();
+
+        std::string to_move = document.at("to_move").get<std::string>();
+        if (to_move != "x" && to_move != "o") {
+            return std::unexpected("to_move must be \"x\" or \"o\"");
+        }
+        request.to_move = to_move == "x" ? Player::Cross : Player::Naught;
+
+        request.depth = document.at("depth").get<int>();
+        if (request.depth < 1 || request.depth > MAX_DEPTH) {
+            return std::unexpected(std::format("depth must be 1-{}", MAX_DEPTH));
+        }
+        request.alpha = document.value("alpha", -WIN_SCORE - 1);
+        request.timeout_ms = std::max(document.value("timeout_ms", 0), 0);
+
+        const json& flat = document.at("moves");
+        if (!flat.is_array() || flat.size() % 2 != 0) {
+            return std::unexpected("moves must be a flat array of x, y pairs");
+        }
+        for (size_t i = 0; i < flat.size(); i += 2) {
+            Position move(flat[i].get<int>(), flat[i + 1].get<int>());
+            if (!move.is_valid(request.board_size)) {
+                return std::unexpected(std::format("move ({}, {}) is off the board", move.x, move.y));
+            }
+            request.moves.push_back(move);
+        }
+        return request;
+
+    } catch (const json::exception& e) {
+        return std::unexpected(std::format("Invalid subtree request: {}", e.what()));
+    }
+}
+
+json SubtreeScore::to_json() const {
+    json line;
+    line["x"] = move.x;
+    line["y"] = move.y;
+    line["score"] = score;
+    line["nodes"] = nodes;
+    return line;
+}
+
+std::expected<SubtreeScore, std::string> SubtreeScore::from_json(const json& line) {
+    try {
+        SubtreeScore score;
+        score.move = Position(line.at("x").get<int>(), line.at("y").get<int>());
+        score.score = line.at("score").get<int>();
+        score.nodes = line.value("nodes", uint64_t{0});
+        return score;
+    } catch (const json::exception& e) {
+        return std::unexpected(std::format("Invalid subtree score: {}", e.what()));
+    }
+}
+
+//===============================================================================
+// ROOT SPLIT SEARCH
+//===============================================================================
+
+struct RootSplitSearch::Peer {
+    PeerAddress address;
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> moves{0};         // Root moves the peer scored
+    std::atomic<uint64_t> failures{0};      // Requests whose moves were searched locally instead
+};
+
+/**
+ * The state one run() shares with its peer threads.
+ */
+struct RootSplitSearch::Split {
+    SubtreeRequest position;                // Every field but alpha, timeout_ms and moves
+    game_state_t* game;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Position> pending;           // Not yet dealt out
+    std::deque<Position> returned;          // Given back by failed peers, searched here first
+    int in_flight = 0;                      // Chunks out on peers
+    int best_score = -WIN_SCORE - 1;
+    Position best{-1, -1};
+    int scored = 0;
+    std::vector<httplib::Client*> clients;  // Peer connections, cut once the search stops
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> peer_nodes{0};
+
+    // Drops peer requests still in flight, so none holds the reply past the deadline
+    void cancel_peers() {
+        std::lock_guard lock(mutex);
+        stop.store(true);
+        for (httplib::Client* client : clients) {
+            client->stop();
+        }
+    }
+
+    void record(const SubtreeScore& result) {
+        std::lock_guard lock(mutex);
+        if (result.score > best_score) {
+            best_score = result.score;
+            best = result.move;
+        }
+        ++scored;
+    }
+};
+
+RootSplitSearch::RootSplitSearch(std::vector<PeerAddress> peers, std::chrono::milliseconds peer_timeout,
+                                 std::string cluster_key)
+    : peer_timeout_(peer_timeout), cluster_key_(std::move(cluster_key)) {
+    for (auto& address : peers) {
+        auto peer = std::make_unique<Peer>();
+        peer->address = std::move(address);
+        peers_.push_back(std::move(peer));
+    }
+}
+
+RootSplitSearch::~RootSplitSearch() = default;
+
+json RootSplitSearch::metrics() const {
+    json peers = json::array();
+    for (const auto& peer : peers_) {
+        json entry;
+        entry["peer"] = std::format("{}:{}", peer->address.host, peer->address.port);
+        entry["requests"] = peer->requests.load(std::memory_order_relaxed);
+        entry["moves"] = peer->moves.load(std::memory_order_relaxed);
+        entry["failures"] = peer->failures.load(std::memory_order_relaxed);
+        peers.push_back(std::move(entry));
+    }
+    return peers;
+}
+
+void RootSplitSearch::search_on_peer(Peer& peer, Split& split) const {
+    httplib::Client client(peer.address.host, peer.address.port);
+    struct Registration {
+        Split& split;
+        httplib::Client* client;
+        ~Registration() {
+            std::lock_guard lock(split.mutex);
+            std::erase(split.clients, client);
+        }
+    };
+    {
+        std::lock_guard lock(split.mutex);
+        split.clients.push_back(&client);
+    }
+    Registration registration{split, &client};
+
+    const game_state_t* game = split.game;
+    for (;;) {
+        SubtreeRequest request = split.position;
+        {
+            std::lock_guard lock(split.mutex);
+            if (split.stop.load() || split.pending.empty()) {
+                return;
+            }
+            while (!split.pending.empty() && request.moves.size() < static_cast<size_t>(CHUNK_MOVES)) {
+                request.moves.push_back(split.pending.front());
+                split.pending.pop_front();
+            }
+            request.alpha = split.best_score;
+            ++split.in_flight;
+        }
+
+        // The peer gets what is left of this search's own time budget, and is waited
+        // on no longer than that: cancel_peers() misses a request not yet connected
+        std::chrono::milliseconds timeout = peer_timeout_;
+        if (game->search_timeout_ms > 0) {
+            double left_ms = game->search_timeout_ms - (get_current_time() - game->search_start_time) * 1000.0;
+            request.timeout_ms = std::max(static_cast<int>(left_ms), 1);
+            timeout = std::min(timeout, std::chrono::milliseconds(request.timeout_ms));
+        }
+        client.set_connection_timeout(timeout);
+        client.set_read_timeout(timeout);
+        client.set_write_timeout(timeout);
+
+        peer.requests.fetch_add(1, std::memory_order_relaxed);
+        std::vector<Position> unscored = request.moves;
+        std::string buffer;
+        httplib::Headers headers{{"Accept", "application/x-ndjson"}, {SubtreeRequest::KEY_HEADER, cluster_key_}};
+        auto result = client.Post(SubtreeRequest::PATH, headers,
+            encode_body(request.to_json(), WireFormat::MessagePack), wire_content_type(WireFormat::MessagePack),
+            [&](const char* data, size_t length) {
+                buffer.append(data, length);
+                for (size_t newline; (newline = buffer.find('\n')) != std::string::npos; buffer.erase(0, newline + 1)) {
+                    json line = json::parse(buffer.substr(0, newline), nullptr, false);
+                    auto score = SubtreeScore::from_json(line);
+                    auto match = score ? std::ranges::find(unscored, score->move) : unscored.end();
+                    if (match == unscored.end()) {
+                        continue;
+                    }
+                    unscored.erase(match);
+                    split.record(*score);
+                    split.peer_nodes.fetch_add(score->nodes, std::memory_order_relaxed);
+                    peer.moves.fetch_add(1, std::memory_order_relaxed);
+                }
+                return !split.stop.load();
+            });
+
+        // A peer that timed out, refused or stopped short gives its moves back
+        bool complete = result && result->status == 200 && unscored.empty();
+        {
+            std::lock_guard lock(split.mutex);
+            --split.in_flight;
+            if (!complete) {
+                split.returned.insert(split.returned.end(), unscored.begin(), unscored.end());
+            }
+        }
+        split.changed.notify_all();
+        if (!complete) {
+            if (!split.stop.load()) {
+                peer.failures.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+    }
+}
+
+SearchResult RootSplitSearch::run(game_state_t& game) {
+    ScratchLease lease(&game);
+    SearchMetricsScope metrics(&game);
+
+    game.search_start_time = get_current_time();
+    game.search_timed_out = 0;
+    game.search_depth_reached = 0;
+    game.search_nodes = 0;
+    game.search_tt_probes = 0;
+    game.search_tt_hits = 0;
+    game.search_moves_evaluated = 0;
+    if (game.transposition_table) {
+        game.transposition_table->new_search();
+    }
+
+    SearchResult result;
+    auto finish = [&](int x, int y, int score) {
+        result.move = Position{x, y};
+        result.depth = game.search_depth_reached;
+        result.score = score;
+        result.nodes = game.search_nodes;
+        result.moves_evaluated = game.search_moves_evaluated;
+        result.elapsed_ms = (get_current_time() - game.search_start_time) * 1000.0;
+        result.stopped = game.search_timed_out != 0;
+        return result;
+    };
+
+    int x = -1, y = -1;
+    if (probe_opening_book(&game, &x, &y)) {
+        return finish(x, y, 0);
+    }
+    if (game.bitboard.stone_count() <= 1) {
+        find_first_ai_move(&game, &x, &y);
+        game.search_depth_reached = 1;
+        add_ai_history_entry(&game, 1);
+        return finish(x, y, 0);
+    }
+
+    std::vector<move_t> moves(static_cast<size_t>(game.board_size * game.board_size));
+    int move_count = generate_moves_optimized(&game, moves.data(), game.current_player);
+    for (int i = 0; i < move_count; i++) {
+        if (evaluate_threat_fast(game.bitboard, moves[i].x, moves[i].y, game.current_player) >= 100000) {
+            game.search_depth_reached = 1;
+            add_ai_history_entry(&game, 1);
+            return finish(moves[i].x, moves[i].y, WIN_SCORE);
+        }
+    }
+    if (find_forced_win(&game, &x, &y)) {
+        return finish(x, y, 0);
+    }
+    if (move_count == 0) {
+        return finish(-1, -1, 0);
+    }
+    qsort(moves.data(), move_count, sizeof(move_t), compare_moves);
+
+    // The first move sets alpha for the rest, so it is searched here in full
+    int depth = std::max(game.max_depth, 1);
+    int first_score = search_root_move(&game, moves[0].x, moves[0].y, depth, -WIN_SCORE - 1);
+    if (game.search_timed_out) {
+        add_ai_history_entry(&game, 0);
+        return finish(moves[0].x, moves[0].y, 0);
+    }
+
+    Split split;
+    split.game = &game;
+    split.position.board_size = game.board_size;
+    split.position.board_packed = GameAPI::pack_board(game.board, game.board_size);
+    split.position.to_move = static_cast<Player>(game.current_player);
+    split.position.depth = depth;
+    split.best_score = first_score;
+    split.best = Position(moves[0].x, moves[0].y);
+    split.scored = 1;
+    for (int i = 1; i < move_count; i++) {
+        split.pending.emplace_back(moves[i].x, moves[i].y);
+    }
+
+    // A won line needs no other move looked at
+    std::vector<std::jthread> peer_threads;
+    if (first_score < WIN_SCORE - 1000) {
+        for (const auto& peer : peers_) {
+            peer_threads.emplace_back([this, &peer, &split] { search_on_peer(*peer, split); });
+        }
+    } else {
+        split.pending.clear();
+    }
+
+    // This thread takes chunks too, and searches whatever failed peers give back
+    for (;;) {
+        Position move;
+        int alpha;
+        {
+            std::unique_lock lock(split.mutex);
+            while (split.returned.empty() && split.pending.empty() && split.in_flight > 0 &&
+                   !is_search_timed_out(&game)) {
+                split.changed.wait_for(lock, std::chrono::milliseconds(50));
+            }
+            std::deque<Position>& source = split.returned.empty() ? split.pending : split.returned;
+            if (source.empty() || split.best_score >= WIN_SCORE - 1000) {
+                break;
+            }
+            move = source.front();
+            source.pop_front();
+            alpha = split.best_score;
+        }
+
+        if (is_search_timed_out(&game)) {
+            game.search_timed_out = 1;
+            break;
+        }
+        int score = search_root_move(&game, move.x, move.y, depth, alpha);
+        if (game.search_timed_out) {
+            break;
+        }
+        split.record(SubtreeScore{move, score, 0});
+    }
+
+    // Past the deadline, peers still searching are cut off mid-stream
+    split.cancel_peers();
+    peer_threads.clear();
+
+    bool complete = split.scored == move_count || split.best_score >= WIN_SCORE - 1000;
+    if (is_search_timed_out(&game) && !complete) {
+        game.search_timed_out = 1;
+    }
+    game.search_nodes += split.peer_nodes.load();
+    game.search_moves_evaluated = split.scored;
+    if (complete) {
+        game.search_depth_reached = depth;
+        report_search_depth(&game, &game, depth, split.best_score, split.best.x, split.best.y, game.search_nodes);
+    }
+
+    snprintf(game.ai_status_message, sizeof(game.ai_status_message),
+            "Split over %zu peers in %.0fs (checked %d moves)",
+            peers_.size(), get_current_time() - game.search_start_time, split.scored);
+    add_ai_history_entry(&game, split.scored);
+    return finish(split.best.x, split.best.y, split.best_score);
+}
+
+} // namespace gomoku::httpd
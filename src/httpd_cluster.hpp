@@ -0,0 +1,130 @@
+//
+//  httpd_cluster.hpp
+//  gomoku-httpd - Root-split search across peer daemons
+//
+//  Deals a position's root moves out to other gomoku-httpd instances and merges their scores
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.hpp"
+#include "game.h"
+#include "gomoku.hpp"
+#include "search_handle.hpp"
+
+namespace gomoku::httpd {
+
+using json = nlohmann::json;
+
+/**
+ * A peer daemon, as host:port.
+ */
+struct PeerAddress {
+    std::string host;
+    int port = 0;
+};
+
+/**
+ * Parses a comma-separated list of host:port peers.
+ */
+std::expected<std::vector<PeerAddress>, std::string> parse_peer_list(std::string_view list);
+
+//===============================================================================
+// SUBTREE PROTOCOL
+//===============================================================================
+
+/**
+ * Body of POST /ai/v1/internal/subtree: a position, packed as by
+ * GameAPI::pack_board(), and root moves to score in it for the side to move.
+ * Coordinators send it as MessagePack, with the cluster key in KEY_HEADER;
+ * the peer streams back one SubtreeScore NDJSON line per move, in the order
+ * it finishes them.
+ */
+struct SubtreeRequest {
+    static constexpr const char* PATH = "/ai/v1/internal/subtree";
+    static constexpr const char* KEY_HEADER = "X-Gomoku-Cluster-Key";
+
+    int board_size = 0;
+    std::vector<uint8_t> board_packed;
+    Player to_move = Player::Cross;
+    int depth = 1;                  // Plies below the position, counting the root move
+    int alpha = -WIN_SCORE - 1;     // Best root score the coordinator knows of
+    int timeout_ms = 0;             // Time left for the whole request; 0 = none
+    std::vector<Position> moves;
+
+    [[nodiscard]] json to_json() const;
+    static std::expected<SubtreeRequest, std::string> from_json(const json& document);
+};
+
+/**
+ * One scored root move. A score at or below the alpha it was searched with
+ * is an upper bound, which is all the coordinator needs of a worse move.
+ */
+struct SubtreeScore {
+    Position move;
+    int score = 0;
+    uint64_t nodes = 0;
+
+    [[nodiscard]] json to_json() const;
+    static std::expected<SubtreeScore, std::string> from_json(const json& line);
+};
+
+//===============================================================================
+// ROOT SPLIT SEARCH
+//===============================================================================
+
+/**
+ * Alpha-beta search whose root moves are shared out between this daemon and
+ * its peers. The moves are ordered by generate_moves_optimized(); the first
+ * is searched here with the full window to set alpha, and the rest are dealt
+ * CHUNK_MOVES at a time to whichever worker is free, each chunk carrying the
+ * best score found so far. Peers stream their scores back move by move, and
+ * the calling thread searches chunks of its own in the meantime.
+ *
+ * A peer that cannot be reached, refuses the request, or sends nothing for
+ * peer_timeout is dropped for the rest of the search, and the moves it had
+ * not scored are searched locally. Requests still out on peers when the
+ * search stops are cut off, so a late peer cannot delay the reply past the
+ * search's deadline. Safe to run from concurrent requests.
+ */
+class RootSplitSearch {
+public:
+    static constexpr int CHUNK_MOVES = 2;
+
+    RootSplitSearch(std::vector<PeerAddress> peers, std::chrono::milliseconds peer_timeout, std::string cluster_key);
+    ~RootSplitSearch();
+
+    RootSplitSearch(const RootSplitSearch&) = delete;
+    RootSplitSearch& operator=(const RootSplitSearch&) = delete;
+
+    /**
+     * Finds the move for the side to move to game->max_depth, with the
+     * same book, first-move and forced-win shortcuts as the local search.
+     */
+    SearchResult run(game_state_t& game);
+
+    /**
+     * Per-peer request, move and failure counters for /ai/v1/status.
+     */
+    [[nodiscard]] json metrics() const;
+
+private:
+    struct Peer;
+    struct Split;
+
+    void search_on_peer(Peer& peer, Split& split) const;
+
+    std::vector<std::unique_ptr<Peer>> peers_;
+    std::chrono::milliseconds peer_timeout_;
+    std::string cluster_key_;
+};
+
+} // namespace gomoku::httpd
@@ -6,7 +6,12 @@
 //
 
 #include "httpd_game_api.hpp"
+#include "search_handle.hpp"
+#include "search_metrics.hpp"
+#include "search_scratch.hpp"
+#include <algorithm>
 #include <format>
+#include <limits>
 #include <chrono>
 #include <random>
 #include <sstream>
@@ -23,7 +28,12 @@ using namespace gomoku;
 
 namespace gomoku::httpd {
 
-GameAPI::GameAPI(int default_depth) : default_depth_(default_depth) {}
+GameAPI::GameAPI(int default_depth, size_t session_cache_size, int search_threads)
+    : default_depth_(default_depth), sessions_(session_cache_size) {
+    if (search_threads > 1) {
+        parallel_ai_ = std::make_unique<ParallelAI>(static_cast<size_t>(search_threads), SearchMode::LazySmp);
+    }
+}
 
 GameAPI::~GameAPI() = default;
 
@@ -99,39 +109,156 @@ json GameAPI::create_empty_game(int board_size, const std::string& game_id) {
     return game;
 }
 
-std::expected<MoveResponse, GameAPIError> GameAPI::process_move_request(const json& request_json) {
+std::expected<MoveResponse, GameAPIError> GameAPI::process_move_request(const json& request_json,
+                                                                        std::optional<int> timeout_ms) {
     // Parse the move request
     auto request = parse_move_request(request_json);
     if (!request) {
         return std::unexpected(request.error());
     }
+    request->timeout_ms = timeout_ms.value_or(request->timeout_ms);
+    
+    // Continue from the game's cached state when the request extends it,
+    // otherwise build the state from the JSON
+    GamePtr game(nullptr, cleanup_game);
+    if (auto cached = sessions_.take(request->game_id)) {
+        if (continue_cached_game(cached->get(), request_json)) {
+            game = std::move(*cached);
+        } else {
+            sessions_.record_rejected();
+        }
+    }
+    
+    if (!game) {
+        auto deserialized = deserialize_game_state(request_json);
+        if (!deserialized) {
+            return std::unexpected(deserialized.error());
+        }
+        game = std::move(*deserialized);
+    }
+    
+    auto response = respond_with_ai_move(*request, game.get());
+    if (response) {
+        sessions_.put(request->game_id, std::move(game));
+    }
+    return response;
+}
+
+std::expected<MoveResponse, GameAPIError> GameAPI::process_batch_position(const json& request_json,
+                                                                          std::optional<int> timeout_ms) {
+    auto request = parse_move_request(request_json);
+    if (!request) {
+        return std::unexpected(request.error());
+    }
+    request->timeout_ms = timeout_ms.value_or(request->timeout_ms);
+    auto config = parse_game_config(request_json);
+    if (!config) {
+        return std::unexpected(config.error());
+    }
     
-    // Create game state from JSON
-    auto game_state = deserialize_game_state(request_json);
-    if (!game_state) {
-        return std::unexpected(game_state.error());
+    game_state_t* game = worker_game(*config);
+    if (!game) {
+        return std::unexpected(GameAPIError::InvalidGameState);
     }
     
+    auto loaded = load_game_state(request_json, game);
+    if (!loaded) {
+        return std::unexpected(loaded.error());
+    }
+    return respond_with_ai_move(*request, game);
+}
+
+std::expected<void, GameAPIError> GameAPI::search_subtree(const SubtreeRequest& request,
+                                                          const std::function<void(const SubtreeScore&)>& on_score,
+                                                          std::atomic<bool>* abort) const {
+    cli_config_t config = {};
+    config.board_size = request.board_size;
+    config.max_depth = request.depth;
+    game_state_t* game = worker_game(config);
+    if (!game) {
+        return std::unexpected(GameAPIError::InvalidGameState);
+    }
+    
+    auto unpacked = unpack_board(request.board_packed, game->board, game->board_size);
+    if (!unpacked) {
+        return std::unexpected(unpacked.error());
+    }
+    rebuild_search_caches(game);
+    game->current_player = static_cast<int>(request.to_move);
+    
+    gomoku::ScratchLease lease(game);
+    gomoku::SearchMetricsScope metrics(game);
+    game->search_start_time = get_current_time();
+    game->search_timeout_ms = request.timeout_ms;
+    game->search_timed_out = 0;
+    game->search_nodes = 0;
+    game->abort_search = abort;
+    
+    int alpha = request.alpha;
+    for (const Position& move : request.moves) {
+        if (!game->board.is_playable(move.x, move.y)) {
+            game->abort_search = nullptr;
+            return std::unexpected(GameAPIError::InvalidMove);
+        }
+        if (is_search_timed_out(game)) {
+            break;
+        }
+        
+        uint64_t nodes_before = game->search_nodes;
+        int score = search_root_move(game, move.x, move.y, request.depth, alpha);
+        if (game->search_timed_out) {
+            break;
+        }
+        on_score(SubtreeScore{move, score, game->search_nodes - nodes_before});
+        alpha = std::max(alpha, score);
+    }
+    
+    game->abort_search = nullptr;
+    game->search_timeout_ms = 0;
+    return {};
+}
+
+void GameAPI::enable_root_split(std::vector<PeerAddress> peers, std::chrono::milliseconds peer_timeout,
+                                int min_depth, std::string cluster_key) {
+    root_split_ = std::make_unique<RootSplitSearch>(std::move(peers), peer_timeout, std::move(cluster_key));
+    root_split_min_depth_ = min_depth;
+}
+
+game_state_t* GameAPI::worker_game(const cli_config_t& config) {
+    // Each search worker resets one game state for every position it is given
+    thread_local GamePtr spare(nullptr, cleanup_game);
+    if (!spare) {
+        spare = GamePtr(init_game(config), cleanup_game);
+    } else {
+        reset_game(spare.get(), config);
+    }
+    return spare.get();
+}
+
+std::expected<MoveResponse, GameAPIError> GameAPI::respond_with_ai_move(const MoveRequest& request,
+                                                                        game_state_t* game) const {
     // Make AI move
-    auto move_result = make_ai_move(game_state->get());
+    game->search_algorithm = request.algorithm;
+    auto move_result = make_ai_move(game, request.timeout_ms);
     if (!move_result) {
         return std::unexpected(move_result.error());
     }
     
     // Build response
     MoveResponse response;
-    response.game_id = request->game_id;
+    response.game_id = request.game_id;
     response.move = *move_result;
-    response.board_state = serialize_board(game_state->get()->board, game_state->get()->board_size);
+    response.board_state = serialize_board(game->board, game->board_size);
+    response.board_packed = pack_board(game->board, game->board_size);
     
     // Serialize move history
-    for (int i = 0; i < game_state->get()->move_history_count; ++i) {
-        response.move_history.push_back(serialize_move(game_state->get()->move_history[i]));
+    for (int i = 0; i < game->move_history_count; ++i) {
+        response.move_history.push_back(serialize_move(game->move_history[i]));
     }
     
     // Determine game status
-    check_game_state(game_state->get());
-    switch (game_state->get()->game_state) {
+    check_game_state(game);
+    switch (game->game_state) {
         case GAME_RUNNING:
             response.game_status = "in_progress";
             break;
@@ -149,15 +276,78 @@ std::expected<MoveResponse, GameAPIError> GameAPI::process_move_request(const js
     }
     
     // Get AI metrics from the last move
-    if (game_state->get()->move_history_count > 0) {
-        const auto& last_move = game_state->get()->move_history[game_state->get()->move_history_count - 1];
+    if (game->move_history_count > 0) {
+        const auto& last_move = game->move_history[game->move_history_count - 1];
         response.positions_evaluated = last_move.positions_evaluated;
         response.move_time_ms = static_cast<int>(last_move.time_taken * 1000);
     }
+    response.depth_reached = game->search_depth_reached;
+    response.timed_out = game->search_timed_out != 0;
     
     return response;
 }
 
+bool GameAPI::continue_cached_game(game_state_t* game, const json& request_json) const {
+    try {
+        if (request_json["game"]["board_size"] != game->board_size) {
+            return false;
+        }
+        
+        // The cached moves must be a prefix of the request's moves
+        const json moves = request_json.value("moves", json::array());
+        if (moves.size() < static_cast<size_t>(game->move_history_count)) {
+            return false;
+        }
+        for (int i = 0; i < game->move_history_count; ++i) {
+            auto move = deserialize_move(moves[i]);
+            const move_history_t& cached = game->move_history[i];
+            if (!move || move->x != cached.x || move->y != cached.y || move->player != cached.player) {
+                return false;
+            }
+        }
+        
+        // Play the moves made since the cached state
+        for (size_t i = game->move_history_count; i < moves.size(); ++i) {
+            auto move = deserialize_move(moves[i]);
+            if (!move || !make_move(game, move->x, move->y, move->player,
+                                    move->time_taken, move->positions_evaluated)) {
+                return false;
+            }
+        }
+        
+        // A board sent along with the moves must agree with them
+        FlatBoard expected(game->board_size);
+        auto has_board = read_board(request_json, expected, game->board_size);
+        if (!has_board || (*has_board && !(expected == game->board))) {
+            return false;
+        }
+        
+        auto depth = parse_ai_depth(request_json);
+        if (!depth) {
+            return false;
+        }
+        game->max_depth = *depth;
+        game->config.max_depth = game->max_depth;
+        if (request_json.contains("current_player")) {
+            game->current_player = request_json["current_player"] == "x"
+                ? static_cast<int>(Player::Cross) : static_cast<int>(Player::Naught);
+        }
+        
+        return true;
+        
+    } catch (const json::exception& e) {
+        return false;
+    }
+}
+
+void GameAPI::rebuild_search_caches(game_state_t* game) const {
+    game->bitboard.load(game->board, game->board_size);
+    game->threats.load(game->bitboard);
+    game->candidates.load(game->bitboard);
+    refresh_zobrist_hash(game);
+    invalidate_winner_cache(game);
+}
+
 std::expected<MoveRequest, GameAPIError> GameAPI::parse_move_request(const json& request_json) const {
     try {
         MoveRequest request;
@@ -170,12 +360,21 @@ std::expected<MoveRequest, GameAPIError> GameAPI::parse_move_request(const json&
         request.board_size = request_json["game"]["board_size"];
         
         if (request_json.contains("game") && request_json["game"].contains("ai_config")) {
-            if (request_json["game"]["ai_config"].contains("depth")) {
-                request.ai_depth = request_json["game"]["ai_config"]["depth"];
+            auto depth = parse_ai_depth(request_json);
+            if (!depth) {
+                return std::unexpected(depth.error());
             }
+            request.ai_depth = *depth;
             if (request_json["game"]["ai_config"].contains("timeout_ms")) {
                 request.timeout_ms = request_json["game"]["ai_config"]["timeout_ms"];
             }
+            if (request_json["game"]["ai_config"].contains("algorithm")) {
+                auto algorithm = parse_search_algorithm(request_json["game"]["ai_config"]["algorithm"].get<std::string>());
+                if (!algorithm) {
+                    return std::unexpected(GameAPIError::InvalidGameState);
+                }
+                request.algorithm = *algorithm;
+            }
         }
         
         if (request_json.contains("board_state")) {
@@ -201,28 +400,60 @@ std::expected<MoveRequest, GameAPIError> GameAPI::parse_move_request(const json&
     }
 }
 
-std::expected<std::unique_ptr<game_state_t, void(*)(game_state_t*)>, GameAPIError> 
-GameAPI::deserialize_game_state(const json& game_json) const {
+std::expected<GamePtr, GameAPIError> GameAPI::deserialize_game_state(const json& game_json) const {
+    auto config = parse_game_config(game_json);
+    if (!config) {
+        return std::unexpected(config.error());
+    }
+    
+    auto game = GamePtr(init_game(*config), cleanup_game);
+    if (!game) {
+        return std::unexpected(GameAPIError::InvalidGameState);
+    }
+    
+    auto loaded = load_game_state(game_json, game.get());
+    if (!loaded) {
+        return std::unexpected(loaded.error());
+    }
+    return game;
+}
+
+std::expected<cli_config_t, GameAPIError> GameAPI::parse_game_config(const json& game_json) const {
     try {
         cli_config_t config = {};
         config.board_size = game_json["game"]["board_size"];
-        config.max_depth = game_json.value("game", json::object()).value("ai_config", json::object()).value("depth", default_depth_);
-        
-        auto game = std::unique_ptr<game_state_t, void(*)(game_state_t*)>(
-            init_game(config), cleanup_game);
-        
-        if (!game) {
-            return std::unexpected(GameAPIError::InvalidGameState);
+        if (config.board_size != 15 && config.board_size != 19) {
+            return std::unexpected(GameAPIError::BoardSizeMismatch);
+        }
+        auto depth = parse_ai_depth(game_json);
+        if (!depth) {
+            return std::unexpected(depth.error());
         }
+        config.max_depth = *depth;
+        return config;
         
+    } catch (const json::exception& e) {
+        return std::unexpected(GameAPIError::SerializationError);
+    }
+}
+
+std::expected<int, GameAPIError> GameAPI::parse_ai_depth(const json& game_json) const {
+    // The same bounds the subtree endpoint enforces on its peers
+    int depth = game_json.value("game", json::object()).value("ai_config", json::object()).value("depth", default_depth_);
+    if (depth < 1 || depth > MAX_DEPTH) {
+        return std::unexpected(GameAPIError::InvalidGameState);
+    }
+    return depth;
+}
+
+std::expected<void, GameAPIError> GameAPI::load_game_state(const json& game_json, game_state_t* game) const {
+    try {
         // Deserialize board state
-        if (game_json.contains("board_state")) {
-            auto deserialize_result = deserialize_board(
-                game_json["board_state"], game->board, game->board_size);
-            if (!deserialize_result) {
-                return std::unexpected(deserialize_result.error());
-            }
+        auto read_result = read_board(game_json, game->board, game->board_size);
+        if (!read_result) {
+            return std::unexpected(read_result.error());
         }
+        bool has_board = *read_result;
         
         // Deserialize move history
         if (game_json.contains("moves")) {
@@ -232,37 +463,56 @@ GameAPI::deserialize_game_state(const json& game_json) const {
                     return std::unexpected(move_result.error());
                 }
                 
+                // Without a board, the moves are the position
+                if (!has_board) {
+                    if (!game->board.is_playable(move_result->x, move_result->y)) {
+                        return std::unexpected(GameAPIError::InvalidMove);
+                    }
+                    game->board[move_result->x][move_result->y] = move_result->player;
+                }
+                
                 // Add move to history
-                add_move_to_history(game.get(), move_result->x, move_result->y, 
+                add_move_to_history(game, move_result->x, move_result->y, 
                                   move_result->player, move_result->time_taken,
                                   move_result->positions_evaluated);
             }
         }
         
+        rebuild_search_caches(game);
+        
         // Set current player
         if (game_json.contains("current_player")) {
             std::string current_player = game_json["current_player"];
             game->current_player = (current_player == "x") ? static_cast<int>(Player::Cross) : static_cast<int>(Player::Naught);
         }
         
-        return game;
+        return {};
         
     } catch (const json::exception& e) {
         return std::unexpected(GameAPIError::SerializationError);
     }
 }
 
-std::expected<json, GameAPIError> GameAPI::make_ai_move(game_state_t* game) const {
+std::expected<json, GameAPIError> GameAPI::make_ai_move(game_state_t* game, int timeout_ms) const {
     if (game->game_state != GAME_RUNNING) {
         return std::unexpected(GameAPIError::GameAlreadyFinished);
     }
     
     start_move_timer(game);
     
-    int best_x = -1, best_y = -1;
-    find_best_ai_move(game, &best_x, &best_y);
+    // Iterative deepening stops at the deadline with the deepest completed move
+    game->search_timeout_ms = std::max(timeout_ms, 0);
+    // Deep alpha-beta searches are worth sharing out with peers
+    bool split = root_split_ && game->search_algorithm == SearchAlgorithm::AlphaBeta &&
+                 game->max_depth >= root_split_min_depth_;
+    SearchResult search = split ? root_split_->run(*game) : run_search(*game, parallel_ai_.get());
+    game->search_timeout_ms = 0;
     
     double move_time = end_move_timer(game);
+    int positions_evaluated = static_cast<int>(
+        std::min<uint64_t>(search.nodes, std::numeric_limits<int>::max()));
+    int best_x = search.move.x;
+    int best_y = search.move.y;
     
     if (best_x == -1 || best_y == -1) {
         return std::unexpected(GameAPIError::InvalidMove);
@@ -270,7 +520,7 @@ std::expected<json, GameAPIError> GameAPI::make_ai_move(game_state_t* game) cons
     
     // Make the move
     if (!make_move(game, best_x, best_y, game->current_player, 
-                   move_time, 0)) {  // positions_evaluated not available in current API
+                   move_time, positions_evaluated)) {
         return std::unexpected(GameAPIError::InvalidMove);
     }
     
@@ -282,7 +532,8 @@ std::expected<json, GameAPIError> GameAPI::make_ai_move(game_state_t* game) cons
     move_json["timestamp"] = std::format("{:%Y-%m-%dT%H:%M:%SZ}", 
                                        std::chrono::system_clock::now());
     move_json["move_time_ms"] = static_cast<int>(move_time * 1000);
-    move_json["positions_evaluated"] = 0;  // Not available in current API
+    move_json["positions_evaluated"] = positions_evaluated;
+    move_json["depth_reached"] = search.depth;
     
     // Check if this was a winning move
     check_game_state(game);
@@ -330,7 +581,7 @@ std::expected<move_history_t, GameAPIError> GameAPI::deserialize_move(const json
     }
 }
 
-std::vector<std::string> GameAPI::serialize_board(int** board, int size) const {
+std::vector<std::string> GameAPI::serialize_board(const FlatBoard& board, int size) const {
     std::vector<std::string> board_rows;
     board_rows.reserve(size);
     
@@ -359,9 +610,81 @@ std::vector<std::string> GameAPI::serialize_board(int** board, int size) const {
     return board_rows;
 }
 
+std::vector<uint8_t> GameAPI::pack_board(const FlatBoard& board, int size) {
+    std::vector<uint8_t> packed((size * size + 3) / 4, 0);
+    
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            int cell = i * size + j;
+            uint8_t code = board[i][j] == static_cast<int>(Player::Cross) ? 1
+                         : board[i][j] == static_cast<int>(Player::Naught) ? 2 : 0;
+            packed[cell / 4] |= static_cast<uint8_t>(code << (2 * (cell % 4)));
+        }
+    }
+    
+    return packed;
+}
+
+std::expected<void, GameAPIError> GameAPI::unpack_board(const std::vector<uint8_t>& packed,
+                                                        FlatBoard& board, int size) {
+    if (packed.size() != static_cast<size_t>((size * size + 3) / 4)) {
+        return std::unexpected(GameAPIError::BoardSizeMismatch);
+    }
+    
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            int cell = i * size + j;
+            switch ((packed[cell / 4] >> (2 * (cell % 4))) & 3) {
+                case 0:
+                    board[i][j] = static_cast<int>(Player::Empty);
+                    break;
+                case 1:
+                    board[i][j] = static_cast<int>(Player::Cross);
+                    break;
+                case 2:
+                    board[i][j] = static_cast<int>(Player::Naught);
+                    break;
+                default:
+                    return std::unexpected(GameAPIError::InvalidGameState);
+            }
+        }
+    }
+    
+    return {};
+}
+
+std::expected<bool, GameAPIError> GameAPI::read_board(const json& request_json, FlatBoard& board, int size) const {
+    try {
+        if (request_json.contains("board_packed")) {
+            const json& packed = request_json["board_packed"];
+            if (!packed.is_binary()) {
+                return std::unexpected(GameAPIError::SerializationError);
+            }
+            auto unpacked = unpack_board(packed.get_binary(), board, size);
+            if (!unpacked) {
+                return std::unexpected(unpacked.error());
+            }
+            return true;
+        }
+        
+        if (request_json.contains("board_state")) {
+            auto deserialized = deserialize_board(request_json["board_state"], board, size);
+            if (!deserialized) {
+                return std::unexpected(deserialized.error());
+            }
+            return true;
+        }
+        
+        return false;
+        
+    } catch (const json::exception& e) {
+        return std::unexpected(GameAPIError::SerializationError);
+    }
+}
+
 std::expected<void, GameAPIError> GameAPI::deserialize_board(
         const std::vector<std::vector<std::string>>& board_json, 
-        int** board, int size) const {
+        FlatBoard& board, int size) const {
     
     if (board_json.size() != static_cast<size_t>(size)) {
         return std::unexpected(GameAPIError::BoardSizeMismatch);
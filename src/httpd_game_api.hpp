@@ -7,15 +7,23 @@
 
 #pragma once
 
+#include <cstdint>
 #include <expected>
 #include <string>
+#include <vector>
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 
 #include "json.hpp"
 #include "game.h"
 #include "ai.h"
 #include "gomoku.hpp"
+#include "httpd_session_cache.hpp"
+#include "ai_parallel.hpp"
+#include "httpd_cluster.hpp"
 
 namespace gomoku::httpd {
 
@@ -39,6 +47,7 @@ struct MoveRequest {
     std::string current_player;
     int ai_depth = 6;
     int timeout_ms = 0;
+    SearchAlgorithm algorithm = SearchAlgorithm::AlphaBeta;
 };
 
 struct MoveResponse {
@@ -46,40 +55,115 @@ struct MoveResponse {
     json move;
     std::string game_status;
     std::vector<std::string> board_state;  // Now array of visual strings
+    std::vector<uint8_t> board_packed;     // The same board in 2 bits per cell, for binary encodings
     std::vector<json> move_history;
     int positions_evaluated = 0;
     int move_time_ms = 0;
+    int depth_reached = 0;      // Deepest iteration completed within the timeout
+    bool timed_out = false;     // The timeout cut the search short of the requested depth
 };
 
 class GameAPI {
 public:
-    explicit GameAPI(int default_depth = 6);
+    /**
+     * @param search_threads Threads searching each move: 1 searches on the
+     *        calling thread, more share one Lazy SMP pool of that size
+     */
+    explicit GameAPI(int default_depth = 6, size_t session_cache_size = SessionCache::DEFAULT_CAPACITY,
+                     int search_threads = 1);
     ~GameAPI();
     
-    std::expected<MoveResponse, GameAPIError> process_move_request(const json& request_json);
+    /**
+     * Makes the AI move for the requested position. When the request's moves
+     * extend those of the state cached for its game id, that state is
+     * advanced by the new moves instead of being rebuilt from the JSON.
+     * timeout_ms, when given, replaces the request's own: the search pool
+     * passes what is left of it after the request queued.
+     */
+    std::expected<MoveResponse, GameAPIError> process_move_request(const json& request_json,
+                                                                   std::optional<int> timeout_ms = std::nullopt);
+    
+    /**
+     * Makes the AI move for one position of a batch. Batch positions bypass
+     * the session cache; each calling thread reuses one game state for all
+     * the positions it evaluates instead of allocating one per position.
+     * timeout_ms replaces the position's own as for process_move_request().
+     */
+    std::expected<MoveResponse, GameAPIError> process_batch_position(const json& request_json,
+                                                                     std::optional<int> timeout_ms = std::nullopt);
+    
+    /**
+     * Scores the request's root moves one after another, passing each score
+     * to on_score as it is found. Each move after the first is searched
+     * against the best score so far, or the request's alpha if higher. Stops
+     * without scoring the rest once abort is raised or the request times out.
+     */
+    std::expected<void, GameAPIError> search_subtree(const SubtreeRequest& request,
+                                                     const std::function<void(const SubtreeScore&)>& on_score,
+                                                     std::atomic<bool>* abort) const;
+    
+    /**
+     * Splits the root moves of alpha-beta searches at least min_depth deep
+     * with peers from now on, presenting cluster_key to them. Not safe while
+     * a search is running.
+     */
+    void enable_root_split(std::vector<PeerAddress> peers, std::chrono::milliseconds peer_timeout, int min_depth,
+                           std::string cluster_key);
+    
+    /**
+     * Per-peer counters of the root split, an empty array without one.
+     */
+    json root_split_metrics() const { return root_split_ ? root_split_->metrics() : json::array(); }
     
     json serialize_game_state(const game_state_t* game) const;
-    std::expected<std::unique_ptr<game_state_t, void(*)(game_state_t*)>, GameAPIError> 
-        deserialize_game_state(const json& game_json) const;
+    std::expected<GamePtr, GameAPIError> deserialize_game_state(const json& game_json) const;
+    
+    /**
+     * Session cache counters reported by /ai/v1/status.
+     */
+    json session_cache_metrics() const { return sessions_.metrics(); }
+    
+    /**
+     * Packs board at 2 bits per cell, cell (i, j) at index i * size + j, four
+     * cells per byte from the low bits: 0 empty, 1 x, 2 o. Binary requests
+     * may send it as "board_packed" in place of board_state.
+     */
+    static std::vector<uint8_t> pack_board(const FlatBoard& board, int size);
+    static std::expected<void, GameAPIError> unpack_board(const std::vector<uint8_t>& packed,
+                                                          FlatBoard& board, int size);
     
     static json create_empty_game(int board_size, const std::string& game_id);
     static std::string generate_game_id();
     
 private:
     std::expected<MoveRequest, GameAPIError> parse_move_request(const json& request_json) const;
-    std::expected<json, GameAPIError> make_ai_move(game_state_t* game) const;
+    std::expected<cli_config_t, GameAPIError> parse_game_config(const json& game_json) const;
+    // The request's ai_config depth, or the default; outside 1 to MAX_DEPTH is an error
+    std::expected<int, GameAPIError> parse_ai_depth(const json& game_json) const;
+    std::expected<void, GameAPIError> load_game_state(const json& game_json, game_state_t* game) const;
+    static game_state_t* worker_game(const cli_config_t& config);
+    std::expected<MoveResponse, GameAPIError> respond_with_ai_move(const MoveRequest& request,
+                                                                   game_state_t* game) const;
+    std::expected<json, GameAPIError> make_ai_move(game_state_t* game, int timeout_ms) const;
+    bool continue_cached_game(game_state_t* game, const json& request_json) const;
+    void rebuild_search_caches(game_state_t* game) const;
     
     json serialize_move(const move_history_t& move) const;
     std::expected<move_history_t, GameAPIError> deserialize_move(const json& move_json) const;
     
-    std::vector<std::string> serialize_board(int** board, int size) const;
+    std::vector<std::string> serialize_board(const FlatBoard& board, int size) const;
+    std::expected<bool, GameAPIError> read_board(const json& request_json, FlatBoard& board, int size) const;
     std::expected<void, GameAPIError> deserialize_board(
         const std::vector<std::vector<std::string>>& board_json, 
-        int** board, int size) const;
+        FlatBoard& board, int size) const;
     
     const char* game_api_error_to_string(GameAPIError error) const;
     
     int default_depth_;
+    SessionCache sessions_;
+    std::unique_ptr<ParallelAI> parallel_ai_;   // Null when searching single-threaded
+    std::unique_ptr<RootSplitSearch> root_split_;   // Null without peers
+    int root_split_min_depth_ = 0;
 };
 
 } // namespace gomoku::httpd
\ No newline at end of file
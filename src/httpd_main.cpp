@@ -17,6 +17,7 @@
 
 #include "httpd_server.hpp"
 #include "httpd_cli.hpp"
+#include "transposition_table.hpp"
 
 namespace gomoku::httpd {
 
@@ -95,6 +96,20 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
+        // Map the opening book while errors can still reach the terminal
+        if (!config->book_path.empty()) {
+            auto opened = gomoku::shared_opening_book().open(config->book_path);
+            if (!opened) {
+                std::cerr << std::format("Error: {}\n", opened.error());
+                return 1;
+            }
+        }
+        
+        // daemonize() moves to /, so resolve a relative snapshot path first
+        if (!config->tt_snapshot_path.empty()) {
+            config->tt_snapshot_path = std::filesystem::absolute(config->tt_snapshot_path).string();
+        }
+        
         if (config->daemon_mode && !config->foreground_mode) {
             std::cout << std::format("Starting gomoku-httpd in daemon mode on {}:{}\n", 
                                    config->host, config->port);
@@ -110,6 +125,22 @@ int main(int argc, char* argv[]) {
         
         setup_signal_handlers();
         
+        // Every request searches against the same table, so size it once up front
+        gomoku::shared_transposition_table().resize(static_cast<size_t>(config->tt_size_mb));
+        
+        // Warm the table before the first request can probe it. A missing or
+        // stale snapshot only costs the warm start; the next save replaces it.
+        if (!config->tt_snapshot_path.empty()) {
+            if (!std::filesystem::exists(config->tt_snapshot_path)) {
+                std::cout << std::format("No transposition table snapshot at {} yet\n", config->tt_snapshot_path);
+            } else if (auto loaded = gomoku::shared_transposition_table().load_snapshot(config->tt_snapshot_path)) {
+                std::cout << std::format("Loaded {} transposition table entries from {}\n",
+                                         *loaded, config->tt_snapshot_path);
+            } else {
+                std::cerr << std::format("Warning: {}\n", loaded.error());
+            }
+        }
+        
         // Create and start the HTTP server
         HttpServer server(*config);
         if (!server.start()) {
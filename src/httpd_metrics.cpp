@@ -0,0 +1,99 @@
+//
+//  httpd_metrics.cpp
+//  gomoku-httpd - Latency histograms and Prometheus text exposition
+//
+//  Bucketing of samples and formatting of the exposition lines
+//
+
+#include "httpd_metrics.hpp"
+#include <algorithm>
+#include <format>
+
+namespace gomoku::httpd {
+
+//===============================================================================
+// LATENCY HISTOGRAM
+//===============================================================================
+
+void LatencyHistogram::observe(std::chrono::steady_clock::duration duration) noexcept {
+    auto ns = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), 0);
+    double seconds = static_cast<double>(ns) / 1e9;
+
+    size_t bucket = static_cast<size_t>(std::lower_bound(BOUNDS.begin(), BOUNDS.end(), seconds) - BOUNDS.begin());
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const noexcept {
+    Snapshot snapshot;
+    for (size_t i = 0; i < buckets_.size(); i++) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_seconds = static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) / 1e9;
+    return snapshot;
+}
+
+//===============================================================================
+// PROMETHEUS WRITER
+//===============================================================================
+
+void PrometheusWriter::family(std::string_view name, std::string_view type, std::string_view help) {
+    out_ += std::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+void PrometheusWriter::series(std::string_view name, std::string_view labels) {
+    out_ += name;
+    if (!labels.empty()) {
+        out_ += std::format("{{{}}}", labels);
+    }
+    out_ += ' ';
+}
+
+void PrometheusWriter::sample(std::string_view name, std::string_view labels, double value) {
+    series(name, labels);
+    out_ += std::format("{}\n", value);
+}
+
+void PrometheusWriter::sample(std::string_view name, std::string_view labels, uint64_t value) {
+    series(name, labels);
+    out_ += std::format("{}\n", value);
+}
+
+void PrometheusWriter::histogram(std::string_view name, std::string_view labels,
+                                 const LatencyHistogram::Snapshot& histogram) {
+    std::string prefix = labels.empty() ? std::string() : std::format("{},", labels);
+    std::string bucket = std::format("{}_bucket", name);
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < LatencyHistogram::BOUNDS.size(); i++) {
+        cumulative += histogram.buckets[i];
+        sample(bucket, std::format("{}le=\"{}\"", prefix, LatencyHistogram::BOUNDS[i]), cumulative);
+    }
+    sample(bucket, std::format("{}le=\"+Inf\"", prefix), histogram.count);
+    sample(std::format("{}_sum", name), labels, histogram.sum_seconds);
+    sample(std::format("{}_count", name), labels, histogram.count);
+}
+
+std::string prometheus_label_value(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            default:
+                escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace gomoku::httpd
@@ -0,0 +1,85 @@
+//
+//  httpd_metrics.hpp
+//  gomoku-httpd - Latency histograms and Prometheus text exposition
+//
+//  Lock-free histograms for the request path and a writer for /metrics
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace gomoku::httpd {
+
+//===============================================================================
+// LATENCY HISTOGRAM
+//===============================================================================
+
+/**
+ * Cumulative-bucket histogram of durations, as Prometheus expects one.
+ * observe() is a couple of relaxed atomic adds, safe from any thread.
+ */
+class LatencyHistogram {
+public:
+    // Upper bounds in seconds, from 1 ms to a minute; larger samples land in +Inf
+    static constexpr std::array<double, 14> BOUNDS = {
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 60.0
+    };
+
+    void observe(std::chrono::steady_clock::duration duration) noexcept;
+
+    struct Snapshot {
+        std::array<uint64_t, BOUNDS.size() + 1> buckets{};     // Per bucket, not cumulative; last is +Inf
+        uint64_t count = 0;
+        double sum_seconds = 0.0;
+    };
+
+    [[nodiscard]] Snapshot snapshot() const noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, BOUNDS.size() + 1> buckets_{};
+    std::atomic<uint64_t> sum_ns_{0};
+};
+
+//===============================================================================
+// PROMETHEUS WRITER
+//===============================================================================
+
+/**
+ * Builds a response body in the Prometheus text exposition format 0.0.4.
+ * Each family is declared once with family() and followed by its samples.
+ */
+class PrometheusWriter {
+public:
+    static constexpr const char* CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+    void family(std::string_view name, std::string_view type, std::string_view help);
+
+    // labels is the inside of the braces, such as route="/health", or empty
+    void sample(std::string_view name, std::string_view labels, double value);
+    void sample(std::string_view name, std::string_view labels, uint64_t value);
+
+    // The _bucket, _sum and _count series of a histogram family
+    void histogram(std::string_view name, std::string_view labels, const LatencyHistogram::Snapshot& histogram);
+
+    [[nodiscard]] const std::string& str() const noexcept { return out_; }
+
+private:
+    void series(std::string_view name, std::string_view labels);
+
+    std::string out_;
+};
+
+/**
+ * Escapes a label value: backslash, double quote and newline.
+ */
+std::string prometheus_label_value(std::string_view value);
+
+} // namespace gomoku::httpd
@@ -0,0 +1,126 @@
+//
+//  httpd_search_pool.cpp
+//  gomoku-httpd - Bounded search executor with admission control
+//
+//  Admission decisions, queue accounting and the status gauges
+//
+
+#include "httpd_search_pool.hpp"
+#include <algorithm>
+
+namespace gomoku::httpd {
+
+namespace {
+
+// Weight of the newest sample in the moving averages
+constexpr double SMOOTHING = 0.2;
+
+double to_ms(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void add_sample(double& average, double sample, uint64_t samples) {
+    average = samples == 0 ? sample : average + SMOOTHING * (sample - average);
+}
+
+} // namespace
+
+const char* search_rejection_to_string(SearchRejection rejection) {
+    switch (rejection) {
+        case SearchRejection::QueueFull:
+            return "Search queue is full";
+        case SearchRejection::DeadlineUnreachable:
+            return "Search queue wait exceeds the request timeout";
+        case SearchRejection::Expired:
+            return "Request timed out in the search queue";
+        default:
+            return "Search rejected";
+    }
+}
+
+SearchPool::SearchPool(size_t workers, size_t queue_capacity)
+    : queue_capacity_(queue_capacity), pool_(std::max<size_t>(workers, 1)) {}
+
+std::optional<SearchRejection> SearchPool::admit(std::chrono::milliseconds timeout) {
+    std::lock_guard lock(mutex_);
+
+    if (queued_ >= queue_capacity_) {
+        ++rejected_queue_full_;
+        return SearchRejection::QueueFull;
+    }
+    if (timeout.count() > 0 && estimated_wait_ms() > static_cast<double>(timeout.count())) {
+        ++rejected_deadline_;
+        return SearchRejection::DeadlineUnreachable;
+    }
+
+    ++queued_;
+    ++accepted_;
+    return std::nullopt;
+}
+
+bool SearchPool::start(std::chrono::milliseconds timeout, Duration waited) {
+    queue_wait_.observe(waited);
+    std::lock_guard lock(mutex_);
+
+    double waited_ms = to_ms(waited);
+    add_sample(average_wait_ms_, waited_ms, accepted_ - queued_);
+    max_wait_ms_ = std::max(max_wait_ms_, waited_ms);
+    --queued_;
+
+    if (timeout.count() > 0 && waited >= timeout) {
+        ++expired_;
+        return false;
+    }
+
+    ++active_;
+    return true;
+}
+
+std::chrono::milliseconds SearchPool::remaining_budget(std::chrono::milliseconds timeout, Duration waited) {
+    if (timeout.count() <= 0) {
+        return timeout;
+    }
+    auto left = timeout - std::chrono::duration_cast<std::chrono::milliseconds>(waited);
+    return std::max(left, MIN_SEARCH_BUDGET);
+}
+
+void SearchPool::finish(Duration service_time) {
+    search_time_.observe(service_time);
+    std::lock_guard lock(mutex_);
+
+    add_sample(average_service_ms_, to_ms(service_time), completed_);
+    --active_;
+    ++completed_;
+}
+
+double SearchPool::estimated_wait_ms() const {
+    // A new search starts once every search ahead of it but one per worker has finished
+    size_t workers = pool_.size();
+    size_t ahead = queued_ + active_;
+    if (ahead < workers) {
+        return 0.0;
+    }
+    return static_cast<double>(ahead - workers + 1) * average_service_ms_ / static_cast<double>(workers);
+}
+
+json SearchPool::metrics() const {
+    std::lock_guard lock(mutex_);
+
+    json metrics;
+    metrics["workers"] = pool_.size();
+    metrics["queue_capacity"] = queue_capacity_;
+    metrics["queue_depth"] = queued_;
+    metrics["active"] = active_;
+    metrics["average_wait_ms"] = average_wait_ms_;
+    metrics["max_wait_ms"] = max_wait_ms_;
+    metrics["average_search_ms"] = average_service_ms_;
+    metrics["estimated_wait_ms"] = estimated_wait_ms();
+    metrics["accepted"] = accepted_;
+    metrics["completed"] = completed_;
+    metrics["rejected_queue_full"] = rejected_queue_full_;
+    metrics["rejected_deadline"] = rejected_deadline_;
+    metrics["expired"] = expired_;
+    return metrics;
+}
+
+} // namespace gomoku::httpd
@@ -0,0 +1,176 @@
+//
+//  httpd_search_pool.hpp
+//  gomoku-httpd - Bounded search executor with admission control
+//
+//  Runs AI searches on a fixed set of workers and sheds requests it cannot serve in time
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "json.hpp"
+#include "httpd_metrics.hpp"
+#include "util/thread_pool.hpp"
+
+namespace gomoku::httpd {
+
+using json = nlohmann::json;
+
+/**
+ * Why the pool did not run a search.
+ */
+enum class SearchRejection {
+    QueueFull,            // Every queue slot is taken; answered with 429
+    DeadlineUnreachable,  // The expected queue wait exceeds the request's timeout; 503
+    Expired               // The request's timeout passed while it was queued; 503
+};
+
+const char* search_rejection_to_string(SearchRejection rejection);
+
+//===============================================================================
+// SEARCH POOL
+//===============================================================================
+
+/**
+ * Runs searches on a fixed number of workers, with at most queue_capacity
+ * more waiting for one. The number of concurrent searches therefore never
+ * exceeds the worker count, however many connections httplib accepts.
+ *
+ * A search is refused up front when the queue is full, or when the queue
+ * wait estimated from the recent search times would already exceed the
+ * request's timeout. A search that was admitted but waited past its timeout
+ * is dropped without running; one that waited less searches only for what
+ * is left of its timeout, so queueing does not stretch the reply past it.
+ */
+class SearchPool {
+public:
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 64;
+    // Least time left to a search whose wait nearly used up its timeout
+    static constexpr std::chrono::milliseconds MIN_SEARCH_BUDGET{10};
+
+    SearchPool(size_t workers, size_t queue_capacity);
+
+    /**
+     * Runs search on a worker and returns its result, blocking the calling
+     * connection thread until it is done or refused. search is passed the
+     * time it may take: timeout less the queue wait, or zero for none.
+     *
+     * @param timeout The request's time budget, or zero for none
+     */
+    template<class F>
+    std::expected<std::invoke_result_t<F, std::chrono::milliseconds>, SearchRejection>
+    run(std::chrono::milliseconds timeout, F&& search) {
+        using Clock = std::chrono::steady_clock;
+
+        if (auto rejection = admit(timeout)) {
+            return std::unexpected(*rejection);
+        }
+
+        auto queued_at = Clock::now();
+        auto task = [this, timeout, queued_at, &search]()
+                -> std::expected<std::invoke_result_t<F, std::chrono::milliseconds>, SearchRejection> {
+            auto started_at = Clock::now();
+            if (!start(timeout, started_at - queued_at)) {
+                return std::unexpected(SearchRejection::Expired);
+            }
+            Finish finish(this, started_at);
+            return search(remaining_budget(timeout, started_at - queued_at));
+        };
+        return pool_.enqueue(std::move(task)).get();
+    }
+
+    /**
+     * Queues search without waiting for it, passing it its budget as run()
+     * does. complete receives the search's
+     * result, or why it was refused, exactly once: on the caller's thread
+     * when the search is refused up front, otherwise on the worker. Unlike
+     * run(), nothing carries an exception back, so neither callable may throw.
+     *
+     * @param timeout The request's time budget, or zero for none
+     */
+    template<class F, class C>
+    void submit(std::chrono::milliseconds timeout, F search, C complete) {
+        using Clock = std::chrono::steady_clock;
+        using Result = std::expected<std::invoke_result_t<F&, std::chrono::milliseconds>, SearchRejection>;
+
+        if (auto rejection = admit(timeout)) {
+            complete(Result(std::unexpected(*rejection)));
+            return;
+        }
+
+        auto queued_at = Clock::now();
+        pool_.enqueue_detach([this, timeout, queued_at,
+                              search = std::move(search), complete = std::move(complete)]() mutable {
+            auto started_at = Clock::now();
+            if (!start(timeout, started_at - queued_at)) {
+                complete(Result(std::unexpected(SearchRejection::Expired)));
+                return;
+            }
+            std::optional<Result> outcome;
+            {
+                Finish finish(this, started_at);
+                outcome.emplace(search(remaining_budget(timeout, started_at - queued_at)));
+            }
+            complete(std::move(*outcome));
+        });
+    }
+
+    [[nodiscard]] size_t workers() const noexcept { return pool_.size(); }
+    [[nodiscard]] size_t queue_capacity() const noexcept { return queue_capacity_; }
+
+    /**
+     * Queue depth, wait and service time gauges and rejection counters for /ai/v1/status.
+     */
+    [[nodiscard]] json metrics() const;
+
+    // Time admitted searches spent queued, and the time they then searched for
+    [[nodiscard]] const LatencyHistogram& queue_wait() const noexcept { return queue_wait_; }
+    [[nodiscard]] const LatencyHistogram& search_time() const noexcept { return search_time_; }
+
+private:
+    using Duration = std::chrono::steady_clock::duration;
+
+    // Marks the search finished however it leaves the task
+    struct Finish {
+        SearchPool* pool;
+        std::chrono::steady_clock::time_point started_at;
+        ~Finish() { pool->finish(std::chrono::steady_clock::now() - started_at); }
+    };
+
+    std::optional<SearchRejection> admit(std::chrono::milliseconds timeout);
+    static std::chrono::milliseconds remaining_budget(std::chrono::milliseconds timeout, Duration waited);
+    bool start(std::chrono::milliseconds timeout, Duration waited);
+    void finish(Duration service_time);
+    double estimated_wait_ms() const;
+
+    size_t queue_capacity_;
+
+    mutable std::mutex mutex_;
+    size_t queued_ = 0;
+    size_t active_ = 0;
+    double average_wait_ms_ = 0.0;      // Exponential moving averages
+    double average_service_ms_ = 0.0;
+    double max_wait_ms_ = 0.0;
+
+    uint64_t accepted_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t rejected_queue_full_ = 0;
+    uint64_t rejected_deadline_ = 0;
+    uint64_t expired_ = 0;
+
+    LatencyHistogram queue_wait_;
+    LatencyHistogram search_time_;
+
+    // Declared last, so its workers are joined before the counters go away
+    ThreadPool pool_;
+};
+
+} // namespace gomoku::httpd
@@ -6,19 +6,69 @@
 //
 
 #include "httpd_server.hpp"
+#include "simd_kernels.hpp"
+#include "httpd_wire.hpp"
+#include "search_metrics.hpp"
 #include <iostream>
 #include <format>
 #include <fstream>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
 #include <sys/sysctl.h>
 #include <mach/mach.h>
 #include <unistd.h>
 
 namespace gomoku::httpd {
 
+namespace {
+
+int resolve_search_threads(int requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 1 ? static_cast<int>(cores - 1) : 1;
+}
+
+// Connection threads serve one request at a time, from routing to the log line
+thread_local std::chrono::steady_clock::time_point request_started;
+
+// Compares every byte whatever the first mismatch, so timing gives away nothing of the key
+bool keys_match(std::string_view presented, std::string_view key) {
+    unsigned char difference = presented.size() == key.size() ? 0 : 1;
+    for (size_t i = 0; i < presented.size(); i++) {
+        difference |= static_cast<unsigned char>(presented[i] ^ key[i % key.size()]);
+    }
+    return difference == 0;
+}
+
+} // namespace
+
 HttpServer::HttpServer(const HttpDaemonConfig& config) 
     : config_(config), server_(std::make_unique<httplib::Server>()),
-      game_api_(std::make_unique<GameAPI>(config.depth)) {
+      game_api_(std::make_unique<GameAPI>(config.depth, static_cast<size_t>(config.session_cache_size),
+                                          resolve_search_threads(config.search_threads))),
+      search_pool_(static_cast<size_t>(config.threads), static_cast<size_t>(config.search_queue_size)) {
+    
+    // Enough connection threads for every worker and queue slot, plus a few
+    // more so status requests and refusals are answered while the pool is full
+    size_t connection_threads = static_cast<size_t>(config.threads + config.search_queue_size + 4);
+    server_->new_task_queue = [connection_threads] { return new httplib::ThreadPool(connection_threads); };
+    
+    // Off by default, since it adds a clock read to every leaf
+    gomoku::enable_search_metrics(config.search_metrics);
+    
+    // Deep searches share their root moves with peers; the list was checked when parsed
+    if (!config.peers.empty()) {
+        if (auto peers = parse_peer_list(config.peers)) {
+            game_api_->enable_root_split(std::move(*peers), std::chrono::milliseconds(config.peer_timeout_ms),
+                                         config.peer_min_depth, config.cluster_key);
+        }
+    }
     
     setup_middleware();
     setup_routes();
@@ -37,14 +87,6 @@ bool HttpServer::start() {
         try {
             running_.store(true);
             
-            if (config_.verbose) {
-                server_->set_logger([](const httplib::Request& req, const httplib::Response& res) {
-                    std::cout << std::format("{} {} -> {} ({}ms)\n", 
-                                           req.method, req.path, res.status,
-                                           /* timing would go here */0);
-                });
-            }
-            
             bool success = server_->listen(config_.host, config_.port);
             if (!success && running_.load()) {
                 std::cerr << std::format("Failed to bind to {}:{}\n", config_.host, config_.port);
@@ -60,7 +102,12 @@ bool HttpServer::start() {
     // Give the server a moment to start
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
     
-    return running_.load();
+    bool started = running_.load();
+    if (started && !config_.tt_snapshot_path.empty() && !snapshot_thread_.joinable()) {
+        snapshot_stopping_ = false;
+        snapshot_thread_ = std::thread([this]() { run_snapshots(); });
+    }
+    return started;
 }
 
 void HttpServer::stop() {
@@ -72,33 +119,89 @@ void HttpServer::stop() {
             server_thread_.join();
         }
     }
+    
+    // The snapshot thread saves once more on its way out
+    if (snapshot_thread_.joinable()) {
+        {
+            std::lock_guard lock(snapshot_mutex_);
+            snapshot_stopping_ = true;
+        }
+        snapshot_wakeup_.notify_all();
+        snapshot_thread_.join();
+    }
+}
+
+void HttpServer::run_snapshots() {
+    std::unique_lock lock(snapshot_mutex_);
+    while (!snapshot_stopping_) {
+        auto stopping = [this] { return snapshot_stopping_; };
+        if (config_.tt_snapshot_interval > 0) {
+            snapshot_wakeup_.wait_for(lock, std::chrono::seconds(config_.tt_snapshot_interval), stopping);
+        } else {
+            snapshot_wakeup_.wait(lock, stopping);
+        }
+        
+        // Searches may keep storing while the table is read; see save_snapshot()
+        lock.unlock();
+        save_snapshot();
+        lock.lock();
+    }
+}
+
+void HttpServer::save_snapshot() {
+    auto saved = gomoku::shared_transposition_table().save_snapshot(config_.tt_snapshot_path);
+    if (!saved) {
+        std::cerr << std::format("Warning: {}\n", saved.error());
+        return;
+    }
+    
+    snapshot_saves_.fetch_add(1, std::memory_order_relaxed);
+    snapshot_entries_.store(*saved, std::memory_order_relaxed);
+    if (config_.verbose) {
+        std::cout << std::format("Saved {} transposition table entries to {}\n", *saved, config_.tt_snapshot_path);
+    }
 }
 
 void HttpServer::setup_middleware() {
-    // CORS headers
-    server_->set_pre_routing_handler([](const httplib::Request&, httplib::Response& res) {
+    // httplib keeps a single pre-routing handler, so one handler does it all
+    server_->set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        request_started = std::chrono::steady_clock::now();
+        
+        // CORS headers
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
         res.set_header("Access-Control-Allow-Headers", "Content-Type");
-        return httplib::Server::HandlerResponse::Unhandled;
-    });
-    
-    // Content-Type validation for POST requests
-    server_->set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res) {
+        
+        // Content-Type validation for POST requests
         if (req.method == "POST") {
             auto content_type = req.get_header_value("Content-Type");
-            if (content_type.find("application/json") == std::string::npos) {
+            if (!wire_format_from_content_type(content_type)) {
                 res.status = 400;
-                res.set_content(R"({"error": "Content-Type must be application/json"})", 
-                               "application/json");
+                res.set_content(
+                    R"({"error": "Content-Type must be application/json, application/cbor or application/msgpack"})",
+                    "application/json");
                 return httplib::Server::HandlerResponse::Handled;
             }
         }
         return httplib::Server::HandlerResponse::Unhandled;
     });
+    
+    // Runs once the response is written, streamed batches included
+    server_->set_logger([this](const httplib::Request& req, const httplib::Response& res) {
+        auto elapsed = observe_request(req, res);
+        if (config_.verbose) {
+            std::cout << std::format("{} {} -> {} ({}ms)\n", req.method, req.path, res.status,
+                                     std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+        }
+    });
 }
 
 void HttpServer::setup_routes() {
+    for (const char* route : {"/ai/v1/status", "/ai/v1/move", "/ai/v1/moves:batch", SubtreeRequest::PATH,
+                              "/gomoku.schema.json", "/health", "/metrics", ""}) {
+        request_latency_.try_emplace(route);
+    }
+    
     server_->Get("/ai/v1/status", [this](const httplib::Request& req, httplib::Response& res) {
         handle_status(req, res);
     });
@@ -107,6 +210,14 @@ void HttpServer::setup_routes() {
         handle_move(req, res);
     });
     
+    server_->Post("/ai/v1/moves:batch", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_batch(req, res);
+    });
+    
+    server_->Post(SubtreeRequest::PATH, [this](const httplib::Request& req, httplib::Response& res) {
+        handle_subtree(req, res);
+    });
+    
     server_->Get("/gomoku.schema.json", [this](const httplib::Request& req, httplib::Response& res) {
         handle_schema(req, res);
     });
@@ -115,8 +226,17 @@ void HttpServer::setup_routes() {
         res.set_content(R"({"status": "ok", "service": "gomoku-httpd"})", "application/json");
     });
     
+    server_->Get("/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        handle_metrics(req, res);
+    });
+    
+    // Called for every status from 400 up; responses a handler already wrote keep their own status
     server_->set_error_handler([this](const httplib::Request& req, httplib::Response& res) {
+        if (!res.body.empty()) {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
         handle_not_found(req, res);
+        return httplib::Server::HandlerResponse::Handled;
     });
 }
 
@@ -128,7 +248,21 @@ void HttpServer::handle_status(const httplib::Request&, httplib::Response& res)
         status_response["version"] = gomoku::GAME_VERSION;
         status_response["config"]["depth"] = config_.depth;
         status_response["config"]["threads"] = config_.threads;
+        status_response["config"]["search_threads"] = resolve_search_threads(config_.search_threads);
+        status_response["config"]["simd"] = gomoku::simd::kernel_name();
         status_response["metrics"] = get_system_metrics();
+        status_response["session_cache"] = game_api_->session_cache_metrics();
+        status_response["search_pool"] = search_pool_.metrics();
+        const auto& book = gomoku::shared_opening_book();
+        status_response["opening_book"]["loaded"] = book.is_open();
+        status_response["opening_book"]["path"] = book.path();
+        status_response["opening_book"]["entries"] = book.size();
+        status_response["tt_snapshot"]["path"] = config_.tt_snapshot_path;
+        status_response["tt_snapshot"]["interval"] = config_.tt_snapshot_interval;
+        status_response["tt_snapshot"]["saves"] = snapshot_saves_.load(std::memory_order_relaxed);
+        status_response["tt_snapshot"]["entries"] = snapshot_entries_.load(std::memory_order_relaxed);
+        status_response["root_split"]["min_depth"] = config_.peer_min_depth;
+        status_response["root_split"]["peers"] = game_api_->root_split_metrics();
         
         res.set_content(status_response.dump(2), "application/json");
         
@@ -142,7 +276,9 @@ void HttpServer::handle_status(const httplib::Request&, httplib::Response& res)
 
 void HttpServer::handle_move(const httplib::Request& req, httplib::Response& res) {
     try {
-        json request_json = json::parse(req.body);
+        WireFormat format = wire_format_from_content_type(req.get_header_value("Content-Type"))
+                                .value_or(WireFormat::Json);
+        json request_json = decode_body(req.body, format);
         
         // Validate request against schema
         auto validation_result = validate_move_request(request_json);
@@ -154,7 +290,23 @@ void HttpServer::handle_move(const httplib::Request& req, httplib::Response& res
             return;
         }
         
-        auto move_result = game_api_->process_move_request(request_json);
+        // Search on the bounded pool, which may refuse the request under load
+        std::chrono::milliseconds timeout(
+            request_json["game"].value("ai_config", json::object()).value("timeout_ms", 0));
+        auto search_result = search_pool_.run(timeout, [&](std::chrono::milliseconds budget) {
+            return game_api_->process_move_request(request_json, static_cast<int>(budget.count()));
+        });
+        if (!search_result) {
+            bool queue_full = search_result.error() == SearchRejection::QueueFull;
+            res.status = queue_full ? 429 : 503;
+            res.set_header("Retry-After", "1");
+            auto error_response = create_error_response(
+                search_rejection_to_string(search_result.error()), res.status);
+            res.set_content(error_response.dump(), "application/json");
+            return;
+        }
+        
+        auto& move_result = *search_result;
         if (!move_result) {
             res.status = 400;
             auto error_response = create_error_response("Invalid move request", 400);
@@ -162,16 +314,14 @@ void HttpServer::handle_move(const httplib::Request& req, httplib::Response& res
             return;
         }
         
-        json response_json;
-        response_json["game_id"] = move_result->game_id;
-        response_json["game_status"] = move_result->game_status;
-        response_json["board_state"] = move_result->board_state;
-        response_json["move_history"] = move_result->move_history;
-        response_json["latest_move"] = move_result->move;
-        response_json["ai_metrics"]["positions_evaluated"] = move_result->positions_evaluated;
-        response_json["ai_metrics"]["move_time_ms"] = move_result->move_time_ms;
-        
-        res.set_content(response_json.dump(2), "application/json");
+        // Binary callers get the binary encoding back unless they ask for another
+        WireFormat response_format = wire_format_from_accept(req.get_header_value("Accept"), format);
+        json response_json = move_response_json(*move_result);
+        if (response_format != WireFormat::Json) {
+            response_json.erase("board_state");
+            response_json["board_packed"] = json::binary(move_result->board_packed);
+        }
+        res.set_content(encode_body(response_json, response_format), wire_content_type(response_format));
         
     } catch (const json::parse_error& e) {
         res.status = 400;
@@ -187,6 +337,265 @@ void HttpServer::handle_move(const httplib::Request& req, httplib::Response& res
     }
 }
 
+//===============================================================================
+// BATCH MOVES
+//===============================================================================
+
+namespace {
+
+// Larger batches are refused with 413 rather than held in memory
+constexpr size_t MAX_BATCH_POSITIONS = 10000;
+
+} // namespace
+
+/**
+ * One batch request. Results are queued as NDJSON lines in completion order
+ * and written out by the connection thread.
+ */
+struct HttpServer::BatchState {
+    json positions;
+    size_t window = 1;          // Positions queued or searching at once
+    
+    std::mutex mutex;
+    std::condition_variable ready;
+    size_t next = 0;            // Index of the next position to dispatch
+    size_t in_flight = 0;
+    size_t written = 0;
+    bool dispatching = false;
+    bool cancelled = false;     // The client went away
+    std::deque<std::string> lines;
+    
+    void push(json line) {
+        std::lock_guard lock(mutex);
+        lines.push_back(line.dump() + "\n");
+        --in_flight;
+        ready.notify_one();
+    }
+};
+
+void HttpServer::handle_batch(const httplib::Request& req, httplib::Response& res) {
+    auto batch = std::make_shared<BatchState>();
+    try {
+        WireFormat format = wire_format_from_content_type(req.get_header_value("Content-Type"))
+                                .value_or(WireFormat::Json);
+        batch->positions = decode_body(req.body, format);
+    } catch (const json::parse_error& e) {
+        res.status = 400;
+        res.set_content(create_error_response(std::format("Invalid JSON: {}", e.what()), 400).dump(),
+                        "application/json");
+        return;
+    }
+    
+    if (!batch->positions.is_array()) {
+        res.status = 400;
+        res.set_content(create_error_response("Batch body must be an array of positions", 400).dump(),
+                        "application/json");
+        return;
+    }
+    if (batch->positions.size() > MAX_BATCH_POSITIONS) {
+        res.status = 413;
+        res.set_content(create_error_response(
+            std::format("Batch exceeds {} positions", MAX_BATCH_POSITIONS), 413).dump(), "application/json");
+        return;
+    }
+    
+    // One position per worker keeps a batch from taking the queue slots
+    // that single move requests need
+    batch->window = search_pool_.workers();
+    dispatch_batch(batch);
+    
+    size_t total = batch->positions.size();
+    res.set_chunked_content_provider("application/x-ndjson",
+        [batch, total](size_t, httplib::DataSink& sink) {
+            std::unique_lock lock(batch->mutex);
+            if (batch->written == total) {
+                sink.done();
+                return true;
+            }
+            batch->ready.wait(lock, [&] { return !batch->lines.empty(); });
+            std::string line = std::move(batch->lines.front());
+            batch->lines.pop_front();
+            ++batch->written;
+            lock.unlock();
+            return sink.write(line.data(), line.size());
+        },
+        [batch](bool) {
+            std::lock_guard lock(batch->mutex);
+            batch->cancelled = true;
+        });
+}
+
+void HttpServer::dispatch_batch(const std::shared_ptr<BatchState>& batch) {
+    std::unique_lock lock(batch->mutex);
+    
+    // Completions dispatch from worker threads; whoever holds the flag does it for all
+    if (batch->dispatching) {
+        return;
+    }
+    batch->dispatching = true;
+    
+    while (!batch->cancelled && batch->in_flight < batch->window && batch->next < batch->positions.size()) {
+        size_t index = batch->next++;
+        ++batch->in_flight;
+        lock.unlock();
+        
+        const json& position = batch->positions[index];
+        auto line = [index](int status) {
+            json line;
+            line["index"] = index;
+            line["status"] = status;
+            return line;
+        };
+        
+        auto valid = validate_move_request(position);
+        if (!valid) {
+            json error = line(400);
+            error["error"] = std::format("Schema validation failed: {}", valid.error());
+            batch->push(std::move(error));
+            lock.lock();
+            continue;
+        }
+        
+        std::chrono::milliseconds timeout(
+            position["game"].value("ai_config", json::object()).value("timeout_ms", 0));
+        search_pool_.submit(timeout,
+            [this, &position, line](std::chrono::milliseconds budget) -> json {
+                try {
+                    auto move_result = game_api_->process_batch_position(position, static_cast<int>(budget.count()));
+                    if (!move_result) {
+                        json error = line(400);
+                        error["error"] = "Invalid move request";
+                        return error;
+                    }
+                    json result = line(200);
+                    result["result"] = move_response_json(*move_result);
+                    return result;
+                } catch (const std::exception& e) {
+                    json error = line(500);
+                    error["error"] = std::format("Server error: {}", e.what());
+                    return error;
+                }
+            },
+            [this, batch, line](std::expected<json, SearchRejection> outcome) {
+                if (outcome) {
+                    batch->push(std::move(*outcome));
+                } else {
+                    json error = line(outcome.error() == SearchRejection::QueueFull ? 429 : 503);
+                    error["error"] = search_rejection_to_string(outcome.error());
+                    batch->push(std::move(error));
+                }
+                dispatch_batch(batch);
+            });
+        lock.lock();
+    }
+    
+    batch->dispatching = false;
+}
+
+//===============================================================================
+// SUBTREE SEARCH
+//===============================================================================
+
+/**
+ * One subtree request from a coordinator. Each score is queued as an NDJSON
+ * line as soon as the search finds it and written out by the connection thread.
+ */
+struct HttpServer::SubtreeState {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::string> lines;
+    bool finished = false;
+    std::optional<SearchRejection> rejection;
+    std::atomic<bool> abort{false};     // The coordinator went away
+    
+    void push(const SubtreeScore& score) {
+        std::lock_guard lock(mutex);
+        lines.push_back(score.to_json().dump() + "\n");
+        ready.notify_one();
+    }
+    
+    void finish(std::optional<SearchRejection> refused) {
+        std::lock_guard lock(mutex);
+        finished = true;
+        rejection = refused;
+        ready.notify_one();
+    }
+};
+
+void HttpServer::handle_subtree(const httplib::Request& req, httplib::Response& res) {
+    // Only daemons of the same cluster may put searches on this one's pool
+    if (config_.cluster_key.empty()) {
+        res.status = 404;
+        res.set_content(create_error_response("Not found", 404).dump(), "application/json");
+        return;
+    }
+    if (!keys_match(req.get_header_value(SubtreeRequest::KEY_HEADER), config_.cluster_key)) {
+        res.status = 403;
+        res.set_content(create_error_response("Missing or wrong cluster key", 403).dump(), "application/json");
+        return;
+    }
+    
+    std::expected<SubtreeRequest, std::string> parsed;
+    try {
+        WireFormat format = wire_format_from_content_type(req.get_header_value("Content-Type"))
+                                .value_or(WireFormat::Json);
+        parsed = SubtreeRequest::from_json(decode_body(req.body, format));
+    } catch (const json::parse_error& e) {
+        parsed = std::unexpected(std::format("Invalid JSON: {}", e.what()));
+    }
+    if (!parsed) {
+        res.status = 400;
+        res.set_content(create_error_response(parsed.error(), 400).dump(), "application/json");
+        return;
+    }
+    
+    auto subtree = std::make_shared<SubtreeState>();
+    auto request = std::make_shared<SubtreeRequest>(std::move(*parsed));
+    search_pool_.submit(std::chrono::milliseconds(request->timeout_ms),
+        [this, subtree, request](std::chrono::milliseconds budget) -> bool {
+            try {
+                request->timeout_ms = static_cast<int>(budget.count());
+                auto on_score = [&subtree](const SubtreeScore& score) { subtree->push(score); };
+                return game_api_->search_subtree(*request, on_score, &subtree->abort).has_value();
+            } catch (const std::exception&) {
+                return false;
+            }
+        },
+        [subtree](std::expected<bool, SearchRejection> outcome) {
+            subtree->finish(outcome ? std::nullopt : std::optional(outcome.error()));
+        });
+    
+    // Refused up front, before anything was streamed, so the status can still say so
+    {
+        std::lock_guard lock(subtree->mutex);
+        if (subtree->rejection && subtree->lines.empty()) {
+            res.status = *subtree->rejection == SearchRejection::QueueFull ? 429 : 503;
+            res.set_header("Retry-After", "1");
+            res.set_content(create_error_response(search_rejection_to_string(*subtree->rejection),
+                                                  res.status).dump(), "application/json");
+            return;
+        }
+    }
+    
+    // Moves the stream ends without are searched again by the coordinator
+    res.set_chunked_content_provider("application/x-ndjson",
+        [subtree](size_t, httplib::DataSink& sink) {
+            std::unique_lock lock(subtree->mutex);
+            subtree->ready.wait(lock, [&] { return !subtree->lines.empty() || subtree->finished; });
+            if (subtree->lines.empty()) {
+                sink.done();
+                return true;
+            }
+            std::string line = std::move(subtree->lines.front());
+            subtree->lines.pop_front();
+            lock.unlock();
+            return sink.write(line.data(), line.size());
+        },
+        [subtree](bool) {
+            subtree->abort.store(true, std::memory_order_relaxed);
+        });
+}
+
 void HttpServer::handle_schema(const httplib::Request&, httplib::Response& res) {
     try {
         std::ifstream schema_file("schema/gomoku.schema.json");
@@ -210,6 +619,134 @@ void HttpServer::handle_schema(const httplib::Request&, httplib::Response& res)
     }
 }
 
+//===============================================================================
+// METRICS
+//===============================================================================
+
+void HttpServer::handle_metrics(const httplib::Request&, httplib::Response& res) {
+    PrometheusWriter out;
+    
+    out.family("gomoku_build_info", "gauge", "Version of the running daemon");
+    out.sample("gomoku_build_info", std::format("version=\"{}\"", prometheus_label_value(gomoku::GAME_VERSION)),
+               uint64_t{1});
+    
+    // Requests
+    out.family("gomoku_http_request_duration_seconds", "histogram",
+               "Time from routing a request to writing the last byte of its response");
+    for (const auto& [route, histogram] : request_latency_) {
+        std::string label = route.empty() ? "other" : prometheus_label_value(route);
+        out.histogram("gomoku_http_request_duration_seconds", std::format("route=\"{}\"", label),
+                      histogram.snapshot());
+    }
+    out.family("gomoku_http_responses_total", "counter", "Responses by status class");
+    for (size_t i = 0; i < responses_by_class_.size(); i++) {
+        out.sample("gomoku_http_responses_total", std::format("code=\"{}xx\"", i + 1),
+                   responses_by_class_[i].load(std::memory_order_relaxed));
+    }
+    
+    // Search pool
+    json pool = search_pool_.metrics();
+    out.family("gomoku_search_queue_wait_seconds", "histogram", "Time admitted searches waited for a worker");
+    out.histogram("gomoku_search_queue_wait_seconds", "", search_pool_.queue_wait().snapshot());
+    out.family("gomoku_search_duration_seconds", "histogram", "Time searches ran on a worker");
+    out.histogram("gomoku_search_duration_seconds", "", search_pool_.search_time().snapshot());
+    out.family("gomoku_search_queue_depth", "gauge", "Searches waiting for a worker");
+    out.sample("gomoku_search_queue_depth", "", pool["queue_depth"].get<uint64_t>());
+    out.family("gomoku_search_active", "gauge", "Searches running");
+    out.sample("gomoku_search_active", "", pool["active"].get<uint64_t>());
+    out.family("gomoku_search_workers", "gauge", "Searches that may run at once");
+    out.sample("gomoku_search_workers", "", pool["workers"].get<uint64_t>());
+    out.family("gomoku_search_requests_total", "counter", "Searches by how the pool disposed of them");
+    for (const char* outcome : {"accepted", "completed", "rejected_queue_full", "rejected_deadline", "expired"}) {
+        out.sample("gomoku_search_requests_total", std::format("outcome=\"{}\"", outcome),
+                   pool[outcome].get<uint64_t>());
+    }
+    
+    // Session cache
+    json cache = game_api_->session_cache_metrics();
+    out.family("gomoku_session_cache_entries", "gauge", "Games kept between requests");
+    out.sample("gomoku_session_cache_entries", "", cache["entries"].get<uint64_t>());
+    out.family("gomoku_session_cache_memory_bytes", "gauge", "Memory held by cached games");
+    out.sample("gomoku_session_cache_memory_bytes", "", cache["memory_bytes"].get<uint64_t>());
+    out.family("gomoku_session_cache_lookups_total", "counter", "Session cache lookups by result");
+    for (const char* result : {"hits", "misses"}) {
+        out.sample("gomoku_session_cache_lookups_total", std::format("result=\"{}\"", result),
+                   cache[result].get<uint64_t>());
+    }
+    out.family("gomoku_session_cache_evictions_total", "counter", "Games evicted from the session cache");
+    out.sample("gomoku_session_cache_evictions_total", "", cache["evictions"].get<uint64_t>());
+    
+    // Search internals, counted only with --search-metrics
+    gomoku::SearchMetricsSnapshot search = gomoku::collect_search_metrics();
+    out.family("gomoku_search_metrics_enabled", "gauge", "Whether the search_* internals below are being counted");
+    out.sample("gomoku_search_metrics_enabled", "", uint64_t{gomoku::search_metrics_enabled() ? 1u : 0u});
+    out.family("gomoku_search_nodes_total", "counter", "Positions visited by searches");
+    out.sample("gomoku_search_nodes_total", "", search.nodes);
+    out.family("gomoku_search_research_nodes_total", "counter",
+               "Positions visited by aspiration windows that failed and were searched again");
+    out.sample("gomoku_search_research_nodes_total", "", search.research_nodes);
+    out.family("gomoku_search_leaf_evals_total", "counter", "Leaf positions scored");
+    out.sample("gomoku_search_leaf_evals_total", "", search.leaf_evals());
+    out.family("gomoku_tt_probes_total", "counter", "Transposition table lookups");
+    out.sample("gomoku_tt_probes_total", "", search.tt_probes);
+    out.family("gomoku_tt_hits_total", "counter", "Transposition table lookups that found their position");
+    out.sample("gomoku_tt_hits_total", "", search.tt_hits);
+    out.family("gomoku_tt_collisions_total", "counter",
+               "Table moves that were not playable in the position probing them");
+    out.sample("gomoku_tt_collisions_total", "", search.tt_collisions);
+    out.family("gomoku_search_cutoffs_total", "counter", "Beta cutoffs by the 1-based index of the cutting move");
+    for (int i = 0; i < gomoku::CUTOFF_MOVE_BUCKETS; i++) {
+        std::string move = i + 1 < gomoku::CUTOFF_MOVE_BUCKETS ? std::to_string(i + 1) : std::format("{}+", i + 1);
+        out.sample("gomoku_search_cutoffs_total", std::format("move=\"{}\"", move), search.cutoffs[i]);
+    }
+    out.family("gomoku_search_phase_calls_total", "counter", "Move generations, leaf evaluations and searches");
+    for (int i = 0; i < gomoku::SEARCH_PHASE_COUNT; i++) {
+        out.sample("gomoku_search_phase_calls_total",
+                   std::format("phase=\"{}\"", gomoku::search_phase_to_string(static_cast<gomoku::SearchPhase>(i))),
+                   search.phase_calls[i]);
+    }
+    out.family("gomoku_search_phase_seconds_total", "counter",
+               "Time in each phase; movegen and eval time is also part of search time");
+    for (int i = 0; i < gomoku::SEARCH_PHASE_COUNT; i++) {
+        out.sample("gomoku_search_phase_seconds_total",
+                   std::format("phase=\"{}\"", gomoku::search_phase_to_string(static_cast<gomoku::SearchPhase>(i))),
+                   static_cast<double>(search.phase_ns[i]) / 1e9);
+    }
+    out.family("gomoku_search_depth_iterations_total", "counter", "Iterative deepening iterations completed by depth");
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; depth++) {
+        out.sample("gomoku_search_depth_iterations_total", std::format("depth=\"{}\"", depth),
+                   search.depth_completed[depth]);
+    }
+    out.family("gomoku_search_depth_seconds_total", "counter", "Time spent in completed iterations by depth");
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; depth++) {
+        out.sample("gomoku_search_depth_seconds_total", std::format("depth=\"{}\"", depth),
+                   static_cast<double>(search.depth_ns[depth]) / 1e9);
+    }
+    
+    res.set_content(out.str(), PrometheusWriter::CONTENT_TYPE);
+}
+
+std::chrono::steady_clock::duration HttpServer::observe_request(const httplib::Request& req,
+                                                                const httplib::Response& res) {
+    if (res.status >= 100 && res.status < 600) {
+        responses_by_class_[res.status / 100 - 1].fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Requests refused before routing, such as malformed ones, were never timed
+    if (request_started == std::chrono::steady_clock::time_point{}) {
+        return {};
+    }
+    auto elapsed = std::chrono::steady_clock::now() - request_started;
+    request_started = {};
+    
+    auto histogram = request_latency_.find(req.matched_route);
+    if (histogram == request_latency_.end()) {
+        histogram = request_latency_.find("");
+    }
+    histogram->second.observe(elapsed);
+    return elapsed;
+}
+
 void HttpServer::handle_not_found(const httplib::Request& req, httplib::Response& res) {
     res.status = 404;
     auto error_response = create_error_response(
@@ -217,6 +754,20 @@ void HttpServer::handle_not_found(const httplib::Request& req, httplib::Response
     res.set_content(error_response.dump(), "application/json");
 }
 
+json HttpServer::move_response_json(const MoveResponse& response) const {
+    json response_json;
+    response_json["game_id"] = response.game_id;
+    response_json["game_status"] = response.game_status;
+    response_json["board_state"] = response.board_state;
+    response_json["move_history"] = response.move_history;
+    response_json["latest_move"] = response.move;
+    response_json["ai_metrics"]["positions_evaluated"] = response.positions_evaluated;
+    response_json["ai_metrics"]["move_time_ms"] = response.move_time_ms;
+    response_json["ai_metrics"]["depth_reached"] = response.depth_reached;
+    response_json["ai_metrics"]["timed_out"] = response.timed_out;
+    return response_json;
+}
+
 json HttpServer::get_system_metrics() const {
     json metrics;
     
@@ -305,6 +856,13 @@ std::expected<json, std::string> HttpServer::validate_move_request(const json& r
             return std::unexpected("game.board_size must be 15 or 19");
         }
         
+        if (game.contains("ai_config") && game["ai_config"].contains("algorithm")) {
+            const auto& algorithm = game["ai_config"]["algorithm"];
+            if (!algorithm.is_string() || !parse_search_algorithm(algorithm.get<std::string>())) {
+                return std::unexpected("game.ai_config.algorithm must be 'alphabeta' or 'mcts'");
+            }
+        }
+        
         // Validate current_player
         std::string current_player = request["current_player"];
         if (current_player != "x" && current_player != "o") {
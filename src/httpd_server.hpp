@@ -12,12 +12,19 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <expected>
+#include <map>
+#include <mutex>
 
 #include "httplib.h"
 #include "json.hpp"
 #include "httpd_cli.hpp"
 #include "httpd_game_api.hpp"
+#include "httpd_search_pool.hpp"
+#include "httpd_metrics.hpp"
 
 namespace gomoku::httpd {
 
@@ -40,19 +47,49 @@ private:
     // Route handlers
     void handle_status(const httplib::Request& req, httplib::Response& res);
     void handle_move(const httplib::Request& req, httplib::Response& res);
+    void handle_batch(const httplib::Request& req, httplib::Response& res);
     void handle_schema(const httplib::Request& req, httplib::Response& res);
+    void handle_metrics(const httplib::Request& req, httplib::Response& res);
+    void handle_subtree(const httplib::Request& req, httplib::Response& res);
     void handle_not_found(const httplib::Request& req, httplib::Response& res);
     
+    // Batch positions are searched a few at a time and streamed as they finish
+    struct BatchState;
+    void dispatch_batch(const std::shared_ptr<BatchState>& batch);
+    
+    // Subtree scores are streamed as the search on the pool finds them
+    struct SubtreeState;
+    
+    // Saves the shared transposition table every tt_snapshot_interval seconds
+    // and once more when stopped
+    void run_snapshots();
+    void save_snapshot();
+    
     // Utility methods
+    json move_response_json(const MoveResponse& response) const;
     json get_system_metrics() const;
+    std::chrono::steady_clock::duration observe_request(const httplib::Request& req, const httplib::Response& res);
     std::expected<json, std::string> validate_move_request(const json& request) const;
     json create_error_response(const std::string& error, int code = 400) const;
     
     HttpDaemonConfig config_;
     std::unique_ptr<httplib::Server> server_;
     std::unique_ptr<GameAPI> game_api_;
+    SearchPool search_pool_;
+    
+    // Latency per route pattern, created with the routes so lookups need no lock;
+    // the "" entry takes requests no route matched
+    std::map<std::string, LatencyHistogram, std::less<>> request_latency_;
+    std::array<std::atomic<uint64_t>, 5> responses_by_class_{};   // 1xx to 5xx
     std::atomic<bool> running_{false};
     std::thread server_thread_;
+    
+    std::thread snapshot_thread_;
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_wakeup_;
+    bool snapshot_stopping_ = false;              // Guarded by snapshot_mutex_
+    std::atomic<uint64_t> snapshot_saves_{0};
+    std::atomic<uint64_t> snapshot_entries_{0};   // Entries written by the last save
 };
 
 } // namespace gomoku::httpd
\ No newline at end of file
@@ -0,0 +1,82 @@
+//
+//  httpd_session_cache.cpp
+//  gomoku-httpd - LRU cache of live game states keyed by game id
+//
+//  Checkout, insertion with eviction, and the status metrics
+//
+
+#include "httpd_session_cache.hpp"
+
+namespace gomoku::httpd {
+
+SessionCache::SessionCache(size_t capacity) : capacity_(capacity) {}
+
+std::optional<GamePtr> SessionCache::take(const std::string& game_id) {
+    std::lock_guard lock(mutex_);
+
+    auto found = index_.find(game_id);
+    if (found == index_.end()) {
+        ++misses_;
+        return std::nullopt;
+    }
+
+    GamePtr game = std::move(found->second->game);
+    entries_.erase(found->second);
+    index_.erase(found);
+    ++hits_;
+    return game;
+}
+
+void SessionCache::put(const std::string& game_id, GamePtr game) {
+    if (capacity_ == 0) {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+
+    // A concurrent request for the same game may have put its state back first
+    if (auto found = index_.find(game_id); found != index_.end()) {
+        entries_.erase(found->second);
+        index_.erase(found);
+    }
+
+    entries_.push_front(Entry{game_id, std::move(game)});
+    index_[game_id] = entries_.begin();
+
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().game_id);
+        entries_.pop_back();
+        ++evictions_;
+    }
+}
+
+void SessionCache::record_rejected() {
+    std::lock_guard lock(mutex_);
+    ++rejected_;
+}
+
+size_t SessionCache::size() const {
+    std::lock_guard lock(mutex_);
+    return entries_.size();
+}
+
+json SessionCache::metrics() const {
+    std::lock_guard lock(mutex_);
+
+    json metrics;
+    metrics["capacity"] = capacity_;
+    metrics["entries"] = entries_.size();
+    metrics["entry_bytes"] = sizeof(game_state_t);
+    size_t memory_bytes = 0;
+    for (const auto& entry : entries_) {
+        memory_bytes += game_state_bytes(entry.game.get());
+    }
+    metrics["memory_bytes"] = memory_bytes;
+    metrics["hits"] = hits_;
+    metrics["misses"] = misses_;
+    metrics["rejected"] = rejected_;
+    metrics["evictions"] = evictions_;
+    return metrics;
+}
+
+} // namespace gomoku::httpd
@@ -0,0 +1,94 @@
+//
+//  httpd_session_cache.hpp
+//  gomoku-httpd - LRU cache of live game states keyed by game id
+//
+//  Lets consecutive move requests of one game continue from the previous search state
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "json.hpp"
+#include "game.h"
+
+namespace gomoku::httpd {
+
+using json = nlohmann::json;
+
+/**
+ * Owning pointer to a game state allocated by init_game().
+ */
+using GamePtr = std::unique_ptr<game_state_t, void(*)(game_state_t*)>;
+
+//===============================================================================
+// SESSION CACHE
+//===============================================================================
+
+/**
+ * Bounded least-recently-used map from game id to the game state left by
+ * that game's last request. A request checks its game out with take(), so
+ * two concurrent requests for one game never share a state, and hands it
+ * back with put() once its move is made. Every entry is one game_state_t
+ * of a few kilobytes plus its move history; search heuristics are borrowed
+ * from the scratch pool only while a request searches.
+ *
+ * All members are safe to call from concurrent request handlers.
+ */
+class SessionCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 128;
+
+    explicit SessionCache(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * Removes and returns the state cached for game_id, or nullopt on a miss.
+     */
+    [[nodiscard]] std::optional<GamePtr> take(const std::string& game_id);
+
+    /**
+     * Caches game under game_id as the most recently used entry, replacing
+     * any entry already there and evicting the least recently used ones
+     * beyond capacity. Does nothing when the capacity is zero.
+     */
+    void put(const std::string& game_id, GamePtr game);
+
+    /**
+     * Counts a cached state that take() returned but the request could not
+     * continue from, because its moves did not extend the cached ones.
+     */
+    void record_rejected();
+
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Capacity, entries, memory and hit/miss/eviction counters for /ai/v1/status.
+     */
+    [[nodiscard]] json metrics() const;
+
+private:
+    struct Entry {
+        std::string game_id;
+        GamePtr game;
+    };
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;   // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t rejected_ = 0;
+};
+
+} // namespace gomoku::httpd
@@ -0,0 +1,102 @@
+//
+//  httpd_wire.cpp
+//  gomoku-httpd - Request and response body encodings
+//
+//  Media type negotiation and the nlohmann CBOR/MessagePack codecs
+//
+
+#include "httpd_wire.hpp"
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace gomoku::httpd {
+
+namespace {
+
+constexpr std::array<std::pair<std::string_view, WireFormat>, 5> MEDIA_TYPES = {{
+    {"application/json", WireFormat::Json},
+    {"application/cbor", WireFormat::Cbor},
+    {"application/msgpack", WireFormat::MessagePack},
+    {"application/x-msgpack", WireFormat::MessagePack},
+    {"application/vnd.msgpack", WireFormat::MessagePack},
+}};
+
+// The media type without parameters or surrounding spaces
+std::string_view media_type(std::string_view value) {
+    value = value.substr(0, value.find(';'));
+    size_t first = value.find_first_not_of(' ');
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    size_t last = value.find_last_not_of(' ');
+    return value.substr(first, last - first + 1);
+}
+
+} // namespace
+
+std::optional<WireFormat> wire_format_from_content_type(std::string_view content_type) {
+    std::string_view type = media_type(content_type);
+    for (const auto& [name, format] : MEDIA_TYPES) {
+        if (type == name) {
+            return format;
+        }
+    }
+    return std::nullopt;
+}
+
+WireFormat wire_format_from_accept(std::string_view accept, WireFormat fallback) {
+    while (!accept.empty()) {
+        size_t comma = accept.find(',');
+        if (auto format = wire_format_from_content_type(accept.substr(0, comma))) {
+            return *format;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept.remove_prefix(comma + 1);
+    }
+    return fallback;
+}
+
+const char* wire_content_type(WireFormat format) {
+    switch (format) {
+        case WireFormat::Cbor:
+            return "application/cbor";
+        case WireFormat::MessagePack:
+            return "application/msgpack";
+        case WireFormat::Json:
+        default:
+            return "application/json";
+    }
+}
+
+json decode_body(std::string_view body, WireFormat format) {
+    switch (format) {
+        case WireFormat::Cbor:
+            return json::from_cbor(body.begin(), body.end());
+        case WireFormat::MessagePack:
+            return json::from_msgpack(body.begin(), body.end());
+        case WireFormat::Json:
+        default:
+            return json::parse(body);
+    }
+}
+
+std::string encode_body(const json& document, WireFormat format) {
+    switch (format) {
+        case WireFormat::Cbor: {
+            std::vector<uint8_t> bytes = json::to_cbor(document);
+            return std::string(bytes.begin(), bytes.end());
+        }
+        case WireFormat::MessagePack: {
+            std::vector<uint8_t> bytes = json::to_msgpack(document);
+            return std::string(bytes.begin(), bytes.end());
+        }
+        case WireFormat::Json:
+        default:
+            return document.dump(2);
+    }
+}
+
+} // namespace gomoku::httpd
@@ -0,0 +1,53 @@
+//
+//  httpd_wire.hpp
+//  gomoku-httpd - Request and response body encodings
+//
+//  JSON for browsers and curl, CBOR or MessagePack for service-to-service calls
+//
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "json.hpp"
+
+namespace gomoku::httpd {
+
+using json = nlohmann::json;
+
+/**
+ * Body encodings of /ai/v1/move. The binary ones carry the same document
+ * as JSON, with the board as packed binary instead of visual strings.
+ */
+enum class WireFormat {
+    Json,
+    Cbor,
+    MessagePack
+};
+
+/**
+ * The format a Content-Type header names, or nullopt when it names none we read.
+ */
+std::optional<WireFormat> wire_format_from_content_type(std::string_view content_type);
+
+/**
+ * The first format an Accept header lists, or fallback when it lists none
+ * we write, as for a wildcard or an empty header.
+ */
+WireFormat wire_format_from_accept(std::string_view accept, WireFormat fallback);
+
+const char* wire_content_type(WireFormat format);
+
+/**
+ * Parses body; throws json::parse_error on malformed input, like json::parse().
+ */
+json decode_body(std::string_view body, WireFormat format);
+
+/**
+ * Serializes document; JSON is indented for readability.
+ */
+std::string encode_body(const json& document, WireFormat format);
+
+} // namespace gomoku::httpd
@@ -13,6 +13,7 @@
 #include "game_coordinator.hpp"
 #include "ui.hpp"
 #include "cli.hpp"
+#include "game_analysis.hpp"
 
 int main(int argc, char* argv[]) {
     // Initialize random seed for first move randomization
@@ -33,6 +34,11 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
+        // Analysis writes JSON lines instead of starting the TUI
+        if (config.analyze_path[0] != '\0') {
+            return gomoku::run_analysis_command(config, stdout);
+        }
+
         clear_screen();
 
         if (!config.skip_welcome) {
@@ -0,0 +1,591 @@
+//
+//  mcts.cpp
+//  gomoku - Monte Carlo tree search engine
+//
+//  Tree policy, expansion, rollouts and reuse of the tree between moves
+//
+
+#include "mcts.hpp"
+#include "ansi.h"
+#include "search_metrics.hpp"
+#include "search_scratch.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <iterator>
+#include <vector>
+
+namespace gomoku {
+
+namespace {
+
+//===============================================================================
+// TREE NODES
+//===============================================================================
+
+// Results are summed as fixed point, so that backing one up is a single atomic add
+constexpr int64_t VALUE_SCALE = 1 << 16;
+
+constexpr double EXPLORATION = 1.4;         // Weight of the prior in PUCT
+constexpr double FIRST_PLAY_REDUCTION = 0.2; // Unvisited children start this far below their parent
+constexpr int MAX_CHILDREN = 24;            // Moves kept at a node, by priority
+constexpr int ROLLOUT_MOVES = 8;            // Moves played out below a leaf before it is scored
+constexpr double EVAL_SCALE = 4000.0;       // Threat score that maps to a result of tanh(1)
+constexpr double MAX_RESULT = 0.999;        // Bound on results turned back into scores
+
+constexpr int WIN_PRIORITY = 100000;        // get_move_priority_optimized() of a winning move
+constexpr int BLOCK_PRIORITY = 50000;       // ... and of a move blocking the opponent's win
+
+enum class NodeState : uint8_t {
+    Unexpanded,
+    Expanding,      // A thread is adding the children
+    Expanded,
+    Terminal        // The game is over: outcome holds the result
+};
+
+/**
+ * A tree node. Statistics are shared by every searching thread and only
+ * touched through atomic_ref; the children's range is written once, before
+ * state becomes Expanded, and read only after seeing it.
+ */
+struct Node {
+    int64_t value;          // Sum of results, VALUE_SCALE per win, for the player who moved into the node
+    int32_t visits;
+    int32_t virtual_loss;   // Playouts now below the node, each counted as a loss until backed up
+    uint32_t first_child;
+    uint16_t child_count;
+    int16_t cell;           // x * Size + y of the move into the node, -1 at the root
+    float prior;
+    NodeState state;
+    int8_t outcome;         // Of a Terminal node: 1 if the move into it won, 0 for a full board
+};
+
+template<typename T>
+std::atomic_ref<T> shared(T& field) noexcept {
+    return std::atomic_ref<T>(field);
+}
+
+void init_node(Node& node, int cell, float prior) noexcept {
+    node = Node{0, 0, 0, 0, 0, static_cast<int16_t>(cell), prior, NodeState::Unexpanded, 0};
+}
+
+// Mean result of node for the player who moved into it, virtual losses included
+double mean_result(Node& node, double unvisited) noexcept {
+    int visits = shared(node.visits).load(std::memory_order_relaxed);
+    int virtual_loss = shared(node.virtual_loss).load(std::memory_order_relaxed);
+    if (visits + virtual_loss == 0) {
+        return unvisited;
+    }
+    double value = static_cast<double>(shared(node.value).load(std::memory_order_relaxed)) / VALUE_SCALE;
+    return (value - virtual_loss) / (visits + virtual_loss);
+}
+
+int result_to_score(double result) {
+    return static_cast<int>(EVAL_SCALE * std::atanh(std::clamp(result, -MAX_RESULT, MAX_RESULT)));
+}
+
+} // namespace
+
+//===============================================================================
+// TREE AND SEARCH STATE
+//===============================================================================
+
+struct MctsEngine::Tree {
+    explicit Tree(size_t capacity)
+        : nodes(std::make_unique_for_overwrite<Node[]>(capacity)), capacity(capacity) {}
+
+    uint64_t owner = 0;             // search_id of the game the tree was grown for
+    int root_history = -1;          // The game's move_history_count at the root, -1 for no tree
+    BitBoard root_board;            // Stones at the root
+    int root_player = 0;            // Side to move at the root
+    uint32_t root = 0;
+
+    // Pages of the arena are only touched as nodes are allocated
+    std::unique_ptr<Node[]> nodes;
+    size_t capacity;
+    std::atomic<size_t> used{0};
+    std::atomic<bool> full{false};
+
+    Node& operator[](uint32_t index) noexcept { return nodes[index]; }
+
+    void clear() noexcept {
+        used.store(1, std::memory_order_relaxed);
+        full.store(false, std::memory_order_relaxed);
+        root = 0;
+        init_node(nodes[0], -1, 1.0f);
+    }
+
+    // First of count consecutive nodes, or nullopt once the arena is spent
+    std::optional<uint32_t> allocate(int count) noexcept {
+        size_t first = used.fetch_add(count, std::memory_order_relaxed);
+        if (first + count > capacity) {
+            full.store(true, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(first);
+    }
+};
+
+struct MctsEngine::Search {
+    uint64_t budget = 0;                    // Playouts to run unless stopped first
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> nodes{0};
+};
+
+namespace {
+
+//===============================================================================
+// EXPANSION
+//===============================================================================
+
+/**
+ * Adds the children of a node whose position is in game, with player to
+ * move, and publishes them. Returns the node's new state: Unexpanded again
+ * if the arena is spent.
+ */
+template<int Size> requires ValidBoardSize<Size>
+NodeState expand(MctsEngine::Tree& tree, uint32_t index, game_state_t* game, int player) {
+    PhaseTimer timer(SearchPhase::MoveGen);
+    Node& node = tree[index];
+
+    struct Candidate {
+        int cell;
+        int priority;
+    };
+    std::array<Candidate, Size * Size> candidates;
+    int total_count = 0;
+    game->candidates.for_each([&](int x, int y) {
+        candidates[total_count++] = {x * Size + y, get_move_priority_optimized<Size>(game, x, y, player)};
+    });
+
+    if (total_count == 0) {
+        node.outcome = 0;
+        shared(node.state).store(NodeState::Terminal, std::memory_order_release);
+        return NodeState::Terminal;
+    }
+
+    auto by_priority = [](const Candidate& a, const Candidate& b) { return a.priority > b.priority; };
+    int count = std::min(total_count, MAX_CHILDREN);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.begin() + total_count, by_priority);
+
+    // A win is the only move worth trying, and blocking the opponent's the only other
+    if (candidates[0].priority >= WIN_PRIORITY) {
+        count = 1;
+    } else if (candidates[0].priority >= BLOCK_PRIORITY) {
+        count = static_cast<int>(std::find_if(candidates.begin(), candidates.begin() + count,
+                [](const Candidate& c) { return c.priority < BLOCK_PRIORITY; }) - candidates.begin());
+    }
+
+    auto first = tree.allocate(count);
+    if (!first) {
+        shared(node.state).store(NodeState::Unexpanded, std::memory_order_release);
+        return NodeState::Unexpanded;
+    }
+
+    double total = 0.0;
+    for (int i = 0; i < count; i++) {
+        total += candidates[i].priority + 1;
+    }
+    for (int i = 0; i < count; i++) {
+        Node& child = tree[*first + i];
+        init_node(child, candidates[i].cell, static_cast<float>((candidates[i].priority + 1) / total));
+        if (candidates[i].priority >= WIN_PRIORITY) {
+            child.state = NodeState::Terminal;
+            child.outcome = 1;
+        }
+    }
+
+    node.first_child = *first;
+    node.child_count = static_cast<uint16_t>(count);
+    shared(node.state).store(NodeState::Expanded, std::memory_order_release);
+    return NodeState::Expanded;
+}
+
+//===============================================================================
+// TREE POLICY
+//===============================================================================
+
+/**
+ * The child of an expanded node to descend into: the best mean result plus
+ * an exploration bonus that shrinks as the child is visited, PUCT-style.
+ */
+uint32_t select_child(MctsEngine::Tree& tree, Node& node) {
+    int parent_visits = shared(node.visits).load(std::memory_order_relaxed) +
+                        shared(node.virtual_loss).load(std::memory_order_relaxed);
+    double exploration = EXPLORATION * std::sqrt(static_cast<double>(std::max(parent_visits, 1)));
+
+    // The parent's mean is from the other player's view
+    double unvisited = -mean_result(node, 0.0) - FIRST_PLAY_REDUCTION;
+
+    uint32_t best = node.first_child;
+    double best_score = -1e9;
+    for (uint32_t i = node.first_child; i < node.first_child + node.child_count; i++) {
+        Node& child = tree[i];
+        int visits = shared(child.visits).load(std::memory_order_relaxed) +
+                     shared(child.virtual_loss).load(std::memory_order_relaxed);
+        double score = mean_result(child, unvisited) + exploration * child.prior / (1 + visits);
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// The most visited child, or 0 if the node has none
+uint32_t most_visited_child(MctsEngine::Tree& tree, const Node& node) {
+    if (node.state != NodeState::Expanded) {
+        return 0;
+    }
+    uint32_t best = 0;
+    int best_visits = 0;
+    for (uint32_t i = node.first_child; i < node.first_child + node.child_count; i++) {
+        if (tree[i].visits > best_visits) {
+            best_visits = tree[i].visits;
+            best = i;
+        }
+    }
+    return best;
+}
+
+//===============================================================================
+// ROLLOUTS
+//===============================================================================
+
+/**
+ * Plays up to ROLLOUT_MOVES moves from game's position, player to move,
+ * and returns the result for player. Each side wins when it can, blocks
+ * when it must, and otherwise picks a move with probability growing with the
+ * square of its priority. A rollout that ends undecided is scored from the
+ * threat cache. The position is restored before returning.
+ */
+template<int Size> requires ValidBoardSize<Size>
+double rollout(game_state_t* game, int player, uint64_t& rng, uint64_t& nodes) {
+    PhaseTimer timer(SearchPhase::Eval);
+    std::array<int, ROLLOUT_MOVES> played;
+    int played_count = 0;
+    int side = player;
+    std::optional<double> result;
+
+    while (played_count < ROLLOUT_MOVES) {
+        int win = -1, block = -1, chosen = -1;
+        uint64_t total = 0;
+        game->candidates.for_each([&](int x, int y) {
+            int priority = get_move_priority_optimized<Size>(game, x, y, side);
+            if (priority >= WIN_PRIORITY) {
+                win = x * Size + y;
+            } else if (priority >= BLOCK_PRIORITY) {
+                block = x * Size + y;
+            } else {
+                // Weighted reservoir sampling: one pass, no list of moves
+                uint64_t weight = static_cast<uint64_t>(priority) * priority + 1;
+                total += weight;
+                if (splitmix64(rng) % total < weight) {
+                    chosen = x * Size + y;
+                }
+            }
+        });
+
+        if (win >= 0) {
+            result = side == player ? 1.0 : -1.0;
+            break;
+        }
+        int cell = block >= 0 ? block : chosen;
+        if (cell < 0) {
+            result = 0.0;
+            break;
+        }
+
+        place_stone<Size>(game, cell / Size, cell % Size, side);
+        played[played_count++] = cell;
+        side = ::other_player(side);
+    }
+    nodes += played_count;
+
+    if (!result) {
+        result = std::tanh(game->threats.evaluate(static_cast<Player>(player)) / EVAL_SCALE);
+    }
+    for (int i = played_count - 1; i >= 0; i--) {
+        remove_stone<Size>(game, played[i] / Size, played[i] % Size);
+    }
+    return *result;
+}
+
+} // namespace
+
+//===============================================================================
+// SEARCH
+//===============================================================================
+
+std::optional<SearchAlgorithm> parse_search_algorithm(std::string_view name) {
+    if (name == "alphabeta") return SearchAlgorithm::AlphaBeta;
+    if (name == "mcts") return SearchAlgorithm::MonteCarlo;
+    return std::nullopt;
+}
+
+const char* search_algorithm_to_string(SearchAlgorithm algorithm) {
+    return algorithm == SearchAlgorithm::MonteCarlo ? "mcts" : "alphabeta";
+}
+
+MctsEngine::MctsEngine(ThreadPool* pool, size_t node_capacity)
+    : pool_(pool), node_capacity_(node_capacity) {}
+
+MctsEngine::~MctsEngine() = default;
+
+void MctsEngine::find_best_move(game_state_t* game, int* best_x, int* best_y) {
+    ScratchLease lease(game);
+    SearchMetricsScope metrics(game);
+
+    game->search_start_time = get_current_time();
+    game->search_timed_out = 0;
+    game->search_depth_reached = 0;
+    game->search_nodes = 0;
+    game->search_tt_probes = 0;
+    game->search_tt_hits = 0;
+    game->search_moves_evaluated = 0;
+    *best_x = -1;
+    *best_y = -1;
+
+    if (probe_opening_book(game, best_x, best_y)) {
+        return;
+    }
+
+    if (game->bitboard.stone_count() <= 1) {
+        find_first_ai_move(game, best_x, best_y);
+        game->search_depth_reached = 1;
+        add_ai_history_entry(game, 1);
+        return;
+    }
+
+    // Forced wins are proven outright, not estimated
+    if (find_forced_win(game, best_x, best_y)) {
+        return;
+    }
+
+    dispatch_board_size(game->board_size, [&]<int Size>(std::integral_constant<int, Size>) {
+        search<Size>(game, best_x, best_y);
+    });
+}
+
+template<int Size> requires ValidBoardSize<Size>
+void MctsEngine::search(game_state_t* game, int* best_x, int* best_y) {
+    std::unique_ptr<Tree> tree = acquire_tree(game);
+    Search search;
+    search.budget = static_cast<uint64_t>(std::max(game->max_depth, 1)) * PLAYOUTS_PER_DEPTH;
+    SearchPosition root_position = SearchPosition::capture(*game);
+
+    // Threads are told apart by their seeds, and searches by the counter
+    static std::atomic<uint64_t> searches{0};
+    uint64_t seed = game->search_id ^ (searches.fetch_add(1, std::memory_order_relaxed) << 32);
+
+    if (pool_ && pool_->size() > 1) {
+        std::vector<std::future<void>> futures;
+        for (size_t i = 0; i < pool_->size(); i++) {
+            futures.emplace_back(pool_->enqueue([game, &root_position, &tree, &search, seed, i]() {
+                run_playouts<Size>(game, root_position, tree.get(), &search, seed + i);
+            }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    } else {
+        run_playouts<Size>(game, root_position, tree.get(), &search, seed);
+    }
+
+    // The most visited move is the one the playouts trust most
+    Node& root = (*tree)[tree->root];
+    uint32_t best = most_visited_child(*tree, root);
+    if (best == 0) {
+        // Not even the root was expanded in time: fall back on move ordering
+        int best_priority = -1;
+        game->candidates.for_each([&](int x, int y) {
+            int priority = get_move_priority_optimized<Size>(game, x, y, game->current_player);
+            if (priority > best_priority) {
+                best_priority = priority;
+                *best_x = x;
+                *best_y = y;
+            }
+        });
+    } else {
+        *best_x = (*tree)[best].cell / Size;
+        *best_y = (*tree)[best].cell % Size;
+    }
+
+    // The line of most visited moves stands in for a principal variation
+    search_depth_t report{};
+    for (uint32_t node = best; node != 0 && report.pv_length < MAX_SEARCH_DEPTH;
+            node = most_visited_child(*tree, (*tree)[node])) {
+        report.pv[report.pv_length][0] = (*tree)[node].cell / Size;
+        report.pv[report.pv_length][1] = (*tree)[node].cell % Size;
+        report.pv_length++;
+    }
+
+    uint64_t completed = search.completed.load();
+    game->search_depth_reached = report.pv_length;
+    game->search_nodes = search.nodes.load();
+    game->search_timed_out = completed < search.budget;
+
+    if (best != 0 && game->on_search_depth) {
+        Node& chosen = (*tree)[best];
+        report.depth = report.pv_length;
+        report.score = chosen.state == NodeState::Terminal && chosen.outcome > 0
+            ? WIN_SCORE : result_to_score(mean_result(chosen, 0.0));
+        report.best_x = *best_x;
+        report.best_y = *best_y;
+        report.nodes = game->search_nodes;
+        report.elapsed = get_current_time() - game->search_start_time;
+        game->on_search_depth(game->search_depth_context, &report);
+    }
+
+    size_t threads = pool_ ? std::max<size_t>(pool_->size(), 1) : 1;
+    snprintf(game->ai_status_message, sizeof(game->ai_status_message),
+            "%s%s%s MCTS done in %.1fs (%llu playouts, %zu threads)",
+            COLOR_BLUE, "O", COLOR_RESET, get_current_time() - game->search_start_time,
+            static_cast<unsigned long long>(completed), threads);
+    add_ai_history_entry(game, static_cast<int>(std::min<uint64_t>(completed, INT32_MAX)));
+
+    release_tree(std::move(tree));
+}
+
+template<int Size> requires ValidBoardSize<Size>
+void MctsEngine::run_playouts(const game_state_t* game, const SearchPosition& root_position, Tree* tree,
+                              Search* search, uint64_t seed) {
+    game_state_t* position = thread_search_state(*game, root_position);
+    uint64_t rng = seed;
+    uint64_t nodes = 0;
+    std::array<uint32_t, Size * Size + 1> path;
+
+    while (search->started.fetch_add(1, std::memory_order_relaxed) < search->budget &&
+            !is_search_timed_out(position)) {
+        // Descend to a leaf, marking the way with virtual losses
+        int path_length = 0;
+        uint32_t index = tree->root;
+        int player = position->current_player;
+        path[path_length++] = index;
+
+        NodeState state = shared((*tree)[index].state).load(std::memory_order_acquire);
+        while (state == NodeState::Expanded) {
+            index = select_child(*tree, (*tree)[index]);
+            Node& child = (*tree)[index];
+            shared(child.virtual_loss).fetch_add(1, std::memory_order_relaxed);
+            place_stone<Size>(position, child.cell / Size, child.cell % Size, player);
+            player = ::other_player(player);
+            path[path_length++] = index;
+            state = shared(child.state).load(std::memory_order_acquire);
+        }
+        nodes += path_length;
+
+        // A leaf is expanded on its second visit, the root on its first
+        Node& leaf = (*tree)[index];
+        if (state == NodeState::Unexpanded && !tree->full.load(std::memory_order_relaxed) &&
+                (index == tree->root || shared(leaf.visits).load(std::memory_order_relaxed) > 0) &&
+                shared(leaf.state).compare_exchange_strong(state, NodeState::Expanding, std::memory_order_acquire)) {
+            state = expand<Size>(*tree, index, position, player);
+        }
+
+        // Results are for the player who moved into the leaf
+        double result = state == NodeState::Terminal
+            ? static_cast<double>(leaf.outcome)
+            : -rollout<Size>(position, player, rng, nodes);
+
+        for (int i = path_length - 1; i >= 0; i--) {
+            Node& node = (*tree)[path[i]];
+            shared(node.value).fetch_add(static_cast<int64_t>(std::llround(result * VALUE_SCALE)),
+                                         std::memory_order_relaxed);
+            shared(node.visits).fetch_add(1, std::memory_order_relaxed);
+            if (i > 0) {
+                shared(node.virtual_loss).fetch_sub(1, std::memory_order_relaxed);
+                remove_stone<Size>(position, node.cell / Size, node.cell % Size);
+            }
+            result = -result;
+        }
+        search->completed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    search->nodes.fetch_add(nodes, std::memory_order_relaxed);
+}
+
+//===============================================================================
+// TREE REUSE
+//===============================================================================
+
+std::unique_ptr<MctsEngine::Tree> MctsEngine::acquire_tree(const game_state_t* game) {
+    std::unique_ptr<Tree> tree;
+    {
+        std::lock_guard lock(mutex_);
+        auto owned = std::ranges::find_if(idle_, [game](const auto& t) { return t->owner == game->search_id; });
+        if (owned == idle_.end() && !idle_.empty()) {
+            owned = std::prev(idle_.end());
+            (*owned)->root_history = -1;
+        }
+        if (owned != idle_.end()) {
+            tree = std::move(*owned);
+            idle_.erase(owned);
+        }
+    }
+    if (!tree) {
+        tree = std::make_unique<Tree>(node_capacity_);
+    }
+
+    // Follow the moves played since the last search down to the new root;
+    // a tree half spent on other lines is cheaper to grow again
+    bool reused = tree->owner == game->search_id && tree->root_history >= 0 &&
+                  game->move_history_count >= tree->root_history &&
+                  tree->used.load() <= tree->capacity / 2;
+    uint32_t root = tree->root;
+    if (reused) {
+        BitBoard board = tree->root_board;
+        int player = tree->root_player;
+        for (int i = tree->root_history; i < game->move_history_count && reused; i++) {
+            const move_history_t& move = game->move_history[i];
+            const Node& node = (*tree)[root];
+            reused = move.player == player && node.state == NodeState::Expanded;
+            uint32_t next = 0;
+            for (uint32_t c = node.first_child; reused && c < node.first_child + node.child_count; c++) {
+                if ((*tree)[c].cell == move.x * game->board_size + move.y) {
+                    next = c;
+                }
+            }
+            reused = reused && next != 0;
+            if (reused) {
+                board.place(move.x, move.y, static_cast<Player>(player));
+                root = next;
+                player = ::other_player(player);
+            }
+        }
+        reused = reused && player == game->current_player && board == game->bitboard &&
+                 (*tree)[root].state != NodeState::Terminal;
+    }
+
+    if (reused) {
+        tree->root = root;
+        reused_visits_.store(static_cast<uint64_t>((*tree)[root].visits), std::memory_order_relaxed);
+    } else {
+        reused_visits_.store(0, std::memory_order_relaxed);
+        tree->clear();
+    }
+    tree->owner = game->search_id;
+    tree->root_history = game->move_history_count;
+    tree->root_board = game->bitboard;
+    tree->root_player = game->current_player;
+    return tree;
+}
+
+void MctsEngine::release_tree(std::unique_ptr<Tree> tree) {
+    std::lock_guard lock(mutex_);
+    idle_.push_front(std::move(tree));
+    if (idle_.size() > IDLE_TREES) {
+        idle_.pop_back();
+    }
+}
+
+MctsEngine& shared_mcts_engine() {
+    static MctsEngine engine;
+    return engine;
+}
+
+} // namespace gomoku
@@ -0,0 +1,111 @@
+//
+//  mcts.hpp
+//  gomoku - Monte Carlo tree search engine
+//
+//  Arena-allocated search tree grown by many threads at once with virtual loss
+//
+
+#pragma once
+
+#include "ai.h"
+#include "search_position.hpp"
+#include "util/thread_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+namespace gomoku {
+
+/**
+ * Parses "alphabeta" or "mcts"; anything else yields std::nullopt.
+ */
+std::optional<SearchAlgorithm> parse_search_algorithm(std::string_view name);
+
+const char* search_algorithm_to_string(SearchAlgorithm algorithm);
+
+//===============================================================================
+// MONTE CARLO TREE SEARCH
+//===============================================================================
+
+/**
+ * Monte Carlo tree search: each playout descends the tree by PUCT, expands
+ * the leaf it reaches and scores it with a short threat-aware rollout.
+ * Children are the highest-priority moves of get_move_priority_optimized(),
+ * narrowed to the winning or blocking moves when there are any, so forced
+ * lines are followed rather than sampled.
+ *
+ * The tree lives in a fixed arena of nodes that threads allocate from with
+ * one atomic add, and every thread grows the same tree: a thread descending
+ * through a node adds a virtual loss to it, which steers the others to
+ * different lines until its playout is backed up.
+ *
+ * The search is anytime: it stops at the game's deadline, on abort_search or
+ * after a playout budget that grows with max_depth, and always answers with
+ * the most visited root move.
+ *
+ * After each search the tree is kept for the game that grew it, and the next
+ * search on that game starts from the subtree below the moves played since.
+ * All members are safe to call from concurrent searches.
+ */
+class MctsEngine {
+public:
+    static constexpr size_t DEFAULT_NODE_CAPACITY = size_t{1} << 20;
+    static constexpr size_t IDLE_TREES = 4;        // Trees kept for reuse, most recently searched first
+    static constexpr int PLAYOUTS_PER_DEPTH = 2500; // Playout budget per ply of max_depth
+
+    /**
+     * @param pool Threads that share each search, or null to search on the
+     *        calling thread alone
+     * @param node_capacity Nodes in each tree's arena
+     */
+    explicit MctsEngine(ThreadPool* pool = nullptr, size_t node_capacity = DEFAULT_NODE_CAPACITY);
+    ~MctsEngine();
+
+    MctsEngine(const MctsEngine&) = delete;
+    MctsEngine& operator=(const MctsEngine&) = delete;
+
+    /**
+     * Finds the move for the side to move, game->current_player, with the
+     * same book, first-move and forced-win shortcuts as the alpha-beta search.
+     */
+    void find_best_move(game_state_t* game, int* best_x, int* best_y);
+
+    /**
+     * Visits the last search inherited from the search before it on the
+     * same game, 0 if it grew a new tree. For tests and diagnostics.
+     */
+    [[nodiscard]] uint64_t reused_visits() const noexcept { return reused_visits_.load(std::memory_order_relaxed); }
+
+    // Defined in mcts.cpp
+    struct Tree;
+    struct Search;
+
+private:
+    template<int Size> requires ValidBoardSize<Size>
+    void search(game_state_t* game, int* best_x, int* best_y);
+
+    template<int Size> requires ValidBoardSize<Size>
+    static void run_playouts(const game_state_t* game, const SearchPosition& root_position, Tree* tree,
+                             Search* search, uint64_t seed);
+
+    std::unique_ptr<Tree> acquire_tree(const game_state_t* game);
+    void release_tree(std::unique_ptr<Tree> tree);
+
+    ThreadPool* pool_;
+    size_t node_capacity_;
+    std::mutex mutex_;
+    std::list<std::unique_ptr<Tree>> idle_;
+    std::atomic<uint64_t> reused_visits_{0};
+};
+
+/**
+ * The engine of searches run without a ParallelAI, on the calling thread.
+ */
+MctsEngine& shared_mcts_engine();
+
+} // namespace gomoku
@@ -0,0 +1,145 @@
+//
+//  move_picker.cpp
+//  gomoku - Staged move generation for the alpha-beta search
+//
+//  Stage transitions and the lazy selection of the remaining candidates
+//
+
+#include "move_picker.hpp"
+#include "search_metrics.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace gomoku {
+
+//===============================================================================
+// CONSTRUCTION
+//===============================================================================
+
+template<int Size> requires ValidBoardSize<Size>
+MovePicker<Size>::MovePicker(game_state_t *game, int ply, int player, int tt_x, int tt_y,
+                             int last_x, int last_y) noexcept
+    : game_(game), ply_(ply), player_(player), tt_x_(tt_x), tt_y_(tt_y), last_x_(last_x), last_y_(last_y) {
+    // A table move from a colliding or stale entry may not be playable here
+    if (!game_->board.is_playable(tt_x_, tt_y_)) {
+        if (tt_x_ >= 0) {
+            record_tt_collision();
+        }
+        tt_x_ = -1;
+        tt_y_ = -1;
+    }
+}
+
+//===============================================================================
+// STAGES
+//===============================================================================
+
+template<int Size> requires ValidBoardSize<Size>
+bool MovePicker<Size>::next(move_t &move) noexcept {
+    switch (stage_) {
+        case Stage::TableMove:
+            stage_ = Stage::Generate;
+            if (tt_x_ >= 0) {
+                move = {tt_x_, tt_y_, KILLER_PRIORITY};
+                ++picked_;
+                return true;
+            }
+            [[fallthrough]];
+
+        case Stage::Generate:
+            generate();
+            stage_ = Stage::Tactical;
+            [[fallthrough]];
+
+        case Stage::Tactical:
+            if (current_ < count_) {
+                select_best();
+                if (moves_[current_].priority >= TACTICAL_PRIORITY) {
+                    move = moves_[current_++];
+                    ++picked_;
+                    return true;
+                }
+            }
+            stage_ = Stage::Killers;
+            [[fallthrough]];
+
+        case Stage::Killers:
+            while (ply_ >= 0 && ply_ < MAX_SEARCH_DEPTH && killer_index_ < MAX_KILLER_MOVES) {
+                const int *killer = game_->scratch->killer_moves[ply_][killer_index_++];
+                for (int i = current_; i < count_; ++i) {
+                    if (moves_[i].x == killer[0] && moves_[i].y == killer[1]) {
+                        std::swap(moves_[i], moves_[current_]);
+                        std::swap(keys_[i], keys_[current_]);
+                        move = moves_[current_++];
+                        move.priority = std::max(move.priority, KILLER_PRIORITY);
+                        ++picked_;
+                        return true;
+                    }
+                }
+            }
+            stage_ = Stage::Quiet;
+            [[fallthrough]];
+
+        case Stage::Quiet:
+            if (current_ < count_) {
+                select_best();
+                move = moves_[current_++];
+                ++picked_;
+                return true;
+            }
+            stage_ = Stage::Done;
+            [[fallthrough]];
+
+        case Stage::Done:
+            break;
+    }
+    return false;
+}
+
+//===============================================================================
+// GENERATION AND SELECTION
+//===============================================================================
+
+template<int Size> requires ValidBoardSize<Size>
+void MovePicker<Size>::generate() noexcept {
+    PhaseTimer timer(SearchPhase::MoveGen);
+
+    // The reply that refuted the previous move last time ranks like a move that always cuts off
+    int counter_x = -1, counter_y = -1;
+    get_countermove(game_, player_, last_x_, last_y_, &counter_x, &counter_y);
+
+    game_->candidates.for_each([this, counter_x, counter_y](int x, int y) {
+        if (is_table_move(x, y)) {
+            return;
+        }
+
+        int priority = get_move_priority_optimized<Size>(game_, x, y, player_);
+        moves_[count_] = {x, y, priority};
+        keys_[count_] = priority + get_history_score(game_, player_, x, y);
+        if (x == counter_x && y == counter_y) {
+            keys_[count_] += MAX_HISTORY_SCORE;
+        }
+        ++count_;
+    });
+}
+
+template<int Size> requires ValidBoardSize<Size>
+void MovePicker<Size>::select_best() noexcept {
+    int best = current_;
+    for (int i = current_ + 1; i < count_; ++i) {
+        if (keys_[i] > keys_[best]) {
+            best = i;
+        }
+    }
+    std::swap(moves_[best], moves_[current_]);
+    std::swap(keys_[best], keys_[current_]);
+}
+
+//===============================================================================
+// EXPLICIT TEMPLATE INSTANTIATIONS
+//===============================================================================
+
+template class MovePicker<15>;
+template class MovePicker<19>;
+
+} // namespace gomoku
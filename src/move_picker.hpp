@@ -0,0 +1,92 @@
+//
+//  move_picker.hpp
+//  gomoku - Staged move generation for the alpha-beta search
+//
+//  Hands out moves one at a time, doing only as much ordering work as the node needs
+//
+
+#pragma once
+
+#include "ai.h"
+#include <array>
+
+namespace gomoku {
+
+//===============================================================================
+// MOVE PICKER CLASS
+//===============================================================================
+
+/**
+ * Yields the moves of a search node best-first, in stages:
+ *
+ *   1. the transposition table move, before any other move is generated;
+ *   2. immediate wins, then blocks of the opponent's wins;
+ *   3. the killer moves stored for this ply;
+ *   4. the remaining candidates, by priority plus relative history score,
+ *      with a bonus for the countermove that last refuted the previous move.
+ *
+ * The candidates are scored when stage 1 is exhausted, and each later move
+ * is found by a selection pass over the moves not yet tried, so a node that
+ * cuts off on its first few moves never sorts the rest.
+ *
+ * Moves from stages 1 and 3 come out with a priority of at least
+ * KILLER_PRIORITY, so callers that prune low-priority moves never drop them.
+ *
+ * The picker is specialized on the board size, so its move lists hold
+ * exactly Size * Size entries; the search keeps one per node on the stack.
+ */
+template<int Size> requires ValidBoardSize<Size>
+class MovePicker {
+public:
+    static constexpr int TACTICAL_PRIORITY = 50000;   // Wins and blocks from get_move_priority_optimized()
+    static constexpr int KILLER_PRIORITY = 10000;
+
+    /**
+     * @param game The position to pick moves in; must outlive the picker and
+     *             be back in this position whenever next() is called
+     * @param ply Plies from the search root to the node, which selects its killers
+     * @param player The side to move
+     * @param tt_x X coordinate of the table move, or -1 for none
+     * @param tt_y Y coordinate of the table move, or -1 for none
+     * @param last_x X coordinate of the move that led here, or -1 for none
+     * @param last_y Y coordinate of the move that led here
+     */
+    MovePicker(game_state_t *game, int ply, int player, int tt_x, int tt_y,
+               int last_x = -1, int last_y = -1) noexcept;
+
+    /**
+     * Stores the next move in move and returns true, or returns false once
+     * every move has been handed out.
+     */
+    [[nodiscard]] bool next(move_t &move) noexcept;
+
+    /**
+     * Number of moves handed out so far.
+     */
+    [[nodiscard]] int picked() const noexcept { return picked_; }
+
+private:
+    enum class Stage { TableMove, Generate, Tactical, Killers, Quiet, Done };
+
+    void generate() noexcept;
+    void select_best() noexcept;
+    [[nodiscard]] bool is_table_move(int x, int y) const noexcept { return x == tt_x_ && y == tt_y_; }
+
+    game_state_t *game_;
+    int ply_;
+    int player_;
+    int tt_x_, tt_y_;
+    int last_x_, last_y_;
+
+    Stage stage_ = Stage::TableMove;
+    int killer_index_ = 0;
+    int picked_ = 0;
+
+    // Candidates not yet handed out live in moves_[current_, count_)
+    std::array<move_t, Size * Size> moves_;
+    std::array<int, Size * Size> keys_;
+    int count_ = 0;
+    int current_ = 0;
+};
+
+} // namespace gomoku
@@ -0,0 +1,152 @@
+//
+//  opening_book.cpp
+//  gomoku - Memory-mapped opening book of precomputed AI replies
+//
+//  File mapping, header validation, lookup and the book writer
+//
+
+#include "opening_book.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gomoku {
+
+namespace {
+
+std::string system_error(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+OpeningBook::~OpeningBook() {
+    close();
+}
+
+std::expected<void, std::string> OpeningBook::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(system_error("Cannot open opening book", path));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        auto error = system_error("Cannot stat opening book", path);
+        ::close(fd);
+        return std::unexpected(error);
+    }
+
+    auto length = static_cast<size_t>(info.st_size);
+    if (length < sizeof(Header)) {
+        ::close(fd);
+        return std::unexpected("Opening book " + path + " is too short to hold a header");
+    }
+
+    void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file referenced after its descriptor is closed
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return std::unexpected(system_error("Cannot map opening book", path));
+    }
+
+    const auto* header = static_cast<const Header*>(data);
+    std::string error;
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "Opening book " + path + " has no book header";
+    } else if (header->version != VERSION) {
+        error = "Opening book " + path + " has version " + std::to_string(header->version) +
+                ", expected " + std::to_string(VERSION);
+    } else if (length != sizeof(Header) + static_cast<size_t>(header->count) * sizeof(BookEntry)) {
+        error = "Opening book " + path + " is truncated or has trailing data";
+    }
+    if (!error.empty()) {
+        munmap(data, length);
+        return std::unexpected(error);
+    }
+
+    // Lookups jump around the file, so read-ahead would only waste page cache
+    madvise(data, length, MADV_RANDOM);
+
+    data_ = data;
+    length_ = length;
+    entries_ = reinterpret_cast<const BookEntry*>(static_cast<const char*>(data) + sizeof(Header));
+    count_ = header->count;
+    path_ = path;
+    return {};
+}
+
+void OpeningBook::close() noexcept {
+    if (data_) {
+        munmap(data_, length_);
+    }
+    data_ = nullptr;
+    length_ = 0;
+    entries_ = nullptr;
+    count_ = 0;
+    path_.clear();
+}
+
+std::optional<BookEntry> OpeningBook::probe(uint64_t hash, int board_size) const noexcept {
+    if (count_ == 0) {
+        return std::nullopt;
+    }
+
+    const BookEntry* end = entries_ + count_;
+    const BookEntry* found = std::lower_bound(entries_, end, hash,
+        [](const BookEntry& entry, uint64_t key) { return entry.hash < key; });
+
+    // Boards of different sizes share Zobrist keys, so their hashes may collide
+    for (; found != end && found->hash == hash; ++found) {
+        if (found->board_size == board_size) {
+            return *found;
+        }
+    }
+    return std::nullopt;
+}
+
+std::expected<void, std::string> OpeningBook::write(const std::string& path, std::vector<BookEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.board_size < b.board_size;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.hash == b.hash && a.board_size == b.board_size;
+    }), entries.end());
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.count = static_cast<uint32_t>(entries.size());
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return std::unexpected(system_error("Cannot create opening book", path));
+    }
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   (entries.empty() ||
+                    std::fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) == entries.size());
+    if (std::fclose(file) != 0 || !written) {
+        return std::unexpected(system_error("Cannot write opening book", path));
+    }
+    return {};
+}
+
+//===============================================================================
+// SHARED INSTANCE
+//===============================================================================
+
+OpeningBook& shared_opening_book() {
+    static OpeningBook book;
+    return book;
+}
+
+} // namespace gomoku
@@ -0,0 +1,105 @@
+//
+//  opening_book.hpp
+//  gomoku - Memory-mapped opening book of precomputed AI replies
+//
+//  Sorted file of position hash -> best move records, looked up with a binary search
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gomoku {
+
+//===============================================================================
+// OPENING BOOK
+//===============================================================================
+
+/**
+ * One precomputed position: the AI's best reply and the search that found it.
+ * The record is written to disk as is, so its layout must not change without
+ * bumping OpeningBook::VERSION.
+ */
+struct BookEntry {
+    uint64_t hash;          // Canonical Zobrist hash of the position, AI to move
+    int32_t score;          // Search score of the move, from the AI's side
+    uint8_t x;              // Move in the orientation the hash is keyed on
+    uint8_t y;
+    uint8_t depth;          // Depth of the search that chose the move
+    uint8_t board_size;
+};
+
+static_assert(sizeof(BookEntry) == 16, "book entries are stored as packed 16-byte records");
+
+/**
+ * Read-only view of a book file mapped into memory.
+ *
+ * The file is a 16-byte header (magic, version, entry count) followed by
+ * BookEntry records sorted by hash. Opening it maps the file and checks the
+ * header; nothing is parsed or copied, so a lookup costs one binary search
+ * over pages the kernel loads on demand.
+ */
+class OpeningBook {
+public:
+    static constexpr char MAGIC[8] = {'G', 'M', 'K', 'B', 'O', 'O', 'K', '1'};
+    static constexpr uint32_t VERSION = 3;   // 2: symmetry-canonical keys, 3: splitmix64 keys
+
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    /**
+     * Maps the book at path, replacing any book already open.
+     * Not safe while a search is probing this book.
+     */
+    std::expected<void, std::string> open(const std::string& path);
+
+    /**
+     * Unmaps the book; later probes miss.
+     */
+    void close() noexcept;
+
+    /**
+     * Returns the entry for hash on a board of board_size, if the book has one.
+     */
+    [[nodiscard]] std::optional<BookEntry> probe(uint64_t hash, int board_size) const noexcept;
+
+    [[nodiscard]] bool is_open() const noexcept { return data_ != nullptr; }
+    [[nodiscard]] size_t size() const noexcept { return count_; }
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+    /**
+     * Sorts entries by hash, drops duplicates and writes them as a book file.
+     */
+    static std::expected<void, std::string> write(const std::string& path, std::vector<BookEntry> entries);
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t count;
+    };
+
+    static_assert(sizeof(Header) == 16, "the book header is stored as a packed 16-byte record");
+
+    void* data_ = nullptr;
+    size_t length_ = 0;
+    const BookEntry* entries_ = nullptr;
+    size_t count_ = 0;
+    std::string path_;
+};
+
+/**
+ * Process-wide book probed by the CLI game and every httpd request.
+ * Stays closed, and so never hits, unless a --book option opened it.
+ */
+OpeningBook& shared_opening_book();
+
+} // namespace gomoku
@@ -11,6 +11,8 @@
 #include "ai.h"
 #include "ai_parallel.hpp"
 #include "game_coordinator.hpp"
+#include "search_handle.hpp"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -89,7 +91,7 @@ void HumanPlayer::handle_input(GameStateWrapper* game_state, int& x, int& y, boo
 
         case 13: // ENTER
         case 32: // SPACE
-            if (is_valid_move(game->board, game->cursor_x, game->cursor_y, game->board_size)) {
+            if (game->board.is_playable(game->cursor_x, game->cursor_y)) {
                 x = game->cursor_x;
                 y = game->cursor_y;
                 move_made = true;
@@ -139,31 +141,26 @@ PlayerMoveResult ComputerPlayer::make_move(GameStateWrapper* game_state) {
     game_state_t* game = game_state->legacy_state;
     double start_time = get_current_time();
 
-    int ai_x, ai_y;
-
     // Set the AI depth based on difficulty
     game->max_depth = static_cast<int>(difficulty_);
+    game->search_algorithm = algorithm_;
 
-    // Use parallel AI if available, otherwise fall back to sequential
-    if (g_parallel_ai) {
-        find_best_ai_move_parallel(game, &ai_x, &ai_y);
-    } else {
-        find_best_ai_move(game, &ai_x, &ai_y);
+    // A ponder on the reply that was actually played already holds the move;
+    // otherwise search on the parallel engine if there is one
+    std::optional<SearchResult> result = ponderer_.take(*game);
+    if (!result) {
+        result = run_search(*game, g_parallel_ai.get());
     }
     double time_taken = get_current_time() - start_time;
 
-    if (ai_x >= 0 && ai_y >= 0) {
-        // Get positions evaluated from AI status message
-        int positions_evaluated = 1;
-        if (game->ai_history_count > 0) {
-            std::sscanf(game->ai_history[game->ai_history_count - 1],
-                       "%*d | %d positions evaluated", &positions_evaluated);
-        }
+    if (result->move.x >= 0 && result->move.y >= 0) {
+        int positions_evaluated = std::max(result->moves_evaluated, 1);
 
         std::ostringstream desc;
-        desc << name_ << " move (depth " << static_cast<int>(difficulty_) << ")";
+        desc << name_ << " move (" << (algorithm_ == SearchAlgorithm::MonteCarlo ? "MCTS, " : "")
+             << "depth " << static_cast<int>(difficulty_) << ")";
 
-        return PlayerMoveResult::valid_move(ai_x, ai_y, time_taken, positions_evaluated, desc.str());
+        return PlayerMoveResult::valid_move(result->move.x, result->move.y, time_taken, positions_evaluated, desc.str());
     }
 
     return PlayerMoveResult::invalid();
@@ -183,20 +180,42 @@ void ComputerPlayer::on_game_start(GameStateWrapper* game_state) {
         case Difficulty::Medium: status << "Medium"; break;
         case Difficulty::Hard: status << "Hard"; break;
     }
-    status << " | Depth: " << static_cast<int>(difficulty_) << "]";
+    status << " | Depth: " << static_cast<int>(difficulty_);
+    if (algorithm_ == SearchAlgorithm::MonteCarlo) {
+        status << " | MCTS";
+    }
+    status << "]";
 
     std::strncpy(game->ai_status_message, status.str().c_str(),
                  sizeof(game->ai_status_message) - 1);
     game->ai_status_message[sizeof(game->ai_status_message) - 1] = '\0';
 }
 
+void ComputerPlayer::on_game_end([[maybe_unused]] GameStateWrapper* game_state) {
+    ponderer_.stop();
+}
+
+void ComputerPlayer::on_move_played(GameStateWrapper* game_state, [[maybe_unused]] int x, [[maybe_unused]] int y) {
+    if (pondering_) {
+        ponderer_.start(*game_state->legacy_state);
+    }
+}
+
+void ComputerPlayer::set_pondering(bool enabled) {
+    pondering_ = enabled;
+    if (!enabled) {
+        ponderer_.stop();
+    }
+}
+
 //===============================================================================
 // PLAYER FACTORY IMPLEMENTATION
 //===============================================================================
 
 std::unique_ptr<PlayerImpl> PlayerFactory::create_player(PlayerSpec spec,
                                                     const std::string& name,
-                                                    ComputerPlayer::Difficulty difficulty) {
+                                                    ComputerPlayer::Difficulty difficulty,
+                                                    SearchAlgorithm algorithm) {
     switch (spec) {
         case PlayerSpec::Human:
             return std::make_unique<HumanPlayer>(
@@ -206,7 +225,8 @@ std::unique_ptr<PlayerImpl> PlayerFactory::create_player(PlayerSpec spec,
         case PlayerSpec::Computer:
             return std::make_unique<ComputerPlayer>(
                 name.empty() ? get_classical_name(difficulty) : name,
-                difficulty
+                difficulty,
+                algorithm
             );
     }
 
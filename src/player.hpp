@@ -12,6 +12,7 @@
 #include <optional>
 #include "gomoku.hpp"
 #include "game_state_wrapper.hpp"
+#include "ponder.hpp"
 
 namespace gomoku {
 
@@ -61,6 +62,7 @@ public:
     virtual void on_game_start(GameStateWrapper* game_state) {}
     virtual void on_game_end(GameStateWrapper* game_state) {}
     virtual void on_opponent_move(GameStateWrapper* game_state, int x, int y) {}
+    virtual void on_move_played(GameStateWrapper* game_state, int x, int y) {}
     
     // Getters/Setters
     const std::string& get_name() const { return name_; }
@@ -102,17 +104,32 @@ public:
     };
     
     explicit ComputerPlayer(const std::string& name = "Computer", 
-                           Difficulty difficulty = Difficulty::Medium)
-        : PlayerImpl(name, PlayerType::Computer), difficulty_(difficulty) {}
+                           Difficulty difficulty = Difficulty::Medium,
+                           SearchAlgorithm algorithm = SearchAlgorithm::AlphaBeta)
+        : PlayerImpl(name, PlayerType::Computer), difficulty_(difficulty), algorithm_(algorithm) {}
     
     PlayerMoveResult make_move(GameStateWrapper* game_state) override;
     
     void on_game_start(GameStateWrapper* game_state) override;
+    void on_game_end(GameStateWrapper* game_state) override;
+    void on_move_played(GameStateWrapper* game_state, int x, int y) override;
     Difficulty get_difficulty() const { return difficulty_; }
     void set_difficulty(Difficulty difficulty) { difficulty_ = difficulty; }
     
+    // Alpha-beta or Monte Carlo tree search; the difficulty sets the depth or the playout budget
+    SearchAlgorithm get_algorithm() const { return algorithm_; }
+    void set_algorithm(SearchAlgorithm algorithm) { algorithm_ = algorithm; }
+    
+    // Search the predicted reply while the opponent thinks
+    bool get_pondering() const { return pondering_; }
+    void set_pondering(bool enabled);
+    const Ponderer& get_ponderer() const { return ponderer_; }
+    
 private:
     Difficulty difficulty_;
+    SearchAlgorithm algorithm_;
+    bool pondering_ = false;
+    Ponderer ponderer_;
 };
 
 //===============================================================================
@@ -131,7 +148,8 @@ public:
     
     static std::unique_ptr<PlayerImpl> create_player(PlayerSpec spec, 
                                                      const std::string& name = "",
-                                                     ComputerPlayer::Difficulty difficulty = ComputerPlayer::Difficulty::Medium);
+                                                     ComputerPlayer::Difficulty difficulty = ComputerPlayer::Difficulty::Medium,
+                                                     SearchAlgorithm algorithm = SearchAlgorithm::AlphaBeta);
     
     static std::pair<std::unique_ptr<PlayerImpl>, std::unique_ptr<PlayerImpl>> 
     create_player_pair(PlayerSpec player1, PlayerSpec player2);
@@ -0,0 +1,127 @@
+//
+//  ponder.cpp
+//  gomoku - Pondering: searching on the opponent's time
+//
+//  Reply prediction, the background search and the hand-over to the real move
+//
+
+#include "ponder.hpp"
+#include "ai.h"
+#include "ai_parallel.hpp"
+#include <cstdio>
+
+namespace gomoku {
+
+Ponderer::~Ponderer() {
+    stop();
+}
+
+//===============================================================================
+// PONDERING
+//===============================================================================
+
+bool Ponderer::start(const game_state_t& game) {
+    stop();
+
+    if (game.game_state != static_cast<int>(GameState::Running) || game.move_history_count == 0) {
+        return false;
+    }
+
+    // The copy is all the background search touches, so game may move on meanwhile
+    if (!position_) {
+        position_ = std::make_unique<game_state_t>();
+    }
+    *position_ = game;
+    game_state_t* position = position_.get();
+
+    int ai_player = game.move_history[game.move_history_count - 1].player;
+    int opponent = static_cast<int>(other_player(static_cast<Player>(ai_player)));
+    predicted_ = predict_reply(position, opponent);
+    if (predicted_.x < 0 || !make_move(position, predicted_.x, predicted_.y, opponent, 0.0, 0) ||
+            position->game_state != static_cast<int>(GameState::Running)) {
+        predicted_ = Position{-1, -1};
+        return false;
+    }
+
+    position->current_player = ai_player;
+    position->quiet_search = 1;
+    search_ = SearchHandle::start(*position, g_parallel_ai.get());
+    return true;
+}
+
+std::optional<SearchResult> Ponderer::take(game_state_t& game) {
+    if (!search_.valid()) {
+        return std::nullopt;
+    }
+
+    // The opponent played something else, or undid moves, or the level or engine changed
+    const game_state_t& position = *position_;
+    if (game.current_hash != position.current_hash || !(game.bitboard == position.bitboard) ||
+            game.max_depth != position.max_depth || game.search_algorithm != position.search_algorithm) {
+        stop();
+        misses_++;
+        return std::nullopt;
+    }
+
+    // The pondered search is the one the AI would start now, already under way
+    SearchResult result = search_.get();
+    predicted_ = Position{-1, -1};
+    if (result.move.x < 0 || !game.board.is_playable(result.move.x, result.move.y)) {
+        misses_++;
+        return std::nullopt;
+    }
+    hits_++;
+
+    game.search_depth_reached = position.search_depth_reached;
+    game.search_timed_out = position.search_timed_out;
+    game.search_nodes = position.search_nodes;
+    game.search_tt_probes = position.search_tt_probes;
+    game.search_tt_hits = position.search_tt_hits;
+    constexpr int status_room = static_cast<int>(sizeof(game.ai_status_message) - sizeof("Pondered: "));
+    snprintf(game.ai_status_message, sizeof(game.ai_status_message),
+            "Pondered: %.*s", status_room, position.ai_status_message);
+    add_ai_history_entry(&game, result.moves_evaluated);
+    return result;
+}
+
+void Ponderer::stop() noexcept {
+    if (search_.valid()) {
+        search_.request_stop();
+        try {
+            search_.get();
+        } catch (...) {
+            // A stopped ponder's result is thrown away, failed or not
+        }
+    }
+    predicted_ = Position{-1, -1};
+}
+
+std::optional<Position> Ponderer::predicted_reply() const noexcept {
+    if (!search_.valid()) {
+        return std::nullopt;
+    }
+    return predicted_;
+}
+
+//===============================================================================
+// PREDICTION
+//===============================================================================
+
+Position Ponderer::predict_reply(game_state_t* game, int opponent) {
+    int x = -1, y = -1;
+    if (probe_transposition_move(game, game->current_hash, &x, &y) && game->board.is_playable(x, y)) {
+        return Position{x, y};
+    }
+
+    move_t moves[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+    int move_count = generate_moves_optimized(game, moves, opponent);
+    int best = -1;
+    for (int i = 0; i < move_count; i++) {
+        if (best < 0 || moves[i].priority > moves[best].priority) {
+            best = i;
+        }
+    }
+    return best < 0 ? Position{-1, -1} : Position{moves[best].x, moves[best].y};
+}
+
+} // namespace gomoku
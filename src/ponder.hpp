@@ -0,0 +1,86 @@
+//
+//  ponder.hpp
+//  gomoku - Pondering: searching on the opponent's time
+//
+//  Searches the AI's answer to the opponent's predicted reply while the opponent thinks
+//
+
+#pragma once
+
+#include "game.h"
+#include "gomoku.hpp"
+#include "search_handle.hpp"
+#include <memory>
+#include <optional>
+
+namespace gomoku {
+
+//===============================================================================
+// PONDERER
+//===============================================================================
+
+/**
+ * Thinks on the opponent's time. Once the AI has moved, start() guesses the
+ * opponent's reply and searches the AI's answer to it with a SearchHandle,
+ * over a private copy of the game and the shared transposition table. When
+ * the AI is next to move, take() either finds the guess was right and hands
+ * over the pondered move, or stops the search; the entries it stored still
+ * speed up the real one.
+ *
+ * The background search is the same one the AI would run itself, on the
+ * parallel engine when there is one, so a ponder must be stopped or taken
+ * before anything else searches.
+ */
+class Ponderer {
+public:
+    Ponderer() = default;
+    ~Ponderer();
+
+    Ponderer(const Ponderer&) = delete;
+    Ponderer& operator=(const Ponderer&) = delete;
+
+    /**
+     * Starts pondering game, in which the AI has just moved and the opponent
+     * is to reply. Stops any ponder already running. Returns false, starting
+     * nothing, when the game is over or the predicted reply would end it.
+     */
+    bool start(const game_state_t& game);
+
+    /**
+     * Called with the AI to move in game. If game is the pondered position,
+     * waits for the background search and returns its result, copying the
+     * search's statistics into game; otherwise stops pondering and returns
+     * nullopt.
+     */
+    std::optional<SearchResult> take(game_state_t& game);
+
+    /**
+     * Stops the background search, if one is running, and waits for it.
+     */
+    void stop() noexcept;
+
+    [[nodiscard]] bool is_pondering() const noexcept { return search_.valid(); }
+
+    /**
+     * The opponent reply the running ponder assumed, if one is running.
+     */
+    [[nodiscard]] std::optional<Position> predicted_reply() const noexcept;
+
+    [[nodiscard]] int hits() const noexcept { return hits_; }
+    [[nodiscard]] int misses() const noexcept { return misses_; }
+
+private:
+    /**
+     * The opponent's most likely reply: the move the AI's own search expected,
+     * or, when the table lost it, the highest-priority candidate.
+     */
+    static Position predict_reply(game_state_t* game, int opponent);
+
+    std::unique_ptr<game_state_t> position_;   // The pondered position, searched by search_
+    SearchHandle search_;
+    Position predicted_{-1, -1};
+    int hits_ = 0;
+    int misses_ = 0;
+};
+
+} // namespace gomoku
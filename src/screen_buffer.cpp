@@ -0,0 +1,211 @@
+//
+//  screen_buffer.cpp
+//  gomoku - Double-buffered terminal screen
+//
+//  Plays frames onto a cell grid and diffs consecutive grids into cursor moves and changed cells
+//
+
+#include "screen_buffer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+namespace gomoku::ui {
+
+namespace {
+
+// Variation selectors (U+FE00-U+FE0F) and zero-width spaces and joiners
+// (U+200B-U+200D) take no column of their own
+bool is_zero_width(std::string_view glyph) {
+    if (glyph.size() != 3) {
+        return false;
+    }
+    auto byte = [&](int i) { return static_cast<unsigned char>(glyph[i]); };
+    return (byte(0) == 0xef && byte(1) == 0xb8 && byte(2) >= 0x80 && byte(2) <= 0x8f) ||
+           (byte(0) == 0xe2 && byte(1) == 0x80 && byte(2) >= 0x8b && byte(2) <= 0x8d);
+}
+
+size_t utf8_length(unsigned char lead) {
+    if (lead >= 0xf0) return 4;
+    if (lead >= 0xe0) return 3;
+    if (lead >= 0xc0) return 2;
+    return 1;
+}
+
+// The n-th ';'-separated parameter of a CSI sequence, or fallback when it is missing
+int csi_parameter(std::string_view params, int n, int fallback) {
+    for (int i = 0; i < n; i++) {
+        size_t semicolon = params.find(';');
+        if (semicolon == std::string_view::npos) {
+            return fallback;
+        }
+        params.remove_prefix(semicolon + 1);
+    }
+    int value = 0;
+    auto [end, error] = std::from_chars(params.data(), params.data() + params.size(), value);
+    return error == std::errc{} && end != params.data() ? value : fallback;
+}
+
+} // namespace
+
+//===============================================================================
+// FRAME PARSING
+//===============================================================================
+
+ScreenBuffer::Grid ScreenBuffer::parse(std::string_view frame) {
+    Grid grid;
+    std::string style;
+    size_t row = 0;
+    size_t col = 0;
+
+    for (size_t i = 0; i < frame.size();) {
+        char c = frame[i];
+
+        if (c == '\033' && i + 1 < frame.size() && frame[i + 1] == '[') {
+            // A CSI sequence runs from its parameters to a final byte in @ to ~
+            size_t end = i + 2;
+            while (end < frame.size() && (frame[end] < '@' || frame[end] > '~')) {
+                end++;
+            }
+            if (end == frame.size()) {
+                break;
+            }
+            std::string_view params = frame.substr(i + 2, end - i - 2);
+            i = end + 1;
+
+            switch (frame[end]) {
+                case 'm':
+                    // A leading 0 resets the style; anything after it adds to the reset style
+                    if (params.empty() || params == "0") {
+                        style.clear();
+                    } else if (params.starts_with("0;")) {
+                        style = std::format("\033[{}m", params.substr(2));
+                    } else {
+                        style += std::format("\033[{}m", params);
+                    }
+                    break;
+                case 'H':
+                    row = static_cast<size_t>(std::max(1, csi_parameter(params, 0, 1)) - 1);
+                    col = static_cast<size_t>(std::max(1, csi_parameter(params, 1, 1)) - 1);
+                    break;
+                case 'J':
+                    if (params == "2") {
+                        grid.clear();
+                    }
+                    break;
+                default:
+                    break;
+            }
+            continue;
+        }
+
+        if (c == '\n') {
+            row++;
+            col = 0;
+            i++;
+            continue;
+        }
+        if (c == '\r') {
+            col = 0;
+            i++;
+            continue;
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            i++;
+            continue;
+        }
+
+        std::string_view glyph = frame.substr(i, utf8_length(static_cast<unsigned char>(c)));
+        i += glyph.size();
+        if (is_zero_width(glyph)) {
+            if (col > 0 && row < grid.size() && col <= grid[row].size()) {
+                grid[row][col - 1].glyph += glyph;
+            }
+            continue;
+        }
+
+        if (grid.size() <= row) {
+            grid.resize(row + 1);
+        }
+        if (grid[row].size() <= col) {
+            grid[row].resize(col + 1);
+        }
+        // An unstyled space is the same as a blank cell
+        grid[row][col] = (glyph == " " && style.empty()) ? Cell{} : Cell{std::string(glyph), style};
+        col++;
+    }
+    return grid;
+}
+
+//===============================================================================
+// FRAME DIFFING
+//===============================================================================
+
+std::string ScreenBuffer::diff(std::string_view frame) {
+    Grid next = parse(frame);
+    std::string out = "\033[0m";
+
+    if (!valid_) {
+        out += "\033[2J";
+        cells_.clear();
+    } else {
+        // Whatever was printed below the last frame since it was drawn
+        out += std::format("\033[{};1H\033[J", cells_.size() + 1);
+    }
+
+    static const Cell blank;
+    auto cell_at = [](const Grid& grid, size_t row, size_t col) -> const Cell& {
+        return row < grid.size() && col < grid[row].size() ? grid[row][col] : blank;
+    };
+    auto width = [](const Grid& grid, size_t row) {
+        return row < grid.size() ? grid[row].size() : 0;
+    };
+
+    std::string style;
+    size_t cursor_row = 0;
+    size_t cursor_col = 0;
+    bool cursor_known = false;
+
+    size_t rows = std::max(cells_.size(), next.size());
+    for (size_t row = 0; row < rows; row++) {
+        size_t cols = std::max(width(cells_, row), width(next, row));
+        for (size_t col = 0; col < cols; col++) {
+            const Cell& after = cell_at(next, row, col);
+            if (cell_at(cells_, row, col) == after) {
+                continue;
+            }
+
+            // Cells changed side by side are written in one run, without moves between them
+            if (!cursor_known || cursor_row != row || cursor_col != col) {
+                out += std::format("\033[{};{}H", row + 1, col + 1);
+            }
+            if (after.style != style) {
+                if (!style.empty()) {
+                    out += "\033[0m";
+                }
+                out += after.style;
+                style = after.style;
+            }
+            out += after.glyph.empty() ? std::string_view(" ") : std::string_view(after.glyph);
+            cursor_row = row;
+            cursor_col = col + 1;
+            cursor_known = true;
+        }
+    }
+
+    if (!style.empty()) {
+        out += "\033[0m";
+    }
+    out += std::format("\033[{};1H", next.size() + 1);
+
+    cells_ = std::move(next);
+    valid_ = true;
+    return out;
+}
+
+ScreenBuffer& shared_screen() {
+    static ScreenBuffer screen;
+    return screen;
+}
+
+} // namespace gomoku::ui
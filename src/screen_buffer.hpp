@@ -0,0 +1,71 @@
+//
+//  screen_buffer.hpp
+//  gomoku - Double-buffered terminal screen
+//
+//  Keeps the last frame drawn to the terminal and turns each new frame into the escapes that change only what differs
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gomoku::ui {
+
+//===============================================================================
+// SCREEN BUFFER CLASS
+//===============================================================================
+
+/**
+ * The terminal as the last frame left it. A frame is the text a full
+ * redraw would print after clearing the screen, with its colours and
+ * cursor moves; diff() plays it onto a grid of cells, compares the grid
+ * with the previous frame's and returns the output that brings the
+ * terminal from one to the other: a cursor move to each run of changed
+ * cells, their colours and their characters, and nothing for the rest.
+ *
+ * Each character is taken to fill one column, and variation selectors and
+ * zero-width joiners stay with the character before them.
+ *
+ * Anything printed below the frame after it was drawn, like the search's
+ * progress dots, is cleared by the next diff, which also leaves the cursor
+ * on the line below the frame. Output that may have touched the frame
+ * itself calls for invalidate(), after which the next diff clears the
+ * screen and paints the frame in full.
+ */
+class ScreenBuffer {
+public:
+    /**
+     * Returns the output that turns the previous frame into frame, and
+     * remembers frame as the one on the screen.
+     */
+    [[nodiscard]] std::string diff(std::string_view frame);
+
+    /**
+     * Forgets the frame on the screen, so the next one is painted in full.
+     */
+    void invalidate() noexcept { valid_ = false; }
+
+private:
+    struct Cell {
+        std::string glyph;          // UTF-8 for one column; empty for a blank cell
+        std::string style;          // SGR escapes in effect, empty for the default style
+
+        bool operator==(const Cell&) const = default;
+    };
+
+    using Grid = std::vector<std::vector<Cell>>;
+
+    static Grid parse(std::string_view frame);
+
+    Grid cells_;
+    bool valid_ = false;
+};
+
+/**
+ * The buffer of the terminal the game is drawn on.
+ */
+ScreenBuffer& shared_screen();
+
+} // namespace gomoku::ui
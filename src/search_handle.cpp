@@ -0,0 +1,124 @@
+//
+//  search_handle.cpp
+//  gomoku - Cancellable AI search with per-depth progress
+//
+//  Bridges stop tokens and progress callbacks onto the search's abort flag and depth hook
+//
+
+#include "search_handle.hpp"
+#include "ai.h"
+#include "ai_parallel.hpp"
+#include "mcts.hpp"
+#include <atomic>
+#include <exception>
+#include <utility>
+
+namespace gomoku {
+
+namespace {
+
+// What the depth hook needs to hand reports on and remember the last of
+struct Progress {
+    const SearchInfoCallback* on_info;
+    bool reported = false;
+    int score = 0;
+};
+
+void forward_search_depth(void* context, const search_depth_t* report) {
+    auto* progress = static_cast<Progress*>(context);
+    progress->reported = true;
+    progress->score = report->score;
+
+    if (!*progress->on_info) {
+        return;
+    }
+
+    SearchInfo info;
+    info.depth = report->depth;
+    info.score = report->score;
+    info.pv.reserve(report->pv_length);
+    for (int i = 0; i < report->pv_length; i++) {
+        info.pv.emplace_back(report->pv[i][0], report->pv[i][1]);
+    }
+    info.nodes = report->nodes;
+    info.elapsed_ms = report->elapsed * 1000.0;
+    info.nps = report->elapsed > 0.0 ? static_cast<double>(report->nodes) / report->elapsed : 0.0;
+    (*progress->on_info)(info);
+}
+
+} // namespace
+
+//===============================================================================
+// INLINE SEARCH
+//===============================================================================
+
+SearchResult run_search(game_state_t& game, ParallelAI* engine, std::stop_token stop, SearchInfoCallback on_info) {
+    double started_at = get_current_time();
+
+    // A stop request raises the flag every search thread already polls
+    std::atomic<bool> abort{false};
+    std::atomic<bool>* outer_abort = game.abort_search;
+    if (stop.stop_possible()) {
+        game.abort_search = &abort;
+    }
+    std::stop_callback stop_abort(stop, [&abort] { abort.store(true, std::memory_order_relaxed); });
+
+    Progress progress{&on_info};
+    auto outer_hook = game.on_search_depth;
+    void* outer_context = game.search_depth_context;
+    game.on_search_depth = forward_search_depth;
+    game.search_depth_context = &progress;
+
+    int x = -1, y = -1;
+    if (game.search_algorithm == SearchAlgorithm::MonteCarlo) {
+        (engine ? engine->mcts() : shared_mcts_engine()).find_best_move(&game, &x, &y);
+    } else if (engine) {
+        engine->find_best_move_parallel(&game, &x, &y);
+    } else {
+        find_best_ai_move(&game, &x, &y);
+    }
+
+    game.on_search_depth = outer_hook;
+    game.search_depth_context = outer_context;
+    game.abort_search = outer_abort;
+
+    SearchResult result;
+    result.move = Position{x, y};
+    result.depth = game.search_depth_reached;
+    result.score = progress.reported ? progress.score : 0;
+    result.nodes = game.search_nodes;
+    result.moves_evaluated = game.search_moves_evaluated;
+    result.elapsed_ms = (get_current_time() - started_at) * 1000.0;
+    result.stopped = game.search_timed_out != 0 || stop.stop_requested();
+    return result;
+}
+
+//===============================================================================
+// SEARCH HANDLE
+//===============================================================================
+
+SearchHandle SearchHandle::start(game_state_t& game, ParallelAI* engine, SearchInfoCallback on_info) {
+    std::promise<SearchResult> promise;
+
+    SearchHandle handle;
+    handle.result_ = promise.get_future();
+    handle.thread_ = std::jthread([&game, engine, on_info = std::move(on_info),
+                                   promise = std::move(promise)](std::stop_token stop) mutable {
+        try {
+            promise.set_value(run_search(game, engine, stop, std::move(on_info)));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    });
+    return handle;
+}
+
+SearchResult SearchHandle::get() {
+    SearchResult result = result_.get();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    return result;
+}
+
+} // namespace gomoku
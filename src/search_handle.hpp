@@ -0,0 +1,112 @@
+//
+//  search_handle.hpp
+//  gomoku - Cancellable AI search with per-depth progress
+//
+//  Runs the AI's search inline or on its own thread, reporting each completed depth
+//
+
+#pragma once
+
+#include "game.h"
+#include "gomoku.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace gomoku {
+
+class ParallelAI;
+
+/**
+ * Progress of a search, reported as each iteration of deepening completes.
+ */
+struct SearchInfo {
+    int depth;
+    int score;                      // From the AI's side
+    std::vector<Position> pv;       // Expected line of play, the AI's move first
+    uint64_t nodes;                 // Positions visited so far, by every thread
+    double elapsed_ms;
+    double nps;
+};
+
+/**
+ * What a finished search settled on.
+ */
+struct SearchResult {
+    Position move{-1, -1};          // (-1, -1) when there was no move to make
+    int depth = 0;                  // Deepest completed iteration
+    int score = 0;                  // Of the deepest reported iteration; 0 for book and solver moves
+    uint64_t nodes = 0;
+    int moves_evaluated = 0;        // As reported in the game's AI history
+    double elapsed_ms = 0.0;
+    bool stopped = false;           // Cut short by a stop request or the game's deadline
+};
+
+using SearchInfoCallback = std::function<void(const SearchInfo&)>;
+
+/**
+ * Runs the AI's search of game on the calling thread: Lazy SMP or root split
+ * on engine, or the sequential search when engine is null. Games set to
+ * SearchAlgorithm::MonteCarlo run engine's tree search instead, or the
+ * single-threaded shared_mcts_engine() when engine is null.
+ *
+ * The game's own deadline still applies, and a stop request ends the search
+ * early with the deepest completed move. on_info is called after every
+ * completed depth, on whichever thread completed it but never concurrently.
+ */
+SearchResult run_search(game_state_t& game, ParallelAI* engine,
+                        std::stop_token stop = {}, SearchInfoCallback on_info = {});
+
+//===============================================================================
+// SEARCH HANDLE
+//===============================================================================
+
+/**
+ * A run_search() on a thread of its own. The game belongs to the search until
+ * the result is taken: the caller must not change it meanwhile.
+ *
+ * Destroying or reassigning a handle that is still running stops the search
+ * and waits for it, so a handle never outlives the game it searches.
+ */
+class SearchHandle {
+public:
+    SearchHandle() = default;
+
+    /**
+     * Starts searching game on a new thread.
+     */
+    static SearchHandle start(game_state_t& game, ParallelAI* engine, SearchInfoCallback on_info = {});
+
+    /**
+     * Asks the search to stop; it finishes with the deepest completed move.
+     */
+    void request_stop() noexcept { thread_.request_stop(); }
+
+    /**
+     * Waits up to timeout for the search and returns whether it has finished.
+     */
+    template<class Rep, class Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+        return result_.wait_for(timeout) == std::future_status::ready;
+    }
+
+    /**
+     * Waits for the search and takes its result, leaving the handle empty.
+     */
+    SearchResult get();
+
+    /**
+     * Whether the handle holds a search whose result has not been taken.
+     */
+    [[nodiscard]] bool valid() const noexcept { return result_.valid(); }
+
+private:
+    std::future<SearchResult> result_;
+    std::jthread thread_;               // Declared last, so it is joined first
+};
+
+} // namespace gomoku
@@ -0,0 +1,235 @@
+//
+//  search_metrics.cpp
+//  gomoku - Opt-in counters on the search hot path
+//
+//  Thread registration, recording and the summing read side
+//
+
+#include "search_metrics.hpp"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace gomoku {
+
+namespace {
+
+using Counter = std::atomic<uint64_t>;
+
+// Each thread is the only writer of its counters, so a relaxed load and
+// store stand in for a locked read-modify-write
+void bump(Counter& counter, uint64_t amount = 1) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+template<size_t N>
+void load_into(std::array<uint64_t, N>& sums, const std::array<Counter, N>& counters) noexcept {
+    for (size_t i = 0; i < N; i++) {
+        sums[i] += counters[i].load(std::memory_order_relaxed);
+    }
+}
+
+template<size_t N>
+void clear(std::array<Counter, N>& counters) noexcept {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+struct ThreadCounters {
+    Counter nodes{0};
+    Counter research_nodes{0};
+    Counter tt_probes{0};
+    Counter tt_hits{0};
+    Counter tt_collisions{0};
+    std::array<Counter, CUTOFF_MOVE_BUCKETS> cutoffs{};
+    std::array<Counter, SEARCH_PHASE_COUNT> phase_calls{};
+    std::array<Counter, SEARCH_PHASE_COUNT> phase_ns{};
+    std::array<Counter, MAX_SEARCH_DEPTH + 1> depth_completed{};
+    std::array<Counter, MAX_SEARCH_DEPTH + 1> depth_ns{};
+
+    ThreadCounters();
+    ~ThreadCounters();
+
+    void add_to(SearchMetricsSnapshot& sums) const noexcept {
+        sums.nodes += nodes.load(std::memory_order_relaxed);
+        sums.research_nodes += research_nodes.load(std::memory_order_relaxed);
+        sums.tt_probes += tt_probes.load(std::memory_order_relaxed);
+        sums.tt_hits += tt_hits.load(std::memory_order_relaxed);
+        sums.tt_collisions += tt_collisions.load(std::memory_order_relaxed);
+        load_into(sums.cutoffs, cutoffs);
+        load_into(sums.phase_calls, phase_calls);
+        load_into(sums.phase_ns, phase_ns);
+        load_into(sums.depth_completed, depth_completed);
+        load_into(sums.depth_ns, depth_ns);
+    }
+
+    void reset() noexcept {
+        nodes.store(0, std::memory_order_relaxed);
+        research_nodes.store(0, std::memory_order_relaxed);
+        tt_probes.store(0, std::memory_order_relaxed);
+        tt_hits.store(0, std::memory_order_relaxed);
+        tt_collisions.store(0, std::memory_order_relaxed);
+        clear(cutoffs);
+        clear(phase_calls);
+        clear(phase_ns);
+        clear(depth_completed);
+        clear(depth_ns);
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> live;
+    SearchMetricsSnapshot retired;      // Counts of threads that have exited
+};
+
+Registry& registry() {
+    // Never destroyed: threads may still exit, and retire their counters, after static destruction
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+ThreadCounters::ThreadCounters() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    r.live.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    add_to(r.retired);
+    std::erase(r.live, this);
+}
+
+ThreadCounters& thread_counters() noexcept {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+// Nesting of SearchMetricsScope on this thread
+thread_local int scope_depth = 0;
+
+uint64_t elapsed_since(uint64_t started_ns) noexcept {
+    uint64_t now = search_metrics_now();
+    return now > started_ns ? now - started_ns : 0;
+}
+
+} // namespace
+
+//===============================================================================
+// SNAPSHOT
+//===============================================================================
+
+const char* search_phase_to_string(SearchPhase phase) {
+    switch (phase) {
+        case SearchPhase::MoveGen:
+            return "movegen";
+        case SearchPhase::Eval:
+            return "eval";
+        case SearchPhase::Search:
+            return "search";
+        default:
+            return "unknown";
+    }
+}
+
+SearchMetricsSnapshot& SearchMetricsSnapshot::operator+=(const SearchMetricsSnapshot& other) noexcept {
+    auto add = []<size_t N>(std::array<uint64_t, N>& sums, const std::array<uint64_t, N>& values) {
+        for (size_t i = 0; i < N; i++) {
+            sums[i] += values[i];
+        }
+    };
+    nodes += other.nodes;
+    research_nodes += other.research_nodes;
+    tt_probes += other.tt_probes;
+    tt_hits += other.tt_hits;
+    tt_collisions += other.tt_collisions;
+    add(cutoffs, other.cutoffs);
+    add(phase_calls, other.phase_calls);
+    add(phase_ns, other.phase_ns);
+    add(depth_completed, other.depth_completed);
+    add(depth_ns, other.depth_ns);
+    return *this;
+}
+
+//===============================================================================
+// COLLECTION
+//===============================================================================
+
+void enable_search_metrics(bool enabled) noexcept {
+    detail::search_metrics_on.store(enabled, std::memory_order_relaxed);
+}
+
+SearchMetricsSnapshot collect_search_metrics() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    SearchMetricsSnapshot sums = r.retired;
+    for (const ThreadCounters* counters : r.live) {
+        counters->add_to(sums);
+    }
+    return sums;
+}
+
+void reset_search_metrics() {
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+    r.retired = {};
+    for (ThreadCounters* counters : r.live) {
+        counters->reset();
+    }
+}
+
+void record_phase_slow(SearchPhase phase, uint64_t started_ns) noexcept {
+    ThreadCounters& counters = thread_counters();
+    bump(counters.phase_calls[static_cast<int>(phase)]);
+    bump(counters.phase_ns[static_cast<int>(phase)], elapsed_since(started_ns));
+}
+
+void record_cutoff_slow(int move_index) noexcept {
+    bump(thread_counters().cutoffs[std::clamp(move_index, 0, CUTOFF_MOVE_BUCKETS - 1)]);
+}
+
+void record_tt_collision_slow() noexcept {
+    bump(thread_counters().tt_collisions);
+}
+
+void record_research_nodes_slow(uint64_t nodes) noexcept {
+    bump(thread_counters().research_nodes, nodes);
+}
+
+void record_depth_slow(int depth, uint64_t started_ns) noexcept {
+    if (depth < 0 || depth > MAX_SEARCH_DEPTH) {
+        return;
+    }
+    ThreadCounters& counters = thread_counters();
+    bump(counters.depth_completed[depth]);
+    bump(counters.depth_ns[depth], elapsed_since(started_ns));
+}
+
+//===============================================================================
+// SEARCH SCOPE
+//===============================================================================
+
+SearchMetricsScope::SearchMetricsScope(const game_state_t* game) noexcept : game_(game) {
+    if (scope_depth++ == 0) {
+        started_ns_ = search_metrics_now();
+    }
+}
+
+SearchMetricsScope::~SearchMetricsScope() {
+    --scope_depth;
+    if (started_ns_ == 0) {
+        return;
+    }
+
+    // The game's totals already include every helper thread's share
+    ThreadCounters& counters = thread_counters();
+    bump(counters.nodes, game_->search_nodes);
+    bump(counters.tt_probes, game_->search_tt_probes);
+    bump(counters.tt_hits, game_->search_tt_hits);
+    record_phase_slow(SearchPhase::Search, started_ns_);
+}
+
+} // namespace gomoku
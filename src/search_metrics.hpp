@@ -0,0 +1,171 @@
+//
+//  search_metrics.hpp
+//  gomoku - Opt-in counters on the search hot path
+//
+//  Per-thread counters, summed across threads only when someone reads them
+//
+
+#pragma once
+
+#include "game.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace gomoku {
+
+//===============================================================================
+// SNAPSHOT
+//===============================================================================
+
+// Cutoffs by the index of the move that caused them; the last bucket takes the rest
+inline constexpr int CUTOFF_MOVE_BUCKETS = 8;
+
+enum class SearchPhase {
+    MoveGen,    // Generating and scoring the moves of a node
+    Eval,       // Scoring a leaf, quiescence included
+    Search,     // A whole search, from entry point to best move
+    Count
+};
+
+inline constexpr int SEARCH_PHASE_COUNT = static_cast<int>(SearchPhase::Count);
+
+const char* search_phase_to_string(SearchPhase phase);
+
+/**
+ * Search counters of every thread, summed at one point in time. Counts
+ * only cover the time metrics were enabled.
+ */
+struct SearchMetricsSnapshot {
+    uint64_t nodes = 0;
+    uint64_t research_nodes = 0;    // Nodes of aspiration windows that failed, a share of nodes
+    uint64_t tt_probes = 0;
+    uint64_t tt_hits = 0;
+    uint64_t tt_collisions = 0;     // Table moves that were not playable in the probing position
+    std::array<uint64_t, CUTOFF_MOVE_BUCKETS> cutoffs{};
+    std::array<uint64_t, SEARCH_PHASE_COUNT> phase_calls{};
+    std::array<uint64_t, SEARCH_PHASE_COUNT> phase_ns{};
+    std::array<uint64_t, MAX_SEARCH_DEPTH + 1> depth_completed{};   // Iterations finished at each depth
+    std::array<uint64_t, MAX_SEARCH_DEPTH + 1> depth_ns{};
+
+    [[nodiscard]] uint64_t searches() const noexcept { return phase_calls[static_cast<int>(SearchPhase::Search)]; }
+    [[nodiscard]] uint64_t leaf_evals() const noexcept { return phase_calls[static_cast<int>(SearchPhase::Eval)]; }
+
+    SearchMetricsSnapshot& operator+=(const SearchMetricsSnapshot& other) noexcept;
+};
+
+//===============================================================================
+// COLLECTION
+//===============================================================================
+
+namespace detail {
+inline std::atomic<bool> search_metrics_on{false};
+} // namespace detail
+
+/**
+ * Turns collection on or off for every thread. While off, each hook costs
+ * one relaxed load and a predicted branch.
+ */
+void enable_search_metrics(bool enabled) noexcept;
+
+[[nodiscard]] inline bool search_metrics_enabled() noexcept {
+    return detail::search_metrics_on.load(std::memory_order_relaxed);
+}
+
+/**
+ * Sums the counters of live threads and of threads that have exited.
+ */
+[[nodiscard]] SearchMetricsSnapshot collect_search_metrics();
+
+/**
+ * Zeroes every counter. Counts from searches running meanwhile may survive.
+ */
+void reset_search_metrics();
+
+// Monotonic nanoseconds, or 0 while metrics are off so the caller skips recording
+[[nodiscard]] inline uint64_t search_metrics_now() noexcept {
+    if (!search_metrics_enabled()) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void record_phase_slow(SearchPhase phase, uint64_t started_ns) noexcept;
+void record_cutoff_slow(int move_index) noexcept;
+void record_tt_collision_slow() noexcept;
+void record_research_nodes_slow(uint64_t nodes) noexcept;
+void record_depth_slow(int depth, uint64_t started_ns) noexcept;
+
+inline void record_cutoff(int move_index) noexcept {
+    if (search_metrics_enabled()) {
+        record_cutoff_slow(move_index);
+    }
+}
+
+inline void record_tt_collision() noexcept {
+    if (search_metrics_enabled()) {
+        record_tt_collision_slow();
+    }
+}
+
+/**
+ * Records the nodes of an aspiration window that failed and was searched
+ * again with the full window. They stay in the game's node count too.
+ */
+inline void record_research_nodes(uint64_t nodes) noexcept {
+    if (search_metrics_enabled()) {
+        record_research_nodes_slow(nodes);
+    }
+}
+
+/**
+ * Records an iteration of iterative deepening that finished depth, begun
+ * at started_ns from search_metrics_now().
+ */
+inline void record_depth(int depth, uint64_t started_ns) noexcept {
+    if (started_ns != 0) {
+        record_depth_slow(depth, started_ns);
+    }
+}
+
+/**
+ * Counts a call of phase and the time until the timer goes away.
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(SearchPhase phase) noexcept : phase_(phase), started_ns_(search_metrics_now()) {}
+    ~PhaseTimer() {
+        if (started_ns_ != 0) {
+            record_phase_slow(phase_, started_ns_);
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    SearchPhase phase_;
+    uint64_t started_ns_;
+};
+
+/**
+ * Taken by entry points into the search: times the search and, when it
+ * ends, adds the game's node and table counts. As with ScratchLease, only
+ * the outermost scope on a thread records, so nested entry points are free.
+ */
+class SearchMetricsScope {
+public:
+    explicit SearchMetricsScope(const game_state_t* game) noexcept;
+    ~SearchMetricsScope();
+
+    SearchMetricsScope(const SearchMetricsScope&) = delete;
+    SearchMetricsScope& operator=(const SearchMetricsScope&) = delete;
+
+private:
+    const game_state_t* game_;
+    uint64_t started_ns_ = 0;   // 0 when metrics are off or an outer scope records
+};
+
+} // namespace gomoku
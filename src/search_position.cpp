@@ -0,0 +1,102 @@
+//
+//  search_position.cpp
+//  gomoku - Compact search snapshot handed to parallel search workers
+//
+//  Capture from a game and replay into the calling thread's reusable state
+//
+
+#include "search_position.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace gomoku {
+
+//===============================================================================
+// CAPTURE
+//===============================================================================
+
+SearchPosition SearchPosition::capture(const game_state_t& game) noexcept {
+    SearchPosition position;
+    position.bitboard = game.bitboard;
+    position.hash = game.current_hash;
+    std::copy(std::begin(game.symmetry_hashes), std::end(game.symmetry_hashes), position.symmetry_hashes.begin());
+    position.hash_symmetry = game.hash_symmetry;
+    position.null_move_count = game.null_move_count;
+
+    for (int depth = 0; depth < MAX_SEARCH_DEPTH; depth++) {
+        for (int k = 0; k < MAX_KILLER_MOVES; k++) {
+            position.killers[depth][k] = {
+                static_cast<int8_t>(game.scratch->killer_moves[depth][k][0]),
+                static_cast<int8_t>(game.scratch->killer_moves[depth][k][1])
+            };
+        }
+    }
+
+    return position;
+}
+
+//===============================================================================
+// PER-THREAD SEARCH STATE
+//===============================================================================
+
+game_state_t* thread_search_state(const game_state_t& root, const SearchPosition& position) {
+    // Allocated on the thread's first search and reused for every later one;
+    // the state keeps its scratch attached rather than borrowing from the pool
+    thread_local std::unique_ptr<game_state_t> local = std::make_unique<game_state_t>();
+    thread_local std::unique_ptr<search_scratch_t> scratch = std::make_unique<search_scratch_t>();
+    game_state_t *state = local.get();
+    state->scratch = scratch.get();
+
+    // Configuration, limits and the shared table come from the root game
+    state->config = root.config;
+    state->board_size = root.board_size;
+    state->current_player = root.current_player;
+    state->game_state = root.game_state;
+    state->max_depth = root.max_depth;
+    state->move_timeout = root.move_timeout;
+    state->search_start_time = root.search_start_time;
+    state->search_timed_out = 0;
+    state->search_timeout_ms = root.search_timeout_ms;
+    state->abort_search = root.abort_search;
+    state->search_nodes = 0;
+    state->search_tt_probes = 0;
+    state->search_tt_hits = 0;
+    state->search_moves_evaluated = 0;
+    state->transposition_table = root.transposition_table;
+    std::memcpy(state->scratch->history_scores, root.scratch->history_scores, sizeof(root.scratch->history_scores));
+    std::memcpy(state->scratch->butterfly_scores, root.scratch->butterfly_scores, sizeof(root.scratch->butterfly_scores));
+    std::memcpy(state->scratch->countermoves, root.scratch->countermoves, sizeof(root.scratch->countermoves));
+    state->use_aspiration_windows = root.use_aspiration_windows;
+    state->use_principal_variation = root.use_principal_variation;
+    state->search_algorithm = root.search_algorithm;
+    state->use_threat_space_search = root.use_threat_space_search;
+    state->null_move_allowed = root.null_move_allowed;
+    state->move_history_count = 0;
+    state->ai_history_count = 0;
+    state->scratch->threat_count = 0;
+
+    // Stones and hash come from the snapshot
+    state->bitboard = position.bitboard;
+    state->current_hash = position.hash;
+    std::copy(position.symmetry_hashes.begin(), position.symmetry_hashes.end(), state->symmetry_hashes);
+    state->hash_symmetry = position.hash_symmetry;
+    state->null_move_count = position.null_move_count;
+    state->winner_cache_valid = 0;
+
+    state->board.load(position.bitboard);
+    state->threats.load(position.bitboard);
+    state->candidates.load(position.bitboard);
+
+    for (int depth = 0; depth < MAX_SEARCH_DEPTH; depth++) {
+        for (int k = 0; k < MAX_KILLER_MOVES; k++) {
+            state->scratch->killer_moves[depth][k][0] = position.killers[depth][k][0];
+            state->scratch->killer_moves[depth][k][1] = position.killers[depth][k][1];
+        }
+    }
+
+    return state;
+}
+
+} // namespace gomoku
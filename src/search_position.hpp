@@ -0,0 +1,53 @@
+//
+//  search_position.hpp
+//  gomoku - Compact search snapshot handed to parallel search workers
+//
+//  Replaces per-task game_state_t clones with a small copy plus a per-thread state
+//
+
+#pragma once
+
+#include "game.h"
+#include <array>
+#include <cstdint>
+
+namespace gomoku {
+
+//===============================================================================
+// SEARCH POSITION
+//===============================================================================
+
+/**
+ * The part of a game_state_t that a search reads and mutates: stones, hash
+ * and killer slots. It is a fixed-size value of a couple of kilobytes that can
+ * be captured from one thread's state and replayed into another thread's,
+ * instead of cloning the whole game state. Candidate moves are rebuilt from
+ * the stones on replay.
+ */
+struct SearchPosition {
+    BitBoard bitboard;
+    uint64_t hash = 0;
+    std::array<uint64_t, SYMMETRY_COUNT> symmetry_hashes{};
+    int hash_symmetry = 0;
+    int null_move_count = 0;
+
+    std::array<std::array<std::array<int8_t, 2>, MAX_KILLER_MOVES>, MAX_SEARCH_DEPTH> killers{};
+
+    /**
+     * Snapshots the search-relevant state of game.
+     */
+    [[nodiscard]] static SearchPosition capture(const game_state_t& game) noexcept;
+};
+
+/**
+ * Returns the calling thread's search state, reset to position and carrying
+ * root's configuration, limits and shared transposition table. The state and
+ * its board are allocated once per thread and reused by every later call, so
+ * workers advance it with place_stone()/remove_stone() and never free it.
+ *
+ * The returned pointer stays valid for the lifetime of the thread and is
+ * overwritten by the next call on the same thread.
+ */
+game_state_t* thread_search_state(const game_state_t& root, const SearchPosition& position);
+
+} // namespace gomoku
@@ -0,0 +1,86 @@
+//
+//  search_scratch.cpp
+//  gomoku - Pool of search heuristics lent to games while they search
+//
+//  Owner-affine reuse of idle blocks, clearing them when they change hands
+//
+
+#include "search_scratch.hpp"
+
+namespace gomoku {
+
+//===============================================================================
+// SEARCH SCRATCH POOL
+//===============================================================================
+
+SearchScratchPool::SearchScratchPool(size_t idle_capacity) : idle_capacity_(idle_capacity) {}
+
+search_scratch_t* SearchScratchPool::acquire(uint64_t owner) {
+    std::unique_ptr<search_scratch_t> scratch;
+    {
+        std::lock_guard lock(mutex_);
+        for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+            if ((*it)->owner == owner) {
+                scratch = std::move(*it);
+                idle_.erase(it);
+                return scratch.release();
+            }
+        }
+        if (!idle_.empty()) {
+            scratch = std::move(idle_.back());
+            idle_.pop_back();
+        }
+    }
+
+    // Cleared outside the lock, so concurrent searches do not wait on it
+    if (!scratch) {
+        scratch = std::make_unique<search_scratch_t>();
+    }
+    init_search_scratch(scratch.get());
+    scratch->owner = owner;
+    return scratch.release();
+}
+
+void SearchScratchPool::release(search_scratch_t* scratch) {
+    std::unique_ptr<search_scratch_t> returned(scratch);
+    std::unique_ptr<search_scratch_t> evicted;
+    std::lock_guard lock(mutex_);
+    if (idle_capacity_ == 0) {
+        return;
+    }
+    idle_.push_front(std::move(returned));
+    if (idle_.size() > idle_capacity_) {
+        evicted = std::move(idle_.back());
+        idle_.pop_back();
+    }
+}
+
+size_t SearchScratchPool::idle() const {
+    std::lock_guard lock(mutex_);
+    return idle_.size();
+}
+
+SearchScratchPool& shared_search_scratch_pool() {
+    static SearchScratchPool pool;
+    return pool;
+}
+
+//===============================================================================
+// SCRATCH LEASE
+//===============================================================================
+
+ScratchLease::ScratchLease(game_state_t* game, SearchScratchPool& pool) : game_(game), pool_(pool) {
+    if (!game_->scratch) {
+        scratch_ = pool_.acquire(game_->search_id);
+        game_->scratch = scratch_;
+    }
+}
+
+ScratchLease::~ScratchLease() {
+    if (scratch_) {
+        game_->scratch = nullptr;
+        pool_.release(scratch_);
+    }
+}
+
+} // namespace gomoku
@@ -0,0 +1,93 @@
+//
+//  search_scratch.hpp
+//  gomoku - Pool of search heuristics lent to games while they search
+//
+//  Keeps killers, history and threat lists out of game_state_t between moves
+//
+
+#pragma once
+
+#include "game.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace gomoku {
+
+//===============================================================================
+// SEARCH SCRATCH POOL
+//===============================================================================
+
+/**
+ * Lends search_scratch_t blocks to searching games. Only as many blocks
+ * exist as searches run at once, plus up to idle_capacity returned ones
+ * kept for reuse, however many games are alive.
+ *
+ * A returned block remembers the game it was used for, and acquire() hands
+ * it back to that game if it is still idle, so a game searching move after
+ * move keeps its killers and history as if it owned them. Otherwise the
+ * least recently returned block is cleared and reused.
+ *
+ * All members are safe to call from concurrent searches.
+ */
+class SearchScratchPool {
+public:
+    static constexpr size_t DEFAULT_IDLE_CAPACITY = 256;
+
+    explicit SearchScratchPool(size_t idle_capacity = DEFAULT_IDLE_CAPACITY);
+
+    SearchScratchPool(const SearchScratchPool&) = delete;
+    SearchScratchPool& operator=(const SearchScratchPool&) = delete;
+
+    /**
+     * Returns a block holding owner's heuristics if one is idle, else a
+     * cleared block now owned by owner.
+     */
+    [[nodiscard]] search_scratch_t* acquire(uint64_t owner);
+
+    /**
+     * Takes back a block from acquire(), freeing the least recently
+     * returned one beyond the idle capacity.
+     */
+    void release(search_scratch_t* scratch);
+
+    [[nodiscard]] size_t idle() const;
+
+private:
+    size_t idle_capacity_;
+    mutable std::mutex mutex_;
+    std::list<std::unique_ptr<search_scratch_t>> idle_;   // Most recently returned first
+};
+
+/**
+ * The pool every search in the process borrows from.
+ */
+SearchScratchPool& shared_search_scratch_pool();
+
+//===============================================================================
+// SCRATCH LEASE
+//===============================================================================
+
+/**
+ * Attaches a scratch block from pool to game for the lifetime of the lease
+ * and returns it when the lease goes away. Entry points into the search
+ * take one; a lease on a game that already has a scratch attached does
+ * nothing, so nested entry points are free.
+ */
+class ScratchLease {
+public:
+    explicit ScratchLease(game_state_t* game, SearchScratchPool& pool = shared_search_scratch_pool());
+    ~ScratchLease();
+
+    ScratchLease(const ScratchLease&) = delete;
+    ScratchLease& operator=(const ScratchLease&) = delete;
+
+private:
+    game_state_t* game_;
+    SearchScratchPool& pool_;
+    search_scratch_t* scratch_ = nullptr;   // Null when the game already had one
+};
+
+} // namespace gomoku
@@ -0,0 +1,805 @@
+//
+//  selfplay_main.cpp
+//  gomoku-selfplay - Headless engine-vs-engine matches
+//
+//  Plays many AI-vs-AI games at once and reports per-game JSON lines with Elo and SPRT statistics
+//
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <expected>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "json.hpp"
+#include "gomoku.hpp"
+#include "game.h"
+#include "ai.h"
+#include "ai_parallel.hpp"
+#include "search_handle.hpp"
+#include "game_history.hpp"
+#include "history_writer.hpp"
+
+namespace {
+
+using json = nlohmann::ordered_json;
+using GamePtr = std::unique_ptr<game_state_t, void(*)(game_state_t*)>;
+
+/**
+ * How one side of the match searches
+ */
+struct EngineSpec {
+    std::string name;
+    int depth = 0;              // 0 = 4, or MAX_SEARCH_DEPTH under a time control
+    int threads = 1;            // Lazy SMP threads of every search
+    int movetime_ms = 0;        // Fixed budget per move
+    int clock_ms = 0;           // Game clock, with clock_increment_ms added after every move
+    int clock_increment_ms = 0;
+    bool plain_search = false;
+    gomoku::SearchAlgorithm algorithm = gomoku::SearchAlgorithm::AlphaBeta;
+
+    [[nodiscard]] bool timed() const { return movetime_ms > 0 || clock_ms > 0; }
+    [[nodiscard]] int search_depth() const { return depth > 0 ? depth : timed() ? MAX_SEARCH_DEPTH : 4; }
+};
+
+struct SprtBounds {
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+struct SelfPlayOptions {
+    EngineSpec engines[2];
+    int games = 0;              // 0 = two per opening of the suite, or 100 with random openings
+    int concurrency = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int board_size = 15;
+    std::string openings;       // Opening suite; random openings when empty
+    int random_plies = 3;
+    uint32_t seed = 1;
+    int tt_size_mb = 8;
+    std::string log_dir;        // Game history JSON per game; none when empty
+    std::optional<SprtBounds> sprt;
+};
+
+struct Opening {
+    std::string id;
+    std::vector<move_history_t> moves;
+};
+
+//===============================================================================
+// COMMAND LINE
+//===============================================================================
+
+void print_usage(std::string_view program_name) {
+    std::cout << std::format(R"(
+gomoku-selfplay - Headless engine-vs-engine matches
+
+USAGE:
+    {} [OPTIONS]
+
+OPTIONS:
+    -A, --engine-a <SPEC>    Engine A (default: depth=4)
+    -B, --engine-b <SPEC>    Engine B (default: depth=4)
+    -g, --games <COUNT>      Games to play (default: two per opening, or 100 with random openings)
+    -c, --concurrency <N>    Games played at once (default: CPU cores)
+    -b, --board <SIZE>       Board size, 15 or 19 (default: 15)
+    -o, --openings <PATH>    Opening suite in the gomoku-bench position format
+    -r, --random-plies <N>   Stones in each random opening without a suite (default: 3, range: 1-8)
+    -s, --seed <N>           Seed of the random openings (default: 1)
+    -m, --tt-size <MB>       Transposition table of each engine in each game (default: 8)
+    -l, --log-dir <DIR>      Write every game to DIR in the game history JSON format
+    -S, --sprt <ELO0,ELO1>   Stop once SPRT accepts either Elo (alpha = beta = 0.05)
+    -h, --help               Show this help message
+
+ENGINE SPEC:
+    Comma-separated key=value pairs, for example "depth=6,threads=2,tc=10+0.1":
+      name=<TEXT>            Name in records and logs (default: A or B)
+      depth=<1-10>           Search depth (default: 4, or 10 under a time control)
+      threads=<N>            Lazy SMP threads per search (default: 1)
+      movetime=<MS>          Fixed time per move
+      tc=<SECONDS>+<INC>     Game clock with an increment per move; running out loses
+      search=pvs|plain|mcts  PVS (default), plain alpha-beta or Monte Carlo tree search
+
+Every opening is played twice, each engine taking x once. Each engine keeps
+its own search state and transposition table per game. One JSON object is
+written per line: a "game" record as each game ends, then a "summary" record
+with A's wins, draws and losses, its Elo difference against B with a 95%
+interval, the likelihood of superiority and, with --sprt, the log-likelihood
+ratio and decision.
+)", program_name);
+}
+
+std::optional<int> parse_int(std::string_view text, int min, int max) {
+    int value{};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<double> parse_double(std::string_view text, double min, double max) {
+    double value{};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::expected<EngineSpec, std::string> parse_engine(std::string_view text, std::string name) {
+    EngineSpec spec;
+    spec.name = std::move(name);
+
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view pair = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+        size_t equals = pair.find('=');
+        if (equals == std::string_view::npos) {
+            return std::unexpected(std::format("Engine option '{}' needs a value", pair));
+        }
+        std::string_view key = pair.substr(0, equals);
+        std::string_view value = pair.substr(equals + 1);
+
+        if (key == "name") {
+            if (value.empty() || value.size() > 50) {
+                return std::unexpected("Engine name must be 1-50 characters");
+            }
+            spec.name = value;
+        } else if (key == "depth") {
+            auto depth = parse_int(value, 1, MAX_SEARCH_DEPTH);
+            if (!depth) {
+                return std::unexpected(std::format("Engine depth must be between 1 and {}", MAX_SEARCH_DEPTH));
+            }
+            spec.depth = *depth;
+        } else if (key == "threads") {
+            auto threads = parse_int(value, 1, 256);
+            if (!threads) {
+                return std::unexpected("Engine threads must be between 1 and 256");
+            }
+            spec.threads = *threads;
+        } else if (key == "movetime") {
+            auto movetime = parse_int(value, 1, 3600000);
+            if (!movetime) {
+                return std::unexpected("Engine movetime must be between 1 and 3600000 ms");
+            }
+            spec.movetime_ms = *movetime;
+        } else if (key == "tc") {
+            size_t plus = value.find('+');
+            auto base = parse_double(value.substr(0, plus), 0.001, 86400.0);
+            auto increment = plus == std::string_view::npos ? std::optional(0.0)
+                                                            : parse_double(value.substr(plus + 1), 0.0, 3600.0);
+            if (!base || !increment) {
+                return std::unexpected(std::format("Engine tc '{}' must be <seconds>+<increment>", value));
+            }
+            spec.clock_ms = static_cast<int>(*base * 1000.0);
+            spec.clock_increment_ms = static_cast<int>(*increment * 1000.0);
+        } else if (key == "search") {
+            if (value != "pvs" && value != "plain" && value != "mcts") {
+                return std::unexpected("Engine search must be 'pvs', 'plain' or 'mcts'");
+            }
+            spec.plain_search = value == "plain";
+            if (value == "mcts") {
+                spec.algorithm = gomoku::SearchAlgorithm::MonteCarlo;
+            }
+        } else {
+            return std::unexpected(std::format("Unknown engine option '{}'", key));
+        }
+    }
+
+    if (spec.movetime_ms > 0 && spec.clock_ms > 0) {
+        return std::unexpected(std::format("Engine {} has both movetime and tc", spec.name));
+    }
+    return spec;
+}
+
+std::expected<SelfPlayOptions, std::string> parse_options(int argc, char* argv[]) {
+    SelfPlayOptions options;
+    options.engines[0].name = "A";
+    options.engines[1].name = "B";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            return std::unexpected(std::format("Missing value for '{}'", arg));
+        }
+        std::string_view value = argv[++i];
+
+        if (arg == "-A" || arg == "--engine-a" || arg == "-B" || arg == "--engine-b") {
+            int side = (arg == "-A" || arg == "--engine-a") ? 0 : 1;
+            auto engine = parse_engine(value, options.engines[side].name);
+            if (!engine) {
+                return std::unexpected(engine.error());
+            }
+            options.engines[side] = *engine;
+        } else if (arg == "-g" || arg == "--games") {
+            auto games = parse_int(value, 1, 10000000);
+            if (!games) {
+                return std::unexpected("Games must be between 1 and 10000000");
+            }
+            options.games = *games;
+        } else if (arg == "-c" || arg == "--concurrency") {
+            auto concurrency = parse_int(value, 1, 1024);
+            if (!concurrency) {
+                return std::unexpected("Concurrency must be between 1 and 1024");
+            }
+            options.concurrency = *concurrency;
+        } else if (arg == "-b" || arg == "--board") {
+            auto size = parse_int(value, 15, 19);
+            if (!size || (*size != 15 && *size != 19)) {
+                return std::unexpected("Board size must be 15 or 19");
+            }
+            options.board_size = *size;
+        } else if (arg == "-o" || arg == "--openings") {
+            options.openings = value;
+        } else if (arg == "-r" || arg == "--random-plies") {
+            auto plies = parse_int(value, 1, 8);
+            if (!plies) {
+                return std::unexpected("Random plies must be between 1 and 8");
+            }
+            options.random_plies = *plies;
+        } else if (arg == "-s" || arg == "--seed") {
+            auto seed = parse_int(value, 0, std::numeric_limits<int>::max());
+            if (!seed) {
+                return std::unexpected("Seed must be a non-negative integer");
+            }
+            options.seed = static_cast<uint32_t>(*seed);
+        } else if (arg == "-m" || arg == "--tt-size") {
+            auto size = parse_int(value, 1, 4096);
+            if (!size) {
+                return std::unexpected("Table size must be between 1 and 4096 MB");
+            }
+            options.tt_size_mb = *size;
+        } else if (arg == "-l" || arg == "--log-dir") {
+            options.log_dir = value;
+        } else if (arg == "-S" || arg == "--sprt") {
+            size_t comma = value.find(',');
+            auto elo0 = parse_double(value.substr(0, comma), -1000.0, 1000.0);
+            auto elo1 = comma == std::string_view::npos ? std::nullopt
+                                                        : parse_double(value.substr(comma + 1), -1000.0, 1000.0);
+            if (!elo0 || !elo1 || *elo0 >= *elo1) {
+                return std::unexpected("SPRT bounds must be <elo0>,<elo1> with elo0 < elo1");
+            }
+            options.sprt = SprtBounds{.elo0 = *elo0, .elo1 = *elo1};
+        } else {
+            return std::unexpected(std::format("Unknown argument '{}'", arg));
+        }
+    }
+
+    if (options.engines[0].name == options.engines[1].name) {
+        return std::unexpected("The two engines need different names");
+    }
+    return options;
+}
+
+//===============================================================================
+// OPENINGS
+//===============================================================================
+
+std::expected<GamePtr, std::string> new_game(int board_size) {
+    cli_config_t config{};
+    config.board_size = board_size;
+    config.max_depth = 4;
+    GamePtr game(init_game(config), cleanup_game);
+    if (!game) {
+        return std::unexpected("Failed to initialize game state");
+    }
+    return game;
+}
+
+/**
+ * Reads the opening suite: a "positions" array in the gomoku-bench format,
+ * whose entries carry an id and a "moves" array in the game JSON format, or
+ * a bare array of such entries. Openings for another board size are
+ * skipped, and every opening must leave the game running.
+ */
+std::expected<std::vector<Opening>, std::string> load_openings(const std::string& path, int board_size) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(std::format("Cannot open '{}'", path));
+    }
+    json document = json::parse(file, nullptr, false);
+    if (document.is_discarded()) {
+        return std::unexpected(std::format("'{}' is not valid JSON", path));
+    }
+
+    const json& entries = document.contains("positions") ? document["positions"] : document;
+    if (!entries.is_array() || entries.empty()) {
+        return std::unexpected(std::format("'{}' has no openings", path));
+    }
+
+    auto scratch = new_game(board_size);
+    if (!scratch) {
+        return std::unexpected(scratch.error());
+    }
+
+    std::vector<Opening> openings;
+    for (const auto& entry : entries) {
+        Opening opening;
+        opening.id = entry.value("id", std::format("opening-{}", openings.size() + 1));
+        int size = entry.contains("game") ? entry["game"].value("board_size", board_size)
+                                          : entry.value("board_size", board_size);
+        if (size != board_size) {
+            continue;
+        }
+
+        reset_game(scratch->get(), (*scratch)->config);
+        for (const auto& move : entry.value("moves", json::array())) {
+            if (!move.contains("position")) {
+                return std::unexpected(std::format("{}: every move needs a position", opening.id));
+            }
+            move_history_t record{};
+            record.player = (*scratch)->current_player;
+            record.x = move["position"].value("x", -1);
+            record.y = move["position"].value("y", -1);
+            if (!make_move(scratch->get(), record.x, record.y, record.player, 0.0, 0) ||
+                    (*scratch)->game_state != static_cast<int>(gomoku::GameState::Running)) {
+                return std::unexpected(std::format("{}: move ({}, {}) is illegal or ends the game",
+                                                   opening.id, record.x, record.y));
+            }
+            opening.moves.push_back(record);
+        }
+        openings.push_back(std::move(opening));
+    }
+    if (openings.empty()) {
+        return std::unexpected(std::format("'{}' has no openings for a {}x{} board", path, board_size, board_size));
+    }
+    return openings;
+}
+
+/**
+ * Alternating stones on distinct cells within three of the centre. At most
+ * eight, too few for five, so every such opening leaves the game running.
+ */
+Opening random_opening(uint32_t seed, int pair, int plies, int board_size) {
+    std::mt19937 rng(seed * 1000003u + static_cast<uint32_t>(pair));
+    std::uniform_int_distribution<int> offset(-3, 3);
+    int center = board_size / 2;
+
+    Opening opening;
+    opening.id = std::format("random-{}", pair + 1);
+    while (static_cast<int>(opening.moves.size()) < plies) {
+        move_history_t record{};
+        record.x = center + offset(rng);
+        record.y = center + offset(rng);
+        record.player = opening.moves.size() % 2 == 0 ? static_cast<int>(gomoku::Player::Cross)
+                                                      : static_cast<int>(gomoku::Player::Naught);
+        bool taken = std::any_of(opening.moves.begin(), opening.moves.end(),
+                                 [&](const move_history_t& m) { return m.x == record.x && m.y == record.y; });
+        if (!taken) {
+            opening.moves.push_back(record);
+        }
+    }
+    return opening;
+}
+
+//===============================================================================
+// STATISTICS
+//===============================================================================
+
+/**
+ * Results from engine A's side
+ */
+struct MatchScore {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    [[nodiscard]] int games() const { return wins + draws + losses; }
+    [[nodiscard]] double score() const { return (wins + 0.5 * draws) / games(); }
+
+    // Variance of one game's score around the mean
+    [[nodiscard]] double variance() const {
+        double s = score();
+        return (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games();
+    }
+};
+
+double elo_from_score(double score) {
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double score_from_elo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+/**
+ * Log-likelihood ratio of elo1 against elo0, approximating the per-game
+ * score as normal with the observed variance.
+ */
+double sprt_llr(const MatchScore& match, const SprtBounds& bounds) {
+    double variance = match.variance();
+    if (match.games() == 0 || variance <= 0.0) {
+        return 0.0;
+    }
+    double s0 = score_from_elo(bounds.elo0);
+    double s1 = score_from_elo(bounds.elo1);
+    return match.games() * (s1 - s0) * (2.0 * match.score() - s0 - s1) / (2.0 * variance);
+}
+
+double sprt_lower(const SprtBounds& bounds) { return std::log(bounds.beta / (1.0 - bounds.alpha)); }
+double sprt_upper(const SprtBounds& bounds) { return std::log((1.0 - bounds.beta) / bounds.alpha); }
+
+json summary_record(const SelfPlayOptions& options, const MatchScore& match) {
+    json record = {
+        {"type", "summary"},
+        {"a", options.engines[0].name},
+        {"b", options.engines[1].name},
+        {"games", match.games()},
+        {"wins", match.wins},
+        {"draws", match.draws},
+        {"losses", match.losses},
+        {"score", nullptr},
+        {"elo", nullptr},
+        {"elo_error", nullptr},
+        {"los", nullptr},
+    };
+    if (match.games() == 0) {
+        return record;
+    }
+
+    double score = match.score();
+    record["score"] = score;
+    if (score > 0.0 && score < 1.0) {
+        record["elo"] = elo_from_score(score);
+        double margin = 1.96 * std::sqrt(match.variance() / match.games());
+        if (score - margin > 0.0 && score + margin < 1.0) {
+            record["elo_error"] = (elo_from_score(score + margin) - elo_from_score(score - margin)) / 2.0;
+        }
+    }
+    if (match.wins + match.losses > 0) {
+        record["los"] = 0.5 * (1.0 + std::erf((match.wins - match.losses) /
+                                              std::sqrt(2.0 * (match.wins + match.losses))));
+    }
+
+    if (options.sprt) {
+        double llr = sprt_llr(match, *options.sprt);
+        double lower = sprt_lower(*options.sprt);
+        double upper = sprt_upper(*options.sprt);
+        record["sprt"] = {
+            {"elo0", options.sprt->elo0},
+            {"elo1", options.sprt->elo1},
+            {"llr", llr},
+            {"lower", lower},
+            {"upper", upper},
+            {"result", llr >= upper ? "H1" : llr <= lower ? "H0" : "continue"},
+        };
+    }
+    return record;
+}
+
+//===============================================================================
+// GAMES
+//===============================================================================
+
+struct GameRecord {
+    int index;
+    std::string opening;
+    int x_engine;               // Index into SelfPlayOptions::engines
+    int winner;                 // Player::Cross, Player::Naught or Player::Empty for a draw
+    std::string reason;         // "five", "board full", "time" or "illegal move"
+    int moves;
+    double seconds;
+    std::string log_path;
+};
+
+/**
+ * One engine's private search state: its own copy of the game, table and
+ * Lazy SMP threads, reused from game to game on the same worker.
+ *
+ * The table is private so that a match measures each configuration alone:
+ * with a shared one, the deeper engine's entries would play for the other,
+ * and entries left by other games would tie results together that the Elo
+ * and SPRT statistics take as independent. Clearing it per game does the
+ * same for the games one worker plays.
+ */
+class EngineSide {
+public:
+    EngineSide(const EngineSpec& spec, int tt_size_mb)
+        : spec_(spec), table_(static_cast<size_t>(tt_size_mb)), game_(nullptr, cleanup_game) {
+        if (spec.threads > 1) {
+            engine_ = std::make_unique<gomoku::ParallelAI>(spec.threads, gomoku::SearchMode::LazySmp);
+        }
+    }
+
+    void new_game(int board_size) {
+        cli_config_t config{};
+        config.board_size = board_size;
+        config.max_depth = spec_.search_depth();
+        config.plain_search = spec_.plain_search ? 1 : 0;
+        if (!game_) {
+            game_.reset(init_game(config));
+            if (!game_) {
+                throw std::bad_alloc();
+            }
+        } else {
+            reset_game(game_.get(), config);
+        }
+        table_.clear();
+        game_->transposition_table = &table_;
+        game_->search_algorithm = spec_.algorithm;
+        game_->quiet_search = 1;
+        clock_ms_ = spec_.clock_ms;
+    }
+
+    /**
+     * Searches for the side to move within this move's share of the clock.
+     */
+    gomoku::SearchResult search() {
+        game_->search_timeout_ms = spec_.movetime_ms;
+        if (spec_.clock_ms > 0) {
+            // A fraction of what is left, plus the increment, never more than half the clock
+            double budget = clock_ms_ / 20.0 + spec_.clock_increment_ms;
+            game_->search_timeout_ms = std::max(1, static_cast<int>(std::min(budget, clock_ms_ / 2.0)));
+        }
+        return gomoku::run_search(*game_, engine_.get());
+    }
+
+    /**
+     * Charges a move's time to the clock; false when the flag fell.
+     */
+    bool charge_clock(double elapsed_ms) {
+        if (spec_.clock_ms == 0) {
+            return true;
+        }
+        clock_ms_ -= elapsed_ms;
+        if (clock_ms_ < 0.0) {
+            return false;
+        }
+        clock_ms_ += spec_.clock_increment_ms;
+        return true;
+    }
+
+    game_state_t* game() { return game_.get(); }
+    const EngineSpec& spec() const { return spec_; }
+
+private:
+    const EngineSpec& spec_;
+    gomoku::TranspositionTable table_;
+    std::unique_ptr<gomoku::ParallelAI> engine_;
+    GamePtr game_;
+    double clock_ms_ = 0.0;
+};
+
+class Match {
+public:
+    Match(const SelfPlayOptions& options, std::vector<Opening> openings, std::FILE* out)
+        : options_(options), openings_(std::move(openings)), out_(out) {
+        total_games_ = options_.games > 0 ? options_.games
+                     : !openings_.empty() ? static_cast<int>(openings_.size()) * 2 : 100;
+    }
+
+    void run() {
+        std::vector<std::jthread> workers;
+        int worker_count = std::min(options_.concurrency, total_games_);
+        for (int w = 0; w < worker_count; w++) {
+            workers.emplace_back([this] { worker(); });
+        }
+        workers.clear();   // Joins
+        gomoku::shared_history_writer().flush();   // Every game log is on disk before the summary
+
+        std::lock_guard lock(mutex_);
+        write(summary_record(options_, score_));
+    }
+
+private:
+    void worker() {
+        EngineSide sides[2] = {
+            EngineSide(options_.engines[0], options_.tt_size_mb),
+            EngineSide(options_.engines[1], options_.tt_size_mb),
+        };
+
+        while (!stop_.load(std::memory_order_relaxed)) {
+            int index = next_game_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= total_games_) {
+                break;
+            }
+            record(play(index, sides));
+        }
+    }
+
+    Opening opening_for(int index) const {
+        int pair = index / 2;
+        if (!openings_.empty()) {
+            return openings_[pair % openings_.size()];
+        }
+        return random_opening(options_.seed, pair, options_.random_plies, options_.board_size);
+    }
+
+    /**
+     * Plays game index: the opening, then the engines in turn until a five,
+     * a full board, a fallen flag or an illegal move. Even games give engine
+     * A the crosses, odd ones engine B.
+     */
+    GameRecord play(int index, EngineSide (&sides)[2]) {
+        Opening opening = opening_for(index);
+        int x_engine = index % 2;
+        double started_at = get_current_time();
+
+        for (auto& side : sides) {
+            side.new_game(options_.board_size);
+        }
+
+        std::unique_ptr<gomoku::GameHistory> history;
+        if (!options_.log_dir.empty()) {
+            const EngineSpec& x_spec = options_.engines[x_engine];
+            cli_config_t config{};
+            config.board_size = options_.board_size;
+            config.max_depth = x_spec.search_depth();
+            config.thread_count = x_spec.threads;
+            std::snprintf(config.player1_type, sizeof(config.player1_type), "computer");
+            std::snprintf(config.player2_type, sizeof(config.player2_type), "computer");
+            std::snprintf(config.player1_name, sizeof(config.player1_name), "%s", x_spec.name.c_str());
+            std::snprintf(config.player2_name, sizeof(config.player2_name), "%s",
+                          options_.engines[1 - x_engine].name.c_str());
+            history = std::make_unique<gomoku::GameHistory>(config, options_.log_dir,
+                                                            std::format("game-{:06d}.json", index + 1));
+            (void)history->initialize();
+        }
+
+        // Every move is played on both engines' copies of the game
+        auto play_move = [&](const move_history_t& move) {
+            for (auto& side : sides) {
+                make_move(side.game(), move.x, move.y, move.player, move.time_taken, move.positions_evaluated);
+            }
+            game_state_t* game = sides[0].game();
+            if (history) {
+                bool is_winning = game->game_state != static_cast<int>(gomoku::GameState::Running);
+                (void)history->log_move(game->move_history[game->move_history_count - 1], is_winning);
+            }
+        };
+
+        for (const auto& move : opening.moves) {
+            play_move(move);
+        }
+
+        int winner = static_cast<int>(gomoku::Player::Empty);
+        std::string reason = "board full";
+        game_state_t* reference = sides[0].game();
+        while (reference->game_state == static_cast<int>(gomoku::GameState::Running)) {
+            int mover = reference->current_player;
+            EngineSide& side = sides[mover == static_cast<int>(gomoku::Player::Cross) ? x_engine : 1 - x_engine];
+
+            gomoku::SearchResult result = side.search();
+            if (!side.game()->board.is_playable(result.move.x, result.move.y)) {
+                winner = other_player(mover);
+                reason = "illegal move";
+                break;
+            }
+            if (!side.charge_clock(result.elapsed_ms)) {
+                winner = other_player(mover);
+                reason = "time";
+                break;
+            }
+
+            move_history_t move{};
+            move.x = result.move.x;
+            move.y = result.move.y;
+            move.player = mover;
+            move.time_taken = result.elapsed_ms / 1000.0;
+            move.positions_evaluated = static_cast<int>(std::min<uint64_t>(result.nodes, std::numeric_limits<int>::max()));
+            play_move(move);
+        }
+
+        if (reference->game_state == static_cast<int>(gomoku::GameState::HumanWin)) {
+            winner = static_cast<int>(gomoku::Player::Cross);
+            reason = "five";
+        } else if (reference->game_state == static_cast<int>(gomoku::GameState::AIWin)) {
+            winner = static_cast<int>(gomoku::Player::Naught);
+            reason = "five";
+        }
+
+        if (history) {
+            (void)history->update_game_status(
+                winner == static_cast<int>(gomoku::Player::Cross) ? "game_over_x_wins"
+                : winner == static_cast<int>(gomoku::Player::Naught) ? "game_over_o_wins" : "draw");
+            history->finalize();
+        }
+
+        return GameRecord{
+            .index = index,
+            .opening = opening.id,
+            .x_engine = x_engine,
+            .winner = winner,
+            .reason = reason,
+            .moves = reference->move_history_count,
+            .seconds = get_current_time() - started_at,
+            .log_path = history ? history->get_file_path() : std::string{},
+        };
+    }
+
+    void record(const GameRecord& game) {
+        std::lock_guard lock(mutex_);
+
+        int a_player = game.x_engine == 0 ? static_cast<int>(gomoku::Player::Cross)
+                                          : static_cast<int>(gomoku::Player::Naught);
+        std::string result = "1/2-1/2";
+        if (game.winner == static_cast<int>(gomoku::Player::Empty)) {
+            score_.draws++;
+        } else {
+            (game.winner == a_player ? score_.wins : score_.losses)++;
+            result = game.winner == static_cast<int>(gomoku::Player::Cross) ? "1-0" : "0-1";
+        }
+
+        write({
+            {"type", "game"},
+            {"game", game.index + 1},
+            {"opening", game.opening},
+            {"x", options_.engines[game.x_engine].name},
+            {"o", options_.engines[1 - game.x_engine].name},
+            {"result", result},
+            {"reason", game.reason},
+            {"moves", game.moves},
+            {"time_ms", game.seconds * 1000.0},
+            {"log", game.log_path.empty() ? json(nullptr) : json(game.log_path)},
+        });
+
+        // Games already under way finish, but no new ones start once SPRT decides
+        if (options_.sprt) {
+            double llr = sprt_llr(score_, *options_.sprt);
+            if (llr >= sprt_upper(*options_.sprt) || llr <= sprt_lower(*options_.sprt)) {
+                stop_.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void write(const json& record) {
+        std::fprintf(out_, "%s\n", record.dump().c_str());
+        std::fflush(out_);
+    }
+
+    const SelfPlayOptions& options_;
+    std::vector<Opening> openings_;
+    std::FILE* out_;
+    int total_games_;
+    std::atomic<int> next_game_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;              // Guards score_ and out_
+    MatchScore score_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        std::cerr << std::format("Error: {}\n", options.error());
+        return 1;
+    }
+
+    std::vector<Opening> openings;
+    if (!options->openings.empty()) {
+        auto loaded = load_openings(options->openings, options->board_size);
+        if (!loaded) {
+            std::cerr << std::format("Error: {}\n", loaded.error());
+            return 1;
+        }
+        openings = std::move(*loaded);
+    }
+    gomoku::populate_threat_matrix();
+
+    Match(*options, std::move(openings), stdout).run();
+    return 0;
+}
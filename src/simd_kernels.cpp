@@ -0,0 +1,122 @@
+//
+//  simd_kernels.cpp
+//  gomoku - Vectorized line kernels with runtime dispatch
+//
+//  Instruction-set specific kernels and the startup selection between them
+//
+
+#include "simd_kernels.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GOMOKU_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GOMOKU_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace gomoku::simd {
+
+namespace {
+
+using FiveKernel = bool (*)(std::span<const uint32_t>) noexcept;
+
+//===============================================================================
+// AVX2
+//===============================================================================
+
+#ifdef GOMOKU_SIMD_AVX2
+// Eight line words per pass; only this function is compiled for AVX2, so the
+// binary still runs on CPUs without it
+__attribute__((target("avx2")))
+bool any_five_avx2(std::span<const uint32_t> lines) noexcept {
+    const uint32_t* data = lines.data();
+    size_t count = lines.size();
+    size_t i = 0;
+
+    __m256i found = _mm256_setzero_si256();
+    for (; i + 8 <= count; i += 8) {
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i run = _mm256_and_si256(m, _mm256_srli_epi32(m, 1));
+        run = _mm256_and_si256(run, _mm256_srli_epi32(m, 2));
+        run = _mm256_and_si256(run, _mm256_srli_epi32(m, 3));
+        run = _mm256_and_si256(run, _mm256_srli_epi32(m, 4));
+        found = _mm256_or_si256(found, run);
+    }
+
+    if (!_mm256_testz_si256(found, found)) {
+        return true;
+    }
+    return any_five_scalar(lines.subspan(i));
+}
+#endif
+
+//===============================================================================
+// NEON
+//===============================================================================
+
+#ifdef GOMOKU_SIMD_NEON
+// Four line words per pass; NEON is part of the ARM64 baseline
+bool any_five_neon(std::span<const uint32_t> lines) noexcept {
+    const uint32_t* data = lines.data();
+    size_t count = lines.size();
+    size_t i = 0;
+
+    uint32x4_t found = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t m = vld1q_u32(data + i);
+        uint32x4_t run = vandq_u32(m, vshrq_n_u32(m, 1));
+        run = vandq_u32(run, vshrq_n_u32(m, 2));
+        run = vandq_u32(run, vshrq_n_u32(m, 3));
+        run = vandq_u32(run, vshrq_n_u32(m, 4));
+        found = vorrq_u32(found, run);
+    }
+
+    if (vmaxvq_u32(found) != 0) {
+        return true;
+    }
+    return any_five_scalar(lines.subspan(i));
+}
+#endif
+
+//===============================================================================
+// DISPATCH
+//===============================================================================
+
+bool any_five_fallback(std::span<const uint32_t> lines) noexcept {
+    return any_five_scalar(lines);
+}
+
+struct Kernels {
+    FiveKernel any_five;
+    std::string_view name;
+};
+
+Kernels select_kernels() noexcept {
+#if defined(GOMOKU_SIMD_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {any_five_avx2, "avx2"};
+    }
+#elif defined(GOMOKU_SIMD_NEON)
+    return {any_five_neon, "neon"};
+#endif
+    return {any_five_fallback, "scalar"};
+}
+
+const Kernels& kernels() noexcept {
+    static const Kernels selected = select_kernels();
+    return selected;
+}
+
+} // namespace
+
+bool any_five(std::span<const uint32_t> lines) noexcept {
+    return kernels().any_five(lines);
+}
+
+std::string_view kernel_name() noexcept {
+    return kernels().name;
+}
+
+} // namespace gomoku::simd
@@ -0,0 +1,49 @@
+//
+//  simd_kernels.hpp
+//  gomoku - Vectorized line kernels with runtime dispatch
+//
+//  AVX2 and NEON versions of the bitboard scans, with the scalar loop as fallback
+//
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace gomoku::simd {
+
+//===============================================================================
+// SCALAR REFERENCE
+//===============================================================================
+
+/**
+ * Whether any of the line words holds five consecutive set bits. Each word
+ * is one board line with one bit per cell, so this is the five-in-a-row test
+ * over every line at once.
+ */
+[[nodiscard]] constexpr bool any_five_scalar(std::span<const uint32_t> lines) noexcept {
+    uint32_t found = 0;
+    for (uint32_t m : lines) {
+        found |= m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4);
+    }
+    return found != 0;
+}
+
+//===============================================================================
+// DISPATCHED KERNELS
+//===============================================================================
+
+/**
+ * Same result as any_five_scalar(), using the widest instruction set the CPU
+ * supports: AVX2 on x86-64 when available at run time, NEON on ARM64, the
+ * scalar loop otherwise. The kernel is selected once at startup.
+ */
+[[nodiscard]] bool any_five(std::span<const uint32_t> lines) noexcept;
+
+/**
+ * Name of the kernel any_five() dispatches to: "avx2", "neon" or "scalar".
+ */
+[[nodiscard]] std::string_view kernel_name() noexcept;
+
+} // namespace gomoku::simd
@@ -0,0 +1,143 @@
+//
+//  threat_cache.cpp
+//  gomoku - Per-stone threat classifications maintained on make/unmake
+//
+//  Line-local updates and the running evaluation
+//
+
+#include "threat_cache.hpp"
+#include <algorithm>
+
+namespace gomoku {
+
+//===============================================================================
+// REBUILD
+//===============================================================================
+
+void ThreatCache::reset(int board_size) noexcept {
+    size_ = board_size;
+    owners_.fill(Player::Empty);
+    for (auto& threats : threats_) {
+        threats.fill(ThreatType::Nothing);
+    }
+    scores_.fill(0);
+    totals_ = {};
+    fives_ = {};
+}
+
+void ThreatCache::load(const BitBoard& board) noexcept {
+    reset(board.size());
+
+    for (Player player : {Player::Cross, Player::Naught}) {
+        board.for_each_stone(player, [&](int x, int y) {
+            int cell = index(x, y);
+            owners_[cell] = player;
+            for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+                set_threat(board, cell, dir, x, y);
+            }
+            rescore(cell);
+        });
+    }
+}
+
+//===============================================================================
+// INCREMENTAL UPDATE
+//===============================================================================
+
+void ThreatCache::update(const BitBoard& board, int x, int y) noexcept {
+    dispatch_board_size(size_, [&]<int Size>(std::integral_constant<int, Size>) {
+        update<Size>(board, x, y);
+    });
+}
+
+template<int Size> requires ValidBoardSize<Size>
+void ThreatCache::update(const BitBoard& board, int x, int y) noexcept {
+    int cell = x * Size + y;
+    Player occupant = board.at(x, y);
+
+    if (owners_[cell] != occupant) {
+        clear_cell(cell);
+        if (occupant != Player::Empty) {
+            owners_[cell] = occupant;
+            for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+                set_threat(board, cell, dir, x, y);
+            }
+            rescore(cell);
+        }
+    }
+
+    // Only the neighbours' classification along the shared line can change
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        const Position step = DIRECTIONS[dir];
+        for (int k = -REACH; k <= REACH; ++k) {
+            int nx = x + k * step.x;
+            int ny = y + k * step.y;
+            if (k == 0 || nx < 0 || ny < 0 || nx >= Size || ny >= Size) {
+                continue;
+            }
+
+            int neighbour = nx * Size + ny;
+            if (owners_[neighbour] != Player::Empty) {
+                set_threat(board, neighbour, dir, nx, ny);
+                rescore(neighbour);
+            }
+        }
+    }
+}
+
+void ThreatCache::set_threat(const BitBoard& board, int cell, int dir, int x, int y) noexcept {
+    int player = player_index(owners_[cell]);
+    ThreatType threat = calc_threat_at(board, owners_[cell], dir, x, y);
+
+    fives_[player] += (threat == ThreatType::Five) - (threats_[cell][dir] == ThreatType::Five);
+    threats_[cell][dir] = threat;
+}
+
+void ThreatCache::rescore(int cell) noexcept {
+    int player = player_index(owners_[cell]);
+    totals_[player] -= scores_[cell];
+    scores_[cell] = score_threats(threats_[cell]);
+    totals_[player] += scores_[cell];
+}
+
+void ThreatCache::clear_cell(int cell) noexcept {
+    if (owners_[cell] == Player::Empty) {
+        return;
+    }
+
+    int player = player_index(owners_[cell]);
+    totals_[player] -= scores_[cell];
+    fives_[player] -= static_cast<int>(std::ranges::count(threats_[cell], ThreatType::Five));
+
+    owners_[cell] = Player::Empty;
+    threats_[cell].fill(ThreatType::Nothing);
+    scores_[cell] = 0;
+}
+
+//===============================================================================
+// EVALUATION
+//===============================================================================
+
+int ThreatCache::evaluate(Player player) const noexcept {
+    int own = player_index(player);
+    int opponent = 1 - own;
+
+    // Same precedence as evaluate_position(): a five decides the position
+    if (fives_[own] > 0) {
+        return WIN_SCORE;
+    }
+    if (fives_[opponent] > 0) {
+        return LOSE_SCORE;
+    }
+
+    return totals_[own] - totals_[opponent];
+}
+
+//===============================================================================
+// EXPLICIT TEMPLATE INSTANTIATIONS
+//===============================================================================
+
+template void ThreatCache::update<15>(const BitBoard&, int, int) noexcept;
+template void ThreatCache::update<19>(const BitBoard&, int, int) noexcept;
+
+} // namespace gomoku
@@ -0,0 +1,91 @@
+//
+//  threat_cache.hpp
+//  gomoku - Per-stone threat classifications maintained on make/unmake
+//
+//  Turns the leaf evaluation of the search into a running sum
+//
+
+#pragma once
+
+#include "bitboard.hpp"
+#include <array>
+#include <cstdint>
+
+namespace gomoku {
+
+//===============================================================================
+// THREAT CACHE CLASS
+//===============================================================================
+
+/**
+ * Caches the ThreatType of every stone in each of the four DIRECTIONS, the
+ * stone's score (score_threats() of those threats) and each player's total.
+ * A stone's threat along a direction only depends on the nine cells of that
+ * line centred on it, so placing or removing a stone only reclassifies the
+ * stones within NEED_TO_WIN - 1 cells of it along the four lines through it,
+ * and only in the direction of that line.
+ *
+ * evaluate() then matches evaluate_position() on the whole board in constant
+ * time. Call update() after each change to the BitBoard it mirrors.
+ */
+class ThreatCache {
+public:
+    /**
+     * Empties the cache for a board of board_size.
+     */
+    void reset(int board_size) noexcept;
+
+    /**
+     * Rebuilds every entry from the stones of board.
+     */
+    void load(const BitBoard& board) noexcept;
+
+    /**
+     * Brings the cache in line with board after a stone was placed on or
+     * removed from (x, y).
+     */
+    void update(const BitBoard& board, int x, int y) noexcept;
+
+    /**
+     * update() for a board size known at compile time, with constant cell
+     * strides and edge checks. Size must be the size the cache was reset for.
+     */
+    template<int Size> requires ValidBoardSize<Size>
+    void update(const BitBoard& board, int x, int y) noexcept;
+
+    /**
+     * Same value as evaluate_position(board, player) for the mirrored board.
+     */
+    [[nodiscard]] int evaluate(Player player) const noexcept;
+
+    [[nodiscard]] ThreatType threat(int x, int y, int dir) const noexcept {
+        return threats_[index(x, y)][dir];
+    }
+
+    [[nodiscard]] int score_at(int x, int y) const noexcept { return scores_[index(x, y)]; }
+    [[nodiscard]] int total(Player player) const noexcept { return totals_[player_index(player)]; }
+    [[nodiscard]] bool has_five(Player player) const noexcept { return fives_[player_index(player)] > 0; }
+
+private:
+    static constexpr int CELLS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+    static constexpr int REACH = NEED_TO_WIN - 1;
+
+    [[nodiscard]] static constexpr int player_index(Player player) noexcept {
+        return player == Player::Cross ? 0 : 1;
+    }
+
+    [[nodiscard]] constexpr int index(int x, int y) const noexcept { return x * size_ + y; }
+
+    void set_threat(const BitBoard& board, int cell, int dir, int x, int y) noexcept;
+    void rescore(int cell) noexcept;
+    void clear_cell(int cell) noexcept;
+
+    int size_ = DEFAULT_BOARD_SIZE;
+    std::array<Player, CELLS> owners_{};
+    std::array<std::array<ThreatType, NUM_DIRECTIONS>, CELLS> threats_{};
+    std::array<int, CELLS> scores_{};
+    std::array<int, 2> totals_{};
+    std::array<int, 2> fives_{};   // (stone, direction) pairs classified as Five
+};
+
+} // namespace gomoku
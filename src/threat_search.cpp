@@ -0,0 +1,280 @@
+//
+//  threat_search.cpp
+//  gomoku - Threat-space solver for forced wins by fours (VCF) and threes (VCT)
+//
+//  Bit-parallel line kernels, move generation and the attacker/defender recursion
+//
+
+#include "threat_search.hpp"
+#include <bit>
+
+namespace gomoku {
+
+namespace {
+
+using LineMask = BitBoard::LineMask;
+
+static_assert(NEED_TO_WIN == 5, "the window kernels are unrolled for five in a row");
+
+// Bit i set where the five cells from bit i up are on the board and hold no opponent stone
+constexpr LineMask free_windows(LineMask opponent, LineMask cells) noexcept {
+    LineMask blocked = opponent | ~cells;
+    return ~(blocked | blocked >> 1 | blocked >> 2 | blocked >> 3 | blocked >> 4) & cells;
+}
+
+// Bit i set where exactly count of the five cells from bit i up hold own stones
+constexpr LineMask windows_holding(LineMask own, int count) noexcept {
+    LineMask ones = 0;
+    LineMask twos = 0;
+    LineMask fours = 0;
+    for (int k = 0; k < NEED_TO_WIN; ++k) {
+        LineMask bit = own >> k;
+        LineMask carry = ones & bit;
+        ones ^= bit;
+        fours |= twos & carry;
+        twos ^= carry;
+    }
+    return (count & 1 ? ones : ~ones) & (count & 2 ? twos : ~twos) & (count & 4 ? fours : ~fours);
+}
+
+// Cells covered by the windows starting at the bits of starts
+constexpr LineMask window_cells(LineMask starts) noexcept {
+    return starts | starts << 1 | starts << 2 | starts << 3 | starts << 4;
+}
+
+// Empty cells that would complete a window of own stones holding `stones` already
+constexpr LineMask completing_cells(LineMask own, LineMask opponent, LineMask cells, int stones) noexcept {
+    return window_cells(windows_holding(own, stones) & free_windows(opponent, cells)) & ~own;
+}
+
+// Empty cells that give own five in a row
+constexpr LineMask five_cells(LineMask own, LineMask opponent, LineMask cells) noexcept {
+    return completing_cells(own, opponent, cells, 4);
+}
+
+// Empty cells that put four own stones in a free window: a four, open or not
+constexpr LineMask four_cells(LineMask own, LineMask opponent, LineMask cells) noexcept {
+    return completing_cells(own, opponent, cells, 3);
+}
+
+// Empty cells that put three own stones in a free window, the candidates for a three
+constexpr LineMask three_cells(LineMask own, LineMask opponent, LineMask cells) noexcept {
+    return completing_cells(own, opponent, cells, 2);
+}
+
+static_assert(five_cells(0b0111100, 0, 0x7ffff) == 0b1000010, "an open four has two fives");
+static_assert(five_cells(0b1011100, 0, 0x7ffff) == 0b0100000, "a split four has one five");
+static_assert(five_cells(0b0111100, 0b1000000, 0x7ffff) == 0b0000010, "a blocked four has one five");
+static_assert(four_cells(0b0111000, 0, 0b0001111111) == 0b1000110, "threes extend to fours within the board");
+
+template<typename Fn>
+void for_each_cell(const BitBoard& board, int dir, int index, LineMask mask, Fn&& fn) {
+    while (mask) {
+        fn(board.line_cell(dir, index, std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+
+} // namespace
+
+//===============================================================================
+// SEARCH
+//===============================================================================
+
+ThreatSearch::ThreatSearch(BitBoard& board, Player attacker, ThreatSearchLimits limits) noexcept
+    : board_(board), attacker_(attacker), defender_(other_player(attacker)), limits_(limits) {}
+
+std::optional<Position> ThreatSearch::solve() noexcept {
+    root_moves_left_ = limits_.max_moves;
+    first_move_ = Position{-1, -1};
+
+    CellList own_fives;
+    collect_fives(attacker_, own_fives);
+    if (own_fives.count > 0) {
+        return own_fives.cells[0];
+    }
+
+    CellList defender_fives;
+    collect_fives(defender_, defender_fives);
+    if (attack(root_moves_left_, defender_fives)) {
+        return first_move_;
+    }
+    return std::nullopt;
+}
+
+bool ThreatSearch::attack(int moves_left, const CellList& defender_fives) noexcept {
+    if (++nodes_ > limits_.max_nodes || moves_left == 0 || defender_fives.count >= 2) {
+        return false;
+    }
+
+    // A defender four must be blocked, and the block has to keep the initiative
+    bool threes = limits_.allow_threes && moves_left >= 2;
+    CellList moves;
+    if (defender_fives.count == 1) {
+        moves.add(defender_fives.cells[0]);
+    } else {
+        collect_moves(attacker_, threes, moves);
+    }
+
+    for (int m = 0; m < moves.count; m++) {
+        Position move = moves.cells[m];
+        board_.place(move.x, move.y, attacker_);
+
+        CellList fives;
+        fives_through(attacker_, move, fives);
+
+        bool won = false;
+        if (fives.count >= 2) {
+            won = true;                                 // Open or double four
+        } else if (fives.count == 1) {
+            won = defend_four(moves_left, fives.cells[0]);
+        } else if (threes) {
+            CellList defences;
+            won = three_defences(move, defences) && defend_three(moves_left, defences);
+        }
+
+        board_.remove(move.x, move.y, attacker_);
+
+        if (won) {
+            if (moves_left == root_moves_left_) {
+                first_move_ = move;
+            }
+            return true;
+        }
+        if (nodes_ > limits_.max_nodes) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool ThreatSearch::defend_four(int moves_left, Position block) noexcept {
+    board_.place(block.x, block.y, defender_);
+
+    bool won = false;
+    if (!board_.has_five_at(defender_, block.x, block.y)) {
+        CellList defender_fives;
+        fives_through(defender_, block, defender_fives);
+        won = attack(moves_left - 1, defender_fives);
+    }
+
+    board_.remove(block.x, block.y, defender_);
+    return won;
+}
+
+bool ThreatSearch::defend_three(int moves_left, const CellList& defences) noexcept {
+    // Besides stopping the three, the defender may answer with a four of its own
+    CellList replies = defences;
+    collect_moves(defender_, false, replies);
+
+    for (int r = 0; r < replies.count; r++) {
+        Position reply = replies.cells[r];
+        board_.place(reply.x, reply.y, defender_);
+
+        CellList defender_fives;
+        fives_through(defender_, reply, defender_fives);
+        bool won = attack(moves_left - 1, defender_fives);
+
+        board_.remove(reply.x, reply.y, defender_);
+        if (!won) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//===============================================================================
+// MOVE GENERATION
+//===============================================================================
+
+void ThreatSearch::collect_fives(Player player, CellList& out) const noexcept {
+    Player opponent = other_player(player);
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        for (int index = 0; index < board_.line_count(dir); ++index) {
+            LineMask own = board_.line_stones(player, dir, index);
+            if (std::popcount(own) < NEED_TO_WIN - 1) {
+                continue;
+            }
+            LineMask cells = five_cells(own, board_.line_stones(opponent, dir, index), board_.line_cells(dir, index));
+            for_each_cell(board_, dir, index, cells, [&](Position cell) { out.add(cell); });
+        }
+    }
+}
+
+void ThreatSearch::collect_moves(Player player, bool threes, CellList& out) const noexcept {
+    Player opponent = other_player(player);
+
+    // Fours first: they are the cheapest to refute and the most forcing
+    for (int pass = 0; pass < (threes ? 2 : 1); ++pass) {
+        int needed = pass == 0 ? NEED_TO_WIN - 2 : NEED_TO_WIN - 3;
+        for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+            for (int index = 0; index < board_.line_count(dir); ++index) {
+                LineMask own = board_.line_stones(player, dir, index);
+                if (std::popcount(own) < needed) {
+                    continue;
+                }
+                LineMask opp = board_.line_stones(opponent, dir, index);
+                LineMask on_board = board_.line_cells(dir, index);
+                LineMask cells = pass == 0 ? four_cells(own, opp, on_board) : three_cells(own, opp, on_board);
+                for_each_cell(board_, dir, index, cells, [&](Position cell) { out.add(cell); });
+            }
+        }
+    }
+}
+
+void ThreatSearch::fives_through(Player player, Position cell, CellList& out) const noexcept {
+    Player opponent = other_player(player);
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        int index = board_.line_index(dir, cell.x, cell.y);
+        LineMask cells = five_cells(board_.line_stones(player, dir, index),
+                                    board_.line_stones(opponent, dir, index),
+                                    board_.line_cells(dir, index));
+        for_each_cell(board_, dir, index, cells, [&](Position five) { out.add(five); });
+    }
+}
+
+bool ThreatSearch::three_defences(Position cell, CellList& out) const noexcept {
+    bool three = false;
+
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        int index = board_.line_index(dir, cell.x, cell.y);
+        int bit = BitBoard::line_bit(dir, cell.x, cell.y);
+        LineMask own = board_.line_stones(attacker_, dir, index);
+        LineMask opp = board_.line_stones(defender_, dir, index);
+        LineMask on_board = board_.line_cells(dir, index);
+
+        // Moves within a window of the new stone that would turn its line into an open four
+        LineMask near = (LineMask{0x1ff} << bit) >> (NEED_TO_WIN - 1);
+        LineMask extensions = four_cells(own, opp, on_board) & near;
+        while (extensions) {
+            LineMask extension = extensions & -extensions;
+            extensions ^= extension;
+
+            LineMask fives = five_cells(own | extension, opp, on_board);
+            if (std::popcount(fives) < 2) {
+                continue;
+            }
+
+            // Taking the extension or either completion cell stops this open four
+            three = true;
+            for_each_cell(board_, dir, index, extension | fives, [&](Position defence) { out.add(defence); });
+        }
+    }
+    return three;
+}
+
+bool ThreatSearch::has_four_move(const BitBoard& board, Player player) noexcept {
+    Player opponent = other_player(player);
+    for (int dir = 0; dir < NUM_DIRECTIONS; ++dir) {
+        for (int index = 0; index < board.line_count(dir); ++index) {
+            LineMask own = board.line_stones(player, dir, index);
+            if (std::popcount(own) >= NEED_TO_WIN - 2 &&
+                four_cells(own, board.line_stones(opponent, dir, index), board.line_cells(dir, index)) != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace gomoku
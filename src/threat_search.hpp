@@ -0,0 +1,113 @@
+//
+//  threat_search.hpp
+//  gomoku - Threat-space solver for forced wins by fours (VCF) and threes (VCT)
+//
+//  Proves wins deep in the game tree by only playing moves the opponent must answer
+//
+
+#pragma once
+
+#include "bitboard.hpp"
+#include "gomoku.hpp"
+#include <bitset>
+#include <cstdint>
+#include <optional>
+
+namespace gomoku {
+
+/**
+ * Score of a position the solver proved won, from the winner's side. Below an
+ * immediate five, but high enough for the search to treat it as a win.
+ */
+inline constexpr int FORCED_WIN_SCORE = WIN_SCORE - 500;
+
+/**
+ * How far the solver may look: attacker moves on the longest line it tries,
+ * positions it may visit, and whether open threes count as forcing (VCT) or
+ * only fours do (VCF).
+ */
+struct ThreatSearchLimits {
+    int max_moves;
+    uint64_t max_nodes;
+    bool allow_threes;
+};
+
+//===============================================================================
+// THREAT SEARCH
+//===============================================================================
+
+/**
+ * Threat-space search after Allis (1994). The attacker only plays moves that
+ * make a four, which the defender must block on its single completion cell,
+ * or, with allow_threes, an open three, which the defender must answer on the
+ * cells that stop it becoming an open four or with a four of its own. A line
+ * that ends in a double four, an open four or a five is a proven win.
+ *
+ * Every defence is tried, and a defender four must be blocked by a move that
+ * is itself forcing, so a found win is sound; a win needing quieter moves, or
+ * more nodes than the limits allow, is simply not found.
+ */
+class ThreatSearch {
+public:
+    static constexpr ThreatSearchLimits ROOT_VCF{20, 20000, false};
+    static constexpr ThreatSearchLimits ROOT_VCT{6, 20000, true};
+    static constexpr ThreatSearchLimits LEAF_VCF{6, 48, false};
+
+    /**
+     * Prepares a search for attacker, who is to move on board. The board is
+     * changed during solve() and left exactly as it was found.
+     */
+    ThreatSearch(BitBoard& board, Player attacker, ThreatSearchLimits limits) noexcept;
+
+    /**
+     * Returns the attacker's first move of a forced win, or nullopt when none
+     * was proven within the limits.
+     */
+    [[nodiscard]] std::optional<Position> solve() noexcept;
+
+    [[nodiscard]] uint64_t nodes() const noexcept { return nodes_; }
+
+    /**
+     * Cheap test for whether player has any move that makes a four, without
+     * which no VCF exists. Lets callers skip the solver on quiet positions.
+     */
+    [[nodiscard]] static bool has_four_move(const BitBoard& board, Player player) noexcept;
+
+private:
+    static constexpr int MAX_CELLS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+    static constexpr int MAX_LIST = 128;   // Moves tried per node; the rest are dropped
+
+    // Distinct cells in the order they were added
+    struct CellList {
+        int count = 0;
+        Position cells[MAX_LIST];
+        std::bitset<MAX_CELLS> seen;
+
+        void add(Position cell) noexcept {
+            int index = cell.x * MAX_BOARD_SIZE + cell.y;
+            if (count < MAX_LIST && !seen[index]) {
+                seen.set(index);
+                cells[count++] = cell;
+            }
+        }
+    };
+
+    bool attack(int moves_left, const CellList& defender_fives) noexcept;
+    bool defend_four(int moves_left, Position block) noexcept;
+    bool defend_three(int moves_left, const CellList& defences) noexcept;
+
+    void collect_fives(Player player, CellList& out) const noexcept;
+    void collect_moves(Player player, bool threes, CellList& out) const noexcept;
+    void fives_through(Player player, Position cell, CellList& out) const noexcept;
+    bool three_defences(Position cell, CellList& out) const noexcept;
+
+    BitBoard& board_;
+    Player attacker_;
+    Player defender_;
+    ThreatSearchLimits limits_;
+    uint64_t nodes_ = 0;
+    Position first_move_{-1, -1};
+    int root_moves_left_ = 0;
+};
+
+} // namespace gomoku
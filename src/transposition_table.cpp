@@ -0,0 +1,309 @@
+//
+//  transposition_table.cpp
+//  gomoku - Lock-free transposition table shared by every search thread
+//
+//  Entry packing, bucket replacement, snapshot files and the process-wide instance
+//
+
+#include "transposition_table.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gomoku {
+
+namespace {
+
+std::string system_error(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+template<int Size> requires ValidBoardSize<Size>
+constexpr uint64_t fold_zobrist_keys(uint64_t fingerprint) noexcept {
+    auto mix = [&fingerprint](uint64_t key) {
+        uint64_t state = fingerprint ^ key;
+        fingerprint = splitmix64(state);
+    };
+    for (const auto& player_keys : ZOBRIST_KEYS<Size>.stones[0]) {
+        for (uint64_t key : player_keys) {
+            mix(key);
+        }
+    }
+    mix(ZOBRIST_KEYS<Size>.side);
+    return fingerprint;
+}
+
+// Any change to the keys or to what scores mean yields a different value
+constexpr uint64_t SNAPSHOT_FINGERPRINT = fold_zobrist_keys<19>(fold_zobrist_keys<15>(EVALUATION_VERSION));
+
+} // namespace
+
+//===============================================================================
+// ENTRY PACKING
+//===============================================================================
+
+uint64_t TranspositionTable::pack(int value, int depth, int flag, uint64_t generation,
+                                  int best_x, int best_y) noexcept {
+    // depth and moves are stored off by one so that an all-zero word means "empty"
+    uint64_t stored_depth = static_cast<uint64_t>(std::clamp(depth, 0, 254) + 1);
+    uint64_t stored_x = static_cast<uint64_t>(std::clamp(best_x + 1, 0, 255));
+    uint64_t stored_y = static_cast<uint64_t>(std::clamp(best_y + 1, 0, 255));
+
+    return static_cast<uint64_t>(static_cast<uint32_t>(value))
+         | stored_depth << 32
+         | static_cast<uint64_t>(flag & 3) << 40
+         | (generation & GENERATION_MASK) << 42
+         | stored_x << 48
+         | stored_y << 56;
+}
+
+TranspositionTable::Entry TranspositionTable::unpack(uint64_t data) noexcept {
+    return Entry{
+        .value = static_cast<int32_t>(static_cast<uint32_t>(data)),
+        .depth = depth_of(data),
+        .flag = static_cast<int>((data >> 40) & 3),
+        .best_x = static_cast<int>((data >> 48) & 0xff) - 1,
+        .best_y = static_cast<int>((data >> 56) & 0xff) - 1,
+    };
+}
+
+int TranspositionTable::depth_of(uint64_t data) noexcept {
+    return static_cast<int>((data >> 32) & 0xff) - 1;
+}
+
+uint64_t TranspositionTable::generation_of(uint64_t data) noexcept {
+    return (data >> 42) & GENERATION_MASK;
+}
+
+//===============================================================================
+// ALLOCATION
+//===============================================================================
+
+TranspositionTable::TranspositionTable(size_t size_mb) {
+    resize(size_mb);
+}
+
+void TranspositionTable::resize(size_t size_mb) {
+    size_mb = std::clamp<size_t>(size_mb, 1, MAX_SIZE_MB);
+    size_t buckets = std::bit_floor(size_mb * 1024 * 1024 / sizeof(Bucket));
+
+    buckets_ = std::make_unique<Bucket[]>(buckets);
+    bucket_mask_ = buckets - 1;
+    size_mb_ = size_mb;
+    generation_.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() noexcept {
+    for (size_t i = 0; i <= bucket_mask_; ++i) {
+        for (auto& slot : buckets_[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation_.store(0, std::memory_order_relaxed);
+}
+
+//===============================================================================
+// PROBE / STORE
+//===============================================================================
+
+bool TranspositionTable::probe(uint64_t key, Entry& out) const noexcept {
+    const Bucket& bucket = bucket_for(key);
+
+    for (const auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key) {
+            out = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int value, int depth, int flag,
+                               int best_x, int best_y) noexcept {
+    Bucket& bucket = bucket_for(key);
+    uint64_t generation = generation_.load(std::memory_order_relaxed) & GENERATION_MASK;
+
+    Slot* victim = nullptr;
+    int victim_score = 0;
+
+    for (auto& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if (data != 0 && (check ^ data) == key) {
+            // Same position: keep a deeper result from this search
+            if (generation_of(data) == generation && depth_of(data) > depth) {
+                return;
+            }
+            victim = &slot;
+            break;
+        }
+
+        // Empty slots go first, then older generations count as shallower
+        int age = static_cast<int>((generation - generation_of(data)) & GENERATION_MASK);
+        int score = data == 0 ? std::numeric_limits<int>::min() : depth_of(data) - 8 * age;
+        if (!victim || score < victim_score) {
+            victim = &slot;
+            victim_score = score;
+        }
+    }
+
+    uint64_t data = pack(value, depth, flag, generation, best_x, best_y);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::usage_permille() const noexcept {
+    uint64_t generation = generation_.load(std::memory_order_relaxed) & GENERATION_MASK;
+    size_t sample = std::min<size_t>(1000 / BUCKET_ENTRIES, bucket_mask_ + 1);
+    int used = 0;
+
+    for (size_t i = 0; i < sample; ++i) {
+        for (const auto& slot : buckets_[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && generation_of(data) == generation) {
+                ++used;
+            }
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * BUCKET_ENTRIES));
+}
+
+//===============================================================================
+// SNAPSHOTS
+//===============================================================================
+
+uint64_t TranspositionTable::snapshot_fingerprint() noexcept {
+    return SNAPSHOT_FINGERPRINT;
+}
+
+std::expected<size_t, std::string> TranspositionTable::save_snapshot(const std::string& path, int min_depth) const {
+    std::string temporary = path + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return std::unexpected(system_error("Cannot create transposition table snapshot", temporary));
+    }
+
+    // The header is written again with the count once the records are out
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.fingerprint = SNAPSHOT_FINGERPRINT;
+    header.version = SNAPSHOT_VERSION;
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // MAX_SIZE_MB holds far fewer than 2^32 slots, so the count cannot overflow
+    for (size_t i = 0; written && i <= bucket_mask_; ++i) {
+        for (const auto& slot : buckets_[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            uint64_t check = slot.check.load(std::memory_order_relaxed);
+            if (data == 0 || depth_of(data) < min_depth) {
+                continue;
+            }
+
+            Entry entry = unpack(data);
+            SnapshotRecord record{
+                .key = check ^ data,
+                .value = entry.value,
+                .depth = static_cast<uint8_t>(entry.depth),
+                .flag = static_cast<uint8_t>(entry.flag),
+                .best_x = static_cast<int8_t>(entry.best_x),
+                .best_y = static_cast<int8_t>(entry.best_y),
+            };
+            written = written && std::fwrite(&record, sizeof(record), 1, file) == 1;
+            ++header.count;
+        }
+    }
+
+    written = written && std::fseek(file, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (std::fclose(file) != 0 || !written) {
+        auto error = system_error("Cannot write transposition table snapshot", temporary);
+        std::remove(temporary.c_str());
+        return std::unexpected(error);
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        auto error = system_error("Cannot replace transposition table snapshot", path);
+        std::remove(temporary.c_str());
+        return std::unexpected(error);
+    }
+    return header.count;
+}
+
+std::expected<size_t, std::string> TranspositionTable::load_snapshot(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(system_error("Cannot open transposition table snapshot", path));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        auto error = system_error("Cannot stat transposition table snapshot", path);
+        ::close(fd);
+        return std::unexpected(error);
+    }
+
+    auto length = static_cast<size_t>(info.st_size);
+    if (length < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return std::unexpected("Transposition table snapshot " + path + " is too short to hold a header");
+    }
+
+    void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return std::unexpected(system_error("Cannot map transposition table snapshot", path));
+    }
+
+    const auto* header = static_cast<const SnapshotHeader*>(data);
+    std::string error;
+    if (std::memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        error = "Transposition table snapshot " + path + " has no snapshot header";
+    } else if (header->version != SNAPSHOT_VERSION) {
+        error = "Transposition table snapshot " + path + " has version " + std::to_string(header->version) +
+                ", expected " + std::to_string(SNAPSHOT_VERSION);
+    } else if (header->fingerprint != SNAPSHOT_FINGERPRINT) {
+        error = "Transposition table snapshot " + path + " was saved by a build with other Zobrist keys or evaluation";
+    } else if (length != sizeof(SnapshotHeader) + static_cast<size_t>(header->count) * sizeof(SnapshotRecord)) {
+        error = "Transposition table snapshot " + path + " is truncated or has trailing data";
+    }
+    if (!error.empty()) {
+        munmap(data, length);
+        return std::unexpected(error);
+    }
+
+    // Every record is read once, front to back
+    madvise(data, length, MADV_SEQUENTIAL);
+
+    const auto* records = reinterpret_cast<const SnapshotRecord*>(static_cast<const char*>(data) + sizeof(SnapshotHeader));
+    size_t count = header->count;
+    for (size_t i = 0; i < count; ++i) {
+        const SnapshotRecord& record = records[i];
+        store(record.key, record.value, record.depth, record.flag, record.best_x, record.best_y);
+    }
+
+    munmap(data, length);
+    return count;
+}
+
+//===============================================================================
+// SHARED INSTANCE
+//===============================================================================
+
+TranspositionTable& shared_transposition_table() {
+    static TranspositionTable table;
+    return table;
+}
+
+} // namespace gomoku
@@ -0,0 +1,181 @@
+//
+//  transposition_table.hpp
+//  gomoku - Lock-free transposition table shared by every search thread
+//
+//  Bucketed, power-of-two sized table of packed atomic entries, with snapshots
+//  that carry its deepest results across process restarts
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <string>
+
+namespace gomoku {
+
+//===============================================================================
+// TRANSPOSITION TABLE
+//===============================================================================
+
+/**
+ * Hash table of search results that all threads read and write without locks.
+ *
+ * Each entry is two relaxed 64-bit atomics: the packed payload and the position
+ * key XORed with that payload. A reader accepts an entry only when the two words
+ * XOR back to its key, so a torn write from another thread reads as a miss
+ * rather than as a wrong bound. Entries live in cache-line sized buckets; the
+ * key selects the bucket and the replacement policy picks a slot within it.
+ */
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_SIZE_MB = 32;
+    static constexpr size_t MAX_SIZE_MB = 4096;
+    static constexpr int BUCKET_ENTRIES = 4;
+    static constexpr int SNAPSHOT_MIN_DEPTH = 3;    // Shallower results are cheap to search again
+
+    /**
+     * Payload of a matching entry. flag carries the caller's TT_* bound value.
+     */
+    struct Entry {
+        int value = 0;
+        int depth = 0;
+        int flag = 0;
+        int best_x = -1;
+        int best_y = -1;
+    };
+
+    explicit TranspositionTable(size_t size_mb = DEFAULT_SIZE_MB);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    /**
+     * Reallocates the table to the largest power-of-two bucket count that fits
+     * in size_mb megabytes and clears it. Not safe while a search is running.
+     */
+    void resize(size_t size_mb);
+
+    /**
+     * Drops every entry. Not safe while a search is running.
+     */
+    void clear() noexcept;
+
+    /**
+     * Starts a new search generation so that entries from earlier moves are
+     * the first to be replaced.
+     */
+    void new_search() noexcept { generation_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * Looks up key; fills out and returns true when a consistent entry exists.
+     */
+    [[nodiscard]] bool probe(uint64_t key, Entry& out) const noexcept;
+
+    /**
+     * Stores a result for key, preferring to overwrite the same position,
+     * then empty slots, then the shallowest entry from the oldest generation.
+     */
+    void store(uint64_t key, int value, int depth, int flag, int best_x, int best_y) noexcept;
+
+    [[nodiscard]] size_t size_mb() const noexcept { return size_mb_; }
+    [[nodiscard]] size_t capacity() const noexcept { return (bucket_mask_ + 1) * BUCKET_ENTRIES; }
+
+    /**
+     * Permille of sampled slots written during the current generation.
+     */
+    [[nodiscard]] int usage_permille() const noexcept;
+
+    //===============================================================================
+    // SNAPSHOTS
+    //===============================================================================
+
+    static constexpr char SNAPSHOT_MAGIC[8] = {'G', 'M', 'K', 'T', 'T', 'S', 'N', 'P'};
+    static constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    /**
+     * Writes every entry searched at least min_depth plies deep to path. The
+     * file is written beside path and renamed over it, so a crash never leaves
+     * half a snapshot behind. Safe while searches are running; an entry torn
+     * by a concurrent store is saved under a key no position hashes to.
+     * Returns the number of entries written.
+     */
+    std::expected<size_t, std::string> save_snapshot(const std::string& path,
+                                                     int min_depth = SNAPSHOT_MIN_DEPTH) const;
+
+    /**
+     * Maps a file written by save_snapshot() and stores its entries into this
+     * table, whatever its size. A snapshot taken with other Zobrist keys or
+     * another EVALUATION_VERSION is refused, since its keys or scores would
+     * mean nothing here. Not safe while a search is running.
+     * Returns the number of entries loaded.
+     */
+    std::expected<size_t, std::string> load_snapshot(const std::string& path);
+
+    /**
+     * Hash of the Zobrist keys and EVALUATION_VERSION a snapshot must match.
+     */
+    [[nodiscard]] static uint64_t snapshot_fingerprint() noexcept;
+
+private:
+    // A snapshot is this header followed by count SnapshotRecords
+    struct SnapshotHeader {
+        char magic[8];
+        uint64_t fingerprint;
+        uint32_t version;
+        uint32_t count;
+    };
+
+    // Unpacked, so the file does not depend on the in-memory bit layout
+    struct SnapshotRecord {
+        uint64_t key;
+        int32_t value;
+        uint8_t depth;
+        uint8_t flag;
+        int8_t best_x;
+        int8_t best_y;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 24, "the snapshot header is stored as a packed 24-byte record");
+    static_assert(sizeof(SnapshotRecord) == 16, "snapshot entries are stored as packed 16-byte records");
+
+    struct Slot {
+        std::atomic<uint64_t> check{0};   // key ^ data
+        std::atomic<uint64_t> data{0};
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_ENTRIES];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    // data layout: value:32 | depth:8 | flag:2 | generation:6 | best_x:8 | best_y:8
+    static constexpr int GENERATION_BITS = 6;
+    static constexpr uint64_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+    [[nodiscard]] static uint64_t pack(int value, int depth, int flag, uint64_t generation,
+                                       int best_x, int best_y) noexcept;
+    [[nodiscard]] static Entry unpack(uint64_t data) noexcept;
+    [[nodiscard]] static int depth_of(uint64_t data) noexcept;
+    [[nodiscard]] static uint64_t generation_of(uint64_t data) noexcept;
+
+    [[nodiscard]] Bucket& bucket_for(uint64_t key) const noexcept {
+        return buckets_[key & bucket_mask_];
+    }
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucket_mask_ = 0;
+    size_t size_mb_ = 0;
+    std::atomic<uint64_t> generation_{0};
+};
+
+/**
+ * Process-wide table used by the CLI game and every httpd request.
+ */
+TranspositionTable& shared_transposition_table();
+
+} // namespace gomoku
@@ -11,12 +11,15 @@
 #include <string_view>
 #include <array>
 #include <algorithm>
+#include <cerrno>
+#include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <unistd.h>
 #include "ui.hpp"
 #include "ansi.h"
+#include "screen_buffer.hpp"
 
 namespace gomoku::ui {
 
@@ -113,7 +116,7 @@ void TerminalInput::handle_input(game_state_t* game) const {
         case static_cast<int>(Key::Space):
         case static_cast<int>(Key::Enter):
             if (game->current_player == static_cast<int>(Player::Cross) &&
-                    ::is_valid_move(game->board, game->cursor_x, game->cursor_y, game->board_size)) {
+                    game->board.is_playable(game->cursor_x, game->cursor_y)) {
                 double move_time = end_move_timer(game);
                 make_move(game, game->cursor_x, game->cursor_y, static_cast<int>(Player::Cross), move_time, 0);
             }
@@ -158,8 +161,50 @@ void TerminalInput::handle_input(game_state_t* game) const {
 // DISPLAY FUNCTIONS
 //===============================================================================
 
+// Frames are composed with printf formats, so they lay out exactly as the
+// direct printf calls they replaced did
+[[gnu::format(printf, 2, 3)]]
+static void appendf(std::string& frame, const char* format, ...) {
+    std::array<char, 512> buffer;
+    va_list args;
+    va_start(args, format);
+    int length = std::vsnprintf(buffer.data(), buffer.size(), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if (static_cast<size_t>(length) < buffer.size()) {
+        frame.append(buffer.data(), static_cast<size_t>(length));
+        return;
+    }
+    size_t offset = frame.size();
+    frame.resize(offset + static_cast<size_t>(length) + 1);
+    va_start(args, format);
+    std::vsnprintf(frame.data() + offset, static_cast<size_t>(length) + 1, format, args);
+    va_end(args);
+    frame.resize(offset + static_cast<size_t>(length));
+}
+
+// Hands bytes to the terminal in as few write() calls as it takes them in,
+// after anything still buffered by stdio or the C++ streams
+static void write_out(std::string_view bytes) {
+    std::cout.flush();
+    std::fflush(stdout);
+    while (!bytes.empty()) {
+        ssize_t written = ::write(STDOUT_FILENO, bytes.data(), bytes.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        bytes.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
 void clear_screen() {
     std::cout << "\033[2J\033[H";
+    shared_screen().invalidate();
 }
 
 void draw_game_header() {
@@ -185,20 +230,20 @@ void draw_game_header() {
     clear_screen();
 }
 
-void draw_game_history_sidebar(const game_state_t* game, int start_row) {
+static void render_game_history_sidebar(std::string& frame, const game_state_t* game, int start_row) {
     // Position cursor to the right of the board
     int sidebar_col = std::clamp(game->board_size * 2 + 12, 50, 50);
 
     // Draw Game History header
-    std::printf(ESCAPE_MOVE_CURSOR_TO, start_row, sidebar_col);
-    std::printf("%s%sGame History:%s", COLOR_BOLD_BLACK, COLOR_GREEN, COLOR_RESET);
+    appendf(frame, ESCAPE_MOVE_CURSOR_TO, start_row, sidebar_col);
+    appendf(frame, "%s%sGame History:%s", COLOR_BOLD_BLACK, COLOR_GREEN, COLOR_RESET);
 
-    std::printf(ESCAPE_MOVE_CURSOR_TO, start_row + 1, sidebar_col);
-    std::printf("%sMove Player [Time] (AI positions evaluated)%s",
+    appendf(frame, ESCAPE_MOVE_CURSOR_TO, start_row + 1, sidebar_col);
+    appendf(frame, "%sMove Player [Time] (AI positions evaluated)%s",
                 COLOR_BOLD_BLACK, COLOR_RESET);
 
-    std::printf(ESCAPE_MOVE_CURSOR_TO, start_row + 2, sidebar_col);
-    std::printf("%s", "───────────────────────────────────────────────");
+    appendf(frame, ESCAPE_MOVE_CURSOR_TO, start_row + 2, sidebar_col);
+    appendf(frame, "%s", "───────────────────────────────────────────────");
 
     // Draw move history entries
     int display_start = (0 > (game->move_history_count - 15)) ? 0 : (game->move_history_count - 15);
@@ -224,79 +269,79 @@ void draw_game_history_sidebar(const game_state_t* game, int start_row) {
                          move.time_taken, move.positions_evaluated, COLOR_RESET);
         }
 
-        std::printf("\033[%d;%dH%s", start_row + 3 + (i - display_start), sidebar_col, move_line.data());
+        appendf(frame, "\033[%d;%dH%s", start_row + 3 + (i - display_start), sidebar_col, move_line.data());
     }
 }
 
-void draw_board(const game_state_t* game) {
-    std::printf("\n     ");
+static void render_board(std::string& frame, const game_state_t* game) {
+    appendf(frame, "\n     ");
 
     // Column numbers with Unicode characters
     for (int j = 0; j < game->board_size; j++) {
         if (j > 9) {
-            std::printf("%s%2s%s ", COLOR_BLUE, get_coordinate_unicode(j - 10).data(), COLOR_RESET);
+            appendf(frame, "%s%2s%s ", COLOR_BLUE, get_coordinate_unicode(j - 10).data(), COLOR_RESET);
         } else {
-            std::printf("%s%2s%s ", COLOR_GREEN, get_coordinate_unicode(j).data(), COLOR_RESET);
+            appendf(frame, "%s%2s%s ", COLOR_GREEN, get_coordinate_unicode(j).data(), COLOR_RESET);
         }
     }
-    std::printf("\n");
+    appendf(frame, "\n");
 
     constexpr int board_start_row = 0;
 
     for (int i = 0; i < game->board_size; i++) {
-        std::printf("  ");
+        appendf(frame, "  ");
         if (i > 9) {
-            std::printf("%s%2s%s ", COLOR_BLUE, get_coordinate_unicode(i - 10).data(), COLOR_RESET);
+            appendf(frame, "%s%2s%s ", COLOR_BLUE, get_coordinate_unicode(i - 10).data(), COLOR_RESET);
         } else {
-            std::printf("%s%2s%s ", COLOR_GREEN, get_coordinate_unicode(i).data(), COLOR_RESET);
+            appendf(frame, "%s%2s%s ", COLOR_GREEN, get_coordinate_unicode(i).data(), COLOR_RESET);
         }
         for (int j = 0; j < game->board_size; j++) {
             // Check if cursor is at this position
             bool is_cursor_here = (i == game->cursor_y && j == game->cursor_x);
 
-            std::printf(" "); // Always add the space before the symbol
+            appendf(frame, " "); // Always add the space before the symbol
 
             // Show appropriate symbol based on cell content
             if (game->board[j][i] == static_cast<int>(Player::Empty)) {
                 if (is_cursor_here) {
                     // Empty cell with cursor: show yellow blinking cursor (no background)
-                    std::printf("%s%s%s", COLOR_X_CURSOR, UNICODE_CURSOR.data(), COLOR_RESET);
+                    appendf(frame, "%s%s%s", COLOR_X_CURSOR, UNICODE_CURSOR.data(), COLOR_RESET);
                 } else {
                     // Empty cell without cursor: show normal grid intersection
-                    std::printf("%s%s%s", COLOR_RESET, UNICODE_EMPTY.data(), COLOR_RESET);
+                    appendf(frame, "%s%s%s", COLOR_RESET, UNICODE_EMPTY.data(), COLOR_RESET);
                 }
             } else if (game->board[j][i] == static_cast<int>(Player::Cross)) {
                 if (is_cursor_here) {
                     // Human stone with cursor: add grey background
-                    std::printf("%s%s%s", COLOR_RESET, UNICODE_OCCUPIED.data(), COLOR_RESET);
+                    appendf(frame, "%s%s%s", COLOR_RESET, UNICODE_OCCUPIED.data(), COLOR_RESET);
                 } else {
                     // Human stone without cursor: normal red
-                    std::printf("%s%s%s", COLOR_X_NORMAL, UNICODE_CROSSES.data(), COLOR_RESET);
+                    appendf(frame, "%s%s%s", COLOR_X_NORMAL, UNICODE_CROSSES.data(), COLOR_RESET);
                 }
             } else { // AI_CELL_NAUGHTS
                 if (is_cursor_here) {
                     // AI stone with cursor: add grey background
-                    std::printf("%s%s%s", COLOR_RESET, UNICODE_OCCUPIED.data(), COLOR_RESET);
+                    appendf(frame, "%s%s%s", COLOR_RESET, UNICODE_OCCUPIED.data(), COLOR_RESET);
                 } else {
                     // AI stone without cursor: normal highlighting
                     if (j == game->last_ai_move_x && i == game->last_ai_move_y) {
-                        std::printf("%s%s%s", COLOR_O_LAST_MOVE, UNICODE_NAUGHTS.data(), COLOR_RESET);
+                        appendf(frame, "%s%s%s", COLOR_O_LAST_MOVE, UNICODE_NAUGHTS.data(), COLOR_RESET);
                     } else {
-                        std::printf("%s%s%s", COLOR_O_NORMAL, UNICODE_NAUGHTS.data(), COLOR_RESET);
+                        appendf(frame, "%s%s%s", COLOR_O_NORMAL, UNICODE_NAUGHTS.data(), COLOR_RESET);
                     }
                 }
             }
         }
-        std::printf("\n");
+        appendf(frame, "\n");
     }
 
     // Draw game history sidebar
-    draw_game_history_sidebar(game, board_start_row + 2);
+    render_game_history_sidebar(frame, game, board_start_row + 2);
 }
 
-void draw_status(const game_state_t* game) {
+static void render_status(std::string& frame, const game_state_t* game) {
     // Add spacing and lock the box to a position
-    std::printf(ESCAPE_MOVE_CURSOR_TO, 24, 1);
+    appendf(frame, ESCAPE_MOVE_CURSOR_TO, 24, 1);
 
     // Box width for the status border
     constexpr int box_width = 19 * 2 + 2;
@@ -305,18 +350,18 @@ void draw_status(const game_state_t* game) {
     constexpr std::string_view prefix = "  ";
 
     // Top border
-    std::printf("%s%s┌", prefix.data(), COLOR_RESET);
+    appendf(frame, "%s%s┌", prefix.data(), COLOR_RESET);
     for (int i = 0; i < box_width - 2; i++) {
-        std::printf("─");
+        appendf(frame, "─");
     }
-    std::printf("┐%s\n", COLOR_RESET);
+    appendf(frame, "┐%s\n", COLOR_RESET);
 
     // Current Player
     if (game->current_player == static_cast<int>(Player::Cross)) {
-        std::printf("%s│%s %-*s %s│%s%s\n", prefix.data(), COLOR_YELLOW, action_width + control_width + 2,
+        appendf(frame, "%s│%s %-*s %s│%s%s\n", prefix.data(), COLOR_YELLOW, action_width + control_width + 2,
                    "Current Player : You (X)", COLOR_RESET, COLOR_RESET, COLOR_YELLOW);
     } else {
-        std::printf("%s│%s %-*s %s│%s%s\n", prefix.data(), COLOR_BLUE, action_width + control_width + 2,
+        appendf(frame, "%s│%s %-*s %s│%s%s\n", prefix.data(), COLOR_BLUE, action_width + control_width + 2,
                    "Current Player : Computer (O)", COLOR_RESET, COLOR_RESET, COLOR_BLUE);
     }
 
@@ -325,7 +370,7 @@ void draw_status(const game_state_t* game) {
                                    ::board_to_display_coord(game->cursor_x),
                                    ::board_to_display_coord(game->cursor_y));
 
-    std::printf("%s%s│ %-*s │\n", prefix.data(), COLOR_RESET, box_width - 4, position_str.c_str());
+    appendf(frame, "%s%s│ %-*s │\n", prefix.data(), COLOR_RESET, box_width - 4, position_str.c_str());
 
     // Difficulty
     const char *difficulty_name;
@@ -350,33 +395,33 @@ void draw_status(const game_state_t* game) {
 
     // Difficulty display
     auto difficulty_str = std::format("{}Difficulty     : {}", difficulty_color, difficulty_name);
-    std::printf("%s%s│ %s %s  │\n", prefix.data(), COLOR_RESET, difficulty_str.c_str(), COLOR_RESET);
+    appendf(frame, "%s%s│ %s %s  │\n", prefix.data(), COLOR_RESET, difficulty_str.c_str(), COLOR_RESET);
 
     auto depth_str = std::format("{}Search Depth   : {}", difficulty_color, game->max_depth);
-    std::printf("%s%s│ %s %s  │%s\n", prefix.data(), COLOR_RESET, depth_str.c_str(), COLOR_RESET, COLOR_RESET);
+    appendf(frame, "%s%s│ %s %s  │%s\n", prefix.data(), COLOR_RESET, depth_str.c_str(), COLOR_RESET, COLOR_RESET);
 
     // Separator line
-    std::printf("%s%s│ %-*s %s│%s\n", prefix.data(), COLOR_RESET, box_width - 4, "", COLOR_RESET, COLOR_RESET);
+    appendf(frame, "%s%s│ %-*s %s│%s\n", prefix.data(), COLOR_RESET, box_width - 4, "", COLOR_RESET, COLOR_RESET);
 
     // Controls header
-    std::printf("%s%s│ %s%-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_BLUE, box_width - 4, "Controls", COLOR_RESET);
+    appendf(frame, "%s%s│ %s%-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_BLUE, box_width - 4, "Controls", COLOR_RESET);
 
     // Control instructions
-    std::printf("%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "Arrow Keys", COLOR_GREEN, action_width, "Move cursor", COLOR_RESET);
-    std::printf("%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET,
+    appendf(frame, "%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "Arrow Keys", COLOR_GREEN, action_width, "Move cursor", COLOR_RESET);
+    appendf(frame, "%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET,
                COLOR_BRIGHT_YELLOW, control_width, "Space / Enter", COLOR_GREEN,
                action_width, "Make move", COLOR_RESET);
     if (game->config.enable_undo) {
-        std::printf("%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "U", COLOR_GREEN, action_width, "Undo last move pair", COLOR_RESET);
+        appendf(frame, "%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "U", COLOR_GREEN, action_width, "Undo last move pair", COLOR_RESET);
     }
-    std::printf("%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "?", COLOR_GREEN, action_width, "Show game rules", COLOR_RESET);
-    std::printf("%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "ESC", COLOR_GREEN, action_width, "Quit game", COLOR_RESET);
+    appendf(frame, "%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "?", COLOR_GREEN, action_width, "Show game rules", COLOR_RESET);
+    appendf(frame, "%s%s│ %s%-*s — %s%-*s%s│\n", prefix.data(), COLOR_RESET, COLOR_BRIGHT_YELLOW, control_width, "ESC", COLOR_GREEN, action_width, "Quit game", COLOR_RESET);
 
-    std::printf("%s%s│ %-*s │%s\n", prefix.data(), COLOR_RESET, box_width - 4, " ", COLOR_RESET);
+    appendf(frame, "%s%s│ %-*s │%s\n", prefix.data(), COLOR_RESET, box_width - 4, " ", COLOR_RESET);
 
     // AI status message if available
     if (std::strlen(game->ai_status_message) > 0) {
-        std::printf("%s%s├%-*s┤%s\n", prefix.data(), COLOR_RESET, box_width - 4, "──────────────────────────────────────", COLOR_RESET);
+        appendf(frame, "%s%s├%-*s┤%s\n", prefix.data(), COLOR_RESET, box_width - 4, "──────────────────────────────────────", COLOR_RESET);
 
         // Extract clean message without ANSI color codes
         std::string clean_message;
@@ -392,27 +437,27 @@ void draw_status(const game_state_t* game) {
             }
         }
 
-        std::printf("%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_MAGENTA,
+        appendf(frame, "%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_MAGENTA,
                    box_width - 4, clean_message.c_str(), COLOR_RESET);
     }
 
     // Game state messages
     if (game->game_state != static_cast<int>(GameState::Running)) {
-        std::printf("%s%s├%-*s┤%s\n", prefix.data(), COLOR_RESET, box_width - 4, "──────────────────────────────────────", COLOR_RESET);
-        std::printf("%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_RESET,
+        appendf(frame, "%s%s├%-*s┤%s\n", prefix.data(), COLOR_RESET, box_width - 4, "──────────────────────────────────────", COLOR_RESET);
+        appendf(frame, "%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_RESET,
                    box_width - 4, "", COLOR_RESET);
 
         switch (static_cast<GameState>(game->game_state)) {
             case GameState::HumanWin:
-                std::printf("%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
+                appendf(frame, "%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
                            box_width - 4, "Human wins! Great job!", COLOR_RESET);
                 break;
             case GameState::AIWin:
-                std::printf("%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
+                appendf(frame, "%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
                            box_width - 4, "AI wins! Try again!", COLOR_RESET);
                 break;
             case GameState::Draw:
-                std::printf("%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_RESET,
+                appendf(frame, "%s%s│%s %-*s %s│\n", prefix.data(), COLOR_RESET, COLOR_RESET,
                            control_width, "The Game is a draw!", COLOR_RESET);
                 break;
             default:
@@ -422,19 +467,40 @@ void draw_status(const game_state_t* game) {
         // Show timing summary
         auto time_summary = std::format("Time: Human: {:.1f}s | AI: {:.1f}s",
                                        game->total_human_time, game->total_ai_time);
-        std::printf("%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
+        appendf(frame, "%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
                    box_width - 4, time_summary.c_str(), COLOR_RESET);
 
-        std::printf("%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
+        appendf(frame, "%s%s│ %-*s %s│\n", prefix.data(), COLOR_RESET,
                    box_width - 4, "Press any key to exit...", COLOR_RESET);
     }
 
     // Bottom border
-    std::printf("  %s└", COLOR_RESET);
+    appendf(frame, "  %s└", COLOR_RESET);
     for (int i = 0; i < box_width - 2; i++) {
-        std::printf("─");
+        appendf(frame, "─");
     }
-    std::printf("┘%s\n", COLOR_RESET);
+    appendf(frame, "┘%s\n", COLOR_RESET);
+}
+
+void draw_game_history_sidebar(const game_state_t* game, int start_row) {
+    std::string frame;
+    render_game_history_sidebar(frame, game, start_row);
+    write_out(frame);
+    shared_screen().invalidate();
+}
+
+void draw_board(const game_state_t* game) {
+    std::string frame;
+    render_board(frame, game);
+    write_out(frame);
+    shared_screen().invalidate();
+}
+
+void draw_status(const game_state_t* game) {
+    std::string frame;
+    render_status(frame, game);
+    write_out(frame);
+    shared_screen().invalidate();
 }
 
 void display_rules() {
@@ -478,27 +544,29 @@ void display_rules() {
 }
 
 void refresh_display(const game_state_t* game) {
-    clear_screen();
-    draw_board(game);
-    draw_status(game);
+    std::string frame;
+    render_board(frame, game);
+    render_status(frame, game);
+    write_out(shared_screen().diff(frame));
 }
 
 void refresh_display_with_players(const game_state_t* game,
                                  const std::string& player1_name,
                                  const std::string& player2_name,
                                  const std::string& current_player_name) {
-    clear_screen();
+    std::string frame;
 
     // Display player information at top
-    std::cout << std::format("{}{}Player 1 (X): {}{} vs {}{}Player 2 (O): {}{}\n",
-                            COLOR_BRIGHT_BLUE, ESCAPE_CODE_BOLD, player1_name, COLOR_RESET,
-                            COLOR_BRIGHT_RED, ESCAPE_CODE_BOLD, player2_name, COLOR_RESET);
+    frame += std::format("{}{}Player 1 (X): {}{} vs {}{}Player 2 (O): {}{}\n",
+                         COLOR_BRIGHT_BLUE, ESCAPE_CODE_BOLD, player1_name, COLOR_RESET,
+                         COLOR_BRIGHT_RED, ESCAPE_CODE_BOLD, player2_name, COLOR_RESET);
 
-    std::cout << std::format("{}Current turn: {}{}\n\n",
-                            COLOR_BRIGHT_GREEN, current_player_name, COLOR_RESET);
+    frame += std::format("{}Current turn: {}{}\n\n",
+                         COLOR_BRIGHT_GREEN, current_player_name, COLOR_RESET);
 
-    draw_board(game);
-    draw_status(game);
+    render_board(frame, game);
+    render_status(frame, game);
+    write_out(shared_screen().diff(frame));
 }
 
 } // namespace gomoku::ui
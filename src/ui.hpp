@@ -80,7 +80,7 @@ private:
 //===============================================================================
 
 /**
- * Clears the screen.
+ * Clears the screen; the next refresh paints the whole display.
  */
 void clear_screen();
 
@@ -119,13 +119,14 @@ void display_rules();
 void bad_beep();
 
 /**
- * Refreshes the entire game display.
+ * Refreshes the game display. The frame is composed in memory and only the
+ * cells that differ from the previous frame are written, in a single write.
  * @param game The game state
  */
 void refresh_display(const game_state_t* game);
 
 /**
- * Enhanced display with player information.
+ * Enhanced display with player information, refreshed like refresh_display().
  * @param game The game state
  * @param player1_name Name of player 1
  * @param player2_name Name of player 2
@@ -0,0 +1,81 @@
+//
+//  zobrist.hpp
+//  gomoku - Zobrist keys generated at compile time
+//
+//  One read-only key table per board size, shared by every game and search thread
+//
+
+#pragma once
+
+#include "gomoku.hpp"
+#include "board_symmetry.hpp"
+#include <array>
+#include <cstdint>
+
+namespace gomoku {
+
+//===============================================================================
+// ZOBRIST KEYS
+//===============================================================================
+
+/**
+ * One step of splitmix64: advances state and returns the next value of a
+ * stream whose every bit is well mixed, unlike the 31 bits rand() gives.
+ */
+[[nodiscard]] constexpr uint64_t splitmix64(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Start of the key stream; changing it invalidates opening books
+inline constexpr uint64_t ZOBRIST_SEED = 0x676F6D6F6B75ULL;
+
+/**
+ * Zobrist keys of a Size x Size board. stones[s][p][x * Size + y] is the key
+ * of player p's stone at (x, y) seen in orientation s, which is the plain
+ * key of cell transform_cell(s, x, y, Size). Hashing a position in all eight
+ * orientations is then a table lookup per orientation, with no transforms.
+ */
+template<int Size> requires ValidBoardSize<Size>
+struct ZobristKeys {
+    std::array<std::array<std::array<uint64_t, Size * Size>, 2>, SYMMETRY_COUNT> stones;
+    uint64_t side;   // XORed in whenever the side to move flips
+};
+
+template<int Size> requires ValidBoardSize<Size>
+[[nodiscard]] consteval ZobristKeys<Size> make_zobrist_keys() noexcept {
+    ZobristKeys<Size> keys{};
+
+    // Each size draws its own stream, so 15x15 and 19x19 positions sharing a
+    // transposition table do not share keys
+    uint64_t state = ZOBRIST_SEED ^ static_cast<uint64_t>(Size);
+    for (auto& player_keys : keys.stones[0]) {
+        for (uint64_t& key : player_keys) {
+            key = splitmix64(state);
+        }
+    }
+    keys.side = splitmix64(state);
+
+    for (int s = 1; s < SYMMETRY_COUNT; s++) {
+        for (int player = 0; player < 2; player++) {
+            for (int x = 0; x < Size; x++) {
+                for (int y = 0; y < Size; y++) {
+                    SymmetricCell cell = transform_cell(s, x, y, Size);
+                    keys.stones[s][player][x * Size + y] = keys.stones[0][player][cell.x * Size + cell.y];
+                }
+            }
+        }
+    }
+    return keys;
+}
+
+/**
+ * The keys every game of board size Size hashes with, built by the compiler
+ * into read-only storage.
+ */
+template<int Size> requires ValidBoardSize<Size>
+inline constexpr ZobristKeys<Size> ZOBRIST_KEYS = make_zobrist_keys<Size>();
+
+} // namespace gomoku
@@ -1,11 +1,32 @@
 #include <gtest/gtest.h>
 #include <cstdlib>
 #include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Include C-compatible headers for testing
 #include "gomoku.hpp"
 #include "game.h"
 #include "ai.h"
+#include "ai_parallel.hpp"
+#include "mcts.hpp"
+#include "simd_kernels.hpp"
+#include "move_picker.hpp"
+#include "threat_search.hpp"
+#include "ponder.hpp"
+#include "search_handle.hpp"
+#include "game_history.hpp"
+#include "game_analysis.hpp"
+#include "screen_buffer.hpp"
+#include "history_writer.hpp"
+#include "search_scratch.hpp"
+#include "search_metrics.hpp"
+#include "zobrist.hpp"
 
 class GomokuTest : public testing::Test {
 protected:
@@ -18,15 +39,12 @@ protected:
         board = create_board(BOARD_SIZE);
         ASSERT_NE(board, nullptr);
         
-        // Create a test configuration
-        cli_config_t config = {
-            .board_size = BOARD_SIZE,      // 19x19 board
-            .max_depth = 4,                // AI search depth
-            .move_timeout = 0,             // No timeout
-            .show_help = 0,                // Don't show help
-            .invalid_args = 0,             // Valid arguments
-            .enable_undo = 1               // Enable undo for testing
-        };
+        // Create a test configuration; every field not set here is zero or empty
+        cli_config_t config{};
+        config.board_size = BOARD_SIZE;    // 19x19 board
+        config.max_depth = 4;              // AI search depth
+        config.move_timeout = 0;           // No timeout
+        config.enable_undo = 1;            // Enable undo for testing
         
         // Create a test game state
         game = init_game(config);
@@ -35,6 +53,15 @@ protected:
         gomoku::populate_threat_matrix();
     }
     
+    // Mirrors the game's board into the legacy int** board used by the C shims
+    void copy_game_board() {
+        for (int i = 0; i < BOARD_SIZE; i++) {
+            for (int j = 0; j < BOARD_SIZE; j++) {
+                board[i][j] = game->board[i][j];
+            }
+        }
+    }
+    
     void TearDown() {
         if (board) {
             free_board(board, BOARD_SIZE);
@@ -312,6 +339,1285 @@ TEST_F(GomokuTest, BlockedPatterns) {
     EXPECT_GT(unblocked_score, score);
 }
 
+// Test that the bitwise threat kernel agrees with the line scan
+TEST_F(GomokuTest, BitboardThreatMatchesLineScan) {
+    using gomoku::Player;
+    constexpr int window = gomoku::NEED_TO_WIN * 2 - 1;
+    constexpr int center = gomoku::NEED_TO_WIN - 1;
+
+    // Enumerate every 3-state filling of the eight cells around the center
+    int combinations = 1;
+    for (int i = 0; i < window - 1; i++) {
+        combinations *= 3;
+    }
+
+    for (int code = 0; code < combinations; code++) {
+        std::array<Player, window> line{};
+        uint32_t own = 1u << center;
+        uint32_t opponent = 0;
+        int rest = code;
+
+        for (int i = 0; i < window; i++) {
+            if (i == center) {
+                line[i] = Player::Cross;
+                continue;
+            }
+            int cell = rest % 3;
+            rest /= 3;
+            line[i] = cell == 1 ? Player::Cross : cell == 2 ? Player::Naught : Player::Empty;
+            if (cell == 1) own |= 1u << i;
+            if (cell == 2) opponent |= 1u << i;
+        }
+
+        ASSERT_EQ(gomoku::calc_threat_in_window(own, opponent),
+                  gomoku::calc_threat_in_one_dimension(line, Player::Cross)) << "pattern " << code;
+    }
+}
+
+// Test that the bitboard mirror follows make_move/undo
+TEST_F(GomokuTest, BitboardTracksBoard) {
+    using gomoku::Player;
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(make_move(game, 5 + i, 5 + i, static_cast<int>(Player::Cross), 0.0, 0));
+        ASSERT_TRUE(make_move(game, 5 + i, 12, static_cast<int>(Player::Naught), 0.0, 0));
+    }
+
+    EXPECT_EQ(game->bitboard.stone_count(), 8);
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            ASSERT_EQ(static_cast<int>(game->bitboard.at(i, j)), game->board[i][j]);
+        }
+    }
+    EXPECT_FALSE(game->bitboard.has_five(Player::Cross));
+    EXPECT_EQ(game->bitboard.run_length(Player::Cross, 2, 9, 9), 5);
+
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(Player::Cross), 0.0, 0));
+    EXPECT_TRUE(game->bitboard.has_five(Player::Cross));
+    EXPECT_TRUE(game->bitboard.has_five_at(Player::Cross, 7, 7));
+    copy_game_board();
+    EXPECT_EQ(has_winner(board, BOARD_SIZE, static_cast<int>(Player::Cross)), 1);
+
+    undo_last_moves(game);
+    EXPECT_EQ(game->bitboard.stone_count(), 7);
+    EXPECT_TRUE(game->bitboard.is_empty(9, 9));
+    EXPECT_TRUE(game->bitboard.is_empty(8, 12));
+    EXPECT_FALSE(game->bitboard.has_five(Player::Cross));
+
+    // Evaluation through the legacy shim matches the bitboard kernel
+    copy_game_board();
+    EXPECT_EQ(evaluate_position(board, BOARD_SIZE, static_cast<int>(Player::Naught)),
+              gomoku::evaluate_position(game->bitboard, Player::Naught));
+}
+
+// Test that the incremental hash tracks moves, undo and search
+TEST_F(GomokuTest, IncrementalZobristHash) {
+    uint64_t empty_hash = game->current_hash;
+    EXPECT_EQ(empty_hash, compute_zobrist_hash(game));
+
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    EXPECT_EQ(game->current_hash, compute_zobrist_hash(game));
+
+    // Side to move is part of the key: one stone vs. the same stone plus a pass
+    uint64_t after_three = game->current_hash;
+    place_stone(game, 0, 0, static_cast<int>(gomoku::Player::Naught));
+    EXPECT_NE(game->current_hash, after_three);
+    remove_stone(game, 0, 0);
+    EXPECT_EQ(game->current_hash, after_three);
+
+    // A search makes and unmakes moves, leaving the hash untouched
+    game->max_depth = 2;
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(game->current_hash, after_three);
+
+    ASSERT_TRUE(make_move(game, best_x, best_y, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    undo_last_moves(game);
+    EXPECT_EQ(game->current_hash, compute_zobrist_hash(game));
+
+    undo_last_moves(game);
+    EXPECT_EQ(game->bitboard.stone_count(), 0);
+    EXPECT_EQ(game->current_hash, empty_hash);
+}
+
+// Test that the 15x15 specialization keeps the incremental state exact at the board edge
+TEST_F(GomokuTest, SizedMakeUnmakeOnSmallBoard) {
+    using gomoku::Player;
+
+    cli_config_t config = game->config;
+    config.board_size = 15;
+    game_state_t *small = init_game(config);
+    ASSERT_NE(small, nullptr);
+    uint64_t empty_hash = small->current_hash;
+
+    const int stones[4][3] = {{14, 14, static_cast<int>(Player::Cross)},
+                              {14, 13, static_cast<int>(Player::Naught)},
+                              {13, 14, static_cast<int>(Player::Cross)},
+                              {0, 14, static_cast<int>(Player::Naught)}};
+    for (const auto &stone : stones) {
+        place_stone<15>(small, stone[0], stone[1], stone[2]);
+    }
+    EXPECT_EQ(small->current_hash, compute_zobrist_hash(small));
+    EXPECT_EQ(small->threats.evaluate(Player::Cross), gomoku::evaluate_position(small->bitboard, Player::Cross));
+    EXPECT_TRUE(small->candidates.contains(12, 12));
+    EXPECT_FALSE(small->candidates.contains(14, 14));
+
+    // The sized search leaves the position as it found it
+    {
+        gomoku::ScratchLease lease(small);
+        int before = small->threats.evaluate(Player::Naught);
+        minimax_with_timeout<15>(small, 2, -1000000, 1000000, 1, static_cast<int>(Player::Naught), 0, 14);
+        EXPECT_EQ(small->threats.evaluate(Player::Naught), before);
+        EXPECT_EQ(small->current_hash, compute_zobrist_hash(small));
+    }
+
+    for (const auto &stone : stones) {
+        remove_stone<15>(small, stone[0], stone[1]);
+    }
+    EXPECT_EQ(small->current_hash, empty_hash);
+    EXPECT_EQ(small->bitboard.stone_count(), 0);
+    EXPECT_EQ(small->threats.evaluate(Player::Cross), 0);
+    cleanup_game(small);
+}
+
+// Test that the compile-time keys are distinct, match the symmetries and leave rand() alone
+TEST_F(GomokuTest, ZobristKeysAreStaticAndDistinct) {
+    const auto &keys = gomoku::ZOBRIST_KEYS<19>;
+    std::set<uint64_t> distinct;
+    for (const auto &player_keys : keys.stones[0]) {
+        distinct.insert(player_keys.begin(), player_keys.end());
+    }
+    distinct.insert(keys.side);
+    for (const auto &player_keys : gomoku::ZOBRIST_KEYS<15>.stones[0]) {
+        distinct.insert(player_keys.begin(), player_keys.end());
+    }
+    EXPECT_EQ(distinct.size(), 2u * 361 + 1 + 2 * 225);
+
+    gomoku::SymmetricCell cell = gomoku::transform_cell(1, 3, 4, 19);
+    EXPECT_EQ(keys.stones[1][0][3 * 19 + 4], keys.stones[0][0][cell.x * 19 + cell.y]);
+
+    // Starting a game no longer reseeds the C library generator
+    std::srand(99);
+    int expected = std::rand();
+    std::srand(99);
+    game_state_t *other = init_game(game->config);
+    EXPECT_EQ(std::rand(), expected);
+    cleanup_game(other);
+}
+
+// Test that rotated and mirrored positions share a key and translate table moves
+TEST_F(GomokuTest, SymmetricPositionsShareHash) {
+    using gomoku::Player;
+
+    const int stones[3][3] = {{3, 4, static_cast<int>(Player::Cross)},
+                              {5, 7, static_cast<int>(Player::Naught)},
+                              {6, 2, static_cast<int>(Player::Cross)}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+
+    for (int s = 1; s < gomoku::SYMMETRY_COUNT; s++) {
+        game_state_t *image = init_game(game->config);
+        ASSERT_NE(image, nullptr);
+        for (const auto &stone : stones) {
+            gomoku::SymmetricCell cell = gomoku::transform_cell(s, stone[0], stone[1], BOARD_SIZE);
+            ASSERT_TRUE(make_move(image, cell.x, cell.y, stone[2], 0.0, 0));
+        }
+        EXPECT_EQ(image->current_hash, game->current_hash) << "symmetry " << s;
+        EXPECT_EQ(image->current_hash, compute_zobrist_hash(image));
+
+        // A move stored from one orientation comes back as its image in the other
+        store_transposition(game, game->current_hash, 10, 5, TT_EXACT, 8, 1);
+        int x = -1, y = -1;
+        ASSERT_TRUE(probe_transposition_move(image, image->current_hash, &x, &y));
+        gomoku::SymmetricCell expected = gomoku::transform_cell(s, 8, 1, BOARD_SIZE);
+        EXPECT_EQ(x, expected.x);
+        EXPECT_EQ(y, expected.y);
+        cleanup_game(image);
+    }
+
+    // Placing and removing a stone restores the key along with the orientation
+    uint64_t key = game->current_hash;
+    int symmetry = game->hash_symmetry;
+    place_stone(game, 0, 0, static_cast<int>(Player::Naught));
+    remove_stone(game, 0, 0);
+    EXPECT_EQ(game->current_hash, key);
+    EXPECT_EQ(game->hash_symmetry, symmetry);
+}
+
+// Test store/probe, key verification and bucket replacement of the shared table
+TEST(TranspositionTableTest, StoreProbeAndReplace) {
+    gomoku::TranspositionTable table(1);
+    gomoku::TranspositionTable::Entry entry;
+
+    EXPECT_EQ(table.size_mb(), 1u);
+    EXPECT_FALSE(table.probe(0x1234, entry));
+
+    table.store(0x1234, -777, 5, TT_LOWER_BOUND, 3, 18);
+    ASSERT_TRUE(table.probe(0x1234, entry));
+    EXPECT_EQ(entry.value, -777);
+    EXPECT_EQ(entry.depth, 5);
+    EXPECT_EQ(entry.flag, TT_LOWER_BOUND);
+    EXPECT_EQ(entry.best_x, 3);
+    EXPECT_EQ(entry.best_y, 18);
+
+    // Same bucket, different key: the XOR check rejects it
+    uint64_t buckets = table.capacity() / gomoku::TranspositionTable::BUCKET_ENTRIES;
+    EXPECT_FALSE(table.probe(0x1234 + buckets, entry));
+
+    // A shallower result for the same position does not overwrite a deeper one
+    table.store(0x1234, 1, 2, TT_EXACT, -1, -1);
+    ASSERT_TRUE(table.probe(0x1234, entry));
+    EXPECT_EQ(entry.depth, 5);
+
+    // Filling the bucket evicts entries; the deepest survives
+    for (uint64_t i = 1; i <= 8; i++) {
+        table.store(0x1234 + i * buckets, static_cast<int>(i), 1, TT_EXACT, -1, -1);
+    }
+    ASSERT_TRUE(table.probe(0x1234, entry));
+    EXPECT_EQ(entry.value, -777);
+
+    // Once stale, depth alone no longer protects the old entry
+    table.new_search();
+    for (uint64_t i = 9; i <= 12; i++) {
+        table.store(0x1234 + i * buckets, static_cast<int>(i), 1, TT_EXACT, -1, -1);
+    }
+    EXPECT_FALSE(table.probe(0x1234, entry));
+
+    table.clear();
+    EXPECT_FALSE(table.probe(0x1234 + 12 * buckets, entry));
+    EXPECT_EQ(table.usage_permille(), 0);
+}
+
+// Test that a snapshot keeps only deep entries, reloads into any table size and rejects other builds
+TEST(TranspositionTableTest, SnapshotSavesDeepEntriesAndReloads) {
+    using gomoku::TranspositionTable;
+
+    TranspositionTable table(1);
+    TranspositionTable::Entry entry;
+    table.store(0xABCDEF, 4321, TranspositionTable::SNAPSHOT_MIN_DEPTH, TT_EXACT, 14, -1);
+    table.store(0x123456, -99, 8, TT_UPPER_BOUND, 0, 18);
+    table.store(0x777777, 5, TranspositionTable::SNAPSHOT_MIN_DEPTH - 1, TT_EXACT, 1, 1);
+
+    std::string path = testing::TempDir() + "gomoku_test.ttsnap";
+    auto saved = table.save_snapshot(path);
+    ASSERT_TRUE(saved.has_value()) << saved.error();
+    EXPECT_EQ(*saved, 2u);
+
+    TranspositionTable reloaded(2);
+    auto loaded = reloaded.load_snapshot(path);
+    ASSERT_TRUE(loaded.has_value()) << loaded.error();
+    EXPECT_EQ(*loaded, 2u);
+    ASSERT_TRUE(reloaded.probe(0xABCDEF, entry));
+    EXPECT_EQ(entry.value, 4321);
+    EXPECT_EQ(entry.depth, TranspositionTable::SNAPSHOT_MIN_DEPTH);
+    EXPECT_EQ(entry.best_x, 14);
+    EXPECT_EQ(entry.best_y, -1);
+    ASSERT_TRUE(reloaded.probe(0x123456, entry));
+    EXPECT_EQ(entry.value, -99);
+    EXPECT_EQ(entry.flag, TT_UPPER_BOUND);
+    EXPECT_FALSE(reloaded.probe(0x777777, entry));
+
+    // A snapshot from a build with other keys or evaluation is refused whole
+    FILE *file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    uint64_t fingerprint = TranspositionTable::snapshot_fingerprint() + 1;
+    fseek(file, sizeof(TranspositionTable::SNAPSHOT_MAGIC), SEEK_SET);
+    fwrite(&fingerprint, sizeof(fingerprint), 1, file);
+    fclose(file);
+    TranspositionTable stale(1);
+    EXPECT_FALSE(stale.load_snapshot(path).has_value());
+    EXPECT_FALSE(stale.probe(0x123456, entry));
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(stale.load_snapshot(path).has_value());
+}
+
+// Test that games share one table instead of owning a copy
+TEST_F(GomokuTest, GamesShareTranspositionTable) {
+    game_state_t *other = init_game(game->config);
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(game->transposition_table, &gomoku::shared_transposition_table());
+    EXPECT_EQ(other->transposition_table, game->transposition_table);
+
+    store_transposition(game, 0xabcdef, 42, 3, TT_EXACT, 1, 2);
+    int value = 0;
+    EXPECT_EQ(probe_transposition(other, 0xabcdef, 3, -100, 100, &value), 1);
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(probe_transposition(other, 0xabcdef, 4, -100, 100, &value), 0);
+
+    cleanup_game(other);
+}
+
+// Test that searches for either colour read each other's entries with the right sign
+TEST_F(GomokuTest, SharedTableServesBothColours) {
+    using gomoku::Player;
+    const int cross = static_cast<int>(Player::Cross);
+    const int naught = static_cast<int>(Player::Naught);
+
+    const int stones[][3] = {{9, 9, cross}, {9, 10, naught}, {10, 10, cross}, {8, 11, naught}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+    game->use_principal_variation = 0;
+    gomoku::ScratchLease lease(game);
+
+    // Crosses are to move: their own search maximizes here, naughts' minimizes
+    auto search = [&](int ai_player) {
+        return minimax_with_timeout(game, 3, -gomoku::WIN_SCORE - 1, gomoku::WIN_SCORE + 1,
+                                    ai_player == cross, ai_player, 9, 9);
+    };
+    int fresh[2];
+    for (int ai_player : {cross, naught}) {
+        game->transposition_table->clear();
+        fresh[ai_player == cross ? 0 : 1] = search(ai_player);
+    }
+    EXPECT_NE(fresh[0], 0);
+
+    for (int first : {cross, naught}) {
+        int second = other_player(first);
+        game->transposition_table->clear();
+        EXPECT_EQ(search(first), fresh[first == cross ? 0 : 1]);
+        EXPECT_EQ(search(second), fresh[second == cross ? 0 : 1]);
+    }
+}
+
+// Test that a worker replays a snapshot exactly and can be reused without allocating
+TEST_F(GomokuTest, SearchPositionReplaysIntoThreadState) {
+    using gomoku::Player;
+
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, static_cast<int>(Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, static_cast<int>(Player::Cross), 0.0, 0));
+
+    gomoku::ScratchLease lease(game);
+    gomoku::SearchPosition position = gomoku::SearchPosition::capture(*game);
+    EXPECT_EQ(position.hash, game->current_hash);
+    static_assert(sizeof(gomoku::SearchPosition) < 4096);
+
+    game_state_t *worker = gomoku::thread_search_state(*game, position);
+    ASSERT_NE(worker, game);
+    EXPECT_EQ(worker->bitboard, game->bitboard);
+    EXPECT_EQ(worker->current_hash, compute_zobrist_hash(worker));
+    EXPECT_GT(worker->candidates.count(), 0);
+    EXPECT_EQ(worker->candidates.count(), game->candidates.count());
+    for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int j = 0; j < BOARD_SIZE; j++) {
+            ASSERT_EQ(worker->board[i][j], game->board[i][j]);
+        }
+    }
+
+    int naught = static_cast<int>(Player::Naught);
+    int on_game = minimax_with_timeout(game, 2, -gomoku::WIN_SCORE - 1, gomoku::WIN_SCORE + 1, 1, naught, 10, 10);
+    int on_worker = minimax_with_timeout(worker, 2, -gomoku::WIN_SCORE - 1, gomoku::WIN_SCORE + 1, 1, naught, 10, 10);
+    EXPECT_EQ(on_worker, on_game);
+
+    // Leftover stones from a previous task are wiped on the next bind
+    place_stone(worker, 0, 0, naught);
+    gomoku::SearchPosition same = gomoku::SearchPosition::capture(*game);
+    game_state_t *again = gomoku::thread_search_state(*game, same);
+    EXPECT_EQ(again, worker);
+    EXPECT_EQ(again->board[0][0], static_cast<int>(Player::Empty));
+    EXPECT_EQ(again->current_hash, game->current_hash);
+}
+
+// Test that Lazy SMP search completes the requested depth and finds the win
+TEST_F(GomokuTest, LazySmpFindsWinningMove) {
+    using gomoku::Player;
+
+    const int cross_moves[4][2] = {{9, 5}, {9, 7}, {7, 5}, {7, 7}};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(make_move(game, cross_moves[i][0], cross_moves[i][1], static_cast<int>(Player::Cross), 0.0, 0));
+        ASSERT_TRUE(make_move(game, 11, 5 + i, static_cast<int>(Player::Naught), 0.0, 0));
+    }
+    // Block one end of Naught's four so the search has to find the other
+    ASSERT_TRUE(make_move(game, 11, 4, static_cast<int>(Player::Cross), 0.0, 0));
+    uint64_t hash_before = game->current_hash;
+
+    gomoku::ParallelAI lazy(2, gomoku::SearchMode::LazySmp);
+    EXPECT_EQ(lazy.get_search_mode(), gomoku::SearchMode::LazySmp);
+
+    game->max_depth = 2;
+    int best_x = -1, best_y = -1;
+    lazy.find_best_move_parallel(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, 11);
+    EXPECT_EQ(best_y, 9);
+    EXPECT_EQ(game->current_hash, hash_before);
+    EXPECT_EQ(game->abort_search, nullptr);
+
+    EXPECT_EQ(gomoku::parse_search_mode("root"), gomoku::SearchMode::RootSplit);
+    EXPECT_EQ(gomoku::parse_search_mode("lazy"), gomoku::SearchMode::LazySmp);
+    EXPECT_FALSE(gomoku::parse_search_mode("ybwc").has_value());
+}
+
+// Test that a root split search deepens by iterations and stops at its deadline
+TEST_F(GomokuTest, RootSplitHonorsDeadline) {
+    using gomoku::Player;
+
+    const int stones[][3] = {{9, 9, static_cast<int>(Player::Cross)}, {9, 10, static_cast<int>(Player::Naught)},
+                             {10, 10, static_cast<int>(Player::Cross)}, {8, 11, static_cast<int>(Player::Naught)},
+                             {10, 8, static_cast<int>(Player::Cross)}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+    gomoku::ParallelAI root(2, gomoku::SearchMode::RootSplit);
+    int best_x = -1, best_y = -1;
+
+    game->max_depth = 3;
+    root.find_best_move_parallel(game, &best_x, &best_y);
+    EXPECT_EQ(game->search_depth_reached, 3);
+    EXPECT_FALSE(game->search_timed_out);
+    EXPECT_TRUE(game->board.is_playable(best_x, best_y));
+    EXPECT_GT(game->search_nodes, 0u);
+
+    game->max_depth = 10;
+    game->search_timeout_ms = 100;
+    double started = get_current_time();
+    root.find_best_move_parallel(game, &best_x, &best_y);
+    EXPECT_LT(get_current_time() - started, 2.0);
+    EXPECT_TRUE(game->search_timed_out);
+    EXPECT_GE(game->search_depth_reached, 1);
+    EXPECT_LT(game->search_depth_reached, 10);
+    EXPECT_TRUE(game->board.is_playable(best_x, best_y));
+}
+
+TEST_F(GomokuTest, SearchPlaysSideToMove) {
+    using gomoku::Player;
+
+    // Naught's four is blocked at (11, 4), and crosses are to move
+    const int cross_moves[4][2] = {{9, 5}, {9, 7}, {7, 5}, {11, 4}};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(make_move(game, cross_moves[i][0], cross_moves[i][1], static_cast<int>(Player::Cross), 0.0, 0));
+        ASSERT_TRUE(make_move(game, 11, 5 + i, static_cast<int>(Player::Naught), 0.0, 0));
+    }
+    ASSERT_EQ(game->current_player, static_cast<int>(Player::Cross));
+
+    game->max_depth = 2;
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, 11);
+    EXPECT_EQ(best_y, 9);
+
+    gomoku::ParallelAI lazy(2, gomoku::SearchMode::LazySmp);
+    best_x = best_y = -1;
+    lazy.find_best_move_parallel(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, 11);
+    EXPECT_EQ(best_y, 9);
+
+    // With a four of its own, crosses win instead of blocking
+    ASSERT_TRUE(make_move(game, 8, 5, static_cast<int>(Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 0, 0, static_cast<int>(Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 6, 5, static_cast<int>(Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 0, 1, static_cast<int>(Player::Naught), 0.0, 0));
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(best_y, 5);
+    EXPECT_TRUE(best_x == 5 || best_x == 10);
+}
+
+TEST_F(GomokuTest, MctsBlocksWinsAndReusesTree) {
+    using gomoku::Player;
+
+    // Naught's four is blocked at (11, 4), and crosses are to move
+    const int cross_moves[4][2] = {{9, 5}, {9, 7}, {7, 5}, {11, 4}};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(make_move(game, cross_moves[i][0], cross_moves[i][1], static_cast<int>(Player::Cross), 0.0, 0));
+        ASSERT_TRUE(make_move(game, 11, 5 + i, static_cast<int>(Player::Naught), 0.0, 0));
+    }
+    uint64_t hash_before = game->current_hash;
+
+    // Leave the forcing lines to the tree rather than the threat-space solver
+    game->use_threat_space_search = 0;
+    game->max_depth = 2;
+    gomoku::MctsEngine engine;
+    int best_x = -1, best_y = -1;
+    engine.find_best_move(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, 11);
+    EXPECT_EQ(best_y, 9);
+    EXPECT_EQ(game->current_hash, hash_before);
+    EXPECT_GT(game->search_nodes, 0u);
+    EXPECT_EQ(engine.reused_visits(), 0u);
+
+    // The reply's search starts from the subtree below the move just played
+    ASSERT_TRUE(make_move(game, best_x, best_y, static_cast<int>(Player::Cross), 0.0, 0));
+    engine.find_best_move(game, &best_x, &best_y);
+    EXPECT_GT(engine.reused_visits(), 0u);
+    EXPECT_TRUE(game->board.is_playable(best_x, best_y));
+
+    // Searched through run_search() on a pool, crosses with a four win instead of blocking
+    ASSERT_TRUE(make_move(game, 0, 0, static_cast<int>(Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 8, 5, static_cast<int>(Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 0, 1, static_cast<int>(Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 6, 5, static_cast<int>(Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 0, 2, static_cast<int>(Player::Naught), 0.0, 0));
+    game->search_algorithm = gomoku::SearchAlgorithm::MonteCarlo;
+    gomoku::ParallelAI parallel(2);
+    gomoku::SearchResult result = gomoku::run_search(*game, &parallel);
+    EXPECT_EQ(result.move.y, 5);
+    EXPECT_TRUE(result.move.x == 5 || result.move.x == 10);
+    EXPECT_GE(result.depth, 1);
+    EXPECT_FALSE(result.stopped);
+
+    EXPECT_EQ(gomoku::parse_search_algorithm("mcts"), gomoku::SearchAlgorithm::MonteCarlo);
+    EXPECT_EQ(gomoku::parse_search_algorithm("alphabeta"), gomoku::SearchAlgorithm::AlphaBeta);
+    EXPECT_FALSE(gomoku::parse_search_algorithm("uct").has_value());
+}
+
+// Test the flat board's wall, row access and bitboard round trip
+TEST(FlatBoardTest, WallAndRowAccess) {
+    using gomoku::FlatBoard;
+    using gomoku::Player;
+
+    FlatBoard flat(15);
+    EXPECT_EQ(flat.size(), 15);
+    for (int i = -FlatBoard::PADDING; i < 15 + FlatBoard::PADDING; i++) {
+        EXPECT_EQ(flat[-1][i], FlatBoard::WALL);
+        EXPECT_EQ(flat[i][15], FlatBoard::WALL);
+        EXPECT_EQ(flat[i][-2], FlatBoard::WALL);
+    }
+    EXPECT_EQ(flat[0][0], static_cast<FlatBoard::Cell>(Player::Empty));
+    EXPECT_EQ(&flat[1][0] - &flat[0][0], FlatBoard::STRIDE);
+    EXPECT_EQ(&flat[1][1] - &flat[0][0], FlatBoard::step(1, 1));
+
+    EXPECT_TRUE(flat.is_playable(14, 14));
+    EXPECT_FALSE(flat.is_playable(15, 0));
+    EXPECT_FALSE(flat.is_playable(-3, 0));
+
+    // A walk needs no bounds check: it stops at the wall
+    for (int y = 10; y < 15; y++) {
+        flat[7][y] = static_cast<FlatBoard::Cell>(Player::Cross);
+    }
+    int run = 0;
+    for (const FlatBoard::Cell* cell = &flat[7][10]; *cell == static_cast<FlatBoard::Cell>(Player::Cross);
+            cell += FlatBoard::step(0, 1)) {
+        run++;
+    }
+    EXPECT_EQ(run, 5);
+    EXPECT_FALSE(flat.is_playable(7, 12));
+
+    gomoku::BitBoard bits(15);
+    bits.load(flat, 15);
+    EXPECT_TRUE(bits.has_five(Player::Cross));
+
+    FlatBoard copy;
+    copy.load(bits);
+    EXPECT_EQ(copy, flat);
+}
+
+// Test that the threat cache tracks place_stone()/remove_stone() exactly
+TEST_F(GomokuTest, ThreatCacheMatchesFullEvaluation) {
+    using gomoku::Player;
+
+    auto expect_in_sync = [&]() {
+        for (Player player : {Player::Cross, Player::Naught}) {
+            ASSERT_EQ(game->threats.evaluate(player), gomoku::evaluate_position(game->bitboard, player));
+        }
+        gomoku::ThreatCache rebuilt;
+        rebuilt.load(game->bitboard);
+        ASSERT_EQ(rebuilt.total(Player::Cross), game->threats.total(Player::Cross));
+        ASSERT_EQ(rebuilt.total(Player::Naught), game->threats.total(Player::Naught));
+    };
+
+    // Stones clustered around the centre so that lines overlap, then undone
+    std::srand(7);
+    int placed[40][2];
+    int count = 0;
+    int player = static_cast<int>(Player::Cross);
+    while (count < 40) {
+        int x = 6 + std::rand() % 7;
+        int y = 6 + std::rand() % 7;
+        if (!game->board.is_playable(x, y)) {
+            continue;
+        }
+        place_stone(game, x, y, player);
+        placed[count][0] = x;
+        placed[count][1] = y;
+        count++;
+        player = other_player(player);
+        expect_in_sync();
+    }
+    EXPECT_EQ(game->threats.has_five(Player::Cross), game->bitboard.has_five(Player::Cross));
+    EXPECT_EQ(game->threats.has_five(Player::Naught), game->bitboard.has_five(Player::Naught));
+
+    while (count > 0) {
+        count--;
+        remove_stone(game, placed[count][0], placed[count][1]);
+        expect_in_sync();
+    }
+    EXPECT_EQ(game->threats.total(Player::Cross), 0);
+    EXPECT_EQ(game->threats.total(Player::Naught), 0);
+}
+
+// Test that the dispatched five-in-a-row kernel agrees with the scalar loop
+TEST(SimdKernelsTest, AnyFiveMatchesScalar) {
+    using gomoku::simd::any_five;
+    using gomoku::simd::any_five_scalar;
+
+    std::string_view kernel = gomoku::simd::kernel_name();
+    EXPECT_TRUE(kernel == "avx2" || kernel == "neon" || kernel == "scalar") << kernel;
+
+    // Every length around the vector widths, with the run in each position
+    std::array<uint32_t, 4 * gomoku::BitBoard::MAX_LINES> lines{};
+    for (size_t count = 0; count <= lines.size(); count++) {
+        std::span<const uint32_t> view(lines.data(), count);
+        ASSERT_FALSE(any_five(view));
+
+        for (size_t i = 0; i < count; i++) {
+            lines[i] = 0b1111011110u << (i % 20);  // two broken fours
+            ASSERT_FALSE(any_five(view)) << count << " " << i;
+            lines[i] |= 0b11111u << 27;            // five at the top of the word
+            ASSERT_TRUE(any_five(view)) << count << " " << i;
+            lines[i] = 0;
+        }
+    }
+
+    std::srand(11);
+    for (int round = 0; round < 1000; round++) {
+        for (auto& line : lines) {
+            line = static_cast<uint32_t>(std::rand()) & static_cast<uint32_t>(std::rand());
+        }
+        ASSERT_EQ(any_five(lines), any_five_scalar(lines));
+    }
+
+    gomoku::BitBoard bits(19);
+    for (int i = 0; i < 5; i++) {
+        bits.place(14 - i, 4 + i, gomoku::Player::Naught);
+    }
+    EXPECT_TRUE(bits.has_five(gomoku::Player::Naught));
+    EXPECT_FALSE(bits.has_five(gomoku::Player::Cross));
+}
+
+// Test that the move picker hands out table move, wins, blocks, killers, then the rest
+TEST_F(GomokuTest, MovePickerStagesMoves) {
+    using MovePicker = gomoku::MovePicker<19>;
+    const int naught = static_cast<int>(gomoku::Player::Naught);
+    const int cross = static_cast<int>(gomoku::Player::Cross);
+
+    // Naught has an open four on row 5, Cross one on row 10
+    for (int y = 5; y <= 8; y++) {
+        ASSERT_TRUE(make_move(game, 5, y, naught, 0.0, 0));
+        ASSERT_TRUE(make_move(game, 10, y, cross, 0.0, 0));
+    }
+    store_transposition(game, game->current_hash, 0, 30, TT_EXACT, 12, 12);
+    gomoku::ScratchLease lease(game);
+    game->scratch->killer_moves[3][0][0] = 7;
+    game->scratch->killer_moves[3][0][1] = 6;
+
+    move_t all[361];
+    int candidates = generate_moves_optimized(game, all, naught);
+
+    int tt_x = -1, tt_y = -1;
+    ASSERT_TRUE(probe_transposition_move(game, game->current_hash, &tt_x, &tt_y));
+    MovePicker picker(game, 3, naught, tt_x, tt_y);
+
+    std::vector<move_t> picked;
+    move_t move;
+    while (picker.next(move)) {
+        picked.push_back(move);
+    }
+    ASSERT_EQ(static_cast<int>(picked.size()), candidates + 1);
+    EXPECT_EQ(picker.picked(), candidates + 1);
+
+    EXPECT_EQ(picked[0].x, 12);
+    EXPECT_EQ(picked[0].y, 12);
+    for (int i = 1; i <= 2; i++) {
+        EXPECT_EQ(picked[i].x, 5);
+        EXPECT_EQ(picked[i].priority, 100000);
+    }
+    for (int i = 3; i <= 4; i++) {
+        EXPECT_EQ(picked[i].x, 10);
+        EXPECT_EQ(picked[i].priority, 50000);
+    }
+    EXPECT_EQ(picked[5].x, 7);
+    EXPECT_EQ(picked[5].y, 6);
+    EXPECT_GE(picked[5].priority, MovePicker::KILLER_PRIORITY);
+    for (size_t i = 7; i < picked.size(); i++) {
+        EXPECT_GE(picked[i - 1].priority, picked[i].priority) << i;
+    }
+
+    // Every move exactly once
+    std::set<std::pair<int, int>> unique;
+    for (const move_t &m : picked) {
+        unique.insert({m.x, m.y});
+    }
+    EXPECT_EQ(unique.size(), picked.size());
+}
+
+// Test that killers are kept per ply and that history and countermoves feed move ordering
+TEST_F(GomokuTest, CutoffHeuristicsFeedOrdering) {
+    using MovePicker = gomoku::MovePicker<19>;
+    const int naught = static_cast<int>(gomoku::Player::Naught);
+    const int cross = static_cast<int>(gomoku::Player::Cross);
+
+    ASSERT_TRUE(make_move(game, 9, 9, cross, 0.0, 0));
+    gomoku::ScratchLease lease(game);
+    store_killer_move(game, 2, 8, 8);
+    EXPECT_TRUE(is_killer_move(game, 2, 8, 8));
+    EXPECT_FALSE(is_killer_move(game, 3, 8, 8));
+    store_killer_move(game, MAX_SEARCH_DEPTH, 7, 7);
+    EXPECT_FALSE(is_killer_move(game, MAX_SEARCH_DEPTH, 7, 7));
+
+    // History is the depth-weighted share of a move's searches that cut off
+    for (int i = 0; i < 4; i++) {
+        store_butterfly_move(game, naught, 4, 10, 10);
+        store_butterfly_move(game, naught, 4, 10, 8);
+    }
+    store_history_move(game, naught, 4, 10, 10);
+    store_history_move(game, naught, 4, 10, 10);
+    int cutting = get_history_score(game, naught, 10, 10);
+    EXPECT_GT(cutting, 0);
+    EXPECT_LT(cutting, MAX_HISTORY_SCORE / 2);
+    EXPECT_EQ(get_history_score(game, naught, 10, 8), 0);
+    EXPECT_EQ(get_history_score(game, cross, 10, 10), 0);
+    age_history_scores(game);
+    EXPECT_GT(get_history_score(game, naught, 10, 10), 0);
+
+    // The countermove to the previous move outranks every other quiet move
+    store_countermove(game, naught, 9, 9, 11, 7);
+    int counter_x = -1, counter_y = -1;
+    ASSERT_TRUE(get_countermove(game, naught, 9, 9, &counter_x, &counter_y));
+    EXPECT_EQ(counter_x, 11);
+    EXPECT_EQ(counter_y, 7);
+    EXPECT_FALSE(get_countermove(game, naught, 9, 10, &counter_x, &counter_y));
+
+    init_killer_moves(game);
+    MovePicker picker(game, 1, naught, -1, -1, 9, 9);
+    move_t move;
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move.x, 11);
+    EXPECT_EQ(move.y, 7);
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move.x, 10);
+    EXPECT_EQ(move.y, 10);
+}
+
+// Test that games keep only their own state and borrow search heuristics while searching
+TEST_F(GomokuTest, SearchScratchIsLentPerSearch) {
+    const int naught = static_cast<int>(gomoku::Player::Naught);
+
+    // Thousands of idle games fit in a few tens of megabytes
+    EXPECT_LT(sizeof(game_state_t), 8192u);
+    EXPECT_EQ(game->scratch, nullptr);
+
+    gomoku::SearchScratchPool pool(1);
+    search_scratch_t *first = nullptr;
+    {
+        gomoku::ScratchLease lease(game, pool);
+        first = game->scratch;
+        ASSERT_NE(first, nullptr);
+        EXPECT_EQ(first->owner, game->search_id);
+        store_history_move(game, naught, 4, 10, 10);
+
+        // Nested entry points reuse the attached scratch
+        gomoku::ScratchLease nested(game, pool);
+        EXPECT_EQ(game->scratch, first);
+    }
+    EXPECT_EQ(game->scratch, nullptr);
+    EXPECT_EQ(pool.idle(), 1u);
+
+    // The next search of the same game gets its heuristics back
+    {
+        gomoku::ScratchLease lease(game, pool);
+        EXPECT_EQ(game->scratch, first);
+        EXPECT_GT(get_history_score(game, naught, 10, 10), 0);
+    }
+
+    // Another game takes the idle block over with the heuristics cleared
+    game_state_t *other = init_game(game->config);
+    ASSERT_NE(other->search_id, game->search_id);
+    {
+        gomoku::ScratchLease lease(other, pool);
+        EXPECT_EQ(other->scratch->owner, other->search_id);
+        EXPECT_EQ(get_history_score(other, naught, 10, 10), 0);
+    }
+    cleanup_game(other);
+}
+
+// Test that a written book maps back, rejects bad files and answers before any search
+TEST_F(GomokuTest, OpeningBookProbesBeforeSearch) {
+    using gomoku::BookEntry;
+    using gomoku::OpeningBook;
+    using gomoku::Player;
+
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(Player::Cross), 0.0, 0));
+    uint64_t hash = game->current_hash;
+
+    std::string path = testing::TempDir() + "gomoku_test.book";
+    std::vector<BookEntry> entries = {
+        {hash + 1, 5, 1, 1, 4, 19},
+        {hash, 120, 10, 8, 8, 19},
+        {hash, 0, 2, 2, 8, 15},
+    };
+    ASSERT_TRUE(OpeningBook::write(path, entries).has_value());
+
+    OpeningBook book;
+    ASSERT_TRUE(book.open(path).has_value());
+    EXPECT_EQ(book.size(), 3u);
+    auto hit = book.probe(hash, BOARD_SIZE);
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->x, 10);
+    EXPECT_EQ(hit->y, 8);
+    EXPECT_EQ(book.probe(hash, 15)->x, 2);
+    EXPECT_FALSE(book.probe(hash + 2, BOARD_SIZE).has_value());
+
+    // A search would place the first reply at random; the book decides it instead
+    game->opening_book = &book;
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, 10);
+    EXPECT_EQ(best_y, 8);
+    EXPECT_EQ(game->search_depth_reached, 8);
+
+    FILE *file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    fputs("NOTABOOK", file);
+    fclose(file);
+    EXPECT_FALSE(book.open(path).has_value());
+    EXPECT_FALSE(book.is_open());
+    EXPECT_FALSE(book.probe(hash, BOARD_SIZE).has_value());
+    std::remove(path.c_str());
+}
+
+// Test that the threat-space solver proves a win needing two fours and the AI plays it
+TEST_F(GomokuTest, ThreatSearchFindsVcf) {
+    using gomoku::Player;
+
+    // The four at (8,7) leaves (8,8) a double four; the one at (7,7) leads to an open
+    // four on the anti-diagonal. No single move wins outright.
+    const int naught = static_cast<int>(Player::Naught);
+    const int cross = static_cast<int>(Player::Cross);
+    const int stones[][3] = {{5, 8, naught}, {6, 8, naught}, {7, 8, naught}, {4, 8, cross},
+                             {8, 5, naught}, {8, 6, naught}, {8, 4, cross},
+                             {9, 7, naught}, {10, 7, naught}, {11, 7, naught}, {12, 7, cross}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+
+    gomoku::BitBoard before = game->bitboard;
+    gomoku::ThreatSearch solver(game->bitboard, Player::Naught, gomoku::ThreatSearch::ROOT_VCF);
+    auto move = solver.solve();
+    ASSERT_TRUE(move.has_value());
+    EXPECT_EQ(move->y, 7);
+    EXPECT_TRUE(move->x == 7 || move->x == 8);
+    EXPECT_GT(solver.nodes(), 1u);
+    EXPECT_TRUE(game->bitboard == before);
+
+    // Cross has no four to start from, so it has no VCF
+    EXPECT_FALSE(gomoku::ThreatSearch::has_four_move(game->bitboard, Player::Cross));
+    EXPECT_FALSE(gomoku::ThreatSearch(game->bitboard, Player::Cross, gomoku::ThreatSearch::ROOT_VCF).solve());
+
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(best_x, move->x);
+    EXPECT_EQ(best_y, move->y);
+}
+
+// Test that PVS picks the plain alpha-beta move while visiting far fewer positions
+TEST_F(GomokuTest, PrincipalVariationSearchMatchesPlainSearch) {
+    using gomoku::Player;
+
+    const int stones[][3] = {{9, 9, static_cast<int>(Player::Cross)}, {9, 10, static_cast<int>(Player::Naught)},
+                             {10, 10, static_cast<int>(Player::Cross)}, {8, 11, static_cast<int>(Player::Naught)},
+                             {10, 8, static_cast<int>(Player::Cross)}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+
+    // Node counts include the re-searches of aspiration windows that failed
+    int moves[2][2];
+    uint64_t nodes[2];
+    for (int plain = 0; plain < 2; plain++) {
+        game->use_principal_variation = !plain;
+        game->transposition_table->clear();
+        find_best_ai_move(game, &moves[plain][0], &moves[plain][1]);
+        nodes[plain] = game->search_nodes;
+        EXPECT_EQ(game->search_depth_reached, game->max_depth);
+    }
+
+    EXPECT_EQ(moves[0][0], moves[1][0]);
+    EXPECT_EQ(moves[0][1], moves[1][1]);
+    EXPECT_LT(nodes[0] * 2, nodes[1]);
+}
+
+// Test that a search counts its table lookups, and that searching again finds more entries
+TEST_F(GomokuTest, SearchCountsTranspositionHits) {
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+
+    game->max_depth = 3;
+    game->transposition_table->clear();
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    uint64_t cold_probes = game->search_tt_probes;
+    uint64_t cold_hits = game->search_tt_hits;
+    EXPECT_GT(cold_probes, 0u);
+    EXPECT_LE(cold_hits, cold_probes);
+
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_LE(game->search_tt_hits, game->search_tt_probes);
+    EXPECT_GT(game->search_tt_hits * cold_probes, cold_hits * game->search_tt_probes);
+}
+
+TEST_F(GomokuTest, SearchMetricsCountOnlyWhenEnabled) {
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    game->max_depth = 3;
+    game->transposition_table->clear();
+    int best_x = -1, best_y = -1;
+
+    gomoku::reset_search_metrics();
+    gomoku::enable_search_metrics(true);
+    find_best_ai_move(game, &best_x, &best_y);
+    gomoku::enable_search_metrics(false);
+
+    gomoku::SearchMetricsSnapshot metrics = gomoku::collect_search_metrics();
+    EXPECT_EQ(metrics.searches(), 1u);
+    EXPECT_EQ(metrics.nodes, game->search_nodes);
+    EXPECT_EQ(metrics.tt_probes, game->search_tt_probes);
+    EXPECT_EQ(metrics.tt_hits, game->search_tt_hits);
+    EXPECT_GT(metrics.leaf_evals(), 0u);
+    EXPECT_GT(metrics.phase_calls[static_cast<int>(gomoku::SearchPhase::MoveGen)], 0u);
+    EXPECT_GT(metrics.phase_ns[static_cast<int>(gomoku::SearchPhase::Search)], 0u);
+    for (int depth = 1; depth <= game->search_depth_reached; depth++) {
+        EXPECT_EQ(metrics.depth_completed[depth], 1u) << "depth " << depth;
+    }
+    uint64_t cutoffs = 0;
+    for (uint64_t count : metrics.cutoffs) {
+        cutoffs += count;
+    }
+    EXPECT_GT(cutoffs, 0u);
+
+    // Counts from a thread that has exited are kept
+    std::thread([] {
+        gomoku::enable_search_metrics(true);
+        gomoku::record_cutoff(100);
+        gomoku::enable_search_metrics(false);
+    }).join();
+    EXPECT_EQ(gomoku::collect_search_metrics().cutoffs.back(), metrics.cutoffs.back() + 1);
+
+    // Disabled, a search leaves every counter alone
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(gomoku::collect_search_metrics().nodes, metrics.nodes);
+    EXPECT_EQ(gomoku::collect_search_metrics().searches(), 1u);
+}
+
+// Test that an aspiration window that fails is counted apart from the search repeated in full
+TEST_F(GomokuTest, AspirationResearchCountedApart) {
+    using gomoku::Player;
+    const int stones[][3] = {{9, 9, static_cast<int>(Player::Cross)}, {9, 10, static_cast<int>(Player::Naught)},
+                             {10, 10, static_cast<int>(Player::Cross)}, {8, 11, static_cast<int>(Player::Naught)},
+                             {10, 8, static_cast<int>(Player::Cross)}};
+    for (const auto &stone : stones) {
+        ASSERT_TRUE(make_move(game, stone[0], stone[1], stone[2], 0.0, 0));
+    }
+    int best_x = -1, best_y = -1;
+
+    // Each iteration scores every root move once, whatever window it starts from
+    game->use_aspiration_windows = 0;
+    game->transposition_table->clear();
+    find_best_ai_move(game, &best_x, &best_y);
+    int full_window_moves = game->search_moves_evaluated;
+
+    game->use_aspiration_windows = 1;
+    game->transposition_table->clear();
+    gomoku::reset_search_metrics();
+    gomoku::enable_search_metrics(true);
+    find_best_ai_move(game, &best_x, &best_y);
+    gomoku::enable_search_metrics(false);
+
+    gomoku::SearchMetricsSnapshot metrics = gomoku::collect_search_metrics();
+    EXPECT_GT(metrics.research_nodes, 0u);
+    EXPECT_LT(metrics.research_nodes, metrics.nodes);
+    EXPECT_EQ(metrics.nodes, game->search_nodes);
+    EXPECT_EQ(game->search_moves_evaluated, full_window_moves);
+}
+
+TEST_F(GomokuTest, CandidateSetTracksStones) {
+    // Every empty cell within the radius of a stone, found the slow way
+    auto expected = [this]() {
+        std::set<std::pair<int, int>> cells;
+        for (int x = 0; x < BOARD_SIZE; x++) {
+            for (int y = 0; y < BOARD_SIZE; y++) {
+                if (game->board[x][y] != static_cast<int>(gomoku::Player::Empty)) {
+                    continue;
+                }
+                int r = gomoku::CandidateSet::RADIUS;
+                for (int i = std::max(0, x - r); i <= std::min(BOARD_SIZE - 1, x + r); i++) {
+                    for (int j = std::max(0, y - r); j <= std::min(BOARD_SIZE - 1, y + r); j++) {
+                        if (game->board[i][j] != static_cast<int>(gomoku::Player::Empty)) {
+                            cells.insert({x, y});
+                        }
+                    }
+                }
+            }
+        }
+        return cells;
+    };
+    auto actual = [this]() {
+        std::set<std::pair<int, int>> cells;
+        game->candidates.for_each([&](int x, int y) { cells.insert({x, y}); });
+        EXPECT_EQ(static_cast<int>(cells.size()), game->candidates.count());
+        return cells;
+    };
+
+    EXPECT_EQ(game->candidates.count(), 25);
+    EXPECT_TRUE(game->candidates.contains(BOARD_SIZE / 2, BOARD_SIZE / 2));
+
+    ASSERT_TRUE(make_move(game, 9, 9, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 0, 1, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 11, static_cast<int>(gomoku::Player::Cross), 0.0, 0));
+    ASSERT_TRUE(make_move(game, 11, 11, static_cast<int>(gomoku::Player::Naught), 0.0, 0));
+    std::set<std::pair<int, int>> before = actual();
+    EXPECT_EQ(before, expected());
+    EXPECT_FALSE(game->candidates.contains(9, 9));
+
+    // A search leaves the set as it found it
+    game->max_depth = 2;
+    int best_x = -1, best_y = -1;
+    find_best_ai_move(game, &best_x, &best_y);
+    EXPECT_EQ(actual(), before);
+
+    undo_last_moves(game);
+    EXPECT_EQ(actual(), expected());
+    remove_stone(game, 9, 9);
+    remove_stone(game, 0, 1);
+    EXPECT_EQ(game->candidates.count(), 25);
+}
+
+TEST_F(GomokuTest, PonderHandsOverPredictedReply) {
+    int cross = static_cast<int>(gomoku::Player::Cross);
+    int naught = static_cast<int>(gomoku::Player::Naught);
+    ASSERT_TRUE(make_move(game, 9, 9, cross, 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, naught, 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, cross, 0.0, 0));
+    ASSERT_TRUE(make_move(game, 8, 8, naught, 0.0, 0));
+    game->max_depth = 2;
+
+    gomoku::Ponderer ponderer;
+    ASSERT_TRUE(ponderer.start(*game));
+    auto reply = ponderer.predicted_reply();
+    ASSERT_TRUE(reply.has_value());
+    ASSERT_TRUE(game->board.is_playable(reply->x, reply->y));
+
+    // The predicted reply is played: the pondered move is handed over
+    ASSERT_TRUE(make_move(game, reply->x, reply->y, cross, 0.0, 0));
+    auto move = ponderer.take(*game);
+    ASSERT_TRUE(move.has_value());
+    EXPECT_TRUE(game->board.is_playable(move->move.x, move->move.y));
+    EXPECT_EQ(game->search_depth_reached, 2);
+    EXPECT_EQ(ponderer.hits(), 1);
+    EXPECT_FALSE(ponderer.is_pondering());
+
+    // Any other reply stops the ponder and leaves the move to a real search
+    ASSERT_TRUE(make_move(game, move->move.x, move->move.y, naught, 0.0, 0));
+    ASSERT_TRUE(ponderer.start(*game));
+    reply = ponderer.predicted_reply();
+    ASSERT_TRUE(reply.has_value());
+    int x = 0;
+    while (!game->board.is_playable(x, 0) || x == reply->x) {
+        x++;
+    }
+    ASSERT_TRUE(make_move(game, x, 0, cross, 0.0, 0));
+    EXPECT_FALSE(ponderer.take(*game).has_value());
+    EXPECT_EQ(ponderer.misses(), 1);
+    EXPECT_FALSE(ponderer.is_pondering());
+}
+
+TEST_F(GomokuTest, SearchHandleReportsDepthsAndStops) {
+    int cross = static_cast<int>(gomoku::Player::Cross);
+    int naught = static_cast<int>(gomoku::Player::Naught);
+    ASSERT_TRUE(make_move(game, 9, 9, cross, 0.0, 0));
+    ASSERT_TRUE(make_move(game, 9, 10, naught, 0.0, 0));
+    ASSERT_TRUE(make_move(game, 10, 10, cross, 0.0, 0));
+    game->max_depth = 3;
+
+    std::vector<gomoku::SearchInfo> infos;
+    gomoku::SearchHandle handle = gomoku::SearchHandle::start(*game, nullptr,
+            [&infos](const gomoku::SearchInfo &info) { infos.push_back(info); });
+    ASSERT_TRUE(handle.wait_for(std::chrono::seconds(30)));
+    gomoku::SearchResult result = handle.get();
+    EXPECT_FALSE(handle.valid());
+
+    ASSERT_EQ(infos.size(), 3u);
+    for (size_t i = 0; i < infos.size(); i++) {
+        EXPECT_EQ(infos[i].depth, static_cast<int>(i) + 1);
+        ASSERT_FALSE(infos[i].pv.empty());
+        EXPECT_LE(infos[i].pv.size(), static_cast<size_t>(infos[i].depth));
+    }
+    EXPECT_EQ(result.depth, 3);
+    EXPECT_EQ(result.move.x, infos.back().pv[0].x);
+    EXPECT_EQ(result.move.y, infos.back().pv[0].y);
+    EXPECT_EQ(result.score, infos.back().score);
+    EXPECT_GE(result.nodes, infos.back().nodes);
+    EXPECT_FALSE(result.stopped);
+    EXPECT_EQ(game->bitboard.stone_count(), 3);
+
+    // A stop request ends a deep search with the best move found so far
+    game->max_depth = MAX_SEARCH_DEPTH;
+    handle = gomoku::SearchHandle::start(*game, nullptr);
+    handle.request_stop();
+    ASSERT_TRUE(handle.wait_for(std::chrono::seconds(30)));
+    result = handle.get();
+    EXPECT_TRUE(result.stopped);
+    EXPECT_LT(result.depth, MAX_SEARCH_DEPTH);
+    EXPECT_TRUE(game->board.is_playable(result.move.x, result.move.y));
+    EXPECT_EQ(game->abort_search, nullptr);
+}
+
+TEST_F(GomokuTest, GameHistoryJournalFinalizesToSchema) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "gomoku-history-test";
+    fs::remove_all(dir);
+
+    cli_config_t config{};
+    config.board_size = 15;
+    std::snprintf(config.player1_type, sizeof(config.player1_type), "human");
+    std::snprintf(config.player2_type, sizeof(config.player2_type), "computer");
+
+    gomoku::GameHistory history(config, dir.string(), "game.json");
+    ASSERT_TRUE(history.initialize());
+    move_history_t move{};
+    move.x = 7; move.y = 7; move.player = static_cast<int>(gomoku::Player::Cross);
+    ASSERT_TRUE(history.log_move(move));
+    move.x = 8; move.y = 8; move.player = static_cast<int>(gomoku::Player::Naught);
+    ASSERT_TRUE(history.log_move(move));
+    ASSERT_TRUE(history.update_game_status("game_over_o_wins"));
+
+    // Until finalized, the game lives only in the journal
+    gomoku::shared_history_writer().flush();
+    EXPECT_TRUE(fs::exists(history.get_journal_path()));
+    EXPECT_FALSE(fs::exists(history.get_file_path()));
+
+    history.finalize();
+    gomoku::shared_history_writer().flush();
+    EXPECT_FALSE(fs::exists(history.get_journal_path()));
+    std::ifstream file(history.get_file_path());
+    auto game = nlohmann::json::parse(file);
+    EXPECT_EQ(game["version"], "1.0");
+    EXPECT_EQ(game["game"]["status"], "game_over_o_wins");
+    EXPECT_EQ(game["players"]["o"]["type"], "ai");
+    ASSERT_EQ(game["moves"].size(), 2u);
+    EXPECT_EQ(game["moves"][1]["position"]["x"], 8);
+    EXPECT_EQ(game["current_player"], "x");
+    EXPECT_FALSE(game.contains("type"));
+
+    // A journal torn mid-record by a crash still finalizes, without the torn move
+    fs::path journal = dir / "crashed.jsonl";
+    fs::path recovered = dir / "crashed.json";
+    {
+        std::ofstream out(journal);
+        out << R"({"type":"game","version":"1.0","game":{"status":"in_progress","board_size":15},"players":{}})" << '\n'
+            << R"({"type":"move","move":{"player":"x","position":{"x":7,"y":7}}})" << '\n'
+            << R"({"type":"move","move":{"player":"o","posi)";
+    }
+    ASSERT_TRUE(gomoku::GameHistory::finalize_journal(journal.string(), recovered.string()));
+    std::ifstream recovered_file(recovered);
+    game = nlohmann::json::parse(recovered_file);
+    EXPECT_EQ(game["moves"].size(), 1u);
+    EXPECT_EQ(game["current_player"], "o");
+    EXPECT_EQ(game["game"]["status"], "in_progress");
+
+    fs::remove_all(dir);
+}
+
+TEST_F(GomokuTest, GameAnalyzerFlagsBlundersInLogs) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::temp_directory_path() / "gomoku-analysis-test";
+    fs::remove_all(dir);
+
+    // O ignores the open three, then X misses the straight four that wins
+    cli_config_t config{};
+    config.board_size = 15;
+    std::snprintf(config.player1_type, sizeof(config.player1_type), "human");
+    std::snprintf(config.player2_type, sizeof(config.player2_type), "human");
+    {
+        gomoku::GameHistory history(config, dir.string(), "a.json");
+        ASSERT_TRUE(history.initialize());
+        int moves[][2] = {{7, 7}, {0, 0}, {7, 8}, {0, 2}, {7, 9}, {0, 4}, {3, 3}};
+        for (int i = 0; i < 7; i++) {
+            move_history_t move{};
+            move.x = moves[i][0];
+            move.y = moves[i][1];
+            move.player = static_cast<int>(i % 2 == 0 ? gomoku::Player::Cross : gomoku::Player::Naught);
+            ASSERT_TRUE(history.log_move(move));
+        }
+    }
+    gomoku::shared_history_writer().flush();
+    std::ofstream(dir / "b.json") << R"({"game": {"board": {"side_length": 19}}})";
+
+    auto paths = gomoku::find_game_logs(dir.string());
+    ASSERT_TRUE(paths.has_value()) << paths.error();
+    ASSERT_EQ(paths->size(), 2u);
+    EXPECT_FALSE(gomoku::find_game_logs((dir / "*.txt").string()).has_value());
+
+    std::FILE* out = std::tmpfile();
+    ASSERT_NE(out, nullptr);
+    gomoku::AnalysisOptions options;
+    options.depth = 4;
+    options.threads = 2;
+    EXPECT_EQ(gomoku::GameAnalyzer(options, out).run(*paths), 1);
+
+    std::rewind(out);
+    std::vector<nlohmann::json> moves;
+    nlohmann::json game, error, summary;
+    char line[4096];
+    while (std::fgets(line, sizeof(line), out)) {
+        auto record = nlohmann::json::parse(line);
+        if (record["type"] == "move") {
+            moves.push_back(record);
+        } else {
+            (record["type"] == "game" ? game : record["type"] == "error" ? error : summary) = record;
+        }
+    }
+    std::fclose(out);
+
+    ASSERT_EQ(moves.size(), 7u);
+    EXPECT_EQ(moves[5]["player"], "o");
+    EXPECT_EQ(moves[5]["flags"].get<std::vector<std::string>>(), std::vector<std::string>{"blunder"});
+    EXPECT_TRUE(moves[6]["best"] == nlohmann::json({7, 10}) || moves[6]["best"] == nlohmann::json({7, 6}));
+    EXPECT_EQ(moves[6]["flags"].get<std::vector<std::string>>(),
+              (std::vector<std::string>{"blunder", "missed_win"}));
+    EXPECT_TRUE(moves[0]["flags"].empty());
+    EXPECT_EQ(game["moves"], 7);
+    EXPECT_EQ(game["missed_wins"], 1);
+    EXPECT_EQ(error["file"], (dir / "b.json").string());
+    EXPECT_EQ(summary["games"], 1);
+    EXPECT_EQ(summary["errors"], 1);
+    EXPECT_EQ(summary["positions"], 7);
+
+    fs::remove_all(dir);
+}
+
+TEST(ScreenBufferTest, WritesOnlyChangedCells) {
+    gomoku::ui::ScreenBuffer screen;
+    std::string frame = "ab\033[31mcd\033[0m\n\033[4;2H· ✕\n";
+
+    // The first frame clears the screen and paints everything
+    std::string first = screen.diff(frame);
+    EXPECT_NE(first.find("\033[2J"), std::string::npos);
+    EXPECT_NE(first.find("ab\033[31mcd"), std::string::npos);
+    EXPECT_NE(first.find("\033[4;2H\033[0m·"), std::string::npos);
+    EXPECT_NE(first.find("\033[4;4H✕"), std::string::npos);
+
+    // An unchanged frame only clears below itself and parks the cursor there
+    EXPECT_EQ(screen.diff(frame), "\033[0m\033[5;1H\033[J\033[5;1H");
+
+    // A moved stone touches its two cells, a changed colour one cell
+    std::string moved = "ab\033[31mc\033[0;34md\033[0m\n\033[4;2H✕ ·\n";
+    EXPECT_EQ(screen.diff(moved),
+              "\033[0m\033[5;1H\033[J\033[1;4H\033[34md\033[4;2H\033[0m✕\033[4;4H·\033[5;1H");
+
+    // Cells the new frame leaves out are blanked, and a variation selector stays with its character
+    EXPECT_EQ(screen.diff("ab\n\n\n\033[4;2H\u25FC\uFE0E"),
+              "\033[0m\033[5;1H\033[J\033[1;3H  \033[4;2H\u25FC\uFE0E\033[4;4H \033[5;1H");
+
+    screen.invalidate();
+    EXPECT_NE(screen.diff(moved).find("\033[2J"), std::string::npos);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
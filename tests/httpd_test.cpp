@@ -11,10 +11,16 @@
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
+#include <atomic>
+#include <future>
+#include <set>
+#include <tuple>
 
 #include "httpd_cli.hpp"
 #include "httpd_game_api.hpp"
 #include "httpd_server.hpp"
+#include "httpd_search_pool.hpp"
+#include "httpd_wire.hpp"
 
 using namespace gomoku::httpd;
 using json = nlohmann::json;
@@ -153,6 +159,211 @@ TEST_F(HttpdTest, JSONValidation) {
     }
 }
 
+TEST_F(HttpdTest, SessionCacheContinuesGame) {
+    auto human_move = [](int x, int y) {
+        json move;
+        move["player"] = "x";
+        move["position"]["x"] = x;
+        move["position"]["y"] = y;
+        move["move_time_ms"] = 0;
+        move["positions_evaluated"] = 0;
+        return move;
+    };
+    
+    json request = GameAPI::create_empty_game(15, "session-1");
+    request.erase("board_state");
+    request["moves"].push_back(human_move(7, 7));
+    request["current_player"] = "o";
+    
+    GameAPI api(2, 4);
+    auto first = api.process_move_request(request);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(api.session_cache_metrics()["entries"], 1);
+    EXPECT_EQ(api.session_cache_metrics()["misses"], 1);
+    
+    // The next request replays the game so far and adds one move
+    request["moves"] = first->move_history;
+    request["moves"].push_back(human_move(0, 0));
+    auto second = api.process_move_request(request);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->move_history.size(), 4);
+    EXPECT_EQ(api.session_cache_metrics()["hits"], 1);
+    EXPECT_EQ(api.session_cache_metrics()["rejected"], 0);
+    
+    // A move list that rewrites the cached game is rebuilt from the request
+    request["moves"] = json::array({human_move(3, 3)});
+    auto third = api.process_move_request(request);
+    ASSERT_TRUE(third.has_value());
+    EXPECT_EQ(third->move_history.size(), 2);
+    EXPECT_EQ(api.session_cache_metrics()["rejected"], 1);
+    EXPECT_EQ(api.session_cache_metrics()["entries"], 1);
+}
+
+TEST_F(HttpdTest, MoveRequestHonorsTimeout) {
+    json request = GameAPI::create_empty_game(15, "timeout-1");
+    request.erase("board_state");
+    const int stones[][3] = {{7, 7, 1}, {8, 8, -1}, {7, 8, 1}, {6, 6, -1}, {8, 7, 1}};
+    for (const auto& stone : stones) {
+        json move;
+        move["player"] = stone[2] == 1 ? "x" : "o";
+        move["position"]["x"] = stone[0];
+        move["position"]["y"] = stone[1];
+        request["moves"].push_back(move);
+    }
+    request["current_player"] = "o";
+    request["game"]["ai_config"]["depth"] = 10;
+    request["game"]["ai_config"]["timeout_ms"] = 100;
+    
+    // Sequential and Lazy SMP searches both stop at the deadline
+    for (int search_threads : {1, 2}) {
+        GameAPI api(10, 0, search_threads);
+        auto started = std::chrono::steady_clock::now();
+        auto result = api.process_move_request(request);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        
+        ASSERT_TRUE(result.has_value());
+        EXPECT_LT(elapsed, std::chrono::seconds(3));
+        EXPECT_TRUE(result->timed_out);
+        EXPECT_LT(result->depth_reached, 10);
+        EXPECT_GT(result->positions_evaluated, 0);
+        EXPECT_EQ(result->move["positions_evaluated"], result->positions_evaluated);
+    }
+}
+
+TEST_F(HttpdTest, BinaryWireFormat) {
+    EXPECT_EQ(wire_format_from_content_type("application/json; charset=utf-8"), WireFormat::Json);
+    EXPECT_EQ(wire_format_from_content_type("application/msgpack"), WireFormat::MessagePack);
+    EXPECT_FALSE(wire_format_from_content_type("text/plain").has_value());
+    EXPECT_EQ(wire_format_from_accept("text/html, application/cbor;q=0.9", WireFormat::Json), WireFormat::Cbor);
+    EXPECT_EQ(wire_format_from_accept("*/*", WireFormat::MessagePack), WireFormat::MessagePack);
+    
+    json request = GameAPI::create_empty_game(15, "binary-1");
+    request.erase("board_state");
+    json move;
+    move["player"] = "x";
+    move["position"]["x"] = 7;
+    move["position"]["y"] = 7;
+    request["moves"].push_back(move);
+    request["current_player"] = "o";
+    
+    // A move list sent as MessagePack, answered with a packed board
+    std::string body = encode_body(request, WireFormat::MessagePack);
+    EXPECT_LT(body.size(), request.dump().size());
+    GameAPI api(2, 0);
+    auto result = api.process_move_request(decode_body(body, WireFormat::MessagePack));
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result->board_packed.size(), (15 * 15 + 3) / 4);
+    
+    gomoku::FlatBoard board(15);
+    ASSERT_TRUE(GameAPI::unpack_board(result->board_packed, board, 15).has_value());
+    int stones = 0;
+    for (int i = 0; i < 15; ++i) {
+        for (int j = 0; j < 15; ++j) {
+            stones += board[i][j] != static_cast<int>(gomoku::Player::Empty);
+        }
+    }
+    EXPECT_EQ(stones, 2);
+    EXPECT_EQ(board[7][7], static_cast<int>(gomoku::Player::Cross));
+    
+    // The packed board stands in for board_state in a CBOR request
+    request["moves"] = result->move_history;
+    request["board_packed"] = json::binary(result->board_packed);
+    auto next = api.process_move_request(decode_body(encode_body(request, WireFormat::Cbor), WireFormat::Cbor));
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->move_history.size(), 3);
+}
+
+TEST_F(HttpdTest, SearchPoolShedsLoad) {
+    using std::chrono::milliseconds;
+    SearchPool pool(1, 1);
+    
+    // Hold the only worker until released
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> running{false};
+    std::thread busy([&] {
+        auto result = pool.run(milliseconds(0), [&](milliseconds) { running = true; released.wait(); return 1; });
+        EXPECT_TRUE(result.has_value());
+    });
+    while (!running) {
+        std::this_thread::yield();
+    }
+    
+    // Takes the only queue slot, and will wait past its timeout
+    std::expected<int, SearchRejection> queued_result;
+    std::thread queued([&] { queued_result = pool.run(milliseconds(10), [](milliseconds) { return 2; }); });
+    while (pool.metrics()["queue_depth"] != 1) {
+        std::this_thread::yield();
+    }
+    
+    auto refused = pool.run(milliseconds(0), [](milliseconds) { return 3; });
+    ASSERT_FALSE(refused.has_value());
+    EXPECT_EQ(refused.error(), SearchRejection::QueueFull);
+    
+    std::this_thread::sleep_for(milliseconds(30));
+    release.set_value();
+    busy.join();
+    queued.join();
+    
+    ASSERT_FALSE(queued_result.has_value());
+    EXPECT_EQ(queued_result.error(), SearchRejection::Expired);
+    
+    json metrics = pool.metrics();
+    EXPECT_EQ(metrics["completed"], 1);
+    EXPECT_EQ(metrics["rejected_queue_full"], 1);
+    EXPECT_EQ(metrics["expired"], 1);
+    EXPECT_EQ(metrics["queue_depth"], 0);
+}
+
+TEST_F(HttpdTest, QueuedSearchGetsRemainingBudget) {
+    using std::chrono::milliseconds;
+    SearchPool pool(1, 1);
+    
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> running{false};
+    std::thread busy([&] {
+        pool.run(milliseconds(0), [&](milliseconds) { running = true; released.wait(); return 0; });
+    });
+    while (!running) {
+        std::this_thread::yield();
+    }
+    
+    std::expected<milliseconds, SearchRejection> budget;
+    std::thread queued([&] { budget = pool.run(milliseconds(1000), [](milliseconds left) { return left; }); });
+    while (pool.metrics()["queue_depth"] != 1) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(milliseconds(100));
+    release.set_value();
+    busy.join();
+    queued.join();
+    
+    ASSERT_TRUE(budget.has_value());
+    EXPECT_LE(*budget, milliseconds(900));
+    EXPECT_GE(*budget, SearchPool::MIN_SEARCH_BUDGET);
+    
+    // Without a timeout the search has no budget either
+    auto unbounded = pool.run(milliseconds(0), [](milliseconds left) { return left; });
+    ASSERT_TRUE(unbounded.has_value());
+    EXPECT_EQ(*unbounded, milliseconds(0));
+}
+
+TEST_F(HttpdTest, MoveDepthOutOfRangeRejected) {
+    GameAPI api(2);
+    json request = GameAPI::create_empty_game(15, "deep-1");
+    request.erase("board_state");
+    request["current_player"] = "x";
+    
+    for (int depth : {0, gomoku::MAX_DEPTH + 1}) {
+        request["game"]["ai_config"]["depth"] = depth;
+        EXPECT_FALSE(api.process_move_request(request).has_value()) << "depth " << depth;
+        EXPECT_FALSE(api.process_batch_position(request).has_value()) << "depth " << depth;
+    }
+    request["game"]["ai_config"]["depth"] = 1;
+    EXPECT_TRUE(api.process_move_request(request).has_value());
+}
+
 TEST_F(HttpdTest, HTTPServerBasicFunctionality) {
     // This is an integration test that would require more setup
     // For now, we'll test that the server can be created
@@ -163,6 +374,250 @@ TEST_F(HttpdTest, HTTPServerBasicFunctionality) {
     });
 }
 
+TEST_F(HttpdTest, BatchMovesStreamNDJSON) {
+    HttpServer server(config_);
+    ASSERT_TRUE(server.start());
+    
+    json position = GameAPI::create_empty_game(15, "batch-1");
+    position.erase("board_state");
+    json move;
+    move["player"] = "x";
+    move["position"]["x"] = 7;
+    move["position"]["y"] = 7;
+    position["moves"].push_back(move);
+    position["current_player"] = "o";
+    
+    json invalid = position;
+    invalid.erase("version");
+    json batch = json::array({position, invalid, position});
+    
+    httplib::Client client(config_.host, config_.port);
+    auto res = client.Post("/ai/v1/moves:batch", batch.dump(), "application/json");
+    server.stop();
+    
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    
+    // One line per position, in completion order
+    std::istringstream lines(res->body);
+    std::string line;
+    std::set<int> indices;
+    while (std::getline(lines, line)) {
+        json result = json::parse(line);
+        int index = result["index"];
+        indices.insert(index);
+        if (index == 1) {
+            EXPECT_EQ(result["status"], 400);
+        } else {
+            EXPECT_EQ(result["status"], 200);
+            EXPECT_EQ(result["result"]["game_id"], "batch-1");
+            EXPECT_TRUE(result["result"]["latest_move"].contains("position"));
+        }
+    }
+    EXPECT_EQ(indices, (std::set<int>{0, 1, 2}));
+}
+
+TEST_F(HttpdTest, RootSplitSharesMovesWithPeers) {
+    config_.cluster_key = "split-key";
+    HttpServer peer(config_);
+    ASSERT_TRUE(peer.start());
+    
+    json position = GameAPI::create_empty_game(15, "split-1");
+    position.erase("board_state");
+    for (auto [player, x, y] : {std::tuple{"x", 7, 7}, std::tuple{"o", 7, 8}, std::tuple{"x", 8, 8}}) {
+        json move;
+        move["player"] = player;
+        move["position"]["x"] = x;
+        move["position"]["y"] = y;
+        position["moves"].push_back(move);
+    }
+    position["current_player"] = "o";
+    position["game"]["ai_config"]["depth"] = 4;
+    
+    // Nothing listens on port 1, so that peer's moves are searched locally
+    GameAPI coordinator(2, 0, 1);
+    coordinator.enable_root_split({{config_.host, config_.port}, {config_.host, 1}},
+                                  std::chrono::milliseconds(2000), 3, config_.cluster_key);
+    auto result = coordinator.process_move_request(position);
+    peer.stop();
+    
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->depth_reached, 4);
+    EXPECT_FALSE(result->timed_out);
+    int x = result->move["position"]["x"];
+    int y = result->move["position"]["y"];
+    EXPECT_TRUE(x >= 0 && x < 15 && y >= 0 && y < 15);
+    
+    json peers = coordinator.root_split_metrics();
+    ASSERT_EQ(peers.size(), 2u);
+    EXPECT_GT(peers[0]["moves"].get<uint64_t>(), 0u);
+    EXPECT_EQ(peers[0]["failures"], 0);
+    EXPECT_EQ(peers[1]["moves"], 0);
+    EXPECT_EQ(peers[1]["failures"], 1);
+    
+    // The subtree protocol survives its binary encoding
+    SubtreeRequest request;
+    request.board_size = 15;
+    request.board_packed = {1, 2, 3};
+    request.to_move = gomoku::Player::Naught;
+    request.depth = 5;
+    request.alpha = -42;
+    request.moves = {{3, 4}, {14, 0}};
+    auto decoded = SubtreeRequest::from_json(decode_body(encode_body(request.to_json(), WireFormat::MessagePack),
+                                                         WireFormat::MessagePack));
+    ASSERT_TRUE(decoded.has_value()) << decoded.error();
+    EXPECT_EQ(decoded->board_packed, request.board_packed);
+    EXPECT_EQ(decoded->to_move, gomoku::Player::Naught);
+    EXPECT_EQ(decoded->alpha, -42);
+    EXPECT_EQ(decoded->moves, request.moves);
+    request.moves = {{15, 0}};
+    EXPECT_FALSE(SubtreeRequest::from_json(request.to_json()).has_value());
+    EXPECT_FALSE(parse_peer_list("alpha:5500,beta").has_value());
+}
+
+TEST_F(HttpdTest, RootSplitDoesNotWaitOnStalledPeer) {
+    // A peer that accepts the subtree request and then sends nothing
+    std::atomic<bool> released{false};
+    httplib::Server stalled;
+    stalled.Post(SubtreeRequest::PATH, [&](const httplib::Request&, httplib::Response& res) {
+        for (int i = 0; i < 500 && !released; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        res.status = 503;
+    });
+    int port = stalled.bind_to_any_port(config_.host);
+    std::thread serving([&] { stalled.listen_after_bind(); });
+    stalled.wait_until_ready();
+    
+    json position = GameAPI::create_empty_game(15, "stall-1");
+    position.erase("board_state");
+    for (auto [player, x, y] : {std::tuple{"x", 7, 7}, std::tuple{"o", 7, 8}, std::tuple{"x", 8, 8}}) {
+        json move;
+        move["player"] = player;
+        move["position"]["x"] = x;
+        move["position"]["y"] = y;
+        position["moves"].push_back(move);
+    }
+    position["current_player"] = "o";
+    position["game"]["ai_config"]["depth"] = 6;
+    position["game"]["ai_config"]["timeout_ms"] = 300;
+    
+    GameAPI coordinator(2, 0, 1);
+    coordinator.enable_root_split({{config_.host, port}}, std::chrono::milliseconds(10000), 3, "stall-key");
+    auto started = std::chrono::steady_clock::now();
+    auto result = coordinator.process_move_request(position);
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    released = true;
+    stalled.stop();
+    serving.join();
+    
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->timed_out);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(2000));
+}
+
+TEST_F(HttpdTest, SubtreeServedOnlyToClusterPeers) {
+    SubtreeRequest request;
+    request.board_size = 15;
+    request.board_packed.assign(57, 0);
+    request.depth = 2;
+    request.moves = {{7, 7}};
+    std::string body = encode_body(request.to_json(), WireFormat::MessagePack);
+    std::string content_type = wire_content_type(WireFormat::MessagePack);
+    
+    // Without a cluster key the endpoint is not there at all
+    {
+        HttpServer server(config_);
+        ASSERT_TRUE(server.start());
+        httplib::Client client(config_.host, config_.port);
+        auto res = client.Post(SubtreeRequest::PATH, body, content_type);
+        ASSERT_TRUE(res);
+        EXPECT_EQ(res->status, 404);
+        server.stop();
+    }
+    
+    config_.cluster_key = "cluster-secret";
+    config_.port++;
+    HttpServer server(config_);
+    ASSERT_TRUE(server.start());
+    httplib::Client client(config_.host, config_.port);
+    for (const char* key : {"", "cluster-secreT", "cluster-secret-and-more"}) {
+        httplib::Headers headers;
+        if (*key) {
+            headers.emplace(SubtreeRequest::KEY_HEADER, key);
+        }
+        auto res = client.Post(SubtreeRequest::PATH, headers, body, content_type);
+        ASSERT_TRUE(res);
+        EXPECT_EQ(res->status, 403) << key;
+    }
+    auto res = client.Post(SubtreeRequest::PATH, httplib::Headers{{SubtreeRequest::KEY_HEADER, "cluster-secret"}},
+                           body, content_type);
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_NE(res->body.find("\"score\""), std::string::npos);
+    server.stop();
+    
+    // A coordinator must have a key for its peers to accept it
+    const char* args[] = {"gomoku-httpd", "--peers", "127.0.0.1:5505"};
+    EXPECT_FALSE(parse_command_line(3, const_cast<char**>(args)).has_value());
+}
+
+TEST_F(HttpdTest, MetricsEndpointServesPrometheusText) {
+    config_.search_metrics = true;
+    HttpServer server(config_);
+    ASSERT_TRUE(server.start());
+    
+    // Past the first reply, which is placed without a search
+    json position = GameAPI::create_empty_game(15, "metrics-1");
+    position.erase("board_state");
+    for (auto [player, x, y] : {std::tuple{"x", 7, 7}, std::tuple{"o", 7, 8}, std::tuple{"x", 8, 8}}) {
+        json move;
+        move["player"] = player;
+        move["position"]["x"] = x;
+        move["position"]["y"] = y;
+        position["moves"].push_back(move);
+    }
+    position["current_player"] = "o";
+    
+    httplib::Client client(config_.host, config_.port);
+    auto moved = client.Post("/ai/v1/move", position.dump(), "application/json");
+    auto res = client.Get("/metrics");
+    server.stop();
+    
+    ASSERT_TRUE(moved);
+    EXPECT_EQ(moved->status, 200);
+    ASSERT_TRUE(res);
+    EXPECT_EQ(res->status, 200);
+    EXPECT_TRUE(res->get_header_value("Content-Type").starts_with("text/plain; version=0.0.4"));
+    
+    // The move request was logged before /metrics was routed; /metrics itself is not yet
+    const std::string& body = res->body;
+    EXPECT_NE(body.find("# TYPE gomoku_http_request_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(body.find("gomoku_http_request_duration_seconds_count{route=\"/ai/v1/move\"} 1\n"), std::string::npos);
+    EXPECT_NE(body.find("gomoku_http_request_duration_seconds_bucket{route=\"/ai/v1/move\",le=\"+Inf\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(body.find("gomoku_search_queue_wait_seconds_count 1\n"), std::string::npos);
+    EXPECT_NE(body.find("gomoku_search_requests_total{outcome=\"completed\"} 1\n"), std::string::npos);
+    EXPECT_NE(body.find("gomoku_search_metrics_enabled 1\n"), std::string::npos);
+    
+    // Every sample line is a name, optional labels and a number
+    std::istringstream lines(body);
+    std::string line;
+    uint64_t nodes = 0;
+    while (std::getline(lines, line)) {
+        if (line.empty() || line.starts_with("#")) {
+            continue;
+        }
+        size_t space = line.rfind(' ');
+        ASSERT_NE(space, std::string::npos) << line;
+        EXPECT_NO_THROW((void)std::stod(line.substr(space + 1))) << line;
+        if (line.starts_with("gomoku_search_nodes_total ")) {
+            nodes = std::stoull(line.substr(space + 1));
+        }
+    }
+    EXPECT_GT(nodes, 0u);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();